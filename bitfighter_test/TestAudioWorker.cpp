@@ -0,0 +1,156 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "AudioWorker.h"
+#include "VoiceJitterBuffer.h"
+#include "voiceCodec.h"
+
+#include "TestUtils.h"
+#include "gtest/gtest.h"
+
+namespace Zap
+{
+
+class LoopbackAudioWorker : public AudioWorker
+{
+protected:
+   VoiceDecoder *createDecoder() { return new LoopbackVoiceDecoder(); }
+};
+
+
+static const S32 SamplesPerFrame = 160;
+
+static void addFrames(VoiceJitterBuffer &buffer, U8 first, U8 count, U32 time)
+{
+   U8 data[256];
+   for(U8 i = 0; i < count; i++)
+      data[i] = first + i;
+
+   buffer.addPacket(data, count, time);
+}
+
+
+TEST(AudioWorkerTest, JitterBufferWaitsForCushion)
+{
+   VoiceJitterBuffer buffer(new LoopbackVoiceDecoder());
+   Vector<S16> samples;
+
+   addFrames(buffer, 1, 3, 0);            // 60ms isn't enough to start with...
+   buffer.readSamples(0, samples);
+   EXPECT_EQ(0, samples.size());
+   EXPECT_FALSE(buffer.isPlaying());
+
+   addFrames(buffer, 4, 3, 20);           // ...but 120ms is
+   buffer.readSamples(20, samples);
+   EXPECT_TRUE(buffer.isPlaying());
+   ASSERT_EQ(2 * SamplesPerFrame, samples.size());    // PlayAhead worth
+   EXPECT_EQ(1, samples[0]);
+   EXPECT_EQ(2, samples[SamplesPerFrame]);
+
+   // Nothing more until the device has room for it
+   buffer.readSamples(20, samples);
+   EXPECT_EQ(2 * SamplesPerFrame, samples.size());
+
+   buffer.readSamples(40, samples);
+   ASSERT_EQ(3 * SamplesPerFrame, samples.size());
+   EXPECT_EQ(3, samples[2 * SamplesPerFrame]);
+}
+
+
+TEST(AudioWorkerTest, JitterBufferPlaysShortBurst)
+{
+   VoiceJitterBuffer buffer(new LoopbackVoiceDecoder());
+   Vector<S16> samples;
+
+   // A single frame will never reach TargetDelay; it gets played once it has waited that long
+   addFrames(buffer, 7, 1, 0);
+   buffer.readSamples(VoiceJitterBuffer::TargetDelay - 1, samples);
+   EXPECT_EQ(0, samples.size());
+
+   buffer.readSamples(VoiceJitterBuffer::TargetDelay, samples);
+   ASSERT_TRUE(samples.size() >= SamplesPerFrame);
+   EXPECT_EQ(7, samples[0]);
+}
+
+
+TEST(AudioWorkerTest, JitterBufferConcealsUnderrun)
+{
+   VoiceJitterBuffer buffer(new LoopbackVoiceDecoder());
+   Vector<S16> samples;
+
+   addFrames(buffer, 1, 6, 0);
+
+   for(U32 time = 0; time <= 200; time += 20)
+      buffer.readSamples(time, samples);
+
+   // Six real frames, then MaxConcealTime's worth of made up ones, then we give up
+   S32 concealed = VoiceJitterBuffer::MaxConcealTime / 20;
+   ASSERT_EQ((6 + concealed) * SamplesPerFrame, samples.size());
+   EXPECT_EQ(6, samples[5 * SamplesPerFrame]);
+   EXPECT_EQ(-1, samples[6 * SamplesPerFrame]);
+   EXPECT_EQ(-1, samples.last());
+   EXPECT_EQ(concealed, buffer.getConcealedFrames());
+   EXPECT_FALSE(buffer.isPlaying());
+
+   // Speaker starts up again; we wait for a new cushion
+   addFrames(buffer, 20, 6, 220);
+   buffer.readSamples(220, samples);
+   EXPECT_TRUE(buffer.isPlaying());
+   EXPECT_EQ(20, samples[(6 + concealed) * SamplesPerFrame]);
+}
+
+
+TEST(AudioWorkerTest, JitterBufferDropsOldAudio)
+{
+   VoiceJitterBuffer buffer(new LoopbackVoiceDecoder());
+   Vector<S16> samples;
+
+   addFrames(buffer, 1, 16, 0);           // 320ms, over MaxDelay
+
+   U32 targetDelay = VoiceJitterBuffer::TargetDelay;
+   EXPECT_EQ(targetDelay, buffer.getBufferedTime());
+   EXPECT_EQ(10, buffer.getDroppedFrames());
+
+   buffer.readSamples(0, samples);
+   ASSERT_TRUE(samples.size() > 0);
+   EXPECT_EQ(11, samples[0]);             // Oldest audio is gone
+}
+
+
+TEST(AudioWorkerTest, SpeakersComeAndGo)
+{
+   LoopbackAudioWorker worker;            // No thread; we call process() ourselves
+   U8 data[6] = { 1, 2, 3, 4, 5, 6 };
+
+   EXPECT_TRUE(worker.addVoicePacket(1, data, sizeof(data)));
+   EXPECT_TRUE(worker.addVoicePacket(2, data, sizeof(data)));
+
+   worker.process(0);
+   EXPECT_EQ(2, worker.getSpeakerCount());
+
+   AudioWorker::VoiceSamples samples;
+   bool found[3] = { false, false, false };
+
+   while(worker.getVoiceSamples(samples))
+   {
+      ASSERT_TRUE(samples.speakerId == 1 || samples.speakerId == 2);
+      EXPECT_EQ(1, samples.samples[0]);
+      found[samples.speakerId] = true;
+   }
+
+   EXPECT_TRUE(found[1] && found[2]);
+
+   worker.removeSpeaker(1);
+   worker.process(20);
+   EXPECT_EQ(1, worker.getSpeakerCount());
+
+   while(worker.getVoiceSamples(samples))
+      EXPECT_EQ(2, samples.speakerId);
+
+   EXPECT_EQ(0, worker.getDroppedSamples());
+}
+
+
+};
@@ -6,9 +6,13 @@
 #include "UIEditor.h"
 
 #include "ClientGame.h"
+#include "EditorUndoManager.h"
+#include "Level.h"
 #include "UIManager.h"
 #include "WallItem.h"
 
+#include "tnlPlatform.h"
+
 #include "TestUtils.h"
 #include "gtest/gtest.h"
 
@@ -140,4 +144,148 @@ TEST(EditorTest, panZoom)
    ASSERT_FLOAT_EQ( 900, r.max.y);
 }   
 
+
+TEST(EditorTest, snapToObjects)
+{
+   GamePair pair;
+   EditorUserInterface editorUi(pair.getClient(0), NULL);
+   editorUi.setLevel(boost::shared_ptr<Level>(new Level("BarrierMaker 20 0 0 100 0\n"
+                                                        "BarrierMaker 20 5000 5000 5100 5000\n"
+                                                        "BarrierMaker 20 20 20 20 100\n")));
+   Level *level = editorUi.getLevel();
+   const F32 minDist = 100;      // Squared, so we'll snap to anything within 10
+
+   // Snaps to the nearby vertex...
+   EXPECT_EQ(Point(100, 0), editorUi.snapToObjects(Point(95, 3), Point(95, 3), minDist));
+
+   // ...but not to one that's too far away, even if it's the closest one around
+   EXPECT_EQ(Point(60, 0), editorUi.snapToObjects(Point(60, 0), Point(60, 0), minDist));
+
+   // And never to selected objects
+   static_cast<BfObject *>(level->findObjects_fast(WallItemTypeNumber)->get(2))->setSelected(true);
+   EXPECT_EQ(Point(22, 22), editorUi.snapToObjects(Point(22, 22), Point(22, 22), minDist));
+   EXPECT_EQ(Point(0, 0),   editorUi.snapToObjects(Point(2, 2),   Point(2, 2),   minDist));
+}
+
+// Moves every wall in the level by offset, in a single undoable transaction
+static void moveAllWalls(Editor::EditorUndoManager &undoManager, Level *level, const Point &offset)
+{
+   const Vector<DatabaseObject *> *walls = level->findObjects_fast(WallItemTypeNumber);
+
+   undoManager.startTransaction();
+
+   for(S32 i = 0; i < walls->size(); i++)
+   {
+      WallItem *wall = static_cast<WallItem *>(walls->get(i));
+
+      undoManager.saveChangeAction_before(wall);
+      wall->moveTo(wall->getVert(0) + offset);
+      undoManager.saveChangeAction_after(wall);
+   }
+
+   undoManager.endTransaction();
+}
+
+
+TEST(EditorTest, undoMove)
+{
+   boost::shared_ptr<Level> level(new Level("BarrierMaker 20 0 0 100 0\n"
+                                            "BarrierMaker 20 0 0 0 100 100 100\n"));
+   Editor::EditorUndoManager undoManager;
+   undoManager.setLevel(level, NULL);
+
+   const Vector<DatabaseObject *> *walls = level->findObjects_fast(WallItemTypeNumber);
+   ASSERT_EQ(2, walls->size());
+   WallItem *wall = static_cast<WallItem *>(walls->get(1));
+
+   moveAllWalls(undoManager, level.get(), Point(50, 60));
+   EXPECT_EQ(Point(50, 60), wall->getVert(0));
+   EXPECT_EQ(Point(150, 160), wall->getVert(2));
+
+   undoManager.undo();
+   EXPECT_EQ(Point(0, 0), wall->getVert(0));
+   EXPECT_EQ(Point(100, 100), wall->getVert(2));
+   EXPECT_EQ(Point(100, 0), static_cast<WallItem *>(walls->get(0))->getVert(1));
+
+   undoManager.redo();
+   EXPECT_EQ(Point(50, 60), wall->getVert(0));
+   EXPECT_EQ(Point(150, 160), wall->getVert(2));
+}
+
+
+TEST(EditorTest, undoChangeStoresOnlyGeometry)
+{
+   boost::shared_ptr<Level> level(new Level("BarrierMaker 20 0 0 100 0\n"));
+   WallItem *wall = static_cast<WallItem *>(level->findObjects_fast(WallItemTypeNumber)->get(0));
+
+   // Moving the wall only changes its geometry...
+   WallItem *orig = static_cast<WallItem *>(wall->clone());
+   wall->moveTo(Point(10, 10));
+
+   Editor::EditorWorkUnitChange move(level, NULL, orig, wall);
+   EXPECT_TRUE(move.isGeomOnly());
+
+   // ...but changing its width doesn't, so we'll need whole copies to get back
+   delete orig;
+   orig = static_cast<WallItem *>(wall->clone());
+   wall->changeWidth(10);
+
+   Editor::EditorWorkUnitChange widen(level, NULL, orig, wall);
+   EXPECT_FALSE(widen.isGeomOnly());
+   EXPECT_LT(move.getMemoryUsage(), widen.getMemoryUsage());
+
+   widen.undo();
+   wall = static_cast<WallItem *>(level->findObjects_fast(WallItemTypeNumber)->get(0));
+   EXPECT_EQ(20, wall->getWidth());
+
+   move.undo();
+   EXPECT_EQ(Point(0, 0), wall->getVert(0));
+
+   // Merging the width change into the move leaves us with something that can do both
+   move.merge(&widen);
+   EXPECT_FALSE(move.isGeomOnly());
+
+   move.redo();
+   wall = static_cast<WallItem *>(level->findObjects_fast(WallItemTypeNumber)->get(0));
+   EXPECT_EQ(30, wall->getWidth());
+   EXPECT_EQ(Point(10, 10), wall->getVert(0));
+
+   move.undo();
+   wall = static_cast<WallItem *>(level->findObjects_fast(WallItemTypeNumber)->get(0));
+   EXPECT_EQ(20, wall->getWidth());
+   EXPECT_EQ(Point(0, 0), wall->getVert(0));
+
+   delete orig;
+}
+
+
+// Times moving a big selection, and undoing and redoing the move.  Run with --gtest_also_run_disabled_tests to see the numbers.
+TEST(EditorTest, DISABLED_undoMoveBenchmark)
+{
+   const S32 WallCount = 5000;
+
+   string levelCode;
+   for(S32 i = 0; i < WallCount; i++)
+      levelCode += "BarrierMaker 20 " + itos(i * 10) + " 0 " + itos(i * 10) + " 100 " + itos(i * 10 + 50) + " 100\n";
+
+   boost::shared_ptr<Level> level(new Level(levelCode));
+   Editor::EditorUndoManager undoManager;
+   undoManager.setLevel(level, NULL);
+
+   U32 startTime = Platform::getRealMilliseconds();
+   moveAllWalls(undoManager, level.get(), Point(5, 5));
+   U32 moveTime = Platform::getRealMilliseconds() - startTime;
+
+   startTime = Platform::getRealMilliseconds();
+   undoManager.undo();
+   U32 undoTime = Platform::getRealMilliseconds() - startTime;
+
+   startTime = Platform::getRealMilliseconds();
+   undoManager.redo();
+   U32 redoTime = Platform::getRealMilliseconds() - startTime;
+
+   printf("%d walls: move %dms, undo %dms, redo %dms, history %d bytes\n",
+          WallCount, moveTime, undoTime, redoTime, undoManager.getMemoryUsage());
+}
+
 };
@@ -0,0 +1,409 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "gameNetInterface.h"
+
+#include "ClientGame.h"
+#include "ClientInfo.h"
+#include "GameSettings.h"
+#include "ServerGame.h"
+
+#include "TestUtils.h"
+
+#include "tnlClientPuzzle.h"
+#include "tnlRandom.h"
+
+#include "gtest/gtest.h"
+
+namespace Zap
+{
+
+static void expectSameBytes(BitStream &expected, BitStream &actual)
+{
+   ASSERT_EQ(expected.getBytePosition(), actual.getBytePosition());
+   EXPECT_EQ(0, memcmp(expected.getBuffer(), actual.getBuffer(), expected.getBytePosition()));
+}
+
+
+TEST(GameNetInterfaceTest, CachedQueryResponse)
+{
+   ServerGame *game = newServerGame();
+   GameNetInterface *netInterface = game->getNetInterface();
+
+   Nonce nonce1, nonce2;
+   nonce1.getRandom();
+   nonce2.getRandom();
+
+   // Each query gets its own nonce, but the rest is only written once
+   for(S32 i = 0; i < 3; i++)
+   {
+      const Nonce &nonce = (i % 2) ? nonce2 : nonce1;
+      PacketStream expected;
+
+      GameNetInterface::writeQueryResponse(game, nonce, &expected);
+      expectSameBytes(expected, *netInterface->getQueryResponse(nonce));
+   }
+
+   EXPECT_EQ(1, netInterface->getQueryResponseBuildCount());
+
+   // Change something that goes in the response, and it should get written again
+   game->getSettings()->setHostName("Bitfighter Test Server", false);
+
+   PacketStream expected;
+   GameNetInterface::writeQueryResponse(game, nonce1, &expected);
+   expectSameBytes(expected, *netInterface->getQueryResponse(nonce1));
+
+   EXPECT_EQ(2, netInterface->getQueryResponseBuildCount());
+
+   delete game;
+}
+
+
+TEST(GameNetInterfaceTest, InfoRequestRateLimit)
+{
+   ServerGame *game = newServerGame();
+   GameNetInterface *netInterface = game->getNetInterface();
+
+   Address flooder("IP:10.0.0.1:28000");
+   Address flooderOtherPort("IP:10.0.0.1:28001");
+   Address bystander("IP:10.0.0.2:28000");
+
+   U32 time = 100000;
+
+   // We'll answer a burst...
+   for(U32 i = 0; i < GameNetInterface::RequestBurst; i++)
+      EXPECT_TRUE(netInterface->allowInfoRequest(flooder, time));
+
+   // ...but no more than that, even from another port
+   EXPECT_FALSE(netInterface->allowInfoRequest(flooder, time));
+   EXPECT_FALSE(netInterface->allowInfoRequest(flooderOtherPort, time));
+
+   // Wait a bit and we'll answer another
+   time += GameNetInterface::RequestRefillTime;
+   EXPECT_TRUE(netInterface->allowInfoRequest(flooder, time));
+   EXPECT_FALSE(netInterface->allowInfoRequest(flooder, time));
+
+   // Wait a long time, and we're back to a full burst, but no more
+   time += GameNetInterface::RequestRefillTime * 1000;
+   for(U32 i = 0; i < GameNetInterface::RequestBurst; i++)
+      EXPECT_TRUE(netInterface->allowInfoRequest(flooder, time));
+
+   EXPECT_FALSE(netInterface->allowInfoRequest(flooder, time));
+
+   // Other addresses aren't affected
+   EXPECT_TRUE(netInterface->allowInfoRequest(bystander, time));
+
+   delete game;
+}
+
+
+// Requests from forged addresses, spread across every bucket, shouldn't lock anyone out
+TEST(GameNetInterfaceTest, InfoRequestSpoofedFlood)
+{
+   ServerGame *game = newServerGame();
+   GameNetInterface *netInterface = game->getNetInterface();
+
+   Address bystander("IP:10.0.0.2:28000");
+   U32 time = 100000;
+
+   for(U32 i = 0; i < GameNetInterface::RequestBucketCount * GameNetInterface::RequestBurst * 4; i++)
+   {
+      Address spoofed;
+      spoofed.netNum[0] = Random::readI();
+      netInterface->allowInfoRequest(spoofed, time);
+   }
+
+   EXPECT_TRUE(netInterface->allowInfoRequest(bystander, time));
+
+   delete game;
+}
+
+
+TEST(GameNetInterfaceTest, HandshakeRateLimit)
+{
+   ServerGame *game = newServerGame();
+   GameNetInterface *netInterface = game->getNetInterface();
+
+   Address flooder("IP:10.0.0.1:28000");
+   Address neighbor("IP:10.0.0.2:28000");
+   Address bystander("IP:10.0.1.1:28000");
+
+   U32 time = 100000;
+
+   for(U32 i = 0; i < NetInterface::HandshakeBurst; i++)
+      EXPECT_TRUE(netInterface->allowHandshake(flooder, time));
+
+   // The rest of the flooder's network is cut off too...
+   EXPECT_FALSE(netInterface->allowHandshake(flooder, time));
+   EXPECT_FALSE(netInterface->allowHandshake(neighbor, time));
+
+   time += NetInterface::HandshakeRefillTime;
+   EXPECT_TRUE(netInterface->allowHandshake(neighbor, time));
+   EXPECT_FALSE(netInterface->allowHandshake(flooder, time));
+
+   // ...but not other networks
+   EXPECT_TRUE(netInterface->allowHandshake(bystander, time));
+
+   delete game;
+}
+
+
+// Connect requests from forged addresses never get as far as the limit, as they can't have our identity token
+TEST(GameNetInterfaceTest, HandshakeSpoofedFlood)
+{
+   ServerGame *game = newServerGame();
+   GameNetInterface *netInterface = game->getNetInterface();
+
+   for(U32 i = 0; i < NetInterface::HandshakeBucketCount * NetInterface::HandshakeBurst * 4; i++)
+   {
+      Nonce nonce, serverNonce;
+      nonce.getRandom();
+
+      PacketStream packet;
+      packet.write(U8(NetInterface::ConnectRequest));
+      nonce.write(&packet);
+      serverNonce.write(&packet);
+      packet.write(U32(Random::readI()));     // Guessing at the identity token
+      packet.setBitPosition(0);
+
+      Address spoofed("IP:10.0.0.1:28000");
+      spoofed.netNum[0] = Random::readI();
+
+      netInterface->processPacket(spoofed, &packet);
+   }
+
+   EXPECT_EQ(0, netInterface->getDroppedHandshakeCount());
+   EXPECT_TRUE(netInterface->allowHandshake(Address("IP:10.0.0.1:28000"), netInterface->getCurrentTime()));
+
+   delete game;
+}
+
+
+TEST(GameNetInterfaceTest, PuzzleDifficultyFollowsLoad)
+{
+   ClientPuzzleManager puzzles;
+   U32 time = 100000;
+   puzzles.tick(time);
+
+   U32 initialDifficulty = puzzles.getCurrentDifficulty();
+   Nonce oldServerNonce = puzzles.getCurrentNonce();
+
+   // A busy second makes puzzles harder, and starts a new one
+   puzzles.addHandshakeTime(ClientPuzzleManager::HighHandshakeLoad + 1);
+   time += ClientPuzzleManager::DifficultyUpdateInterval;
+   puzzles.tick(time);
+
+   EXPECT_EQ(initialDifficulty + 1, puzzles.getCurrentDifficulty());
+   EXPECT_FALSE(puzzles.getCurrentNonce() == oldServerNonce);
+
+   Nonce serverNonce = puzzles.getCurrentNonce();
+   Nonce clientNonce;
+   clientNonce.getRandom();
+   U32 clientIdentity = 1234;
+
+   // Clients that got the old puzzle can still solve it at the old difficulty...
+   U32 solution = 0;
+   while(!ClientPuzzleManager::solvePuzzle(&solution, clientNonce, oldServerNonce, initialDifficulty, clientIdentity))
+      ;
+
+   EXPECT_EQ(ClientPuzzleManager::Success,
+             puzzles.checkSolution(solution, clientNonce, oldServerNonce, initialDifficulty, clientIdentity));
+
+   // ...but the new one has to be solved at the new one
+   EXPECT_EQ(ClientPuzzleManager::InvalidPuzzleDifficulty,
+             puzzles.checkSolution(solution, clientNonce, serverNonce, initialDifficulty, clientIdentity));
+
+   // A quiet second makes them easier again, without a new puzzle, but never easier than we started
+   for(S32 i = 0; i < 3; i++)
+   {
+      time += ClientPuzzleManager::DifficultyUpdateInterval;
+      puzzles.tick(time);
+   }
+
+   EXPECT_EQ(initialDifficulty, puzzles.getCurrentDifficulty());
+   EXPECT_TRUE(puzzles.getCurrentNonce() == serverNonce);
+
+   // Never harder than clients will put up with, either
+   for(S32 i = 0; i < 20; i++)
+   {
+      puzzles.addHandshakeTime(ClientPuzzleManager::DifficultyUpdateInterval);
+      time += ClientPuzzleManager::DifficultyUpdateInterval;
+      puzzles.tick(time);
+   }
+
+   EXPECT_EQ(U32(ClientPuzzleManager::MaxAdaptivePuzzleDifficulty), puzzles.getCurrentDifficulty());
+}
+
+
+class TestNetInterface : public NetInterface
+{
+public:
+   TestNetInterface() : NetInterface(Address()) { }
+
+   ~TestNetInterface()
+   {
+      while(mPendingConnections.size() > 0)
+         removePendingConnection(mPendingConnections[0]);
+   }
+
+   void addPending(NetConnection *conn) { addPendingConnection(conn); }
+   void addConnected(NetConnection *conn) { addConnection(conn); }
+   NetConnection *findPending(const Address &address) { return findPendingConnection(address); }
+};
+
+
+TEST(GameNetInterfaceTest, PendingConnectionLookup)
+{
+   TestNetInterface netInterface;
+   Vector<RefPtr<NetConnection> > connections;
+
+   // Enough to make the table grow
+   for(S32 i = 0; i < 300; i++)
+   {
+      Address address("IP:10.0.0.0:28000");
+      address.netNum[0] += i;
+
+      connections.push_back(new NetConnection());
+      connections.last()->setNetAddress(address);
+      netInterface.addPending(connections.last());
+   }
+
+   EXPECT_EQ(connections.size(), netInterface.getPendingConnectionCount());
+
+   for(S32 i = 0; i < connections.size(); i++)
+      EXPECT_TRUE(netInterface.findPending(connections[i]->getNetAddress()) == connections[i]);
+
+   EXPECT_TRUE(netInterface.findPending(Address("IP:10.0.2.0:28000")) == NULL);
+}
+
+
+// Floods a server with connect challenge requests from lots of made up loopback addresses, so the replies
+// go nowhere, and reports what that did to the puzzle difficulty
+TEST(GameNetInterfaceTest, DISABLED_HandshakeFlood)
+{
+   const U32 Seconds = 10;
+   const S32 PacketsPerBatch = 1000;
+
+   ServerGame *game = newServerGame();
+   GameNetInterface *netInterface = game->getNetInterface();
+   ClientPuzzleManager &puzzles = netInterface->getPuzzleManager();
+
+   U32 startTime = Platform::getRealMilliseconds();
+   U32 reportTime = startTime;
+   U32 sent = 0;
+
+   while(Platform::getRealMilliseconds() - startTime < Seconds * 1000)
+   {
+      for(S32 i = 0; i < PacketsPerBatch; i++)
+      {
+         Nonce nonce;
+         nonce.getRandom();
+
+         PacketStream packet;
+         packet.write(U8(NetInterface::ConnectChallengeRequest));
+         nonce.write(&packet);
+         packet.writeFlag(false);
+         packet.writeFlag(false);
+         packet.setBitPosition(0);
+
+         // Anywhere in 127.0.0.0/8
+         Address address("IP:127.0.0.1:28000");
+         address.netNum[0] = (127 << 24) | (Random::readI() & 0xFFFFFF);
+
+         netInterface->processPacket(address, &packet);
+      }
+
+      sent += PacketsPerBatch;
+      netInterface->processConnections();    // Moves the clock along, and adjusts the puzzle difficulty
+
+      if(Platform::getRealMilliseconds() - reportTime >= 1000)
+      {
+         reportTime += 1000;
+         printf("Handshake load %dms/s, puzzle difficulty %d\n", puzzles.getHandshakeLoad(), puzzles.getCurrentDifficulty());
+      }
+   }
+
+   printf("%d challenge requests in %ds\n", sent, Seconds);
+
+   EXPECT_GT(puzzles.getCurrentDifficulty(), U32(ClientPuzzleManager::InitialPuzzleDifficulty));
+
+   delete game;
+}
+
+
+// Connections only get looked at when they're due, but anything posted to one has to go out on the next pass,
+// whether or not the clock has moved on.  Otherwise tests that idle a few times and expect messages to have made
+// it across would depend on how fast they run.
+TEST(GameNetInterfaceTest, RPCArrivesWithinPasses)
+{
+   GamePair gamePair("", 2);
+   GamePair::idle(10, 5);
+
+   ClientGame *sender = gamePair.getClient(0);
+   ClientGame *listener = gamePair.getClient(1);
+   StringTableEntry senderName = sender->getClientInfo()->getName();
+
+   ClientInfo *senderAsHeard = listener->findClientInfo(senderName);
+   ASSERT_TRUE(senderAsHeard != NULL);
+   ASSERT_FALSE(senderAsHeard->isBusy());
+
+   // Client to server on the first pass, server to the other client on the second
+   sender->setBusyChatting(true);
+   GamePair::idle(10, 2);
+
+   EXPECT_TRUE(gamePair.server->findClientInfo(senderName)->isBusy());
+   EXPECT_TRUE(senderAsHeard->isBusy());
+}
+
+
+// Compares servicing lots of mostly idle connections, as the master does, only when they're due against
+// looking at every one of them on every pass, as we used to
+TEST(GameNetInterfaceTest, DISABLED_ConnectionServicingBenchmark)
+{
+   const S32 ConnectionCount = 10000;
+   const S32 Passes = 1000;
+
+   TestNetInterface netInterface;
+   Vector<RefPtr<NetConnection> > connections;
+
+   for(S32 i = 0; i < ConnectionCount; i++)
+   {
+      Address address("IP:127.0.0.1:28000");     // Anything we do send goes nowhere
+      address.netNum[0] += i;
+
+      NetConnection *conn = new NetConnection();
+      conn->setNetAddress(address);
+      conn->setInterface(&netInterface);
+      conn->setIsAdaptive();                     // Like the master's
+      conn->setConnectionState(NetConnection::Connected);
+
+      connections.push_back(conn);
+      netInterface.addConnected(conn);
+   }
+
+   S64 wheelTime = 0, everyTime = 0;
+
+   for(S32 i = 0; i < Passes; i++)
+   {
+      S64 startTime = Platform::getHighPrecisionTimerValue();
+      netInterface.processConnections();
+      wheelTime += Platform::getHighPrecisionTimerValue() - startTime;
+
+      startTime = Platform::getHighPrecisionTimerValue();
+      for(S32 j = 0; j < connections.size(); j++)
+         connections[j]->checkPacketSend(false, netInterface.getCurrentTime());
+      everyTime += Platform::getHighPrecisionTimerValue() - startTime;
+
+      Platform::sleep(1);
+   }
+
+   printf("%d passes over %d idle connections: %gms when due, %gms looking at every one every pass\n", Passes,
+          ConnectionCount, Platform::getHighPrecisionMilliseconds(wheelTime), Platform::getHighPrecisionMilliseconds(everyTime));
+
+   EXPECT_EQ(ConnectionCount, netInterface.getConnectionList().size());
+}
+
+
+};
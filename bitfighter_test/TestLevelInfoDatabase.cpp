@@ -27,7 +27,8 @@ TEST(LevelInfoDatabaseTest, reading)
 {
    LevelInfoDb::LevelInfoDatabase db;
 
-   LevelInfoDb::readCsvFromStream(stringstream(csvContents), db);
+   stringstream stream(csvContents);
+   LevelInfoDb::readCsvFromStream(stream, db);
 
    EXPECT_EQ("Level, One",    db.levelName ["d58e3582afa99040e27b92b13c8f2280"]);
    EXPECT_EQ(NexusGame,       db.gameTypeId["d58e3582afa99040e27b92b13c8f2280"]);
@@ -78,4 +79,66 @@ TEST(LevelInfoDatabaseTest, writing)
 
 }
 
+
+TEST(LevelInfoDatabaseTest, indexRoundTrip)
+{
+   LevelInfoDb::LevelHeader header;
+   header.levelName  = "Level, with \"quotes\"";
+   header.levelType  = CTFGame;
+   header.minPlayers = 2;
+   header.maxPlayers = 8;
+   header.scriptName = "script.lua";
+
+   LevelInfoDb::LevelInfoIndex index;
+   EXPECT_FALSE(index.isChanged());
+
+   index.update("/levels/one.level", 1234, 5678, header);
+   index.update("/levels/two.level", 99, 4294967296ull, LevelInfoDb::LevelHeader());    // Time won't fit in 32 bits
+   EXPECT_TRUE(index.isChanged());
+
+   stringstream stream;
+   index.writeToStream(stream);
+
+   LevelInfoDb::LevelInfoIndex copy;
+   copy.readFromStream(stream);
+   EXPECT_EQ(2, copy.getEntryCount());
+
+   LevelInfoDb::LevelHeader found;
+   ASSERT_TRUE(copy.lookup("/levels/one.level", 1234, 5678, found));
+   EXPECT_EQ(header.levelName,  found.levelName);
+   EXPECT_EQ(header.levelType,  found.levelType);
+   EXPECT_EQ(header.minPlayers, found.minPlayers);
+   EXPECT_EQ(header.maxPlayers, found.maxPlayers);
+   EXPECT_EQ(header.scriptName, found.scriptName);
+
+   ASSERT_TRUE(copy.lookup("/levels/two.level", 99, 4294967296ull, found));
+   EXPECT_EQ("", found.levelName);
+   EXPECT_EQ(BitmatchGame, found.levelType);
+}
+
+
+TEST(LevelInfoDatabaseTest, indexIgnoresChangedFiles)
+{
+   LevelInfoDb::LevelInfoIndex index;
+   LevelInfoDb::LevelHeader header;
+
+   index.update("one.level", 100, 200, header);
+
+   EXPECT_TRUE (index.lookup("one.level", 100, 200, header));
+   EXPECT_FALSE(index.lookup("one.level", 101, 200, header));    // Size changed
+   EXPECT_FALSE(index.lookup("one.level", 100, 201, header));    // Modified
+   EXPECT_FALSE(index.lookup("two.level", 100, 200, header));    // Never seen
+
+   // Lines with bad game types or the wrong number of columns are skipped
+   stringstream stream("\"a.level\",1,2,\"A\",BogusGameType,0,0,\n"
+                       "\"b.level\",1,2,\"B\",NexusGameType,0,0\n"
+                       "\"c.level\",1,2,\"C\",NexusGameType,0,0,\n");
+   index.readFromStream(stream);
+
+   EXPECT_FALSE(index.lookup("a.level", 1, 2, header));
+   EXPECT_FALSE(index.lookup("b.level", 1, 2, header));
+   EXPECT_TRUE (index.lookup("c.level", 1, 2, header));
+   EXPECT_EQ(NexusGame, header.levelType);
+}
+
 };
@@ -10,6 +10,10 @@
 #include "GameManager.h"
 #include "WallItem.h"
 #include "EngineeredItem.h"
+#include "BotNavMeshZone.h"
+#include "CompiledLevel.h"
+#include "LevelSource.h"
+#include "stringUtils.h"
 
 
 #include "TestUtils.h"
@@ -105,6 +109,211 @@ TEST(LevelLoaderTest, EngineeredItemMounting2)
          TNLAssert(false, "Bad id!");
    }
 };
-   
+
+
+// Loading a level a piece at a time should give the same results as loading it all at once
+TEST(LevelLoaderTest, IncrementalLoading)
+{
+   string code = getLevelCodeForEngineeredItemSnapping2();
+
+   Level wholeLevel(code);
+
+   Level level;
+   level.beginLoadFromString(code);
+
+   S32 calls = 0;
+   while(!level.continueLoading(0))    // Zero budget means we'll stop after every handful of lines
+      calls++;
+
+   EXPECT_GT(calls, 0);
+   EXPECT_FALSE(level.isLoading());
+   EXPECT_EQ(wholeLevel.getHash(), level.getHash());
+   EXPECT_EQ(wholeLevel.findObjects_fast()->size(), level.findObjects_fast()->size());
+
+   Vector<DatabaseObject *> wholeTurrets, turrets;
+   wholeLevel.findObjects(TurretTypeNumber, wholeTurrets);
+   level.findObjects(TurretTypeNumber, turrets);
+
+   ASSERT_EQ(wholeTurrets.size(), turrets.size());
+   for(S32 i = 0; i < turrets.size(); i++)
+      EXPECT_EQ(wholeTurrets[i]->getPos(), turrets[i]->getPos()) << "Turrets should mount the same way";
+}
+
+
+// A level loaded from its compiled form should be indistinguishable from one loaded from the original text
+TEST(LevelLoaderTest, CompiledLevelRoundTrip)
+{
+   string code = getLevelCodeForEngineeredItemSnapping2();
+   string compiled = CompiledLevel::compile(code);
+
+   Level textLevel(code);
+   Level compiledLevel;
+
+   ASSERT_TRUE(CompiledLevel::loadLevel(compiled, &compiledLevel));
+   EXPECT_FALSE(compiledLevel.isLoading());
+   EXPECT_EQ(textLevel.getHash(), compiledLevel.getHash());
+   EXPECT_EQ(textLevel.toLevelCode(), compiledLevel.toLevelCode());
+
+   // Header should have the same info the level list would get from reading the text
+   LevelInfo textInfo, compiledInfo;
+   LevelSource::getLevelInfoFromCodeChunk(code, textInfo);
+   ASSERT_TRUE(CompiledLevel::getLevelInfo(compiled, compiledInfo));
+
+   EXPECT_EQ(textInfo.mLevelName, compiledInfo.mLevelName);
+   EXPECT_EQ(textInfo.mLevelType, compiledInfo.mLevelType);
+   EXPECT_EQ(textInfo.minRecPlayers, compiledInfo.minRecPlayers);
+   EXPECT_EQ(textInfo.maxRecPlayers, compiledInfo.maxRecPlayers);
+   EXPECT_EQ(textInfo.mScriptFileName, compiledInfo.mScriptFileName);
+
+   // Truncated files should be rejected without adding anything to the level
+   Level truncatedLevel;
+   EXPECT_FALSE(CompiledLevel::loadLevel(compiled.substr(0, compiled.length() - 1), &truncatedLevel));
+   EXPECT_EQ(0, truncatedLevel.findObjects_fast()->size());
+   EXPECT_FALSE(CompiledLevel::loadLevel(code, &truncatedLevel));
+}
+
+
+// An edit that keeps the file the same size, made right after the last load, should still be picked up; and the
+// editor's test file should never be cached at all
+TEST(LevelLoaderTest, CompiledLevelCacheFreshness)
+{
+   CompiledLevel::CacheDir = ".";
+
+   const string sourceFile = "compiled_level_freshness.level";
+   string before = getLevelCodeForEngineeredItemSnapping2() + "LevelName Before\n";
+   string after  = getLevelCodeForEngineeredItemSnapping2() + "LevelName After!\n";
+   ASSERT_EQ(before.length(), after.length());
+
+   {
+      ASSERT_TRUE(writeFile(sourceFile, before));
+      Level level;
+      ASSERT_TRUE(CompiledLevel::loadLevelFromFile(sourceFile, &level));     // Compiles it into the cache
+      EXPECT_EQ("Before", level.getLevelName());
+   }
+
+   {
+      ASSERT_TRUE(writeFile(sourceFile, after));
+      Level level;
+      ASSERT_TRUE(CompiledLevel::loadLevelFromFile(sourceFile, &level));
+      EXPECT_EQ("After!", level.getLevelName());
+   }
+
+   {
+      ASSERT_TRUE(writeFile(LevelSource::TestFileName, before));
+      Level level;
+      ASSERT_TRUE(CompiledLevel::loadLevelFromFile(LevelSource::TestFileName, &level));
+      EXPECT_EQ("Before", level.getLevelName());
+      EXPECT_FALSE(fileExists(CompiledLevel::getCacheFileName(LevelSource::TestFileName)));
+   }
+
+   CompiledLevel::CacheDir = "";
+
+   remove(CompiledLevel::getCacheFileName(sourceFile).c_str());
+   remove(sourceFile.c_str());
+   remove(LevelSource::TestFileName.c_str());
+}
+
+
+// Compares loading the shipped levels from text with loading their compiled versions.  Expects to be run from the
+// bitfighter_test folder; run with --gtest_also_run_disabled_tests to see the numbers.
+TEST(LevelLoaderTest, DISABLED_CompiledLevelBenchmark)
+{
+   const string levelDir = "../resource/levels";
+   const string extension = "level";
+   const S32 Passes = 20;
+
+   Vector<string> levelFiles;
+   getFilesFromFolder(levelDir, levelFiles, FULL_PATH, &extension, 1);
+   ASSERT_GT(levelFiles.size(), 0) << "Couldn't find any levels in " << levelDir;
+
+   Vector<string> codes, compiled;
+   for(S32 i = 0; i < levelFiles.size(); i++)
+   {
+      string code;
+      ASSERT_TRUE(readFile(levelFiles[i], code));
+
+      codes.push_back(code);
+      compiled.push_back(CompiledLevel::compile(code));
+   }
+
+   U32 startTime = Platform::getRealMilliseconds();
+
+   for(S32 pass = 0; pass < Passes; pass++)
+      for(S32 i = 0; i < codes.size(); i++)
+      {
+         Level level;
+         level.loadLevelFromString(codes[i], levelFiles[i]);
+      }
+
+   U32 textTime = Platform::getRealMilliseconds() - startTime;
+
+   startTime = Platform::getRealMilliseconds();
+
+   for(S32 pass = 0; pass < Passes; pass++)
+      for(S32 i = 0; i < compiled.size(); i++)
+      {
+         Level level;
+         CompiledLevel::loadLevel(compiled[i], &level, levelFiles[i]);
+      }
+
+   U32 compiledTime = Platform::getRealMilliseconds() - startTime;
+
+   printf("Loaded %d levels %d times: text %dms, compiled %dms\n", codes.size(), Passes, textTime, compiledTime);
+
+   for(S32 i = 0; i < codes.size(); i++)
+   {
+      Level textLevel(codes[i]);
+      Level compiledLevel;
+      CompiledLevel::loadLevel(compiled[i], &compiledLevel);
+
+      EXPECT_EQ(textLevel.toLevelCode(), compiledLevel.toLevelCode()) << levelFiles[i];
+   }
+}
+
+
+// Zones loaded from the cache should be identical to the ones we built the first time around
+TEST(LevelLoaderTest, BotZoneCache)
+{
+   BotNavMeshZone::CacheDir = ".";
+   const string extension = "navmesh";
+
+   Vector<Point> centers;
+   Vector<S32> neighborCounts;
+
+   {
+      GamePair gamePair(getLevelCodeForEngineeredItemSnapping(), 0);    // Builds zones and writes the cache
+      const Vector<BotNavMeshZone *> &zones = GameManager::getServerGame()->getLevel()->getBotZoneList();
+
+      ASSERT_GT(zones.size(), 0);
+      for(S32 i = 0; i < zones.size(); i++)
+      {
+         centers.push_back(zones[i]->getCenter());
+         neighborCounts.push_back(zones[i]->mNeighbors.size());
+      }
+   }
+
+   Vector<string> cacheFiles;
+   getFilesFromFolder(".", cacheFiles, FULL_PATH, &extension, 1);
+   EXPECT_EQ(1, cacheFiles.size());
+
+   {
+      GamePair gamePair(getLevelCodeForEngineeredItemSnapping(), 0);    // Reads zones from the cache
+      const Vector<BotNavMeshZone *> &zones = GameManager::getServerGame()->getLevel()->getBotZoneList();
+
+      ASSERT_EQ(centers.size(), zones.size());
+      for(S32 i = 0; i < zones.size(); i++)
+      {
+         EXPECT_EQ(i, zones[i]->getZoneId());
+         EXPECT_EQ(centers[i], zones[i]->getCenter());
+         EXPECT_EQ(neighborCounts[i], zones[i]->mNeighbors.size());
+      }
+   }
+
+   BotNavMeshZone::CacheDir = "";
+
+   for(S32 i = 0; i < cacheFiles.size(); i++)
+      remove(cacheFiles[i].c_str());
+}
+
 }     // namespace
 
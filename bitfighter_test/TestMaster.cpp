@@ -8,7 +8,10 @@
 #include "TestUtils.h"
 
 #include "../master/master.h"
+#include "../master/ServerDirectory.h"
+#include "../master/database.h"
 #include "ClientGame.h"
+#include "version.h"
 
 namespace Zap
 {
@@ -33,5 +36,545 @@ TEST(MasterTest, Sanity)
 //   Master::MasterServerConnection *masterConnection = dynamic_cast<Master::MasterServerConnection *>(clientConnection->getRemoteConnectionObject());
 //   EXPECT_TRUE(masterConnection != NULL);
 }
+
+
+TEST(MasterTest, ServerDirectory)
+{
+   MasterSettings masterSettings("");     // Don't read from an INI file
+   MasterServer master(&masterSettings);  // Needed for cleanup of our connections
+
+   ServerDirectory directory;
+
+   const S32 ServerCount = 3;
+   Master::MasterServerConnection *servers[ServerCount];
+
+   for(S32 i = 0; i < ServerCount; i++)
+   {
+      servers[i] = new Master::MasterServerConnection();
+      servers[i]->mCSProtocolVersion = CS_PROTOCOL_VERSION;
+      servers[i]->mInfoFlags = 0;
+   }
+
+   servers[1]->mCSProtocolVersion = CS_PROTOCOL_VERSION - 1;
+   servers[2]->mInfoFlags = HostModeFlag;
+
+   for(S32 i = 0; i < ServerCount; i++)
+      directory.addServer(servers[i]);
+
+   // Servers are split by version and mode
+   ASSERT_TRUE(directory.getServers(CS_PROTOCOL_VERSION, false) != NULL);
+   ASSERT_TRUE(directory.getServers(CS_PROTOCOL_VERSION, true) != NULL);
+   EXPECT_EQ(1, directory.getServers(CS_PROTOCOL_VERSION, false)->size());
+   EXPECT_EQ(1, directory.getServers(CS_PROTOCOL_VERSION, true)->size());
+   EXPECT_EQ(1, directory.getServers(CS_PROTOCOL_VERSION - 1, false)->size());
+   EXPECT_TRUE(directory.getServers(CS_PROTOCOL_VERSION + 1, false) == NULL);
+
+   // Leaving host mode moves the server to the other index
+   U32 oldInfoFlags = servers[2]->mInfoFlags;
+   servers[2]->mInfoFlags = 0;
+   directory.updateServer(servers[2], oldInfoFlags);
+
+   EXPECT_EQ(2, directory.getServers(CS_PROTOCOL_VERSION, false)->size());
+   EXPECT_TRUE(directory.getServers(CS_PROTOCOL_VERSION, true) == NULL);
+
+   // Paging works, and skips hidden servers
+   Vector<Master::MasterServerConnection *> page;
+   EXPECT_EQ(1, directory.getPage(CS_PROTOCOL_VERSION, false, 0, 1, page));
+   ASSERT_EQ(1, page.size());
+   EXPECT_EQ(servers[0], page[0]);
+
+   servers[0]->mIsIgnoredFromList = true;
+   EXPECT_EQ(-1, directory.getPage(CS_PROTOCOL_VERSION, false, 0, 10, page));
+   ASSERT_EQ(1, page.size());
+   EXPECT_EQ(servers[2], page[0]);
+
+   for(S32 i = 0; i < ServerCount; i++)
+   {
+      directory.removeServer(servers[i]);
+      delete servers[i];
+   }
+
+   EXPECT_TRUE(directory.getServers(CS_PROTOCOL_VERSION, false) == NULL);
+   EXPECT_TRUE(directory.getServers(CS_PROTOCOL_VERSION - 1, false) == NULL);
+}
+
+
+struct TestGameReport : public ThreadEntry
+{
+   const MasterSettings *mSettings;
+   GameStats mStats;
+
+   TestGameReport(const MasterSettings *settings) { mSettings = settings; }    // Quickie constructor
+
+   bool isBatchable() const { return true; }
+
+   void run() { DbWriter::getDatabaseWriter(mSettings).insertStats(mStats); }
+};
+
+
+// Hammer the SQLite backend with more reports than the old 128-entry queue could hold, and make sure none get lost
+TEST(MasterTest, DatabaseWriterThreadLoad)
+{
+   const string dbFile = "bitfighter_test_stats.db";
+   remove(dbFile.c_str());
+
+   string oldSqliteFile = DbWriter::DatabaseWriter::sqliteFile;
+   DbWriter::DatabaseWriter::sqliteFile = dbFile;
+
+   MasterSettings masterSettings("");     // Don't read from an INI file; we'll get SQLite by default
+
+   const S32 ReportCount = 1000;
+   const S32 WorkerCount = 4;
+
+   {
+      DbWriter::DatabaseWriterThread thread(&masterSettings, WorkerCount, 32);
+
+      for(S32 i = 0; i < ReportCount; i++)
+      {
+         RefPtr<TestGameReport> report = new TestGameReport(&masterSettings);
+         report->mStats.serverName = "Load Test Server " + itos(i % 10);
+         report->mStats.serverIP = "127.0.0.1";
+         report->mStats.gameType = "Bitmatch";
+         report->mStats.levelName = "Load Test Level";
+         report->mStats.playerCount = 1;
+
+         TeamStats teamStats;
+         teamStats.name = "Blue";
+         teamStats.hexColor = "0000ff";
+         teamStats.gameResult = 'W';
+
+         PlayerStats playerStats;
+         playerStats.name = "Player " + itos(i);
+         playerStats.gameResult = 'W';
+
+         WeaponStats weaponStats;
+         weaponStats.weaponType = WeaponPhaser;
+         weaponStats.shots = 10;
+         weaponStats.hits = 5;
+         playerStats.weaponStats.push_back(weaponStats);
+
+         teamStats.playerStats.push_back(playerStats);
+
+         report->mStats.teamStats.push_back(teamStats);
+
+         thread.addEntry(report);
+      }
+
+      // Wait for the workers to get through it all
+      U32 startTime = Platform::getRealMilliseconds();
+      while(thread.getStats().processedCount < (U32)ReportCount && Platform::getRealMilliseconds() - startTime < 60000)
+      {
+         thread.idle();
+         Platform::sleep(5);
+      }
+      thread.idle();
+
+      DatabaseAccessThread::Stats stats = thread.getStats();
+      EXPECT_EQ(ReportCount, stats.processedCount);
+      EXPECT_EQ(0, stats.queueDepth);
+      EXPECT_GT(stats.peakQueueDepth, 0u);
+      EXPECT_GE(stats.maxLatency, stats.averageLatency);
+   }
+
+   DbWriter::DatabaseWriter databaseWriter(dbFile.c_str());
+   Vector<Vector<string> > results;
+   databaseWriter.selectHandler("SELECT COUNT(*) FROM stats_game;", 1, results);
+   ASSERT_EQ(1, results.size());
+   EXPECT_EQ(itos(ReportCount), results[0][0]);
+
+   results.clear();
+   databaseWriter.selectHandler("SELECT COUNT(*) FROM stats_player;", 1, results);
+   ASSERT_EQ(1, results.size());
+   EXPECT_EQ(itos(ReportCount), results[0][0]);
+
+   results.clear();
+   databaseWriter.selectHandler("SELECT COUNT(*) FROM stats_player_shots;", 1, results);
+   ASSERT_EQ(1, results.size());
+   EXPECT_EQ(itos(ReportCount), results[0][0]);
+
+   DbWriter::DatabaseWriter::sqliteFile = oldSqliteFile;
+   remove(dbFile.c_str());
+}
+
+
+static GameStats makeRollbackTestGame(const string &playerName, bool withLoadout)
+{
+   GameStats gameStats;
+   gameStats.serverName = "Rollback Test Server";
+   gameStats.serverIP = "127.0.0.1";
+   gameStats.gameType = "Bitmatch";
+   gameStats.levelName = "Rollback Test Level";
+   gameStats.playerCount = 1;
+
+   TeamStats teamStats;
+   teamStats.name = "Blue";
+   teamStats.hexColor = "0000ff";
+
+   PlayerStats playerStats;
+   playerStats.name = playerName;
+
+   if(withLoadout)
+   {
+      LoadoutStats loadoutStats;
+      loadoutStats.loadoutHash = 1234;
+      playerStats.loadoutStats.push_back(loadoutStats);
+   }
+
+   teamStats.playerStats.push_back(playerStats);
+   gameStats.teamStats.push_back(teamStats);
+
+   return gameStats;
+}
+
+
+// A game that can't be written completely shouldn't leave any of its rows behind, whether or not it's part of a batch
+TEST(MasterTest, DatabaseWriterRollsBackFailedGame)
+{
+   const string dbFile = "bitfighter_test_rollback.db";
+   remove(dbFile.c_str());
+
+   {
+      DbWriter::DatabaseWriter databaseWriter(dbFile.c_str());      // Creates the schema
+
+      // Make the last insert of any game with a loadout fail
+      {
+         DbWriter::DbQuery query(dbFile.c_str());
+         query.runQuery("DROP TABLE stats_player_loadout;");
+      }
+
+      databaseWriter.insertStats(makeRollbackTestGame("Alone", true));
+
+      databaseWriter.beginTransaction();
+      databaseWriter.insertStats(makeRollbackTestGame("First", false));
+      databaseWriter.insertStats(makeRollbackTestGame("Broken", true));
+      databaseWriter.insertStats(makeRollbackTestGame("Last", false));
+      databaseWriter.commitTransaction();
+
+      Vector<Vector<string> > results;
+      databaseWriter.selectHandler("SELECT COUNT(*) FROM stats_game;", 1, results);
+      ASSERT_EQ(1, results.size());
+      EXPECT_EQ("2", results[0][0]);
+
+      results.clear();
+      databaseWriter.selectHandler("SELECT COUNT(*) FROM stats_team;", 1, results);
+      ASSERT_EQ(1, results.size());
+      EXPECT_EQ("2", results[0][0]);
+
+      results.clear();
+      databaseWriter.selectHandler("SELECT player_name FROM stats_player ORDER BY stats_player_id;", 1, results);
+      ASSERT_EQ(2, results.size());
+      EXPECT_EQ("First", results[0][0]);
+      EXPECT_EQ("Last",  results[1][0]);
+   }
+
+   remove(dbFile.c_str());
+}
+
+
+// Stats sent as columns should come out the same as they went in, only smaller
+TEST(MasterTest, GameStatsEncoding)
+{
+   VersionedGameStats stats;
+   GameStats &gameStats = stats.gameStats;
+   gameStats.gameType = "CTF";
+   gameStats.levelName = "Encoding Test Level";
+   gameStats.duration = 600;
+   gameStats.build_version = 1234;
+   gameStats.isTeamGame = true;
+
+   for(S32 i = 0; i < 2; i++)
+   {
+      TeamStats teamStats;
+      teamStats.name = i == 0 ? "Blue" : "Red";
+      teamStats.intColor = i == 0 ? 0x0000ff : 0xff0000;
+      teamStats.score = 3 - i;
+
+      for(S32 j = 0; j < 8; j++)
+      {
+         PlayerStats playerStats;
+         playerStats.name = "Player " + itos(i * 8 + j);
+         playerStats.isRobot = (j == 7);
+         playerStats.points = j - 2;            // Some negative
+         playerStats.kills = j * 3;
+         playerStats.deaths = 10 - j;
+         playerStats.playTime = 600;
+         playerStats.distTraveled = 50000 + j;
+
+         for(S32 k = 0; k < 3; k++)
+         {
+            WeaponStats weaponStats;
+            weaponStats.weaponType = WeaponType((j + k) % WeaponCount);
+            weaponStats.shots = 100 + k;
+            weaponStats.hits = 40 + k;
+            weaponStats.hitBy = 30 + k;
+            playerStats.weaponStats.push_back(weaponStats);
+         }
+
+         ModuleStats moduleStats;
+         moduleStats.shipModule = (j % 2 == 0) ? ModuleShield : ModuleBoost;
+         moduleStats.seconds = 20 + j;
+         playerStats.moduleStats.push_back(moduleStats);
+
+         LoadoutStats loadoutStats;
+         loadoutStats.loadoutHash = 0xdeadbeef + (j % 3);
+         playerStats.loadoutStats.push_back(loadoutStats);
+
+         teamStats.playerStats.push_back(playerStats);
+      }
+
+      gameStats.teamStats.push_back(teamStats);
+   }
+
+   BitStream s;
+   Types::write(s, stats);
+   U32 size = s.getBitPosition();
+
+   s.setBitPosition(0);
+   VersionedGameStats received;
+   Types::read(s, &received);
+
+   ASSERT_TRUE(received.valid);
+   EXPECT_EQ(size, s.getBitPosition());
+   EXPECT_EQ(U8(VersionedGameStats::CURRENT_VERSION), received.version);
+   EXPECT_EQ(16, received.gameStats.playerCount);
+   ASSERT_EQ(2, received.gameStats.teamStats.size());
+
+   for(S32 i = 0; i < 2; i++)
+   {
+      const TeamStats &sent = gameStats.teamStats[i];
+      const TeamStats &got = received.gameStats.teamStats[i];
+
+      EXPECT_EQ(sent.name, got.name);
+      EXPECT_EQ(sent.score, got.score);
+      EXPECT_EQ(sent.intColor, got.intColor);
+      ASSERT_EQ(sent.playerStats.size(), got.playerStats.size());
+
+      for(S32 j = 0; j < sent.playerStats.size(); j++)
+      {
+         const PlayerStats &sentPlayer = sent.playerStats[j];
+         const PlayerStats &gotPlayer = got.playerStats[j];
+
+         EXPECT_EQ(sentPlayer.name, gotPlayer.name);
+         EXPECT_EQ(sentPlayer.isRobot, gotPlayer.isRobot);
+         EXPECT_EQ(sentPlayer.points, gotPlayer.points);
+         EXPECT_EQ(sentPlayer.kills, gotPlayer.kills);
+         EXPECT_EQ(sentPlayer.deaths, gotPlayer.deaths);
+         EXPECT_EQ(sentPlayer.suicides, gotPlayer.suicides);
+         EXPECT_EQ(sentPlayer.playTime, gotPlayer.playTime);
+         EXPECT_EQ(sentPlayer.distTraveled, gotPlayer.distTraveled);
+
+         ASSERT_EQ(3, gotPlayer.weaponStats.size());
+         for(S32 k = 0; k < 3; k++)
+         {
+            EXPECT_EQ(sentPlayer.weaponStats[k].weaponType, gotPlayer.weaponStats[k].weaponType);
+            EXPECT_EQ(sentPlayer.weaponStats[k].shots,      gotPlayer.weaponStats[k].shots);
+            EXPECT_EQ(sentPlayer.weaponStats[k].hits,       gotPlayer.weaponStats[k].hits);
+            EXPECT_EQ(sentPlayer.weaponStats[k].hitBy,      gotPlayer.weaponStats[k].hitBy);
+         }
+
+         ASSERT_EQ(1, gotPlayer.moduleStats.size());
+         EXPECT_EQ(sentPlayer.moduleStats[0].shipModule, gotPlayer.moduleStats[0].shipModule);
+         EXPECT_EQ(sentPlayer.moduleStats[0].seconds,    gotPlayer.moduleStats[0].seconds);
+
+         ASSERT_EQ(1, gotPlayer.loadoutStats.size());
+         EXPECT_EQ(sentPlayer.loadoutStats[0].loadoutHash, gotPlayer.loadoutStats[0].loadoutHash);
+      }
+   }
+
+   // Compare with the old row-by-row encoding
+   BitStream old;
+   Types::write(old, gameStats, 3);
+   EXPECT_LT(size, old.getBitPosition());
+}
+
+
+TEST(MasterTest, Leaderboard)
+{
+   Leaderboard leaderboard;
+
+   Vector<string> names, scores;
+   names.push_back("Alice");  scores.push_back("5");
+   names.push_back("Bob");    scores.push_back("3");
+   names.push_back("");       scores.push_back("");     // Padding from the database reader is ignored
+
+   leaderboard.load(names, scores);
+   EXPECT_EQ(2, leaderboard.getPlayerCount());
+
+   // Incremental updates can reorder the board, and add players we haven't seen before
+   leaderboard.addToScore("Bob", 3);
+   leaderboard.addToScore("Carol", 1);
+
+   Vector<string> topNames, topScores;
+   leaderboard.getTop(4, topNames, topScores);
+
+   ASSERT_EQ(4, topNames.size());
+   ASSERT_EQ(4, topScores.size());
+   EXPECT_EQ("Bob",   topNames[0]);  EXPECT_EQ("6", topScores[0]);
+   EXPECT_EQ("Alice", topNames[1]);  EXPECT_EQ("5", topScores[1]);
+   EXPECT_EQ("Carol", topNames[2]);  EXPECT_EQ("1", topScores[2]);
+   EXPECT_EQ("",      topNames[3]);  EXPECT_EQ("",  topScores[3]);
+
+   // Reloading replaces everything
+   leaderboard.load(names, scores);
+   EXPECT_EQ(0, leaderboard.getScore("Carol"));
+   EXPECT_EQ(3, leaderboard.getScore("Bob"));
+}
+
+
+TEST(MasterTest, LeaderboardOutsideSnapshot)
+{
+   Leaderboard leaderboard;
+
+   // A full snapshot, so there are players we don't know about
+   Vector<string> names, scores;
+   names.push_back("Alice");  scores.push_back("5");
+   names.push_back("Bob");    scores.push_back("3");
+   leaderboard.load(names, scores);
+
+   EXPECT_FALSE(leaderboard.addToScore("Alice", 1));
+   EXPECT_TRUE(leaderboard.addToScore("Carol", 1));      // Needs looking up...
+   EXPECT_FALSE(leaderboard.addToScore("Carol", 1));     // ...but only once
+   EXPECT_EQ(0, leaderboard.getScore("Carol"));
+
+   // Lookup includes the game that triggered it, but not the one that came in while we were looking
+   leaderboard.setLookedUpScore("Carol", 10);
+   EXPECT_EQ(11, leaderboard.getScore("Carol"));
+
+   Vector<string> topNames, topScores;
+   leaderboard.getTop(1, topNames, topScores);
+   EXPECT_EQ("Carol", topNames[0]);
+
+   // Lookups that finish after a reload are stale
+   EXPECT_TRUE(leaderboard.addToScore("Dave", 1));
+   leaderboard.load(names, scores);
+   leaderboard.setLookedUpScore("Dave", 20);
+   EXPECT_EQ(0, leaderboard.getScore("Dave"));
+}
+
+
+TEST(MasterTest, LeaderboardLowestFirst)
+{
+   Leaderboard leaderboard;
+   leaderboard.setSortOrder(Leaderboard::LowestFirst);
+
+   Vector<string> names, scores;
+   names.push_back("Alice");  scores.push_back("3");
+   names.push_back("Bob");    scores.push_back("1");
+   names.push_back("Carol");  scores.push_back("2");
+   leaderboard.load(names, scores);
+
+   Vector<string> topNames, topScores;
+   leaderboard.getTop(2, topNames, topScores);
+
+   ASSERT_EQ(2, topNames.size());
+   EXPECT_EQ("Bob",   topNames[0]);
+   EXPECT_EQ("Carol", topNames[1]);
+}
+
+
+// Compares answering a high score request from the database with answering it from memory.  Building the synthetic
+// database takes a while, so this is disabled by default; run with --gtest_also_run_disabled_tests to see the numbers.
+TEST(MasterTest, DISABLED_LeaderboardBenchmark)
+{
+   const string dbFile = "bitfighter_test_leaderboard.db";
+   remove(dbFile.c_str());
+
+   const S32 GameCount = 1000000;
+   const S32 PlayerPoolSize = 10000;
+   const S32 Requests = 10;
+
+   DbWriter::DatabaseWriter databaseWriter(dbFile.c_str());      // Creates the schema
+
+   {
+      DbWriter::DbQuery query(dbFile.c_str());
+      query.beginTransaction();
+
+      for(S32 i = 0; i < GameCount; i++)
+      {
+         U64 gameId = query.runQuery("INSERT INTO stats_game(server_id, game_type, is_official, player_count, "
+                                     "duration_seconds, level_name, is_team_game, team_count) "
+                                     "VALUES(1, 'Bitmatch', 1, 2, 600, 'Benchmark', 0, 0);", Vector<string>());
+
+         for(S32 j = 0; j < 2; j++)
+         {
+            // Skew the player distribution so there's a clear leader
+            S32 player = ((i % PlayerPoolSize) * 7919 + j * 104729) % PlayerPoolSize;
+            player = (player * player) / PlayerPoolSize;
+
+            Vector<string> params;
+            params.push_back(itos(gameId));
+            params.push_back("Player " + itos(player));
+            params.push_back(j == 0 ? "W" : "L");
+
+            query.runQuery("INSERT INTO stats_player(stats_game_id, stats_team_id, player_name, is_authenticated, "
+                           "is_robot, result, points, kill_count, death_count, suicide_count, switched_team_count, "
+                           "asteroid_crashes, flag_drops, flag_pickups, flag_returns, flag_scores, teleport_uses, "
+                           "turret_kills, ff_kills, asteroid_kills, turrets_engineered, ffs_engineered, "
+                           "teleports_engineered, distance_traveled) "
+                           "VALUES(?, 0, ?, 1, 0, ?, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);", params);
+         }
+      }
+
+      query.commitTransaction();
+   }
+
+   const string topPlayersSql = "SELECT player_name, COUNT(*) AS game_count FROM stats_player "
+                                "WHERE is_authenticated = 1 AND is_robot = 0 "
+                                "GROUP BY player_name ORDER BY game_count DESC, player_name LIMIT ";
+
+   // From the database, every time
+   Vector<Vector<string> > dbResults;
+   U32 startTime = Platform::getRealMilliseconds();
+
+   for(S32 i = 0; i < Requests; i++)
+   {
+      dbResults.clear();
+      databaseWriter.selectHandler(topPlayersSql + "3;", 2, dbResults);
+   }
+
+   U32 dbTime = Platform::getRealMilliseconds() - startTime;
+
+   // From memory, after loading a snapshot once
+   startTime = Platform::getRealMilliseconds();
+
+   Vector<Vector<string> > snapshot;
+   databaseWriter.selectHandler(topPlayersSql + itos(HighScores::SnapshotSize) + ";", 2, snapshot);
+
+   Vector<string> snapshotNames, snapshotScores;
+   for(S32 i = 0; i < snapshot.size(); i++)
+   {
+      snapshotNames.push_back(snapshot[i][0]);
+      snapshotScores.push_back(snapshot[i][1]);
+   }
+
+   Leaderboard leaderboard;
+   leaderboard.load(snapshotNames, snapshotScores);
+
+   U32 loadTime = Platform::getRealMilliseconds() - startTime;
+
+   Vector<string> names, scores;
+   startTime = Platform::getRealMilliseconds();
+
+   for(S32 i = 0; i < Requests; i++)
+   {
+      names.clear();
+      scores.clear();
+      leaderboard.getTop(3, names, scores);
+   }
+
+   U32 memoryTime = Platform::getRealMilliseconds() - startTime;
+
+   printf("Top players over %d games, %d requests: database %dms, memory %dms (plus %dms to load snapshot)\n",
+          GameCount, Requests, dbTime, memoryTime, loadTime);
+
+   ASSERT_EQ(3, dbResults.size());
+   for(S32 i = 0; i < 3; i++)
+   {
+      EXPECT_EQ(dbResults[i][0], names[i]);
+      EXPECT_EQ(dbResults[i][1], scores[i]);
+   }
+
+   remove(dbFile.c_str());
+}
 	
 };
@@ -4,7 +4,12 @@
 //------------------------------------------------------------------------------
 
 #include "move.h"
+#include "ClientGame.h"
+#include "gameConnection.h"
+#include "ship.h"
 #include "tnlBitStream.h"
+
+#include "TestUtils.h"
 #include "gtest/gtest.h"
 
 namespace Zap
@@ -103,4 +108,43 @@ TEST_F(MoveTest, LargeAngleWrapAround)
    ASSERT_EQ(move1.angle, 0);
 }
    
+
+
+// A correction to something other than our motion can't be applied by shifting our prediction, so when there are more
+// than MaxReplayMoves pending moves, it has to survive the rest of the replay
+TEST_F(MoveTest, ReplayKeepsEnergyCorrection)
+{
+   GamePair gamePair;
+   GamePair::idle(10, 5);
+
+   ClientGame *clientGame = gamePair.getClient(0);
+   GameConnection *conn = clientGame->getConnectionToServer();
+   Ship *ship = clientGame->getLocalPlayerShip();
+   ASSERT_TRUE(ship != NULL);
+
+   // Moving, so we don't get the fast idle recharge
+   Move move;
+   move.x = 1;
+
+   for(S32 i = 0; i < ControlObjectConnection::MaxReplayMoves + 8; i++)
+   {
+      move.time = 50;
+      conn->addPendingMove(&move);
+   }
+
+   U32 moveCount = conn->pendingMoves.size();
+   ASSERT_GT(moveCount, U32(ControlObjectConnection::MaxReplayMoves));
+   S32 predictedEnergy = ship->getEnergy();
+
+   // What s2cCreditEnergy does
+   conn->prepareReplay();
+   ship->creditEnergy(-Ship::EnergyMax / 2);
+
+   conn->replayPendingMoves();
+   conn->mNeedReplayMoves = false;
+
+   EXPECT_EQ(moveCount, conn->getReplayMovesLast());
+   EXPECT_LT(ship->getEnergy(), predictedEnergy);
+}
+
 };
@@ -0,0 +1,49 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "PositionHistory.h"
+
+#include "gtest/gtest.h"
+
+namespace Zap
+{
+
+TEST(PositionHistoryTest, Rewind)
+{
+   PositionHistory history;
+   Point pos;
+
+   EXPECT_FALSE(history.getPos(0, pos));
+
+   // Moving right at 1 unit/ms, sampled every 10ms
+   for(U32 time = 1000; time <= 3000; time += 10)
+      history.record(time, Point(F32(time), 0));
+
+   EXPECT_TRUE(history.getPos(3000, pos));
+   EXPECT_EQ(Point(3000, 0), pos);
+
+   // In between samples
+   history.getPos(2900, pos);
+   EXPECT_FLOAT_EQ(2900, pos.x);
+
+   // Newer than anything we have
+   history.getPos(3500, pos);
+   EXPECT_EQ(Point(3000, 0), pos);
+
+   // We can always look back as far as MaxHistoryTime...
+   history.getPos(3000 - PositionHistory::MaxHistoryTime, pos);
+   EXPECT_FLOAT_EQ(F32(3000 - PositionHistory::MaxHistoryTime), pos.x);
+
+   // ...but no further
+   history.getPos(1000, pos);
+   EXPECT_GT(pos.x, 1000);
+   EXPECT_LE(pos.x, 3000 - PositionHistory::MaxHistoryTime);
+
+   history.clear();
+   EXPECT_FALSE(history.getPos(3000, pos));
+}
+
+
+};
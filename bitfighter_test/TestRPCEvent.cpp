@@ -0,0 +1,114 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "gameConnection.h"
+
+#include "tnlBitStream.h"
+#include "tnlRPC.h"
+
+#include "gtest/gtest.h"
+
+namespace Zap
+{
+
+static void expectSameBits(BitStream &expected, BitStream &actual)
+{
+   ASSERT_EQ(expected.getBitPosition(), actual.getBitPosition());
+
+   U32 bits = expected.getBitPosition();
+
+   for(U32 i = 0; i < bits; i++)
+      ASSERT_EQ(expected.testBit(i), actual.testBit(i)) << "Bit " << i << " of " << bits;
+}
+
+
+// A bit of everything, with strings landing all over the place
+static void writeStuff(BitStream &stream)
+{
+   stream.writeInt(5, 3);
+   stream.writeString("Bitfighter forever");
+   stream.writeFlag(true);
+   stream.writeStringTableEntry(StringTableEntry("Bitfighter for now"));    // Shares a prefix with the last one
+   stream.writeInt(0xABCDE, 20);
+   stream.writeString("");
+   stream.writeString("Short", 3);
+   stream.writeStringTableEntry(StringTableEntry("Zap!"));
+
+   for(U32 i = 0; i < 600; i++)     // Longer than writeRecordedBits copies in one go
+      stream.writeInt(i, 7);
+
+   stream.writeString("The end");
+}
+
+
+// Splicing recorded bits into a stream should give exactly what writing everything into it directly would
+TEST(RPCEventTest, WriteRecordedBits)
+{
+   BitStream recorded;
+   Vector<BitStream::RecordedString> strings;
+
+   recorded.setStringRecorder(&strings);
+   writeStuff(recorded);
+   recorded.setStringRecorder(NULL);
+
+   EXPECT_EQ(6, strings.size());
+
+   // Start at every bit offset, after a string that affects how the first of ours gets compressed
+   for(U32 offset = 0; offset < 8; offset++)
+   {
+      BitStream direct, spliced;
+
+      direct.writeInt(0, offset);
+      direct.writeString("Bitfighter");
+      writeStuff(direct);
+
+      spliced.writeInt(0, offset);
+      spliced.writeString("Bitfighter");
+      EXPECT_TRUE(spliced.writeRecordedBits(recorded.getBitPosition(), recorded.getBuffer(), strings));
+
+      expectSameBits(direct, spliced);
+   }
+}
+
+
+// An event posted to several connections gets packed several times; every time should look like the first
+TEST(RPCEventTest, PackOnceForManyConnections)
+{
+   RefPtr<GameConnection> conn = new GameConnection();
+
+   Vector<StringTableEntry> e;
+   Vector<StringPtr> s;
+   Vector<S32> i;
+
+   e.push_back("Fred");
+   s.push_back("Wilma");
+   i.push_back(42);
+
+   RefPtr<NetEvent> event = TNL_RPC_CONSTRUCT_NETEVENT(conn.getPointer(), s2cDisplayMessageESI,
+                                                       (GameConnection::ColorInfo, SFXNone, "%e0 and %s0: %i0", e, s, i));
+
+   const char *lastStrings[] = { "", "Fred", "Fred and Barney" };
+
+   for(U32 j = 0; j < ARRAYSIZE(lastStrings); j++)
+   {
+      // What a fresh event writes the first time it's packed
+      RefPtr<NetEvent> freshEvent = TNL_RPC_CONSTRUCT_NETEVENT(conn.getPointer(), s2cDisplayMessageESI,
+                                                               (GameConnection::ColorInfo, SFXNone, "%e0 and %s0: %i0", e, s, i));
+      BitStream expected, actual;
+
+      expected.writeInt(j, 5);
+      expected.writeString(lastStrings[j]);
+      freshEvent->pack(conn, &expected);
+
+      actual.writeInt(j, 5);
+      actual.writeString(lastStrings[j]);
+      event->pack(conn, &actual);
+
+      expectSameBits(expected, actual);
+   }
+}
+
+
+};
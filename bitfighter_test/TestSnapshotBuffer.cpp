@@ -0,0 +1,170 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "SnapshotBuffer.h"
+
+#include "ClientGame.h"
+#include "gameConnection.h"
+#include "GameSettings.h"
+#include "Level.h"
+#include "moveObject.h"
+#include "ServerGame.h"
+
+#include "TestUtils.h"
+
+#include "tnlPlatform.h"
+#include "tnlRandom.h"
+
+#include "gtest/gtest.h"
+
+#include <math.h>
+
+namespace Zap
+{
+
+TEST(SnapshotBufferTest, Sample)
+{
+   SnapshotBuffer snapshots;
+   Point pos, vel;
+   F32 angle;
+
+   EXPECT_FALSE(snapshots.sample(0, 0, pos, vel, angle));
+
+   // Moving right at 1 unit/ms, with updates every 50ms
+   for(U32 time = 500; time <= 1500; time += 50)
+      snapshots.push(time, Point(F32(time), 0), Point(1000, 0), 0);
+
+   // In between snapshots
+   EXPECT_TRUE(snapshots.sample(1420, 0, pos, vel, angle));
+   EXPECT_FLOAT_EQ(1420, pos.x);
+   EXPECT_FLOAT_EQ(1000, vel.x);
+
+   // Past our newest snapshot, we'll extrapolate, but only as far as we're allowed to
+   snapshots.sample(1550, 100, pos, vel, angle);
+   EXPECT_FLOAT_EQ(1550, pos.x);
+
+   snapshots.sample(2000, 100, pos, vel, angle);
+   EXPECT_FLOAT_EQ(1600, pos.x);
+
+   // Older than anything we've got
+   snapshots.sample(0, 100, pos, vel, angle);
+   EXPECT_FLOAT_EQ(F32(1500 - (SnapshotBuffer::SnapshotCount - 1) * 50), pos.x);
+
+   // Several updates in one frame replace one another
+   snapshots.push(1500, Point(0, 0), Point(0, 0), 0);
+   snapshots.sample(1500, 100, pos, vel, angle);
+   EXPECT_EQ(Point(0, 0), pos);
+
+   snapshots.clear();
+   EXPECT_FALSE(snapshots.sample(1500, 100, pos, vel, angle));
+}
+
+
+// Angles should be blended the short way around the circle
+TEST(SnapshotBufferTest, SampleAngle)
+{
+   SnapshotBuffer snapshots;
+   Point pos, vel;
+   F32 angle;
+
+   snapshots.push(0,   Point(0, 0), Point(0, 0), FloatPi - 0.1f);
+   snapshots.push(100, Point(0, 0), Point(0, 0), -FloatPi + 0.1f);
+
+   snapshots.sample(50, 0, pos, vel, angle);
+   EXPECT_NEAR(FloatPi, fabs(angle), 0.001f);
+}
+
+
+// Updates that arrive at irregular intervals should still give smooth, steady motion when rendered behind them
+TEST(SnapshotBufferTest, Jitter)
+{
+   const U32 Delay = 100;
+   const U32 MaxJitter = 30;
+
+   SnapshotBuffer snapshots;
+   Point pos, vel;
+   F32 angle;
+
+   F32 lastX = 0;
+   U32 nextSend = 0;
+
+   for(U32 time = 0; time < 5000; time += 10)
+   {
+      // Server sends every 50ms, moving right at 1 unit/ms; updates show up between 0 and MaxJitter ms late
+      if(time >= nextSend + (nextSend * 7919) % MaxJitter)
+      {
+         snapshots.push(time, Point(F32(nextSend), 0), Point(1000, 0), 0);
+         nextSend += 50;
+      }
+
+      if(time < Delay + MaxJitter)
+         continue;
+
+      snapshots.sample(time - Delay, 0, pos, vel, angle);
+
+      EXPECT_GE(pos.x, lastX) << "Went backwards at " << time;
+      EXPECT_NEAR(F32(time - Delay), pos.x, MaxJitter) << "Too far off at " << time;
+
+      lastX = pos.x;
+   }
+}
+
+
+static MoveObject *findResourceItem(Game *game)
+{
+   Vector<DatabaseObject *> fillVector;
+   game->getLevel()->findObjects(ResourceItemTypeNumber, fillVector);
+
+   return fillVector.size() == 1 ? static_cast<MoveObject *>(fillVector[0]) : NULL;
+}
+
+
+// Runs in real time, as that's how simulated latency is measured
+TEST(SnapshotBufferTest, LossAndLatency)
+{
+   const U32 Delay = 150;
+   const U32 MaxExtrapolation = 100;
+
+   GamePair gamePair("ResourceItem 0 0");
+   ClientGame *client = gamePair.getClient(0);
+
+   client->getSettings()->setSetting<U32>(IniKey::InterpolationDelay, Delay);
+   client->getSettings()->setSetting<U32>(IniKey::MaxExtrapolation, MaxExtrapolation);
+
+   MoveObject *serverItem = findResourceItem(gamePair.server);
+   MoveObject *clientItem = findResourceItem(client);
+   ASSERT_TRUE(serverItem && clientItem);
+
+   serverItem->setActualVel(Point(200, 0));
+
+   F32 lastX = clientItem->getRenderPos().x;
+
+   // Lose a fifth of what the server sends, and deliver the rest with varying latency
+   for(S32 i = 0; i < 150; i++)
+   {
+      client->getConnectionToServer()->setSimulatedNetParams(0, 0, 0.2f, TNL::Random::readI(20, 80));
+
+      GamePair::idle(10);
+      Platform::sleep(10);
+
+      EXPECT_GE(clientItem->getRenderPos().x, lastX) << "Went backwards on cycle " << i;
+      lastX = clientItem->getRenderPos().x;
+   }
+
+   EXPECT_GT(lastX, 0) << "Never moved!";
+
+   // Stop hearing from the server altogether; the item should carry on for a bit, then stop
+   client->getConnectionToServer()->setSimulatedNetParams(0, 0, 1, 0);
+
+   Platform::sleep(100);      // Let anything still in flight arrive
+   GamePair::idle(10, Delay / 10 + MaxExtrapolation / 10 + 5);
+   Point frozenPos = clientItem->getRenderPos();
+
+   GamePair::idle(10, 10);
+   EXPECT_EQ(frozenPos, clientItem->getRenderPos());
+}
+
+
+};
@@ -4,6 +4,16 @@
 //------------------------------------------------------------------------------
 
 #include "SymbolShape.h"
+
+#include "ClientGame.h"
+#include "Colors.h"
+#include "InputCode.h"
+#include "UIInstructions.h"
+#include "UIManager.h"
+
+#include "tnlPlatform.h"
+
+#include "TestUtils.h"
 #include "gtest/gtest.h"
 
 using namespace Zap::UI;
@@ -31,5 +41,114 @@ TEST(SymbolStringTest, Height)
    EXPECT_EQ(0, three->getHeight());
 }
 
+
+// Parsing the same markup again should hand back the same shapes, until something they depend on changes
+TEST(SymbolStringTest, ParseCache)
+{
+   InputCodeManager inputCodeManager;
+   inputCodeManager.setBinding(BINDING_CMDRMAP, InputModeKeyboard, KEY_C);
+
+   SymbolString::clearParseCache();
+
+   const string msg = "Press [[ShowCmdrMap]] for the map";
+   Vector<SymbolShapePtr> first, second;
+
+   SymbolString::symbolParse(&inputCodeManager, msg, first,  HelpContext, 16, true, &Colors::white);
+   SymbolString::symbolParse(&inputCodeManager, msg, second, HelpContext, 16, true, &Colors::white);
+
+   ASSERT_EQ(first.size(), second.size());
+   for(S32 i = 0; i < first.size(); i++)
+      EXPECT_EQ(first[i].get(), second[i].get());
+
+   EXPECT_EQ(1, SymbolString::getParseCacheMisses());
+   EXPECT_EQ(1, SymbolString::getParseCacheHits());
+
+   // Parsed symbols get added to whatever's already there
+   SymbolString::symbolParse(&inputCodeManager, msg, second, HelpContext, 16, true, &Colors::white);
+   EXPECT_EQ(first.size() * 2, second.size());
+
+   // Different color, different shapes
+   Vector<SymbolShapePtr> red;
+   SymbolString::symbolParse(&inputCodeManager, msg, red, HelpContext, 16, true, &Colors::red);
+   EXPECT_NE(first[0].get(), red[0].get());
+   EXPECT_EQ(2, SymbolString::getParseCacheMisses());
+
+   // Rebinding a key means we have to start over
+   inputCodeManager.setBinding(BINDING_CMDRMAP, InputModeKeyboard, KEY_M);
+
+   Vector<SymbolShapePtr> rebound;
+   SymbolString::symbolParse(&inputCodeManager, msg, rebound, HelpContext, 16, true, &Colors::white);
+   EXPECT_NE(first[0].get(), rebound[0].get());
+   EXPECT_EQ(3, SymbolString::getParseCacheMisses());
+
+   // As does switching between keyboard and joystick
+   inputCodeManager.setInputMode(InputModeJoystick);
+   inputCodeManager.setInputMode(InputModeKeyboard);
+
+   rebound.clear();
+   SymbolString::symbolParse(&inputCodeManager, msg, rebound, HelpContext, 16, true, &Colors::white);
+   EXPECT_EQ(4, SymbolString::getParseCacheMisses());
+   EXPECT_EQ(2, SymbolString::getParseCacheHits());
+}
+
+
+// Tab stops count the symbols that were there before we parsed, like the line that underlines the plugin headings
+TEST(SymbolStringTest, TabStopAfterExistingSymbols)
+{
+   SymbolString::clearParseCache();
+
+   for(S32 i = 0; i < 2; i++)
+   {
+      Vector<SymbolShapePtr> symbols;
+      symbols.push_back(SymbolString::getHorizLine(735, 16, 20, &Colors::gray70));
+      SymbolString::symbolParse(NULL, "[[TAB_STOP:0]]Key", symbols, HelpContext, 16, true, &Colors::yellow);
+
+      ASSERT_EQ(4, symbols.size());                   // Line, empty text before the tab stop, tab stop, "Key"
+      EXPECT_EQ(-735, symbols[2]->getWidth());
+   }
+
+   Vector<SymbolShapePtr> shorter;
+   shorter.push_back(SymbolString::getHorizLine(300, 16, 20, &Colors::gray70));
+   SymbolString::symbolParse(NULL, "[[TAB_STOP:0]]Key", shorter, HelpContext, 16, true, &Colors::yellow);
+
+   ASSERT_EQ(4, shorter.size());
+   EXPECT_EQ(-300, shorter[2]->getWidth());
+}
+
+
+// Time rendering every page of the instructions, with and without hanging on to parsed symbols between frames
+TEST(SymbolStringTest, DISABLED_InstructionsRenderBenchmark)
+{
+   const S32 Frames = 200;
+
+   GamePair pair;
+   ClientGame *clientGame = pair.getClient(0);
+   InstructionsUserInterface *ui = clientGame->getUIManager()->getUI<InstructionsUserInterface>();
+
+   for(S32 cached = 0; cached < 2; cached++)
+   {
+      SymbolString::clearParseCache();
+      U32 startTime = Platform::getRealMilliseconds();
+
+      for(S32 page = 0; page < InstructionsUserInterface::InstructionMaxPages; page++)
+      {
+         ui->onActivate();
+         ui->activatePage((InstructionsUserInterface::IntructionPages)page);
+
+         for(S32 frame = 0; frame < Frames; frame++)
+         {
+            if(!cached)
+               SymbolString::clearParseCache();
+
+            ui->render();
+         }
+      }
+
+      printf("%s: %d pages x %d frames in %dms (%d parsed, %d reused)\n", cached ? "Cached" : "Uncached",
+             InstructionsUserInterface::InstructionMaxPages, Frames, Platform::getRealMilliseconds() - startTime,
+             SymbolString::getParseCacheMisses(), SymbolString::getParseCacheHits());
+   }
+}
+
    
 };
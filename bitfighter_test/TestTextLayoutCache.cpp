@@ -0,0 +1,86 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "TextLayoutCache.h"
+
+#include "FontManager.h"
+#include "FontStrokeRoman.h"
+
+#include "gtest/gtest.h"
+
+namespace Zap
+{
+
+TEST(TextLayoutCacheTest, LeastRecentlyUsed)
+{
+   TextLayoutCache cache(2);
+   const BfFont *font = NULL;
+
+   TextLayoutCache::Layout *layout = cache.get(font, 10, "Alpha");
+   EXPECT_FALSE(layout->hasGeometry);
+   EXPECT_FALSE(layout->hasWidth);
+
+   layout->width = 50;
+   layout->hasWidth = true;
+
+   cache.get(font, 10, "Beta");
+   EXPECT_EQ(2, cache.getSize());
+
+   // Same string, same size: we've seen it before
+   EXPECT_TRUE(cache.get(font, 10, "Alpha")->hasWidth);
+   EXPECT_FLOAT_EQ(50, cache.get(font, 10, "Alpha")->width);
+
+   // Different size, different layout; Beta was used least recently, so it gets dropped to make room
+   EXPECT_FALSE(cache.get(font, 20, "Alpha")->hasWidth);
+   EXPECT_EQ(2, cache.getSize());
+
+   EXPECT_TRUE(cache.get(font, 10, "Alpha")->hasWidth);
+   EXPECT_FALSE(cache.get(font, 10, "Beta")->hasWidth);
+
+   EXPECT_EQ(3, cache.getHits());
+   EXPECT_EQ(4, cache.getMisses());
+
+   cache.clear();
+   EXPECT_EQ(0, cache.getSize());
+   EXPECT_FALSE(cache.get(font, 10, "Alpha")->hasWidth);
+}
+
+
+// Drawing a laid out string should draw the same lines as drawing it a character at a time
+TEST(TextLayoutCacheTest, StrokeLayout)
+{
+   const char *text = "Hi there!";
+   TextLayoutCache::Layout layout;
+
+   FontManager::layoutStrokeString(&fgStrokeRoman, text, &layout);
+   EXPECT_TRUE(layout.hasGeometry);
+
+   F32 advance = 0;
+   S32 segments = 0;
+
+   for(S32 i = 0; text[i]; i++)
+   {
+      const SFG_StrokeChar *schar = fgStrokeRoman.Characters[(S32)text[i]];
+      ASSERT_TRUE(schar != NULL);
+
+      for(S32 j = 0; j < schar->Number; j++)
+         segments += schar->Strips[j].Number - 1;
+
+      advance += schar->Right;
+   }
+
+   EXPECT_EQ(segments * 4, layout.verts.size());
+   EXPECT_FLOAT_EQ(advance, layout.advance);
+
+   // Last segment of the last character is shifted over by everything before it
+   const SFG_StrokeChar *last = fgStrokeRoman.Characters[(S32)'!'];
+   const SFG_StrokeStrip &lastStrip = last->Strips[last->Number - 1];
+
+   EXPECT_FLOAT_EQ(lastStrip.Vertices[lastStrip.Number - 1].X + advance - last->Right, layout.verts[layout.verts.size() - 2]);
+   EXPECT_FLOAT_EQ(lastStrip.Vertices[lastStrip.Number - 1].Y, layout.verts.last());
+}
+
+
+};
@@ -0,0 +1,116 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "tnlTimerWheel.h"
+#include "tnlVector.h"
+
+#include "gtest/gtest.h"
+
+using namespace TNL;
+
+namespace Zap
+{
+
+// Advances the wheel to time, and returns the ids of the timers that came due
+static Vector<S32> advanceTo(TimerWheel &wheel, U32 time)
+{
+   Vector<S32> due;
+
+   wheel.advance(time);
+   while(TimerWheel::Timer *timer = wheel.getNextDue())
+      due.push_back(*(S32 *) timer->getUserData());
+
+   return due;
+}
+
+
+TEST(TimerWheelTest, ComesDueOnTime)
+{
+   const U32 start = 100000;
+   TimerWheel wheel(start);
+
+   // Near, a few hundred ms out, many seconds out, and beyond what the wheel covers
+   S32 ids[] = { 0, 1, 2, 3 };
+   U32 delays[] = { 5, 300, 20000, 2000000 };
+   TimerWheel::Timer near(&ids[0]), soon(&ids[1]), later(&ids[2]), muchLater(&ids[3]);
+   TimerWheel::Timer *timers[] = { &near, &soon, &later, &muchLater };
+
+   for(S32 i = 0; i < 4; i++)
+      wheel.schedule(timers[i], start + delays[i]);
+
+   for(S32 i = 0; i < 4; i++)
+   {
+      EXPECT_EQ(0, advanceTo(wheel, start + delays[i] - 1).size());
+
+      Vector<S32> due = advanceTo(wheel, start + delays[i]);
+      ASSERT_EQ(1, due.size());
+      EXPECT_EQ(i, due[0]);
+      EXPECT_FALSE(timers[i]->isScheduled());
+   }
+}
+
+
+TEST(TimerWheelTest, LateTimersComeDueNextAdvance)
+{
+   TimerWheel wheel(1000);
+   S32 id = 7;
+   TimerWheel::Timer timer(&id);
+
+   advanceTo(wheel, 2000);
+   wheel.schedule(&timer, 1500);
+
+   // Even if the clock hasn't moved on since
+   wheel.advance(2000);
+   ASSERT_TRUE(wheel.getNextDue() == &timer);
+
+   // But not in the same advance, or we could keep handing out the same timer
+   wheel.schedule(&timer, 2000);
+   EXPECT_TRUE(wheel.getNextDue() == NULL);
+
+   Vector<S32> due = advanceTo(wheel, 2000);
+   ASSERT_EQ(1, due.size());
+   EXPECT_EQ(7, due[0]);
+}
+
+
+TEST(TimerWheelTest, CancelAndReschedule)
+{
+   TimerWheel wheel(0);
+   S32 ids[] = { 0, 1 };
+   TimerWheel::Timer first(&ids[0]);
+
+   wheel.schedule(&first, 50);
+   wheel.schedule(&first, 5000);          // Moves it
+   EXPECT_EQ(0, advanceTo(wheel, 4999).size());
+   EXPECT_EQ(1, advanceTo(wheel, 5000).size());
+
+   wheel.schedule(&first, 6000);
+   wheel.cancel(&first);
+   EXPECT_FALSE(first.isScheduled());
+
+   // A timer that goes away takes itself out of the wheel
+   {
+      TimerWheel::Timer second(&ids[1]);
+      wheel.schedule(&second, 5500);
+   }
+
+   EXPECT_EQ(0, advanceTo(wheel, 10000).size());
+}
+
+
+TEST(TimerWheelTest, TimeWrapsAround)
+{
+   const U32 start = 0xFFFFFF00;
+   TimerWheel wheel(start);
+   S32 id = 3;
+   TimerWheel::Timer timer(&id);
+
+   wheel.schedule(&timer, start + 1000);     // Past 0
+   EXPECT_EQ(0, advanceTo(wheel, start + 999).size());
+   EXPECT_EQ(1, advanceTo(wheel, start + 1000).size());
+}
+
+
+};
@@ -10,7 +10,9 @@
 #include "TeamConstants.h"
 
 #include "../zap/ClientInfo.h"
+#include "../zap/voiceCodec.h"
 
+#include <tnlNetObject.h>        // Must come before tnlGhostConnection.h
 #include <tnlGhostConnection.h>
 
 #include <string>
@@ -91,6 +93,44 @@ struct GamePair
 };
 
 
+// Stand in for Speex, so voice chat can be tested without a sound device.  Each byte of "compressed" data is one
+// 20ms frame with every sample set to the byte's value; concealed frames are all -1.
+class LoopbackVoiceEncoder : public VoiceEncoder
+{
+   U32 getSamplesPerFrame() { return 160; }
+   U32 getMaxCompressedFrameSize() { return 1; }
+
+   U32 compressFrame(S16 *samplePtr, U8 *outputPtr)
+   {
+      *outputPtr = U8(*samplePtr);
+      return 1;
+   }
+};
+
+
+class LoopbackVoiceDecoder : public VoiceDecoder
+{
+   U32 getAvgCompressedFrameSize() { return 1; }
+
+   U32 decompressFrame(S16 *framePtr, U8 *inputPtr, U32 inSize)
+   {
+      for(U32 i = 0; i < getSamplesPerFrame(); i++)
+         framePtr[i] = *inputPtr;
+
+      return 1;
+   }
+
+public:
+   U32 getSamplesPerFrame() { return 160; }
+
+   void concealFrame(S16 *framePtr)
+   {
+      for(U32 i = 0; i < getSamplesPerFrame(); i++)
+         framePtr[i] = -1;
+   }
+};
+
+
 };
 
 #endif
\ No newline at end of file
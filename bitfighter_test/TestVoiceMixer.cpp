@@ -0,0 +1,335 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "VoiceMixer.h"
+
+#include "ClientGame.h"
+#include "ClientInfo.h"
+#include "GameManager.h"
+#include "ServerGame.h"
+#include "teamInfo.h"
+
+#include "TestUtils.h"
+#include "gtest/gtest.h"
+
+namespace Zap
+{
+
+class LoopbackVoiceMixer : public VoiceMixer
+{
+protected:
+   VoiceDecoder *createDecoder() { return new LoopbackVoiceDecoder(); }
+   VoiceEncoder *createEncoder() { return new LoopbackVoiceEncoder(); }
+};
+
+
+class VoiceMixerTest : public testing::Test
+{
+protected:
+   GamePair gamePair;
+   LoopbackVoiceMixer mixer;
+   FullClientInfo alice, bob, carol, dave;
+   Vector<VoiceMixer::Listener> listeners;
+
+   VoiceMixerTest() :
+      gamePair("", 0),
+      alice(gamePair.server, NULL, "Alice", ClientInfo::ClassHuman),
+      bob  (gamePair.server, NULL, "Bob",   ClientInfo::ClassHuman),
+      carol(gamePair.server, NULL, "Carol", ClientInfo::ClassHuman),
+      dave (gamePair.server, NULL, "Dave",  ClientInfo::ClassHuman)
+   {
+      gamePair.server->addTeam(new Team());     // A fresh gamePair has only one
+
+      alice.setTeamIndex(0);
+      bob.setTeamIndex(0);
+      carol.setTeamIndex(1);
+      dave.setTeamIndex(0);                     // Never says a word
+
+      listeners.resize(4);
+      listeners[0].clientInfo = &alice;
+      listeners[1].clientInfo = &bob;
+      listeners[2].clientInfo = &carol;
+      listeners[3].clientInfo = &dave;
+   }
+
+   // Five frames of the same value, as a client would send every 100ms
+   static ByteBufferPtr voice(U8 value)
+   {
+      ByteBufferPtr buffer = new ByteBuffer(5);
+      memset(buffer->getBuffer(), value, 5);
+      return buffer;
+   }
+
+   void mix(U32 timeDelta, Vector<VoiceMixer::MixedStream> &streams)
+   {
+      if(mixer.idle(timeDelta))
+         mixer.mix(listeners, streams);
+   }
+
+   static const VoiceMixer::MixedStream *findStream(const Vector<VoiceMixer::MixedStream> &streams, ClientInfo *listener)
+   {
+      for(S32 i = 0; i < streams.size(); i++)
+         if(streams[i].listeners.contains(listener))
+            return &streams[i];
+
+      return NULL;
+   }
+
+   static const VoiceMixer::MixedStream *findWholeTeam(const Vector<VoiceMixer::MixedStream> &streams, S32 teamIndex)
+   {
+      for(S32 i = 0; i < streams.size(); i++)
+         if(streams[i].teamIndex == teamIndex && streams[i].wholeTeam)
+            return &streams[i];
+
+      return NULL;
+   }
+};
+
+
+TEST_F(VoiceMixerTest, RelayModeNeverMixes)
+{
+   EXPECT_FALSE(mixer.shouldMix(VoiceChatRelay, &alice, false));
+   EXPECT_FALSE(mixer.shouldMix(VoiceChatRelay, &bob, false));
+}
+
+
+// There's nothing to mix someone talking alone with, so they go out as they came in
+TEST_F(VoiceMixerTest, LoneSpeakerIsRelayed)
+{
+   EXPECT_FALSE(mixer.shouldMix(VoiceChatMix, &alice, false));
+   EXPECT_FALSE(mixer.shouldMix(VoiceChatMix, &carol, false));    // Other team
+
+   EXPECT_TRUE(mixer.shouldMix(VoiceChatMix, &bob, false));
+   EXPECT_TRUE(mixer.shouldMix(VoiceChatMix, &alice, false));
+}
+
+
+TEST_F(VoiceMixerTest, MixesEachTeam)
+{
+   Vector<VoiceMixer::MixedStream> streams;
+
+   mixer.addVoice(&alice, false, voice(10));
+   mixer.addVoice(&bob, false, voice(20));
+   mixer.addVoice(&carol, false, voice(30));
+
+   mix(VoiceMixer::MixInterval - 1, streams);
+   EXPECT_EQ(0, streams.size());
+
+   mix(1, streams);
+   ASSERT_EQ(4, streams.size());
+
+   // Dave hears both speakers, who each get their own stream with just the other one
+   const VoiceMixer::MixedStream *team = findWholeTeam(streams, 0);
+   ASSERT_TRUE(team != NULL);
+   EXPECT_EQ(5, team->data->getBufferSize());
+   EXPECT_EQ(30, team->data->getBuffer()[0]);
+   EXPECT_EQ(1, team->listeners.size());
+   EXPECT_EQ(team, findStream(streams, &dave));
+
+   const VoiceMixer::MixedStream *aliceHears = findStream(streams, &alice);
+   ASSERT_TRUE(aliceHears != NULL);
+   EXPECT_EQ(20, aliceHears->data->getBuffer()[0]);
+
+   const VoiceMixer::MixedStream *bobHears = findStream(streams, &bob);
+   ASSERT_TRUE(bobHears != NULL);
+   EXPECT_EQ(10, bobHears->data->getBuffer()[0]);
+
+   EXPECT_NE(aliceHears->streamId, bobHears->streamId);
+   EXPECT_NE(team->streamId, aliceHears->streamId);
+
+   // Carol is talking to herself; a recording would hear her, she hears nothing
+   const VoiceMixer::MixedStream *carolsTeam = findWholeTeam(streams, 1);
+   ASSERT_TRUE(carolsTeam != NULL);
+   EXPECT_EQ(30, carolsTeam->data->getBuffer()[0]);
+   EXPECT_EQ(0, carolsTeam->listeners.size());
+   EXPECT_TRUE(findStream(streams, &carol) == NULL);
+
+   // Everything went out; nothing more to send
+   streams.clear();
+   mix(VoiceMixer::MixInterval, streams);
+   EXPECT_EQ(0, streams.size());
+}
+
+
+TEST_F(VoiceMixerTest, EchoHearsEverything)
+{
+   Vector<VoiceMixer::MixedStream> streams;
+
+   mixer.addVoice(&alice, true, voice(10));
+   mixer.addVoice(&bob, false, voice(20));
+   mix(VoiceMixer::MixInterval, streams);
+
+   ASSERT_EQ(2, streams.size());    // Team, and Bob's own
+
+   const VoiceMixer::MixedStream *team = findWholeTeam(streams, 0);
+   ASSERT_TRUE(team != NULL);
+   EXPECT_EQ(team, findStream(streams, &alice));
+   EXPECT_EQ(team, findStream(streams, &dave));
+}
+
+
+// Muting happens on the server, so it works on mixed streams too
+TEST_F(VoiceMixerTest, MutedSpeakersAreLeftOut)
+{
+   Vector<VoiceMixer::MixedStream> streams;
+
+   listeners[0].muted.push_back(&bob);
+   listeners[3].muted.push_back(&bob);
+
+   mixer.addVoice(&alice, false, voice(10));
+   mixer.addVoice(&bob, false, voice(20));
+   mix(VoiceMixer::MixInterval, streams);
+
+   // Dave leaves out the same speaker Bob does, so they share a stream
+   const VoiceMixer::MixedStream *daveHears = findStream(streams, &dave);
+   ASSERT_TRUE(daveHears != NULL);
+   EXPECT_EQ(10, daveHears->data->getBuffer()[0]);
+   EXPECT_EQ(daveHears, findStream(streams, &bob));
+
+   // Alice has left out everyone talking
+   EXPECT_TRUE(findStream(streams, &alice) == NULL);
+
+   const VoiceMixer::MixedStream *team = findWholeTeam(streams, 0);
+   ASSERT_TRUE(team != NULL);
+   EXPECT_EQ(30, team->data->getBuffer()[0]);
+   EXPECT_EQ(0, team->listeners.size());
+}
+
+
+// Clients decode each stream id separately, so an id has to mean the same encoder for as long as it's in use
+TEST_F(VoiceMixerTest, StreamIdsFollowEncoders)
+{
+   Vector<VoiceMixer::MixedStream> streams;
+
+   mixer.addVoice(&alice, false, voice(10));
+   mixer.addVoice(&bob, false, voice(20));
+   mix(VoiceMixer::MixInterval, streams);
+
+   U32 teamId = findStream(streams, &dave)->streamId;
+   U32 bobId  = findStream(streams, &bob)->streamId;
+
+   // Bob pauses for a moment; he's still leaving himself out, so everyone stays put
+   streams.clear();
+   mixer.addVoice(&alice, false, voice(10));
+   mix(VoiceMixer::MixInterval, streams);
+
+   ASSERT_TRUE(findStream(streams, &bob) != NULL);
+   EXPECT_EQ(bobId, findStream(streams, &bob)->streamId);
+   EXPECT_EQ(teamId, findStream(streams, &dave)->streamId);
+
+   // Dave mutes Bob, and moves over to Bob's stream
+   listeners[3].muted.push_back(&bob);
+
+   streams.clear();
+   mixer.addVoice(&alice, false, voice(10));
+   mixer.addVoice(&bob, false, voice(20));
+   mix(VoiceMixer::MixInterval, streams);
+
+   EXPECT_EQ(bobId, findStream(streams, &dave)->streamId);
+   EXPECT_EQ(teamId, findWholeTeam(streams, 0)->streamId);
+}
+
+
+TEST_F(VoiceMixerTest, AutoMixesOnlyWhenTalkingOverEachOther)
+{
+   Vector<VoiceMixer::MixedStream> streams;
+
+   // Alice alone gets relayed
+   EXPECT_FALSE(mixer.shouldMix(VoiceChatAuto, &alice, false));
+   mix(VoiceMixer::MixInterval, streams);
+   EXPECT_FALSE(mixer.shouldMix(VoiceChatAuto, &alice, false));
+
+   // Carol, on the other team, doesn't change that
+   EXPECT_FALSE(mixer.shouldMix(VoiceChatAuto, &carol, false));
+
+   // Bob joins in
+   ASSERT_TRUE(mixer.shouldMix(VoiceChatAuto, &bob, false));
+   mixer.addVoice(&bob, false, voice(20));
+   ASSERT_TRUE(mixer.shouldMix(VoiceChatAuto, &alice, false));
+   mixer.addVoice(&alice, false, voice(10));
+
+   mix(VoiceMixer::MixInterval, streams);
+   EXPECT_EQ(3, streams.size());
+
+   // Bob stops; once he's been quiet a while, Alice goes back to being relayed
+   for(U32 i = 0; i <= VoiceMixer::SpeakerTimeout; i += VoiceMixer::MixInterval)
+   {
+      streams.clear();
+      mix(VoiceMixer::MixInterval, streams);
+   }
+
+   EXPECT_FALSE(mixer.shouldMix(VoiceChatAuto, &alice, false));
+   EXPECT_EQ(0, mixer.getMixedBytes());    // Sending is someone else's job
+}
+
+
+TEST_F(VoiceMixerTest, SpeakerLeaves)
+{
+   Vector<VoiceMixer::MixedStream> streams;
+
+   carol.setTeamIndex(0);
+
+   mixer.addVoice(&alice, false, voice(10));
+   mixer.addVoice(&bob, false, voice(20));
+   mix(VoiceMixer::MixInterval, streams);
+
+   const VoiceMixer::MixedStream *team = findWholeTeam(streams, 0);
+   ASSERT_TRUE(team != NULL);
+   U32 teamId = team->streamId;
+
+   // Alice leaves mid-sentence; the rest of the team carries on as before
+   mixer.addVoice(&alice, false, voice(10));
+   mixer.removeSpeaker(&alice);
+   listeners.erase(0);
+
+   mixer.addVoice(&bob, false, voice(20));
+   mixer.addVoice(&carol, false, voice(30));
+
+   streams.clear();
+   mix(VoiceMixer::MixInterval, streams);
+
+   team = findWholeTeam(streams, 0);
+   ASSERT_TRUE(team != NULL);
+   EXPECT_EQ(50, team->data->getBuffer()[0]);
+   EXPECT_EQ(teamId, team->streamId);
+   EXPECT_EQ(team, findStream(streams, &dave));
+}
+
+
+// Clients tell the server who they've muted, including anyone muted before they connected
+TEST(VoiceMuteTest, MutesReachServer)
+{
+   GamePair gamePair("", 1);
+   ClientGame *client = gamePair.getClient(0);
+   GameConnection *conn = gamePair.server->getClientInfo(0)->getConnection();
+
+   EXPECT_TRUE(conn->canHearMixedVoiceChat());
+
+   client->addToVoiceMuteList("Bob");
+   GamePair::idle(10, 5);
+   EXPECT_TRUE(conn->isVoiceMuted("Bob"));
+
+   client->removeFromVoiceMuteList("Bob");
+   GamePair::idle(10, 5);
+   EXPECT_FALSE(conn->isVoiceMuted("Bob"));
+
+   // Dave mutes Carol before he's connected
+   ClientGame *dave = newClientGame(gamePair.server->getSettingsPtr());
+   dave->userEnteredLoginCredentials("Dave", "password", false);
+   dave->activateMainMenuUI();
+   GameManager::addClientGame(dave);
+
+   dave->addToVoiceMuteList("Carol");
+   GamePair::addClient(dave);
+   GamePair::idle(10, 5);
+
+   GameConnection *daveConn = gamePair.server->findClientInfo("Dave")->getConnection();
+   ASSERT_TRUE(daveConn != NULL);
+   EXPECT_TRUE(daveConn->isVoiceMuted("Carol"));
+   EXPECT_FALSE(conn->isVoiceMuted("Carol"));
+}
+
+
+};
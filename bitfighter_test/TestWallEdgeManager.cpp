@@ -0,0 +1,159 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "Level.h"
+#include "WallEdgeManager.h"
+#include "WallItem.h"
+#include "stringUtils.h"
+
+#include "tnlPlatform.h"
+
+#include "gtest/gtest.h"
+
+namespace Zap
+{
+
+static Vector<WallSegment const *> getAllWallSegments(Level *level)
+{
+   Vector<WallSegment const *> segments;
+   const Vector<DatabaseObject *> *walls = level->findObjects_fast(WallItemTypeNumber);
+
+   for(S32 i = 0; i < walls->size(); i++)
+   {
+      BarrierX *wall = static_cast<BarrierX *>(static_cast<WallItem *>(walls->get(i)));
+
+      for(S32 j = 0; j < wall->getSegmentCount(); j++)
+         segments.push_back(wall->getSegment(j));
+   }
+
+   return segments;
+}
+
+
+// Edges come back in a different order when walls are clipped in clusters, so we just check every edge is in both lists
+static void expectSameEdges(const Vector<Point> &expected, const Vector<Point> &actual)
+{
+   ASSERT_EQ(expected.size(), actual.size());
+
+   for(S32 i = 0; i < expected.size(); i += 2)
+   {
+      bool found = false;
+
+      for(S32 j = 0; j < actual.size() && !found; j += 2)
+         found = expected[i] == actual[j] && expected[i+1] == actual[j+1];
+
+      EXPECT_TRUE(found) << "Missing edge " << expected[i].toString() << " -> " << expected[i+1].toString();
+   }
+}
+
+
+TEST(WallEdgeManagerTest, IncrementalClipping)
+{
+   Level level("BarrierMaker 20 0 0 1 0\n"         // These two touch, so they're clipped together
+               "BarrierMaker 20 0 0 0 1\n"
+               "BarrierMaker 20 1000 1000 1010 1000\n");   // This one is off on its own
+
+   const WallEdgeManager *wallEdgeManager = level.getWallEdgeManager();
+   EXPECT_EQ(2, wallEdgeManager->getClusterCount());
+
+   Vector<Point> edges, expectedEdges;
+
+   // Nothing changed, nothing to clip
+   level.buildWallEdgeGeometry(edges);
+   EXPECT_EQ(0, wallEdgeManager->getLastClippedClusterCount());
+
+   // Move the loner; the other cluster should be left alone
+   const Vector<DatabaseObject *> *walls = level.findObjects_fast(WallItemTypeNumber);
+   ASSERT_EQ(3, walls->size());
+   static_cast<WallItem *>(walls->get(2))->moveTo(Point(2000, 3000));
+
+   level.buildWallEdgeGeometry(edges);
+   EXPECT_EQ(1, wallEdgeManager->getLastClippedClusterCount());
+   EXPECT_EQ(2, wallEdgeManager->getClusterCount());
+
+   WallEdgeManager::clipAllWallEdges(getAllWallSegments(&level), expectedEdges);
+   expectSameEdges(expectedEdges, edges);
+   EXPECT_EQ(edges.size() / 2, level.getWallEdgeDatabase()->getObjectCount());
+
+   // Now move it onto the others, which should merge the two clusters
+   static_cast<WallItem *>(walls->get(2))->moveTo(Point(0, 0));
+
+   level.buildWallEdgeGeometry(edges);
+   EXPECT_EQ(1, wallEdgeManager->getLastClippedClusterCount());
+   EXPECT_EQ(1, wallEdgeManager->getClusterCount());
+
+   WallEdgeManager::clipAllWallEdges(getAllWallSegments(&level), expectedEdges);
+   expectSameEdges(expectedEdges, edges);
+   EXPECT_EQ(edges.size() / 2, level.getWallEdgeDatabase()->getObjectCount());
+}
+
+
+// Compares rebuilding wall edges after dragging a wall with clipping every wall, the way we used to, on the shipped levels
+// with the most walls.  Expects to be run from the bitfighter_test folder; run with --gtest_also_run_disabled_tests to see
+// the numbers.
+TEST(WallEdgeManagerTest, DISABLED_DragWallBenchmark)
+{
+   const string levelDir = "../resource/levels";
+   const string extension = "level";
+   const S32 LevelsToTest = 5;
+   const S32 Drags = 50;
+
+   Vector<string> levelFiles;
+   getFilesFromFolder(levelDir, levelFiles, FULL_PATH, &extension, 1);
+   ASSERT_GT(levelFiles.size(), 0) << "Couldn't find any levels in " << levelDir;
+
+   // Find the levels with the most wall segments
+   Vector<S32> segmentCounts;
+   for(S32 i = 0; i < levelFiles.size(); i++)
+   {
+      Level level;
+      level.loadLevelFromFile(levelFiles[i]);
+      segmentCounts.push_back(getAllWallSegments(&level).size());
+   }
+
+   for(S32 test = 0; test < LevelsToTest && levelFiles.size() > 0; test++)
+   {
+      S32 biggest = 0;
+      for(S32 i = 1; i < segmentCounts.size(); i++)
+         if(segmentCounts[i] > segmentCounts[biggest])
+            biggest = i;
+
+      string filename = levelFiles[biggest];
+      levelFiles.erase(biggest);
+      segmentCounts.erase(biggest);
+
+      Level level;
+      level.loadLevelFromFile(filename);
+
+      const Vector<DatabaseObject *> *walls = level.findObjects_fast(WallItemTypeNumber);
+      if(walls->size() == 0)
+         continue;
+
+      Vector<Point> edges;
+      U32 incrementalTime = 0, fullTime = 0;
+
+      for(S32 i = 0; i < Drags; i++)
+      {
+         // Nudge a wall back and forth, as if it were being dragged around
+         WallItem *wall = static_cast<WallItem *>(walls->get(i % walls->size()));
+         wall->moveTo(wall->getVert(0) + Point(i % 2 ? -10 : 10, 0));
+
+         U32 startTime = Platform::getRealMilliseconds();
+         level.buildWallEdgeGeometry(edges);
+         incrementalTime += Platform::getRealMilliseconds() - startTime;
+
+         startTime = Platform::getRealMilliseconds();
+         WallEdgeManager::clipAllWallEdges(getAllWallSegments(&level), edges);
+         fullTime += Platform::getRealMilliseconds() - startTime;
+      }
+
+      printf("%s: %d wall segments in %d clusters, %d drags: incremental %dms, full %dms\n",
+             filename.c_str(), getAllWallSegments(&level).size(), level.getWallEdgeManager()->getClusterCount(),
+             Drags, incrementalTime, fullTime);
+   }
+}
+
+
+};
@@ -0,0 +1,153 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "ZoneMap.h"
+
+#include "BfObject.h"
+#include "GeomUtils.h"
+#include "Level.h"
+#include "stringUtils.h"
+
+#include "tnlPlatform.h"
+
+#include "gtest/gtest.h"
+
+namespace Zap
+{
+
+// The way we used to do it: find zones whose extents overlap the point, then test every one of them
+static void findZonesTheHardWay(Level *level, const Point &point, Vector<DatabaseObject *> &zones)
+{
+   Vector<DatabaseObject *> candidates;
+   level->findObjects((TestFunc)isZoneType, candidates, Rect(point, point));
+
+   for(S32 i = 0; i < candidates.size(); i++)
+   {
+      const Vector<Point> *poly = candidates[i]->getCollisionPoly();
+
+      if(polygonContainsPoint(poly->address(), poly->size(), point))
+         zones.push_back(candidates[i]);
+   }
+}
+
+
+static void checkEveryPoint(Level *level, const Rect &area, F32 step)
+{
+   const ZoneMap *zoneMap = level->getZoneMap();
+   Vector<DatabaseObject *> expected, actual;
+
+   for(F32 x = area.min.x; x <= area.max.x; x += step)
+      for(F32 y = area.min.y; y <= area.max.y; y += step)
+      {
+         expected.clear();
+         actual.clear();
+
+         findZonesTheHardWay(level, Point(x, y), expected);
+         zoneMap->findZones(Point(x, y), actual);
+
+         ASSERT_EQ(expected.size(), actual.size()) << "At " << Point(x, y).toString();
+
+         for(S32 i = 0; i < expected.size(); i++)
+            EXPECT_TRUE(actual.contains(expected[i])) << "At " << Point(x, y).toString();
+      }
+}
+
+
+TEST(ZoneMapTest, MatchesPolygonTests)
+{
+   Level level("GoalZone -1 0 0 4 0 4 4 0 4\n"                      // Square
+               "LoadoutZone 0 1 1 8 1 8 2 2 2 2 8 1 8\n"            // Concave L, overlapping the square
+               "GoalZone 1 10 10 14 10 12 13\n");                   // Triangle off on its own
+
+   const ZoneMap *zoneMap = level.getZoneMap();
+
+   EXPECT_GT(zoneMap->getCellCount(), 0);
+   EXPECT_LT(zoneMap->getBoundaryCellCount(), zoneMap->getCellCount()) << "Some cells should need no polygon tests";
+
+   checkEveryPoint(&level, Rect(-255, -255, 4000, 4000), 13.7f);
+
+   // Move a zone; the map should notice and rebuild itself
+   U32 version = zoneMap->getVersion();
+
+   const Vector<DatabaseObject *> *goalZones = level.findObjects_fast(GoalZoneTypeNumber);
+   ASSERT_EQ(2, goalZones->size());
+   static_cast<BfObject *>(goalZones->get(0))->moveTo(Point(2000, 0));
+
+   EXPECT_NE(version, level.getZoneMap()->getVersion());
+   checkEveryPoint(&level, Rect(-255, -255, 4000, 4000), 13.7f);
+}
+
+
+// Compares finding which zones ships are in using the zone map with the way we used to do it, on the shipped levels with
+// the most zones.  Expects to be run from the bitfighter_test folder; run with --gtest_also_run_disabled_tests to see
+// the numbers.
+TEST(ZoneMapTest, DISABLED_ZoneLookupBenchmark)
+{
+   const string levelDir = "../resource/levels";
+   const string extension = "level";
+   const S32 Ticks = 1000;
+   const S32 Ships = 16;
+   const S32 ChecksPerShip = 4;     // Slip, loadout, goal and zone event checks, roughly
+
+   Vector<string> levelFiles;
+   getFilesFromFolder(levelDir, levelFiles, FULL_PATH, &extension, 1);
+   ASSERT_GT(levelFiles.size(), 0) << "Couldn't find any levels in " << levelDir;
+
+   for(S32 i = 0; i < levelFiles.size(); i++)
+   {
+      Level level;
+      level.loadLevelFromFile(levelFiles[i]);
+
+      Vector<DatabaseObject *> zones;
+      level.findObjects((TestFunc)isZoneType, zones);
+
+      if(zones.size() == 0)
+         continue;
+
+      // Ships wander back and forth across the level
+      Rect extents = level.getExtents();
+      Vector<DatabaseObject *> found;
+      U32 hardWayHits = 0, mapHits = 0;
+
+      U32 startTime = Platform::getRealMilliseconds();
+      const ZoneMap *zoneMap = level.getZoneMap();
+      U32 buildTime = Platform::getRealMilliseconds() - startTime;
+
+      startTime = Platform::getRealMilliseconds();
+      for(S32 tick = 0; tick < Ticks; tick++)
+         for(S32 ship = 0; ship < Ships * ChecksPerShip; ship++)
+         {
+            F32 t = F32((tick * 7 + ship * 131) % Ticks) / Ticks;
+            Point pos(extents.min.x + extents.getWidth() * t, extents.min.y + extents.getHeight() * (1 - t) * (ship % 2));
+
+            found.clear();
+            findZonesTheHardWay(&level, pos, found);
+            hardWayHits += found.size();
+         }
+      U32 hardWayTime = Platform::getRealMilliseconds() - startTime;
+
+      startTime = Platform::getRealMilliseconds();
+      for(S32 tick = 0; tick < Ticks; tick++)
+         for(S32 ship = 0; ship < Ships * ChecksPerShip; ship++)
+         {
+            F32 t = F32((tick * 7 + ship * 131) % Ticks) / Ticks;
+            Point pos(extents.min.x + extents.getWidth() * t, extents.min.y + extents.getHeight() * (1 - t) * (ship % 2));
+
+            found.clear();
+            zoneMap->findZones(pos, found);
+            mapHits += found.size();
+         }
+      U32 mapTime = Platform::getRealMilliseconds() - startTime;
+
+      EXPECT_EQ(hardWayHits, mapHits);
+
+      printf("%s: %d zones, %d of %d cells on boundaries, map built in %dms; %d ticks: grid + polygons %dms, zone map %dms\n",
+             levelFiles[i].c_str(), zones.size(), zoneMap->getBoundaryCellCount(), zoneMap->getCellCount(), buildTime,
+             Ticks, hardWayTime, mapTime);
+   }
+}
+
+
+};
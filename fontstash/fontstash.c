@@ -816,6 +816,68 @@ void sth_draw_text(struct sth_stash* stash,
 	if (dx) *dx = x;
 }
 
+int sth_layout_text(struct sth_stash* stash,
+				   int idx, float size,
+				   const char* s, float* verts, struct sth_texture** textures, int maxglyphs, float* dx)
+{
+	unsigned int codepoint;
+	struct sth_glyph* glyph = NULL;
+	unsigned int state = 0;
+	struct sth_quad q;
+	short isize = (short)(size*10.0f);
+	float x = 0, y = 0;
+	float* v = verts;
+	int count = 0;
+	struct sth_font* fnt = NULL;
+
+	if (dx) *dx = 0;
+	if (stash == NULL) return 0;
+
+	fnt = stash->fonts;
+	while(fnt != NULL && fnt->idx != idx) fnt = fnt->next;
+	if (fnt == NULL) return 0;
+	if (fnt->type != BMFONT && !fnt->data) return 0;
+
+	for (; *s && count < maxglyphs; ++s)
+	{
+		if (decutf8(&state, &codepoint, *(unsigned char*)s)) continue;
+		glyph = get_glyph(stash, fnt, codepoint, isize);
+		if (!glyph) continue;
+		if (!get_quad(stash, fnt, glyph, isize, &x, &y, &q)) continue;
+
+		v = setv(v, q.x0, q.y0, q.s0, q.t0);
+		v = setv(v, q.x1, q.y0, q.s1, q.t0);
+		v = setv(v, q.x1, q.y1, q.s1, q.t1);
+
+		v = setv(v, q.x0, q.y0, q.s0, q.t0);
+		v = setv(v, q.x1, q.y1, q.s1, q.t1);
+		v = setv(v, q.x0, q.y1, q.s0, q.t1);
+
+		textures[count++] = glyph->texture;
+	}
+
+	if (dx) *dx = x;
+	return count;
+}
+
+void sth_draw_layout(struct sth_stash* stash, const float* verts, struct sth_texture* const* textures, int glyphcount)
+{
+	struct sth_texture* texture = NULL;
+	int i;
+
+	if (stash == NULL) return;
+
+	for (i = 0; i < glyphcount; i++)
+	{
+		texture = textures[i];
+		if (texture->nverts+6 >= VERT_COUNT)
+			flush_draw(stash);
+
+		memcpy(&texture->verts[texture->nverts*4], &verts[i*6*4], sizeof(float)*6*4);
+		texture->nverts += 6;
+	}
+}
+
 void sth_dim_text(struct sth_stash* stash,
 				  int idx, float size,
 				  const char* s,
@@ -22,6 +22,8 @@
 
 typedef unsigned int GLuint;
 
+struct sth_texture;
+
 struct sth_stash* sth_create(int cachew, int cacheh);
 
 int sth_add_font(struct sth_stash* stash, const char* path);
@@ -42,6 +44,16 @@ void sth_draw_text(struct sth_stash* stash,
 void sth_dim_text(struct sth_stash* stash, int idx, float size, const char* string,
 				  float* minx, float* miny, float* maxx, float* maxy);
 
+/* Lays out string the way sth_draw_text would draw it, but keeps the result rather than drawing it: the six
+   vertices (x, y, s, t) of each glyph go in verts, and the texture it's drawn from in textures.  Writes at most
+   maxglyphs glyphs, and returns how many it wrote.  Glyphs never move around in their textures, so the layout can
+   be drawn with sth_draw_layout for as long as the stash lives. */
+int sth_layout_text(struct sth_stash* stash,
+				   int idx, float size,
+				   const char* string, float* verts, struct sth_texture** textures, int maxglyphs, float* dx);
+
+void sth_draw_layout(struct sth_stash* stash, const float* verts, struct sth_texture* const* textures, int glyphcount);
+
 void sth_vmetrics(struct sth_stash* stash,
 				  int idx, float size,
 				  float* ascender, float* descender, float * lineh);
@@ -9,113 +9,387 @@
 
 #include "tnlThread.h"
 #include "tnlLog.h"
+#include "tnlVector.h"
+#include "tnlPlatform.h"
+
+#include <deque>
 
 namespace Master
 {
 
 class ThreadEntry : public RefPtrData
 {
+   friend class DatabaseAccessThread;
+
+   U32 mQueuedTime;           // When the entry was added to the queue, for latency tracking
+
 public:
+   ThreadEntry() { mQueuedTime = 0; }
    virtual ~ThreadEntry() {};
 
    virtual void run() = 0;    // runs on seperate thread
    virtual void finish() {};  // finishes the entry on primary thread after "run()" is done to avoid 2 threads crashing in to the same network TNL and others.
+
+   // Consecutive batchable entries may be run together by a single worker, inside one database transaction
+   virtual bool isBatchable() const { return false; }
 };
 
-class DatabaseAccessThread : public TNL::Thread
+
+// Per-worker state, such as a database connection.  Created and deleted on the worker thread that owns it.
+class WorkerContext
 {
+public:
+   virtual ~WorkerContext() {};
+
+   virtual void beginBatch() {};    // Called before a worker runs two or more batchable entries back-to-back
+   virtual void endBatch() {};      // Called after the last entry of the batch has run
+};
+
+
+// A pool of worker threads fed by a blocking queue.  Entries are never dropped; if the workers can't keep up, the
+// queue simply grows, and we keep track of how deep it gets and how long entries wait so we can see that happening.
+class DatabaseAccessThread
+{
+public:
+   struct Stats
+   {
+      U32 queueDepth;         // Entries waiting for a worker
+      U32 peakQueueDepth;
+      U32 processedCount;     // Entries run to completion
+      U32 batchCount;         // Number of transactions containing more than one entry
+      U32 averageLatency;     // Ms from addEntry() until run() completed
+      U32 maxLatency;
+   };
+
 private:
-   U32 mEntryStart;
-   U32 mEntryThread;
-   U32 mEntryEnd;
+   class Worker : public TNL::Thread
+   {
+      DatabaseAccessThread *mPool;
+
+   public:
+      Worker(DatabaseAccessThread *pool) { mPool = pool; }
+      U32 run() { return mPool->runWorker(); }
+   };
+
+   // We hold a reference to each entry from addEntry() until idle() is done with it.  Workers never touch the
+   // reference counts, which aren't thread safe, so these are plain pointers.
+   std::deque<ThreadEntry *> mPending;    // Waiting to be run on a worker; a deque, since we take from the front
+   Vector<ThreadEntry *> mFinished;       // Waiting for finish() on the primary thread
+
+   Vector<Worker *> mWorkers;
+   U32 mWorkerCount;
+   U32 mMaxBatchSize;
+   U32 mActiveWorkers;
 
    bool mRunning;
-   bool mThreadActive;
+   bool mStarted;
 
-   static const U32 mEntrySize = 128;
+   Mutex mLock;
+   Semaphore mSemaphore;
 
-   RefPtr<ThreadEntry> mEntry[mEntrySize];
+   Stats mStats;
+   U64 mTotalLatency;
+   U32 mOverloadWarningDepth;
+   bool mWarnOnOverload;
 
-public:
-   DatabaseAccessThread() // Constructor
+   static const U32 FirstOverloadWarningDepth = 128;
+
+   static ThreadStorage &getWorkerStorage()
    {
-      mEntryStart = 0;
-      mEntryThread = 0;
-      mEntryEnd = 0;
+      static ThreadStorage storage;
+      return storage;
+   }
 
-      mRunning = true;
-      mThreadActive = false;
+
+   void startWorkers()
+   {
+      for(U32 i = 0; i < mWorkerCount; i++)
+      {
+         Worker *worker = new Worker(this);
+         mWorkers.push_back(worker);
+
+         mLock.lock();
+         mActiveWorkers++;
+         mLock.unlock();
+
+         if(!worker->start())
+         {
+            mLock.lock();
+            mActiveWorkers--;
+            mLock.unlock();
+
+            logprintf(LogConsumer::LogError, "Could not start database worker thread");
+         }
+      }
    }
 
 
-   void addEntry(ThreadEntry *entry)
+   // Pulls the next entry off the queue, along with any batchable entries that immediately follow it
+   void takeBatch(Vector<ThreadEntry *> &batch)
    {
-      U32 entryEnd = mEntryEnd + 1;
+      batch.clear();
 
-      if(entryEnd >= mEntrySize)
-         entryEnd = 0;
+      mLock.lock();
 
-      if(entryEnd == mEntryStart)      // Too many entries
+      if(mPending.size() > 0)
       {
-         logprintf(LogConsumer::LogError, "Database thread overloaded - database access too slow?");
-         return;
+         batch.push_back(mPending[0]);
+         mPending.pop_front();
+
+         if(batch[0]->isBatchable())
+            while(mPending.size() > 0 && (U32)batch.size() < mMaxBatchSize && mPending[0]->isBatchable())
+            {
+               batch.push_back(mPending[0]);
+               mPending.pop_front();
+            }
+
+         mStats.queueDepth = (U32)mPending.size();
       }
 
-      mEntry[mEntryEnd] = entry;
-      mEntryEnd = entryEnd;
-      if(!mThreadActive)
+      mLock.unlock();
+
+      // The semaphore was signaled once for each entry we took along, so other workers will get some wakeups
+      // with nothing to do.  That's harmless, and cheaper than trying to keep the count exact.
+   }
+
+
+   void completeBatch(const Vector<ThreadEntry *> &batch)
+   {
+      U32 now = Platform::getRealMilliseconds();
+
+      mLock.lock();
+
+      for(S32 i = 0; i < batch.size(); i++)
       {
-         mThreadActive = true;
-         start();
+         U32 latency = now - batch[i]->mQueuedTime;
+
+         mTotalLatency += latency;
+         if(latency > mStats.maxLatency)
+            mStats.maxLatency = latency;
+
+         mFinished.push_back(batch[i]);
       }
+
+      mStats.processedCount += batch.size();
+      if(batch.size() > 1)
+         mStats.batchCount++;
+
+      mLock.unlock();
    }
 
 
-   U32 run()
+   U32 runWorker()
    {
-      mThreadActive = true;
-      while(mRunning)
+      WorkerContext *context = createWorkerContext();
+      getWorkerStorage().set(context);
+
+      Vector<ThreadEntry *> batch;
+
+      for(;;)
       {
-         if(mEntryThread != mEntryEnd)
+         mSemaphore.wait();
+         takeBatch(batch);
+
+         if(batch.size() == 0)      // Someone else got our entry, or we were woken by terminate()
          {
-            mEntry[mEntryThread]->run();
-            mEntryThread++;
-            if(mEntryThread >= mEntrySize)
-               mEntryThread = 0;
+            mLock.lock();
+            bool running = mRunning;
+            mLock.unlock();
+
+            if(!running)
+               break;
+
+            continue;
          }
-         else
-            Platform::sleep(50);
+
+         bool transaction = context && batch.size() > 1;
+
+         if(transaction)
+            context->beginBatch();
+
+         for(S32 i = 0; i < batch.size(); i++)
+            batch[i]->run();
+
+         if(transaction)
+            context->endBatch();
+
+         completeBatch(batch);
       }
 
-      mThreadActive = false;
+      getWorkerStorage().set(NULL);
+      delete context;
+
+      mLock.lock();
+      mActiveWorkers--;
+      mLock.unlock();
 
       return 0;
    }
 
+protected:
+   // Called on each worker thread as it starts; return the state the worker should own for its lifetime, or NULL
+   virtual WorkerContext *createWorkerContext() { return NULL; }
+
+public:
+   DatabaseAccessThread(U32 workerCount = 1, U32 maxBatchSize = 1) : mSemaphore(0, S32_MAX)  // Constructor
+   {
+      mWorkerCount  = workerCount  > 0 ? workerCount  : 1;
+      mMaxBatchSize = maxBatchSize > 0 ? maxBatchSize : 1;
+      mActiveWorkers = 0;
+
+      mRunning = true;
+      mStarted = false;
+
+      mStats.queueDepth     = 0;
+      mStats.peakQueueDepth = 0;
+      mStats.processedCount = 0;
+      mStats.batchCount     = 0;
+      mStats.averageLatency = 0;
+      mStats.maxLatency     = 0;
+      mTotalLatency = 0;
+      mOverloadWarningDepth = FirstOverloadWarningDepth;
+      mWarnOnOverload = true;
+
+      getWorkerStorage();     // Make sure our storage is created here on the primary thread
+   }
+
+
+   // Can be called from any thread
+   void addEntry(ThreadEntry *entry)
+   {
+      entry->incRef();
+      entry->mQueuedTime = Platform::getRealMilliseconds();
+
+      mLock.lock();
+
+      mPending.push_back(entry);
+
+      U32 queueDepth = (U32)mPending.size();
+
+      mStats.queueDepth = queueDepth;
+      if(queueDepth > mStats.peakQueueDepth)
+         mStats.peakQueueDepth = queueDepth;
+
+      bool warn = mWarnOnOverload && queueDepth >= mOverloadWarningDepth;
+      if(warn)
+         mOverloadWarningDepth *= 2;
+
+      bool start = !mStarted && mRunning;
+      if(start)
+         mStarted = true;
+
+      mLock.unlock();
+
+      if(warn)
+         logprintf(LogConsumer::LogWarning, "Database queue has %d entries waiting - database access too slow?", queueDepth);
+
+      if(start)
+         startWorkers();
+
+      mSemaphore.increment();
+   }
+
 
    void idle()
    {
-      while(mEntryStart != mEntryThread)
-      {
-         mEntry[mEntryStart]->finish();
-         mEntry[mEntryStart].set(NULL);  // RefPtr, we can just set to NULL and it will delete itself
-         mEntryStart++;
+      Vector<ThreadEntry *> finished;
+
+      mLock.lock();
+      finished = mFinished;
+      mFinished.clear();
+      mLock.unlock();
 
-         if(mEntryStart >= mEntrySize)
-            mEntryStart = 0;
+      for(S32 i = 0; i < finished.size(); i++)
+      {
+         finished[i]->finish();
+         finished[i]->decRef();     // Deletes the entry if nobody else is holding on to it
       }
    }
 
+
+   Stats getStats()
+   {
+      mLock.lock();
+
+      Stats stats = mStats;
+      stats.averageLatency = mStats.processedCount > 0 ? U32(mTotalLatency / mStats.processedCount) : 0;
+
+      mLock.unlock();
+
+      return stats;
+   }
+
+
+   void resetPeakStats()
+   {
+      mLock.lock();
+
+      mStats.peakQueueDepth = mStats.queueDepth;
+      mStats.maxLatency = 0;
+      mOverloadWarningDepth = FirstOverloadWarningDepth;
+
+      mLock.unlock();
+   }
+
+
+   // For pools that are expected to be handed a big pile of work all at once
+   void disableOverloadWarnings()
+   {
+      mLock.lock();
+      mWarnOnOverload = false;
+      mLock.unlock();
+   }
+
+
+   // Returns the context of the worker we're running on, or NULL if this isn't a worker thread
+   static WorkerContext *getWorkerContext()
+   {
+      return (WorkerContext *)getWorkerStorage().get();
+   }
+
+
+   // Workers will finish everything still in the queue before they exit
    void terminate()
    {
+      mLock.lock();
+      bool wasRunning = mRunning;
       mRunning = false;
-      while(mThreadActive)
-         Platform::sleep(50);
+      mLock.unlock();
+
+      if(!wasRunning)
+         return;
+
+      mSemaphore.increment(mWorkerCount);
+
+      for(;;)
+      {
+         mLock.lock();
+         U32 activeWorkers = mActiveWorkers;
+         mLock.unlock();
+
+         if(activeWorkers == 0)
+            break;
+
+         Platform::sleep(10);
+      }
+
+      for(S32 i = 0; i < mWorkers.size(); i++)
+         delete mWorkers[i];
+
+      mWorkers.clear();
    }
 
-   ~DatabaseAccessThread()
+
+   virtual ~DatabaseAccessThread()
    {
       terminate();
+
+      // Anything left over was added after we were terminated, or never had its finish() called
+      for(U32 i = 0; i < mPending.size(); i++)
+         mPending[i]->decRef();
+
+      for(S32 i = 0; i < mFinished.size(); i++)
+         mFinished[i]->decRef();
    }
 
 };
@@ -123,4 +397,4 @@ public:
 
 }
 
-#endif
\ No newline at end of file
+#endif
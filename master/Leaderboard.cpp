@@ -0,0 +1,159 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "Leaderboard.h"
+
+#include "../zap/stringUtils.h"     // For itos
+
+#include <algorithm>
+#include <stdlib.h>
+
+using namespace Zap;
+
+namespace Master
+{
+
+typedef pair<S32, string> ScoreNamePair;
+
+// Higher scores first; ties go alphabetically so the order doesn't jump around between requests
+static bool scoreSort(const ScoreNamePair &a, const ScoreNamePair &b)
+{
+   if(a.first != b.first)
+      return a.first > b.first;
+
+   return a.second < b.second;
+}
+
+
+static bool reverseScoreSort(const ScoreNamePair &a, const ScoreNamePair &b)
+{
+   if(a.first != b.first)
+      return a.first < b.first;
+
+   return a.second < b.second;
+}
+
+
+// Constructor
+Leaderboard::Leaderboard()
+{
+   mSortOrder = HighestFirst;
+   mIsComplete = false;
+}
+
+
+// Destructor
+Leaderboard::~Leaderboard()
+{
+   // Do nothing
+}
+
+
+void Leaderboard::setSortOrder(SortOrder sortOrder)
+{
+   mSortOrder = sortOrder;
+}
+
+
+void Leaderboard::clear()
+{
+   mScores.clear();
+   mPendingScores.clear();
+   mIsComplete = false;
+}
+
+
+void Leaderboard::load(const Vector<string> &names, const Vector<string> &scores)
+{
+   clear();
+
+   for(S32 i = 0; i < names.size() && i < scores.size(); i++)
+      if(names[i] != "")      // Database readers pad their results with blanks
+         mScores[names[i]] = atoi(scores[i].c_str());
+
+   // If the snapshot came up short, we got everyone
+   mIsComplete = (S32)mScores.size() < names.size();
+}
+
+
+// Returns true if this is a player from outside our snapshot, whose score needs to be looked up before we can add to
+// it.  The lookup should read the database after the game being added has been written, so the score it finds
+// includes it.
+bool Leaderboard::addToScore(const string &name, S32 amount)
+{
+   map<string, S32>::iterator it = mScores.find(name);
+
+   if(it != mScores.end() || mIsComplete)
+   {
+      mScores[name] += amount;
+      return false;
+   }
+
+   it = mPendingScores.find(name);
+
+   if(it != mPendingScores.end())
+   {
+      it->second += amount;      // Game came in after the one doing the lookup, so it won't be in what we get back
+      return false;
+   }
+
+   mPendingScores[name] = 0;
+   return true;
+}
+
+
+void Leaderboard::setLookedUpScore(const string &name, S32 score)
+{
+   map<string, S32>::iterator it = mPendingScores.find(name);
+
+   if(it == mPendingScores.end())     // Board was reloaded while we were looking
+      return;
+
+   mScores[name] = score + it->second;
+   mPendingScores.erase(it);
+}
+
+
+S32 Leaderboard::getScore(const string &name) const
+{
+   map<string, S32>::const_iterator it = mScores.find(name);
+
+   return it == mScores.end() ? 0 : it->second;
+}
+
+
+S32 Leaderboard::getPlayerCount() const
+{
+   return (S32)mScores.size();
+}
+
+
+void Leaderboard::getTop(S32 count, Vector<string> &names, Vector<string> &scores) const
+{
+   std::vector<ScoreNamePair> sorted;
+   sorted.reserve(mScores.size());
+
+   for(map<string, S32>::const_iterator it = mScores.begin(); it != mScores.end(); it++)
+      sorted.push_back(ScoreNamePair(it->second, it->first));
+
+   S32 found = min(count, (S32)sorted.size());
+
+   partial_sort(sorted.begin(), sorted.begin() + found, sorted.end(), mSortOrder == HighestFirst ? scoreSort : reverseScoreSort);
+
+   for(S32 i = 0; i < found; i++)
+   {
+      names.push_back(sorted[i].second);
+      scores.push_back(itos(sorted[i].first));
+   }
+
+   for(S32 i = found; i < count; i++)
+   {
+      names.push_back("");
+      scores.push_back("");
+   }
+}
+
+
+}
@@ -0,0 +1,58 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _LEADERBOARD_H_
+#define _LEADERBOARD_H_
+
+#include "tnlTypes.h"
+#include "tnlVector.h"
+
+#include <map>
+#include <string>
+
+using namespace TNL;
+using namespace std;
+
+namespace Master
+{
+
+// Player scores for one high score group, kept in memory so we can answer requests without going to the database.
+// Loaded from a snapshot of the database, then kept current by adding to players' scores as their games come in.
+class Leaderboard
+{
+public:
+   enum SortOrder {
+      HighestFirst,
+      LowestFirst          // For things like ranks
+   };
+
+private:
+   map<string, S32> mScores;           // Keyed by player name
+   map<string, S32> mPendingScores;    // Players we're looking up, and what they've added since we started looking
+   SortOrder mSortOrder;
+   bool mIsComplete;                   // True if the snapshot had everyone, so anyone we don't know has a score of 0
+
+public:
+   Leaderboard();             // Constructor
+   virtual ~Leaderboard();    // Destructor
+
+   void setSortOrder(SortOrder sortOrder);
+
+   void clear();
+   void load(const Vector<string> &names, const Vector<string> &scores);    // Replaces what we have
+
+   bool addToScore(const string &name, S32 amount);
+   void setLookedUpScore(const string &name, S32 score);
+   S32 getScore(const string &name) const;
+   S32 getPlayerCount() const;
+
+   // Always fills in count entries, padding with empty strings if we don't know about that many players
+   void getTop(S32 count, Vector<string> &names, Vector<string> &scores) const;
+};
+
+
+}
+
+#endif
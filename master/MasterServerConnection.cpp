@@ -337,49 +337,77 @@ void MasterServerConnection::c2mQueryServersOption(U32 queryId, bool hostonly)
 {
    Vector<IPAddress> addresses(IP_MESSAGE_ADDRESS_COUNT);
    Vector<S32> serverIdList(IP_MESSAGE_ADDRESS_COUNT);
-   
+   Vector<MasterServerConnection *> page(IP_MESSAGE_ADDRESS_COUNT);
 
-   const Vector<MasterServerConnection *> *serverList = mMaster->getServerList();
+   const ServerDirectory *directory = mMaster->getServerDirectory();
 
-   for(S32 i = 0; i < serverList->size(); i++)
+   // Only look at servers running our version in the requested mode; the directory skips hidden servers for us.
+   // Each page holds a packet's worth of servers.
+   S32 nextIndex = 0;
+   while(nextIndex != -1)
    {
-      // Hide hidden servers
-      if(serverList->get(i)->mIsIgnoredFromList)  
-         continue;
-
-      // Skip servers with incompatible versions
-      if(serverList->get(i)->mCSProtocolVersion != mCSProtocolVersion)  
-         continue;
+      nextIndex = directory->getPage(mCSProtocolVersion, hostonly, nextIndex, IP_MESSAGE_ADDRESS_COUNT, page);
 
-      // Skip servers with host mode
-      if(((serverList->get(i)->mInfoFlags & HostModeFlag) != 0) != hostonly)
-         continue;
+      if(page.size() == 0)
+         break;
 
-      // Add us to the results list
-      addresses.push_back(serverList->get(i)->getNetAddress().toIPAddress());
-      serverIdList.push_back(serverList->get(i)->getClientId());
+      addresses.clear();
+      serverIdList.clear();
 
-      // If we get a packet's worth, send it to the client and empty our buffer...
-      if(addresses.size() == IP_MESSAGE_ADDRESS_COUNT)
+      for(S32 i = 0; i < page.size(); i++)
       {
-         sendM2cQueryServersResponse(queryId, addresses, serverIdList);
-         
-         addresses.clear();
-         serverIdList.clear();
+         addresses.push_back(page[i]->getNetAddress().toIPAddress());
+         serverIdList.push_back(page[i]->getClientId());
       }
+
+      sendM2cQueryServersResponse(queryId, addresses, serverIdList);
    }
 
-   // Send the final packet
+   // Send an empty list to signal that we're done
+   addresses.clear();
+   serverIdList.clear();
+
    sendM2cQueryServersResponse(queryId, addresses, serverIdList);
+}
 
-   // If we sent any with the previous message, send another list with no servers
-   if(addresses.size())
-   {
-      addresses.clear();
-      serverIdList.clear();
 
-      sendM2cQueryServersResponse(queryId, addresses, serverIdList);
-   }
+TNL_IMPLEMENT_RPC_OVERRIDE(MasterServerConnection, c2mSubscribeServerList, (U32 queryId, bool hostOnly))
+{
+   if(mConnectionType != MasterConnectionTypeClient)
+      return;
+
+   // Send the full list first, so the client knows which servers it should keep, then the cached status of each
+   c2mQueryServersOption(queryId, hostOnly);
+
+   const Vector<MasterServerConnection *> *servers = mMaster->getServerDirectory()->getServers(mCSProtocolVersion, hostOnly);
+
+   if(servers)
+      for(S32 i = 0; i < servers->size(); i++)
+         if(!servers->get(i)->mIsIgnoredFromList)
+            sendServerStatus(queryId, servers->get(i));
+
+   // From here on out, we'll only send changes
+   mMaster->getServerDirectory()->subscribe(this, queryId, hostOnly);
+}
+
+
+TNL_IMPLEMENT_RPC_OVERRIDE(MasterServerConnection, c2mUnsubscribeServerList, ())
+{
+   mMaster->getServerDirectory()->unsubscribe(this);
+}
+
+
+void MasterServerConnection::sendServerStatus(U32 queryId, MasterServerConnection *server)
+{
+   m2cServerStatus(queryId, server->getNetAddress().toIPAddress(), server->getClientId(), 
+                   server->mPlayerOrServerName, server->mServerDescr, server->mLevelName,
+                   server->mNumBots, server->mPlayerCount, server->mMaxPlayers, server->mInfoFlags);
+}
+
+
+void MasterServerConnection::sendServerRemoved(U32 queryId, MasterServerConnection *server)
+{
+   m2cServerRemoved(queryId, server->getClientId());
 }
 
 
@@ -745,11 +773,15 @@ TNL_IMPLEMENT_RPC_OVERRIDE(MasterServerConnection, s2mUpdateServerStatus, (Strin
       mLevelName = levelName;
       mLevelType = levelType;
 
+      U32 oldInfoFlags = mInfoFlags;
+
       mNumBots     = botCount;
       mPlayerCount = playerCount;
       mMaxPlayers  = maxPlayers;
       mInfoFlags   = infoFlags;
 
+      mMaster->getServerDirectory()->updateServer(this, oldInfoFlags);
+
       // Check to ensure we're not getting flooded with these requests
       checkActivityTime(FOUR_SECONDS);
 
@@ -792,21 +824,58 @@ void MasterServerConnection::processIsAuthenticated(GameStats *gameStats)
 }
 
 
+static const char *highScoreViews[] = {
+#  define HIGH_SCORE_GROUP(a, b, view, d, e) view,
+   HIGH_SCORE_GROUP_TABLE
+#  undef HIGH_SCORE_GROUP
+};
+
+static const char *highScoreColumns[] = {
+#  define HIGH_SCORE_GROUP(a, b, c, column, e) column,
+   HIGH_SCORE_GROUP_TABLE
+#  undef HIGH_SCORE_GROUP
+};
+
 
+// Writes a game to the database.  Players the game added to a leaderboard who weren't in our snapshot get their scores
+// read back here too, on the same connection and after the write, so the scores we get are sure to include this game.
 struct AddGameReport : public MasterThreadEntry
 {
    GameStats mStats;
+   Vector<pair<HighScores::Group, string> > mLookups;
+   Vector<S32> mScores;
 
    AddGameReport(const MasterSettings *settings) : MasterThreadEntry(settings) { }    // Quickie constructor
 
+   bool isBatchable() const { return true; }
+
    void run()
    {
       DatabaseWriter databaseWriter = getDatabaseWriter(mSettings);
       // Will fail if compiled without database support and gWriteStatsToDatabase is true
       databaseWriter.insertStats(mStats);
+
+      for(S32 i = 0; i < mLookups.size(); i++)
+      {
+         HighScores::Group group = mLookups[i].first;
+         mScores.push_back(databaseWriter.getPlayerScore(highScoreViews[group], highScoreColumns[group], mLookups[i].second));
+      }
+   }
+
+
+   void finish()
+   {
+      if(mLookups.size() == 0)
+         return;
+
+      for(S32 i = 0; i < mLookups.size(); i++)
+         MasterServerConnection::highScores.leaderboards[mLookups[i].first].setLookedUpScore(mLookups[i].second, mScores[i]);
+
+      MasterServerConnection::highScores.needsRebuild = true;
    }
 };
 
+
 void MasterServerConnection::writeStatisticsToDb(VersionedGameStats &stats)
 {
    if(!checkActivityTime(SIX_SECONDS))
@@ -829,6 +898,7 @@ void MasterServerConnection::writeStatisticsToDb(VersionedGameStats &stats)
 
    RefPtr<AddGameReport> gameReport = new AddGameReport(mMaster->getSettings());
    gameReport->mStats = *gameStats;  // copy so we keep data during a thread
+   highScores.addGameStats(gameStats, gameReport->mLookups);
    mMaster->getDatabaseAccessThread()->addEntry(gameReport);
 }
 
@@ -842,6 +912,8 @@ struct AchievementWriter : public MasterThreadEntry
 
    AchievementWriter(const MasterSettings *settings) : MasterThreadEntry(settings) { }    // Quickie constructor
 
+   bool isBatchable() const { return true; }
+
    void run()
    {
       DatabaseWriter databaseWriter = getDatabaseWriter(mSettings);
@@ -882,6 +954,8 @@ struct LevelInfoWriter : public MasterThreadEntry
 
    LevelInfoWriter(const MasterSettings *settings) : MasterThreadEntry(settings) { }    // Quickie constructor
 
+   bool isBatchable() const { return true; }
+
    void run()
    {
       DatabaseWriter databaseWriter = getDatabaseWriter(mSettings);
@@ -917,63 +991,37 @@ void MasterServerConnection::writeLevelInfoToDb(const string &hash, const string
 
 struct HighScoresReader : public MasterThreadEntry
 {
-   S32 scoresPerGroup;
+   Vector<string> names[HighScores::GroupCount];
+   Vector<string> scores[HighScores::GroupCount];
 
-   // Constructor
-   HighScoresReader(const MasterSettings *settings, S32 scoresPerGroup) : MasterThreadEntry(settings)        
-   {
-      this->scoresPerGroup = scoresPerGroup;
-   }
+   HighScoresReader(const MasterSettings *settings) : MasterThreadEntry(settings) { }    // Quickie constructor
 
+   // Runs on the database thread, so we only touch our own data here
    void run()
    {
       DatabaseWriter databaseWriter = getDatabaseWriter(mSettings);
 
-      // Client will display these in two columns, row by row
-
-      MasterServerConnection::highScores.groupNames.clear();
-      MasterServerConnection::highScores.names.clear();
-      MasterServerConnection::highScores.scores.clear();
-
-      MasterServerConnection::highScores.groupNames.push_back("Official Wins Last Week");
-      databaseWriter.getTopPlayers("v_last_week_top_player_official_wins", "win_count",  
-                                    scoresPerGroup, MasterServerConnection::highScores.names, 
-                                    MasterServerConnection::highScores.scores);
-
-      MasterServerConnection::highScores.groupNames.push_back("Official Wins This Week, So Far");
-      databaseWriter.getTopPlayers("v_current_week_top_player_official_wins", "win_count",  
-                                    scoresPerGroup, MasterServerConnection::highScores.names, 
-                                    MasterServerConnection::highScores.scores);
+      for(S32 i = 0; i < HighScores::GroupCount; i++)
+         databaseWriter.getTopPlayers(highScoreViews[i], highScoreColumns[i], HighScores::SnapshotSize, names[i], scores[i]);
+   }
 
-      MasterServerConnection::highScores.groupNames.push_back("Games Played Last Week");
-      databaseWriter.getTopPlayers("v_last_week_top_player_games", "game_count", 
-                                    scoresPerGroup, MasterServerConnection::highScores.names, 
-                                    MasterServerConnection::highScores.scores);
 
-      MasterServerConnection::highScores.groupNames.push_back("Games Played This Week, So Far");
-      databaseWriter.getTopPlayers("v_current_week_top_player_games", "game_count", 
-                                    scoresPerGroup, MasterServerConnection::highScores.names,
-                                    MasterServerConnection::highScores.scores);
+   void finish()
+   {
+      HighScores &highScores = MasterServerConnection::highScores;
 
-      MasterServerConnection::highScores.groupNames.push_back("Latest BBB Winners");
-      databaseWriter.getTopPlayers("v_latest_bbb_winners", "rank", 
-                                    scoresPerGroup, MasterServerConnection::highScores.names, 
-                                    MasterServerConnection::highScores.scores);
+      for(S32 i = 0; i < HighScores::GroupCount; i++)
+         highScores.leaderboards[i].load(names[i], scores[i]);
 
-      MasterServerConnection::highScores.scoresPerGroup = scoresPerGroup;
-   }
+      highScores.isLoaded = true;
+      highScores.isBusy = false;
+      highScores.rebuild(highScores.scoresPerGroup);
 
+      for(S32 i = 0; i < highScores.waitingClients.size(); i++)
+         if(highScores.waitingClients[i])
+            highScores.waitingClients[i]->m2cSendHighScores(highScores.groupNames, highScores.names, highScores.scores);
 
-   void finish()
-   {
-      MasterServerConnection::highScores.isBusy = false;
-
-      for(S32 i = 0; i < MasterServerConnection::highScores.waitingClients.size(); i++)
-         if(MasterServerConnection::highScores.waitingClients[i])
-            MasterServerConnection::highScores.waitingClients[i]->m2cSendHighScores(MasterServerConnection::highScores.groupNames, 
-                                                                                    MasterServerConnection::highScores.names, 
-                                                                                    MasterServerConnection::highScores.scores);
-      MasterServerConnection::highScores.waitingClients.clear();
+      highScores.waitingClients.clear();
    }
 };
 
@@ -1080,19 +1128,24 @@ struct PlayerLevelRatingsReader : public MasterThreadEntry
 ////////////////////////////////////////
 ////////////////////////////////////////
 
+// Once the leaderboards have been loaded, we'll keep serving them from memory while they're being refreshed
 HighScores *MasterServerConnection::getHighScores(S32 scoresPerGroup)
 {
    // Remember... highScores is static!
-   if(!highScores.isValid || highScores.isExpired() || scoresPerGroup != highScores.scoresPerGroup)
-      if(!highScores.isBusy)
-      {
-         highScores.isBusy = true;
-         highScores.isValid = true;
-         highScores.resetClock();
+   if((!highScores.isValid || highScores.isExpired()) && !highScores.isBusy)
+   {
+      highScores.isBusy = true;
+      highScores.isValid = true;
+      highScores.resetClock();
 
-         RefPtr<HighScoresReader> highScoreReader = new HighScoresReader(mMaster->getSettings(), scoresPerGroup);
-         mMaster->getDatabaseAccessThread()->addEntry(highScoreReader);
-      }
+      RefPtr<HighScoresReader> highScoreReader = new HighScoresReader(mMaster->getSettings());
+      mMaster->getDatabaseAccessThread()->addEntry(highScoreReader);
+   }
+
+   if(highScores.isLoaded && (highScores.needsRebuild || scoresPerGroup != highScores.scoresPerGroup))
+      highScores.rebuild(scoresPerGroup);
+
+   highScores.scoresPerGroup = scoresPerGroup;     // So a pending refresh will build the right number of scores
       
    return &highScores;
 }
@@ -1225,7 +1278,6 @@ void MasterServerConnection::removeOldEntriesFromRatingsCache()
 TNL_IMPLEMENT_RPC_OVERRIDE(MasterServerConnection, s2mSendStatistics, (VersionedGameStats stats))
 {
    writeStatisticsToDb(stats);
-   highScores.isValid = false;
 }
 
 
@@ -1261,10 +1313,10 @@ TNL_IMPLEMENT_RPC_OVERRIDE(MasterServerConnection, c2mRequestHighScores, ())
 {
    HighScores *highScoreGroup = getHighScores(3);
 
-   if(!highScoreGroup->isBusy)     // Not busy, so value must be cached.  Send the scores now.
+   if(highScoreGroup->isLoaded)     // Scores are in memory, send them now
       m2cSendHighScores(highScoreGroup->groupNames, highScoreGroup->names, highScoreGroup->scores);
 
-   else                       // In the process of retrieving... highScores will send later when retrieval is complete
+   else                             // Still loading... highScores will send later when retrieval is complete
       highScoreGroup->addClientToWaitingList(this);
 }
 
@@ -1371,7 +1423,74 @@ void LevelRating::setRatingMagicValue(S16 rating)
 }
 
 
-U32 HighScores::getCacheExpiryTime() { return TWO_HOURS; }
+// Constructor
+HighScores::HighScores()
+{
+   scoresPerGroup = 0;
+   isLoaded = false;
+   needsRebuild = false;
+
+#  define HIGH_SCORE_GROUP(enumVal, b, c, d, sortOrder) leaderboards[enumVal].setSortOrder(Leaderboard::sortOrder);
+      HIGH_SCORE_GROUP_TABLE
+#  undef HIGH_SCORE_GROUP
+}
+
+
+// Builds the lists we send to clients: all the names and scores for the first group, then the second, and so on
+void HighScores::rebuild(S32 scoresPerGroup)
+{
+   static const char *groupTitles[] = {
+#  define HIGH_SCORE_GROUP(a, title, c, d, e) title,
+      HIGH_SCORE_GROUP_TABLE
+#  undef HIGH_SCORE_GROUP
+   };
+
+   groupNames.clear();
+   names.clear();
+   scores.clear();
+
+   // Client will display these in two columns, row by row
+   for(S32 i = 0; i < GroupCount; i++)
+   {
+      groupNames.push_back(groupTitles[i]);
+      leaderboards[i].getTop(scoresPerGroup, names, scores);
+   }
+
+   this->scoresPerGroup = scoresPerGroup;
+   needsRebuild = false;
+}
+
+
+// Only authenticated humans are counted.  The database views have the final say, and will set us straight at the
+// next refresh if we've counted something differently.  Players we don't have a score for are added to lookups.
+void HighScores::addGameStats(const GameStats *gameStats, Vector<pair<Group, string> > &lookups)
+{
+   if(!isLoaded)     // Nothing to add to yet; the load will include this game
+      return;
+
+   for(S32 i = 0; i < gameStats->teamStats.size(); i++)
+   {
+      const Vector<PlayerStats> &playerStats = gameStats->teamStats[i].playerStats;
+
+      for(S32 j = 0; j < playerStats.size(); j++)
+      {
+         if(playerStats[j].isRobot || !playerStats[j].isAuthenticated)
+            continue;
+
+         if(leaderboards[GamesPlayedThisWeek].addToScore(playerStats[j].name, 1))
+            lookups.push_back(pair<Group, string>(GamesPlayedThisWeek, playerStats[j].name));
+
+         if(gameStats->isOfficial && playerStats[j].gameResult == 'W')
+            if(leaderboards[OfficialWinsThisWeek].addToScore(playerStats[j].name, 1))
+               lookups.push_back(pair<Group, string>(OfficialWinsThisWeek, playerStats[j].name));
+
+         needsRebuild = true;
+      }
+   }
+}
+
+
+U32 HighScores::getCacheExpiryTime() { return ONE_HOUR; }
 
 U32 TotalLevelRating::getCacheExpiryTime() { return TEN_MINUTES; }
 
@@ -1802,6 +1921,7 @@ TNL_IMPLEMENT_RPC_OVERRIDE(MasterServerConnection, c2mSendChat, (StringPtr messa
                if(server->getNetAddress().isEqualAddress(addr) && (addr.port == 0 || addr.port == server->getNetAddress().port))
                {
                   server->mIsIgnoredFromList = true;
+                  mMaster->getServerDirectory()->updateServerVisibility(server);
                   m2cSendChat(server->mPlayerOrServerName, true, "dropped");
                   droppedServer = true;
                }
@@ -1821,6 +1941,7 @@ TNL_IMPLEMENT_RPC_OVERRIDE(MasterServerConnection, c2mSendChat, (StringPtr messa
                {
                   broughtBackServer = true;
                   serverList->get(i)->mIsIgnoredFromList = false;
+                  mMaster->getServerDirectory()->updateServerVisibility(serverList->get(i));
                   m2cSendChat(serverList->get(i)->mPlayerOrServerName, true, "servers restored");
                }
             if(!broughtBackServer)
@@ -1955,6 +2076,7 @@ TNL_IMPLEMENT_RPC_OVERRIDE(MasterServerConnection, s2mChangeName, (StringTableEn
    {
       mPlayerOrServerName = name;
       mMaster->writeJsonNow();  // update server name in ".json"
+      mMaster->getServerDirectory()->updateServer(this, mInfoFlags);
    }
 }
 
@@ -1962,6 +2084,9 @@ TNL_IMPLEMENT_RPC_OVERRIDE(MasterServerConnection, s2mChangeName, (StringTableEn
 TNL_IMPLEMENT_RPC_OVERRIDE(MasterServerConnection, s2mServerDescription, (StringTableEntry descr))
 {
    mServerDescr = descr;
+
+   if(mConnectionType == MasterConnectionTypeServer)
+      mMaster->getServerDirectory()->updateServer(this, mInfoFlags);
 }
 
 
@@ -9,6 +9,7 @@
 
 #include "GameConnectRequest.h"
 #include "masterInterface.h"
+#include "Leaderboard.h"
 
 #include "../zap/ChatCheck.h"
 #include "../zap/Intervals.h"
@@ -48,13 +49,43 @@ public:
 };
 
 
+//                enum                  Group name                          Database view                              Score column   Best first
+#define HIGH_SCORE_GROUP_TABLE \
+   HIGH_SCORE_GROUP(OfficialWinsLastWeek, "Official Wins Last Week",         "v_last_week_top_player_official_wins",    "win_count",   HighestFirst ) \
+   HIGH_SCORE_GROUP(OfficialWinsThisWeek, "Official Wins This Week, So Far", "v_current_week_top_player_official_wins", "win_count",   HighestFirst ) \
+   HIGH_SCORE_GROUP(GamesPlayedLastWeek,  "Games Played Last Week",          "v_last_week_top_player_games",            "game_count",  HighestFirst ) \
+   HIGH_SCORE_GROUP(GamesPlayedThisWeek,  "Games Played This Week, So Far",  "v_current_week_top_player_games",         "game_count",  HighestFirst ) \
+   HIGH_SCORE_GROUP(LatestBbbWinners,     "Latest BBB Winners",              "v_latest_bbb_winners",                    "rank",        LowestFirst  ) \
+
+
+// High scores are served from in-memory leaderboards.  Those are loaded from the database views when they expire,
+// which corrects any drift and picks up the weekly rollover; in between, the "this week" boards are kept current
+// by adding in the results of each game as it's reported.
 struct HighScores : public ThreadingStruct
 {
+   enum Group {
+#  define HIGH_SCORE_GROUP(enumVal, b, c, d, e) enumVal,
+      HIGH_SCORE_GROUP_TABLE
+#  undef HIGH_SCORE_GROUP
+      GroupCount
+   };
+
+   static const S32 SnapshotSize = 100;   // Players per group loaded from the database; more than we show, to limit drift
+
    Vector<StringTableEntry> groupNames;
    Vector<string> names;
    Vector<string> scores;
    S32 scoresPerGroup;
 
+   Leaderboard leaderboards[GroupCount];
+   bool isLoaded;          // True once we've read the leaderboards from the database
+   bool needsRebuild;      // Leaderboards have changed since we last built names and scores
+
+   HighScores();           // Constructor
+
+   void rebuild(S32 scoresPerGroup);
+   void addGameStats(const Zap::GameStats *gameStats, Vector<pair<Group, string> > &lookups);
+
    U32 getCacheExpiryTime();
 };
 
@@ -206,6 +237,14 @@ public:
    TNL_DECLARE_RPC_OVERRIDE(c2mQueryHostServers, (U32 queryId));
    void c2mQueryServersOption(U32 queryId, bool hostonly);
 
+   // Like the above, but the client will continue to be sent changes to the list until it unsubscribes
+   TNL_DECLARE_RPC_OVERRIDE(c2mSubscribeServerList, (U32 queryId, bool hostOnly));
+   TNL_DECLARE_RPC_OVERRIDE(c2mUnsubscribeServerList, ());
+
+   // Helpers used by the ServerDirectory to push changes out to subscribed clients
+   void sendServerStatus(U32 queryId, MasterServerConnection *server);
+   void sendServerRemoved(U32 queryId, MasterServerConnection *server);
+
    /// checkActivityTime validates that this particular connection is
    /// not issuing too many requests at once in an attempt to DOS
    /// by flooding either the master server or any other server
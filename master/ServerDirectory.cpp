@@ -0,0 +1,224 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "ServerDirectory.h"
+
+#include "MasterServerConnection.h"
+
+#include "../zap/SharedConstants.h"    // For HostModeFlag
+
+namespace Master
+{
+
+static bool isHostMode(U32 infoFlags)
+{
+   return (infoFlags & HostModeFlag) != 0;
+}
+
+
+// Constructor
+ServerDirectory::ServerDirectory()
+{
+   // Do nothing
+}
+
+
+// Destructor
+ServerDirectory::~ServerDirectory()
+{
+   // Do nothing
+}
+
+
+ServerDirectory::ServerIndex &ServerDirectory::getIndex(bool hostOnly)
+{
+   return hostOnly ? mHostServers : mServers;
+}
+
+
+const ServerDirectory::ServerIndex &ServerDirectory::getIndex(bool hostOnly) const
+{
+   return hostOnly ? mHostServers : mServers;
+}
+
+
+void ServerDirectory::insert(MasterServerConnection *server, bool hostOnly)
+{
+   Vector<MasterServerConnection *> &bucket = getIndex(hostOnly)[server->mCSProtocolVersion];
+
+   if(!bucket.contains(server))
+      bucket.push_back(server);
+}
+
+
+void ServerDirectory::erase(MasterServerConnection *server, bool hostOnly)
+{
+   ServerIndex &index = getIndex(hostOnly);
+   ServerIndex::iterator it = index.find(server->mCSProtocolVersion);
+
+   if(it == index.end())
+      return;
+
+   S32 i = it->second.getIndex(server);
+   if(i != -1)
+      it->second.erase(i);       // Preserve order so paged queries stay stable
+
+   if(it->second.size() == 0)
+      index.erase(it);
+}
+
+
+void ServerDirectory::addServer(MasterServerConnection *server)
+{
+   bool hostOnly = isHostMode(server->mInfoFlags);
+
+   insert(server, hostOnly);
+
+   if(!server->mIsIgnoredFromList)
+      notifyStatus(server, hostOnly);
+}
+
+
+void ServerDirectory::removeServer(MasterServerConnection *server)
+{
+   bool hostOnly = isHostMode(server->mInfoFlags);
+
+   erase(server, hostOnly);
+
+   if(!server->mIsIgnoredFromList)
+      notifyRemoved(server, hostOnly);
+}
+
+
+void ServerDirectory::updateServer(MasterServerConnection *server, U32 oldInfoFlags)
+{
+   bool wasHostOnly = isHostMode(oldInfoFlags);
+   bool hostOnly    = isHostMode(server->mInfoFlags);
+
+   // Server switched between host mode and regular mode; move it to the other index
+   if(wasHostOnly != hostOnly)
+   {
+      erase(server, wasHostOnly);
+      insert(server, hostOnly);
+
+      if(!server->mIsIgnoredFromList)
+         notifyRemoved(server, wasHostOnly);
+   }
+
+   if(!server->mIsIgnoredFromList)
+      notifyStatus(server, hostOnly);
+}
+
+
+void ServerDirectory::updateServerVisibility(MasterServerConnection *server)
+{
+   bool hostOnly = isHostMode(server->mInfoFlags);
+
+   if(server->mIsIgnoredFromList)
+      notifyRemoved(server, hostOnly);
+   else
+      notifyStatus(server, hostOnly);
+}
+
+
+// Returns NULL if there are no servers with the specified version and mode
+const Vector<MasterServerConnection *> *ServerDirectory::getServers(U32 csProtocolVersion, bool hostOnly) const
+{
+   const ServerIndex &index = getIndex(hostOnly);
+   ServerIndex::const_iterator it = index.find(csProtocolVersion);
+
+   if(it == index.end())
+      return NULL;
+
+   return &it->second;
+}
+
+
+// Fills page with up to count visible servers, starting with the server at firstIndex.  Returns the index at which
+// the next page should start, or -1 if there are no more servers to be had.
+S32 ServerDirectory::getPage(U32 csProtocolVersion, bool hostOnly, S32 firstIndex, S32 count,
+                             Vector<MasterServerConnection *> &page) const
+{
+   page.clear();
+
+   const Vector<MasterServerConnection *> *servers = getServers(csProtocolVersion, hostOnly);
+
+   if(!servers)
+      return -1;
+
+   S32 i;
+   for(i = firstIndex; i < servers->size() && page.size() < count; i++)
+   {
+      if(servers->get(i)->mIsIgnoredFromList)   // Hide hidden servers
+         continue;
+
+      page.push_back(servers->get(i));
+   }
+
+   return i < servers->size() ? i : -1;
+}
+
+
+void ServerDirectory::subscribe(MasterServerConnection *client, U32 queryId, bool hostOnly)
+{
+   for(S32 i = 0; i < mSubscribers.size(); i++)
+      if(mSubscribers[i].client == client)
+      {
+         mSubscribers[i].queryId  = queryId;
+         mSubscribers[i].hostOnly = hostOnly;
+         return;
+      }
+
+   Subscriber subscriber;
+   subscriber.client   = client;
+   subscriber.queryId  = queryId;
+   subscriber.hostOnly = hostOnly;
+
+   mSubscribers.push_back(subscriber);
+}
+
+
+void ServerDirectory::unsubscribe(MasterServerConnection *client)
+{
+   for(S32 i = 0; i < mSubscribers.size(); i++)
+      if(mSubscribers[i].client == client)
+      {
+         mSubscribers.erase_fast(i);
+         return;
+      }
+}
+
+
+S32 ServerDirectory::getSubscriberCount() const
+{
+   return mSubscribers.size();
+}
+
+
+void ServerDirectory::notifyStatus(MasterServerConnection *server, bool hostOnly) const
+{
+   for(S32 i = 0; i < mSubscribers.size(); i++)
+   {
+      const Subscriber &subscriber = mSubscribers[i];
+
+      if(subscriber.hostOnly == hostOnly && subscriber.client->mCSProtocolVersion == server->mCSProtocolVersion)
+         subscriber.client->sendServerStatus(subscriber.queryId, server);
+   }
+}
+
+
+void ServerDirectory::notifyRemoved(MasterServerConnection *server, bool hostOnly) const
+{
+   for(S32 i = 0; i < mSubscribers.size(); i++)
+   {
+      const Subscriber &subscriber = mSubscribers[i];
+
+      if(subscriber.hostOnly == hostOnly && subscriber.client->mCSProtocolVersion == server->mCSProtocolVersion)
+         subscriber.client->sendServerRemoved(subscriber.queryId, server);
+   }
+}
+
+
+}
@@ -0,0 +1,74 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _SERVER_DIRECTORY_H_
+#define _SERVER_DIRECTORY_H_
+
+#include "tnlVector.h"
+
+#include <map>
+
+using namespace TNL;
+using namespace std;
+
+namespace Master
+{
+
+class MasterServerConnection;
+
+// Keeps track of all game servers connected to the master, indexed by the CS protocol version they speak and
+// whether they are running in host mode.  Clients can subscribe to a particular slice of the directory, and
+// will then be sent deltas as servers come, go, or change their status, rather than having to requery.
+class ServerDirectory
+{
+private:
+   typedef map<U32, Vector<MasterServerConnection *> > ServerIndex;     // Keyed by CS protocol version
+
+   struct Subscriber
+   {
+      MasterServerConnection *client;
+      U32 queryId;
+      bool hostOnly;
+   };
+
+   ServerIndex mServers;
+   ServerIndex mHostServers;
+   Vector<Subscriber> mSubscribers;
+
+   ServerIndex &getIndex(bool hostOnly);
+   const ServerIndex &getIndex(bool hostOnly) const;
+
+   void insert(MasterServerConnection *server, bool hostOnly);
+   void erase(MasterServerConnection *server, bool hostOnly);
+
+   void notifyStatus(MasterServerConnection *server, bool hostOnly) const;
+   void notifyRemoved(MasterServerConnection *server, bool hostOnly) const;
+
+public:
+   ServerDirectory();            // Constructor
+   virtual ~ServerDirectory();   // Destructor
+
+   void addServer(MasterServerConnection *server);
+   void removeServer(MasterServerConnection *server);
+
+   // Call after a server's status has been updated; oldInfoFlags are the flags before the update
+   void updateServer(MasterServerConnection *server, U32 oldInfoFlags);
+
+   // Call after a server has been hidden or unhidden
+   void updateServerVisibility(MasterServerConnection *server);
+
+   const Vector<MasterServerConnection *> *getServers(U32 csProtocolVersion, bool hostOnly) const;
+   S32 getPage(U32 csProtocolVersion, bool hostOnly, S32 firstIndex, S32 count,
+               Vector<MasterServerConnection *> &page) const;
+
+   void subscribe(MasterServerConnection *client, U32 queryId, bool hostOnly);
+   void unsubscribe(MasterServerConnection *client);
+   S32 getSubscriberCount() const;
+};
+
+
+}
+
+#endif
@@ -30,9 +30,8 @@ namespace DbWriter
 
 string DatabaseWriter::sqliteFile = "stats.db";
 
-   
-// TODO: Should we be reusing these?
-DatabaseWriter getDatabaseWriter(const MasterSettings *settings)
+
+static DatabaseWriter createDatabaseWriter(const MasterSettings *settings)
 {
    if(settings->getVal<YesNo>(Master::IniKey::WriteStatsToMySql))
       return DatabaseWriter(settings->getVal<string>(Master::IniKey::StatsDatabaseAddress).c_str(), 
@@ -44,6 +43,18 @@ DatabaseWriter getDatabaseWriter(const MasterSettings *settings)
 }
 
 
+// When called from a database worker, the writer we return will use that worker's connection
+DatabaseWriter getDatabaseWriter(const MasterSettings *settings)
+{
+   DatabaseWorkerContext *context = dynamic_cast<DatabaseWorkerContext *>(DatabaseAccessThread::getWorkerContext());
+
+   if(context)
+      return context->getWriter();
+
+   return createDatabaseWriter(settings);
+}
+
+
 // Default constructor -- don't use this one!
 DatabaseWriter::DatabaseWriter()
 {
@@ -65,13 +76,21 @@ DatabaseWriter::DatabaseWriter(const char *db, const char *user, const char *pas
 }
 
 
+// Each database worker makes its own writers, so this keeps two of them from both deciding to create a missing database
+static Mutex createDatabaseLock;
+
+
 // Sqlite Constructor
 DatabaseWriter::DatabaseWriter(const char *db)
 {
-   strncpy(mDb, db, sizeof(mDb) - 1);
+   initialize("", db, "", "");
+
+   createDatabaseLock.lock();
 
    if(!fileExists(mDb))
       createStatsDatabase();
+
+   createDatabaseLock.unlock();
 }
 
 
@@ -81,6 +100,27 @@ void DatabaseWriter::initialize(const char *server, const char *db, const char *
    strncpy(mDb,       db,       sizeof(mDb)       - 1);
    strncpy(mUser,     user,     sizeof(mUser)     - 1);
    strncpy(mPassword, password, sizeof(mPassword) - 1);
+
+   mServer[sizeof(mServer) - 1] = 0;
+   mDb[sizeof(mDb) - 1] = 0;
+   mUser[sizeof(mUser) - 1] = 0;
+   mPassword[sizeof(mPassword) - 1] = 0;
+}
+
+
+DbQuery &DatabaseWriter::getQuery()
+{
+   if(!mQuery || !mQuery->isValid)     // Try again if we couldn't connect last time
+      mQuery = boost::shared_ptr<DbQuery>(new DbQuery(mDb, mServer, mUser, mPassword));
+
+   return *mQuery;
+}
+
+
+bool DatabaseWriter::isSameDatabase(const DatabaseWriter &other) const
+{
+   return strcmp(mDb,       other.mDb)       == 0 && strcmp(mServer,   other.mServer)   == 0 &&
+          strcmp(mUser,     other.mUser)     == 0 && strcmp(mPassword, other.mPassword) == 0;
 }
 
 
@@ -97,121 +137,241 @@ void DatabaseWriter::initialize(const char *server, const char *db, const char *
 #endif
 
 
-static void insertStatsLoadout(const DbQuery &query, U64 playerId, const Vector<LoadoutStats> loadoutStats)
+// Database IDs never change once they've been assigned, so we can hold on to them and save ourselves a trip to the
+// database.  Shared by all writers on all threads; keys include the database, in case the INI points us somewhere else.
+class IdCache
 {
-   for(S32 i = 0; i < loadoutStats.size(); i++)
+private:
+   Mutex mLock;
+   map<string, U64> mIds;
+
+   static const U32 MaxSize = 10000;    // Crude limit on growth; we just start over when we hit it
+
+public:
+   bool get(const string &key, U64 &id)
+   {
+      mLock.lock();
+
+      map<string, U64>::iterator it = mIds.find(key);
+      bool found = (it != mIds.end());
+
+      if(found)
+         id = it->second;
+
+      mLock.unlock();
+
+      return found;
+   }
+
+
+   void put(const string &key, U64 id)
    {
-         string sql = "INSERT INTO stats_player_loadout(stats_player_id, loadout) "
-                       "VALUES(" + itos(playerId) + ", " + itos(loadoutStats[i].loadoutHash) + ");";
+      mLock.lock();
+
+      if(mIds.size() >= MaxSize)
+         mIds.clear();
+
+      mIds[key] = id;
 
-         query.runQuery(sql);
+      mLock.unlock();
    }
+};
+
+
+static IdCache serverIdCache;
+static IdCache levelIdCache;
+
+
+// Inserts rows of columnCount values each, packing several rows into each statement.  We use INSERT ... SELECT with
+// UNION ALL rather than a multi-row VALUES clause because the latter needs a newer SQLite than we can count on.
+// Statements are prepared and reused, so we use a fixed chunk size to keep the number of distinct statements small.
+// Returns false if any of the inserts failed.
+static bool insertRows(DbQuery &query, const string &insertSql, S32 columnCount, const Vector<string> &values)
+{
+   static const S32 MaxRowsPerStatement = 32;
+
+   string rowSql = "SELECT ?";
+   for(S32 i = 1; i < columnCount; i++)
+      rowSql += ", ?";
+
+   S32 rowCount = values.size() / columnCount;
+
+   for(S32 firstRow = 0; firstRow < rowCount; firstRow += MaxRowsPerStatement)
+   {
+      S32 rows = min(MaxRowsPerStatement, rowCount - firstRow);
+
+      string sql = insertSql;
+      Vector<string> params(rows * columnCount);
+
+      for(S32 i = 0; i < rows; i++)
+      {
+         sql += (i == 0 ? " " : " UNION ALL ") + rowSql;
+
+         for(S32 j = 0; j < columnCount; j++)
+            params.push_back(values[(firstRow + i) * columnCount + j]);
+      }
+
+      if(query.runQuery(sql + ";", params) == U64_MAX)
+         return false;
+   }
+
+   return true;
 }
 
 
-static void insertStatsShots(const DbQuery &query, U64 playerId, const Vector<WeaponStats> weaponStats)
+static void addLoadoutRows(U64 playerId, const Vector<LoadoutStats> &loadoutStats, Vector<string> &loadoutRows)
+{
+   for(S32 i = 0; i < loadoutStats.size(); i++)
+   {
+      loadoutRows.push_back(itos(playerId));
+      loadoutRows.push_back(itos(loadoutStats[i].loadoutHash));
+   }
+}
+
+
+static void addShotRows(U64 playerId, const Vector<WeaponStats> &weaponStats, Vector<string> &shotRows)
 {
    for(S32 i = 0; i < weaponStats.size(); i++)
    {
       if(weaponStats[i].shots > 0)
       {
-         string sql = "INSERT INTO stats_player_shots(stats_player_id, weapon, shots, shots_struck) "
-                       "VALUES(" + itos(playerId) + ", '" + WeaponInfo::getWeaponName(weaponStats[i].weaponType) + "', " + 
-                                  itos(weaponStats[i].shots) + ", " + itos(weaponStats[i].hits) + ");";
-         
-         query.runQuery(sql);
+         shotRows.push_back(itos(playerId));
+         shotRows.push_back(WeaponInfo::getWeaponName(weaponStats[i].weaponType));
+         shotRows.push_back(itos(weaponStats[i].shots));
+         shotRows.push_back(itos(weaponStats[i].hits));
       }
    }
 }
 
 
-// Inserts player and all associated weapon stats
-static U64 insertStatsPlayer(const DbQuery &query, const PlayerStats *playerStats, U64 gameId, const string &teamId)
-{
-   string sql = "INSERT INTO stats_player(stats_game_id, stats_team_id, player_name, "
-                                               "is_authenticated,               is_robot, "
-                                               "result,                         points, "
-                                               "kill_count,                     death_count, "
-                                               "suicide_count,                  switched_team_count, "
-                                               "asteroid_crashes,               flag_drops, "
-                                               "flag_pickups,                   flag_returns, "
-                                               "flag_scores,                    teleport_uses, "
-                                               "turret_kills,                   ff_kills, "
-                                               "asteroid_kills,                 turrets_engineered, "
-                                               "ffs_engineered,                 teleports_engineered, "
-                                               "distance_traveled )"                      
-                         "VALUES(" + itos(gameId) + ", " + teamId + ", '"     + sanitizeForSql(playerStats->name)           + "', " +
-                                 btos(playerStats->isAuthenticated)     + ", " + btos(playerStats->isRobot)           + ", " +
-                                 "'" + playerStats->gameResult + "'"    + ", " + itos(playerStats->points)            + ", " + 
-                                 itos(playerStats->kills)               + ", " + itos(playerStats->deaths)            + ", " +
-                                 itos(playerStats->suicides)            + ", " + itos(playerStats->switchedTeamCount) + ", " +
-                                 itos(playerStats->crashedIntoAsteroid) + ", " + itos(playerStats->flagDrop)          + ", " + 
-                                 itos(playerStats->flagPickup)          + ", " + itos(playerStats->flagReturn)        + ", " + 
-                                 itos(playerStats->flagScore)           + ", " + itos(playerStats->teleport)          + ", " + 
-                                 itos(playerStats->turretKills)         + ", " + itos(playerStats->ffKills)           + ", " + 
-                                 itos(playerStats->astKills)            + ", " + itos(playerStats->turretsEngr)       + ", " + 
-                                 itos(playerStats->ffEngr)              + ", " + itos(playerStats->telEngr)           + ", " + 
-                                 itos(playerStats->distTraveled)        + 
-                         ")";
-
-   U64 playerId = query.runQuery(sql);
-
-   insertStatsShots(query, playerId, playerStats->weaponStats);
-   insertStatsLoadout(query, playerId, playerStats->loadoutStats);
+// Per-player rows that don't need their own IDs back; these get written all at once after the players are in
+struct PlayerDetailRows
+{
+   Vector<string> shots;
+   Vector<string> loadouts;
+};
+
+
+// Inserts player, and collects associated weapon stats and loadouts for writing later.  Returns U64_MAX on failure.
+static U64 insertStatsPlayer(DbQuery &query, const PlayerStats *playerStats, U64 gameId, U64 teamId, PlayerDetailRows &details)
+{
+   static const string sql = "INSERT INTO stats_player(stats_game_id, stats_team_id, player_name, "
+                                                      "is_authenticated,               is_robot, "
+                                                      "result,                         points, "
+                                                      "kill_count,                     death_count, "
+                                                      "suicide_count,                  switched_team_count, "
+                                                      "asteroid_crashes,               flag_drops, "
+                                                      "flag_pickups,                   flag_returns, "
+                                                      "flag_scores,                    teleport_uses, "
+                                                      "turret_kills,                   ff_kills, "
+                                                      "asteroid_kills,                 turrets_engineered, "
+                                                      "ffs_engineered,                 teleports_engineered, "
+                                                      "distance_traveled ) "
+                             "VALUES(?, ?, ?,  ?, ?,  ?, ?,  ?, ?,  ?, ?,  ?, ?,  ?, ?,  ?, ?,  ?, ?,  ?, ?,  ?, ?,  ?);";
+
+   Vector<string> params(24);
+
+   params.push_back(itos(gameId));
+   params.push_back(itos(teamId));
+   params.push_back(playerStats->name);
+   params.push_back(btos(playerStats->isAuthenticated));     params.push_back(btos(playerStats->isRobot));
+   params.push_back(ctos(playerStats->gameResult));          params.push_back(itos(playerStats->points));
+   params.push_back(itos(playerStats->kills));               params.push_back(itos(playerStats->deaths));
+   params.push_back(itos(playerStats->suicides));            params.push_back(itos(playerStats->switchedTeamCount));
+   params.push_back(itos(playerStats->crashedIntoAsteroid)); params.push_back(itos(playerStats->flagDrop));
+   params.push_back(itos(playerStats->flagPickup));          params.push_back(itos(playerStats->flagReturn));
+   params.push_back(itos(playerStats->flagScore));           params.push_back(itos(playerStats->teleport));
+   params.push_back(itos(playerStats->turretKills));         params.push_back(itos(playerStats->ffKills));
+   params.push_back(itos(playerStats->astKills));            params.push_back(itos(playerStats->turretsEngr));
+   params.push_back(itos(playerStats->ffEngr));              params.push_back(itos(playerStats->telEngr));
+   params.push_back(itos(playerStats->distTraveled));
+
+   U64 playerId = query.runQuery(sql, params);
+
+   if(playerId == U64_MAX)
+      return U64_MAX;      // No player to hang the details on
+
+   addShotRows(playerId, playerStats->weaponStats, details.shots);
+   addLoadoutRows(playerId, playerStats->loadoutStats, details.loadouts);
 
    return playerId;
 }
 
 
-// Inserts stats of team and all players
-static U64 insertStatsTeam(const DbQuery &query, const TeamStats *teamStats, U64 &gameId)
+// Inserts stats of team and all players.  Returns U64_MAX if the team or any of its players couldn't be written.
+static U64 insertStatsTeam(DbQuery &query, const TeamStats *teamStats, U64 gameId, PlayerDetailRows &details)
 {
-   string sql = "INSERT INTO stats_team(stats_game_id, team_name, team_score, result, color_hex) "
-                "VALUES(" + itos(gameId) + ", '" + sanitizeForSql(teamStats->name) + "', " + itos(teamStats->score) + " ,'" + 
-                ctos(teamStats->gameResult) + "' ,'" + teamStats->hexColor + "');";
+   static const string sql = "INSERT INTO stats_team(stats_game_id, team_name, team_score, result, color_hex) "
+                             "VALUES(?, ?, ?, ?, ?);";
+
+   Vector<string> params(5);
+
+   params.push_back(itos(gameId));
+   params.push_back(teamStats->name);
+   params.push_back(itos(teamStats->score));
+   params.push_back(ctos(teamStats->gameResult));
+   params.push_back(teamStats->hexColor);
 
-   U64 teamId = query.runQuery(sql);
+   U64 teamId = query.runQuery(sql, params);
+
+   if(teamId == U64_MAX)
+      return U64_MAX;
 
    for(S32 i = 0; i < teamStats->playerStats.size(); i++)
-      insertStatsPlayer(query, &teamStats->playerStats[i], gameId, itos(teamId));
+      if(insertStatsPlayer(query, &teamStats->playerStats[i], gameId, teamId, details) == U64_MAX)
+         return U64_MAX;
 
    return teamId;
 }
 
 
-static U64 insertStatsGame(const DbQuery &query, const GameStats *gameStats, U64 serverId)
+// Inserts the game along with all its teams, players, and their details.  Returns U64_MAX if any part failed.
+static U64 insertStatsGame(DbQuery &query, const GameStats *gameStats, U64 serverId)
 {
-   string sql = "INSERT INTO stats_game(server_id, game_type, is_official, player_count, "
-                                       "duration_seconds, level_name, is_team_game, team_count) "
-                "VALUES( " + itos(serverId) + ", '" + gameStats->gameType + "', " + btos(gameStats->isOfficial) + ", " + 
-                             itos(gameStats->playerCount) + ", " + itos(gameStats->duration) + ", '" + 
-                             sanitizeForSql(gameStats->levelName) + "', " + btos(gameStats->isTeamGame) + ", " + 
-                             itos(gameStats->teamStats.size())  + ");";
+   static const string sql = "INSERT INTO stats_game(server_id, game_type, is_official, player_count, "
+                                                    "duration_seconds, level_name, is_team_game, team_count) "
+                             "VALUES(?, ?, ?, ?, ?, ?, ?, ?);";
+
+   Vector<string> params(8);
+
+   params.push_back(itos(serverId));
+   params.push_back(gameStats->gameType);
+   params.push_back(btos(gameStats->isOfficial));
+   params.push_back(itos(gameStats->playerCount));
+   params.push_back(itos(gameStats->duration));
+   params.push_back(gameStats->levelName);
+   params.push_back(btos(gameStats->isTeamGame));
+   params.push_back(itos(gameStats->teamStats.size()));
 
-   U64 gameId = query.runQuery(sql);
+   U64 gameId = query.runQuery(sql, params);
+
+   if(gameId == U64_MAX)
+      return U64_MAX;
+
+   PlayerDetailRows details;
 
    for(S32 i = 0; i < gameStats->teamStats.size(); i++)
-      insertStatsTeam(query, &gameStats->teamStats[i], gameId);
+      if(insertStatsTeam(query, &gameStats->teamStats[i], gameId, details) == U64_MAX)
+         return U64_MAX;
+
+   if(!insertRows(query, "INSERT INTO stats_player_shots(stats_player_id, weapon, shots, shots_struck)", 4, details.shots) ||
+      !insertRows(query, "INSERT INTO stats_player_loadout(stats_player_id, loadout)",                 2, details.loadouts))
+      return U64_MAX;
 
    return gameId;
 }
 
 
-static U64 insertStatsServer(const DbQuery &query, const string &serverName, const string &serverIP)
+static U64 insertStatsServer(DbQuery &query, const string &serverName, const string &serverIP)
 {
-   string sql = "INSERT INTO server(server_name, ip_address) "
-                "VALUES('" + sanitizeForSql(serverName) + "', '" + serverIP + "');";
+   static const string sql = "INSERT INTO server(server_name, ip_address) VALUES(?, ?);";
 
-   if(query.query)
-     return query.runQuery(sql);
+   Vector<string> params(2);
 
-   if(query.sqliteDb)
-   {
-      query.runQuery(sql);
-      return sqlite3_last_insert_rowid(query.sqliteDb);
-   }
+   params.push_back(serverName);
+   params.push_back(serverIP);
 
-   return U64_MAX;
+   return query.runQuery(sql, params);
 }
 
 
@@ -233,73 +393,83 @@ S32 DatabaseWriter::getServerIdFromDatabase(const DbQuery &query, const string &
 }
 
 
-void DatabaseWriter::addToServerCache(U64 id, const string &serverName, const string &serverIP)
+string DatabaseWriter::getCacheKey(const string &key) const
 {
-   // Limit cache growth
-   static const S32 SERVER_CACHE_SIZE = 20;
-
-   if(cachedServers.size() >= SERVER_CACHE_SIZE) 
-      cachedServers.erase(0);
-
-   cachedServers.push_back(ServerInfo(id, serverName, serverIP));
+   return string(mServer) + "/" + mDb + "/" + key;
 }
 
 
 // Get the serverID given its name and IP.  First we'll check our cache to see if this is a known server; if we can't find
-// it there, we'll go to the database to retrieve it.
-U64 DatabaseWriter::getServerID(const DbQuery &query, const string &serverName, const string &serverIP)
+// it there, we'll go to the database to retrieve it.  Server IDs should be unique for a given pair of server name and IP.
+U64 DatabaseWriter::getServerID(DbQuery &query, const string &serverName, const string &serverIP)
 {
-   U64 serverId = getServerIDFromCache(serverName, serverIP);
+   string cacheKey = getCacheKey(serverIP + "/" + serverName);
 
-   if(serverId == U64_MAX)      // Not found in cache, check database
-   {
-      serverId = getServerIdFromDatabase(query, serverName, serverIP);
+   U64 serverId;
+   if(serverIdCache.get(cacheKey, serverId))
+      return serverId;
 
-      if(serverId == U64_MAX)   // Not found in database, add to database
-         serverId = insertStatsServer(query, serverName, serverIP);
+   serverId = getServerIdFromDatabase(query, serverName, serverIP);
 
-      // Save server info to cache for future use
-      addToServerCache(serverId, serverName, serverIP);     
-   }
+   if(serverId == U64_MAX)   // Not found in database, add to database
+      serverId = insertStatsServer(query, serverName, serverIP);
+
+   // Save server info to cache for future use
+   if(serverId != U64_MAX)
+      serverIdCache.put(cacheKey, serverId);
 
    return serverId;
 }
 
 
-// We can save a little wear-and-tear on the database by caching recent server IDs rather than retrieving them from
-// the database each time we need to find one.  Server IDs should be unique for a given pair of server name and IP address.
-U64 DatabaseWriter::getServerIDFromCache(const string &serverName, const string &serverIP)
+// Writes the whole game in one transaction; if we're already in one (because the game is part of a batch), the game
+// gets a savepoint inside it.  Either way, a game that can't be written completely isn't written at all.
+void DatabaseWriter::insertStats(const GameStats &gameStats) 
 {
-   for(S32 i = cachedServers.size() - 1; i >= 0; i--)    // Counting backwards to visit newest servers first
-      if(cachedServers[i].ip == serverIP && cachedServers[i].name == serverName)
-         return cachedServers[i].id;
+   DbQuery &query = getQuery();
 
-   return U64_MAX;
-}
+   if(!query.isValid)
+      return;
 
-
-void DatabaseWriter::insertStats(const GameStats &gameStats) 
-{
-   DbQuery query(mDb, mServer, mUser, mPassword);
+   U64 gameId = U64_MAX;
+   bool inTransaction = false;
 
    try
    {
-      if(query.isValid)
+      // Look up the server outside the game's transaction, so rolling back the game can't leave a cached server id
+      // pointing at a row that was never written
+      U64 serverId = getServerID(query, gameStats.serverName, gameStats.serverIP);
+
+      if(serverId != U64_MAX)
       {
-         U64 serverId = getServerID(query, gameStats.serverName, gameStats.serverIP);
-         insertStatsGame(query, &gameStats, serverId);
+         query.beginTransaction();
+         inTransaction = true;
+
+         gameId = insertStatsGame(query, &gameStats, serverId);
       }
    }
    catch(const Exception &ex) 
    {
       logprintf("[%s] Failure writing stats to database: %s", getTimeStamp().c_str(), ex.what());
    }
+
+   if(inTransaction)
+   {
+      if(gameId != U64_MAX)
+         query.commitTransaction();
+      else
+         query.rollbackTransaction();
+   }
+
+   if(gameId == U64_MAX)
+      logprintf("[%s] Stats for game on %s (%s) were not saved", getTimeStamp().c_str(), gameStats.levelName.c_str(),
+                                                                  gameStats.serverName.c_str());
 }
 
 
 void DatabaseWriter::insertAchievement(U8 achievementId, const StringTableEntry &playerNick, const string &serverName, const string &serverIP) 
 {
-   DbQuery query(mDb, mServer, mUser, mPassword);
+   DbQuery &query = getQuery();
 
    try
    {
@@ -307,11 +477,16 @@ void DatabaseWriter::insertAchievement(U8 achievementId, const StringTableEntry
       {
          U64 serverId = getServerID(query, serverName, serverIP);
 
-         string sql = "INSERT INTO player_achievements(player_name, achievement_id, server_id) "
-                      "VALUES( '" + sanitizeForSql(playerNick.getString()) + "', "
-                              "'" + itos(achievementId) + "', " + itos(serverId) + ");";
+         static const string sql = "INSERT INTO player_achievements(player_name, achievement_id, server_id) "
+                                   "VALUES(?, ?, ?);";
+
+         Vector<string> params(3);
+
+         params.push_back(playerNick.getString());
+         params.push_back(itos(achievementId));
+         params.push_back(itos(serverId));
 
-         query.runQuery(sql);
+         query.runQuery(sql, params);
       }
    }
    catch(const Exception &ex) 
@@ -324,7 +499,7 @@ void DatabaseWriter::insertAchievement(U8 achievementId, const StringTableEntry
 void DatabaseWriter::insertLevelInfo(const string &hash, const string &levelName, const string &creator, 
                                      const string &gameType, bool hasLevelGen, U8 teamCount, S32 winningScore, S32 gameDurationInSeconds)
 {
-   DbQuery query(mDb, mServer, mUser, mPassword);
+   DbQuery &query = getQuery();
 
    try
    {
@@ -335,25 +510,45 @@ void DatabaseWriter::insertLevelInfo(const string &hash, const string &levelName
       if(hash.length() != 32)
          return;
 
-      string sql;
+      // Levels get reported every time they're played, but we only need to record them once
+      string cacheKey = getCacheKey(hash);
+      U64 levelId;
+
+      if(levelIdCache.get(cacheKey, levelId))
+         return;
 
-      // We only want to insert a record of this server if the hash does not yet exist
-      sql = "SELECT hash FROM stats_level WHERE hash = '" + sanitizeForSql(hash) + "' LIMIT 1;";
+      // We only want to insert a record of this level if the hash does not yet exist
+      string sql = "SELECT hash FROM stats_level WHERE hash = '" + sanitizeForSql(hash) + "' LIMIT 1;";
 
       Vector<Vector<string> > results;
       selectHandler(sql, 1, results);
 
       bool found = (results.size() == 1 && results[0].size() == 1);
 
-      if(!found) 
+      if(found)
+         levelId = 0;      // We don't know the ID, but all we really care about is that the level is there
+      else
       {
-         sql = "INSERT INTO stats_level(hash, level_name, creator, game_type, has_levelgen, team_count, winning_score, game_duration) "
-               "VALUES('" + sanitizeForSql(hash)      + "', '" + sanitizeForSql(levelName)         + "', " + 
-                      "'" + sanitizeForSql(creator)   + "', '" + sanitizeForSql(gameType)          + "', " +
-                      "'" + btos(hasLevelGen)   + "', '" + itos(teamCount)             + "', " + 
-                      "'" + itos(winningScore)  + "', '" + itos(gameDurationInSeconds) + "');";
-         query.runQuery(sql);
+         static const string insertSql = 
+               "INSERT INTO stats_level(hash, level_name, creator, game_type, has_levelgen, team_count, winning_score, game_duration) "
+               "VALUES(?, ?, ?, ?, ?, ?, ?, ?);";
+
+         Vector<string> params(8);
+
+         params.push_back(hash);
+         params.push_back(levelName);
+         params.push_back(creator);
+         params.push_back(gameType);
+         params.push_back(btos(hasLevelGen));
+         params.push_back(itos(teamCount));
+         params.push_back(itos(winningScore));
+         params.push_back(itos(gameDurationInSeconds));
+
+         levelId = query.runQuery(insertSql, params);
       }
+
+      if(levelId != U64_MAX)
+         levelIdCache.put(cacheKey, levelId);
    }
    catch(const Exception &ex) 
    {
@@ -387,6 +582,23 @@ void DatabaseWriter::getTopPlayers(const string &table, const string &col2, S32
 }
 
 
+// Returns 0 if the player isn't in the table
+S32 DatabaseWriter::getPlayerScore(const string &table, const string &col2, const string &playerName)
+{
+   string sql = "SELECT " + col2 + " FROM " + table + " " +
+                "WHERE player_name = '" + sanitizeForSql(playerName) + "' LIMIT 1;";
+
+   Vector<Vector<string> > results(1);
+
+   selectHandler(sql, 1, results);
+
+   if(results.size() == 0)
+      return 0;
+
+   return atoi(results[0][0].c_str());
+}
+
+
 string DatabaseWriter::getGameJoltTrophyId(S32 achievementId) 
 {
    string sql = "SELECT gamejolt_id FROM achievements WHERE id = " + itos(achievementId);
@@ -516,7 +728,7 @@ U16 DatabaseWriter::getGamesPlayed(const char *name)
 
 void DatabaseWriter::selectHandler(const string &sql, S32 cols, Vector<Vector<string> > &values)
 {
-   DbQuery query(mDb, mServer, mUser, mPassword);
+   const DbQuery &query = getQuery();
 
    try
    {
@@ -548,12 +760,12 @@ void DatabaseWriter::selectHandler(const string &sql, S32 cols, Vector<Vector<st
          sqlite3_get_table(query.sqliteDb, sql.c_str(), &results, &rows, &cols, &err);
 
          // results[0]...results[cols] contain the col headers ==> http://www.sqlite.org/c3ref/free_table.html
-         for(S32 i = 0; i < rows * cols; i += cols)
+         for(S32 i = 0; i < rows; i++)
          {
             values.push_back(Vector<string>());     // Add another row
 
             for(S32 j = 0; j < cols; j++)
-               values[i].push_back(results[cols + i + j]);
+               values.last().push_back(results[cols + i * cols + j] ? results[cols + i * cols + j] : "");
          }
 
          sqlite3_free_table(results);
@@ -590,6 +802,18 @@ void DatabaseWriter::createStatsDatabase()
 }
 
 
+void DatabaseWriter::beginTransaction()
+{
+   getQuery().beginTransaction();
+}
+
+
+void DatabaseWriter::commitTransaction()
+{
+   getQuery().commitTransaction();
+}
+
+
 void DatabaseWriter::setDumpSql(bool dump)
 {
    DbQuery::dumpSql = dump;
@@ -607,6 +831,7 @@ DbQuery::DbQuery(const char *db, const char *server, const char *user, const cha
    query = NULL;
    sqliteDb = NULL;
    isValid = true;
+   mTransactionDepth = 0;
 
    TNLAssert(db && db[0] != 0, "must have a database");
 
@@ -634,13 +859,24 @@ DbQuery::DbQuery(const char *db, const char *server, const char *user, const cha
       {
          logprintf("ERROR: Can't open stats database %s: %s", db, sqlite3_errmsg(sqliteDb));
          sqlite3_close(sqliteDb);
+         sqliteDb = NULL;
          isValid = false;
       }
+      else
+         sqlite3_busy_timeout(sqliteDb, 5000);     // Other workers may be holding a write lock; wait for them
 }
 
 // Destructor
 DbQuery::~DbQuery()
 {
+   for(map<string, sqlite3_stmt *>::iterator it = mStatements.begin(); it != mStatements.end(); it++)
+      sqlite3_finalize(it->second);
+
+#ifdef BF_WRITE_TO_MYSQL
+   for(map<string, Query *>::iterator it = mTemplateQueries.begin(); it != mTemplateQueries.end(); it++)
+      delete it->second;
+#endif
+
    if(query)
       delete query;
 
@@ -672,8 +908,11 @@ U64 DbQuery::runQuery(const string &sql) const
       sqlite3_exec(sqliteDb, sql.c_str(), NULL, 0, &err);
 
       if(err)
+      {
          logprintf("Database error accessing sqlite databse: %s", err);
-
+         sqlite3_free(err);
+         return U64_MAX;
+      }
 
       return sqlite3_last_insert_rowid(sqliteDb);  
    }
@@ -682,6 +921,267 @@ U64 DbQuery::runQuery(const string &sql) const
 }
 
 
+sqlite3_stmt *DbQuery::getStatement(const string &sql)
+{
+   map<string, sqlite3_stmt *>::iterator it = mStatements.find(sql);
+
+   if(it != mStatements.end())
+      return it->second;
+
+   sqlite3_stmt *statement = NULL;
+
+   if(sqlite3_prepare_v2(sqliteDb, sql.c_str(), -1, &statement, NULL) != SQLITE_OK)
+   {
+      logprintf("Database error preparing sqlite statement: %s", sqlite3_errmsg(sqliteDb));
+      sqlite3_finalize(statement);
+      return NULL;
+   }
+
+   mStatements[sql] = statement;
+   return statement;
+}
+
+
+#ifdef BF_WRITE_TO_MYSQL
+// Converts our ? placeholders to the numbered, quoted ones that mysql++ template queries want
+Query *DbQuery::getTemplateQuery(const string &sql)
+{
+   map<string, Query *>::iterator it = mTemplateQueries.find(sql);
+
+   if(it != mTemplateQueries.end())
+      return it->second;
+
+   string templateSql;
+   S32 paramCount = 0;
+
+   for(U32 i = 0; i < sql.length(); i++)
+   {
+      if(sql[i] == '?')
+         templateSql += "%" + itos(paramCount++) + "q";
+      else if(sql[i] == '%')
+         templateSql += "%%";
+      else
+         templateSql += sql[i];
+   }
+
+   Query *templateQuery = new Query(&conn);
+   *templateQuery << templateSql;
+   templateQuery->parse();
+
+   mTemplateQueries[sql] = templateQuery;
+   return templateQuery;
+}
+#endif
+
+
+// Run the passed query, substituting params for the ? placeholders in sql.  The statement is prepared the first time
+// we see it, and reused after that, so sql should not be built on the fly.  Params don't need to be sanitized.
+// Throws exceptions, like the other runQuery(); SQLite failures return U64_MAX instead.
+U64 DbQuery::runQuery(const string &sql, const Vector<string> &params)
+{
+   if(!isValid)
+      return U64_MAX;
+
+   if(dumpSql)
+      logprintf("SQL: %s (%d params)", sql.c_str(), params.size());
+
+   if(query)
+   {
+      // Should only get here when mysql has been compiled in
+#ifdef BF_WRITE_TO_MYSQL
+      Query *templateQuery = getTemplateQuery(sql);
+
+      SQLQueryParms queryParams;
+      for(S32 i = 0; i < params.size(); i++)
+         queryParams << params[i];
+
+      return templateQuery->execute(queryParams).insert_id();
+#else
+      throw std::exception();    // Should be impossible
+#endif
+   }
+
+   if(sqliteDb)
+   {
+      sqlite3_stmt *statement = getStatement(sql);
+
+      if(!statement)
+         return U64_MAX;
+
+      // Column affinity takes care of turning numbers passed as text into numbers
+      for(S32 i = 0; i < params.size(); i++)
+         sqlite3_bind_text(statement, i + 1, params[i].c_str(), (S32)params[i].length(), SQLITE_TRANSIENT);
+
+      S32 result = sqlite3_step(statement);
+      bool failed = (result != SQLITE_DONE && result != SQLITE_ROW);
+
+      if(failed)
+         logprintf("Database error accessing sqlite databse: %s", sqlite3_errmsg(sqliteDb));
+
+      sqlite3_reset(statement);
+      sqlite3_clear_bindings(statement);
+
+      if(failed)
+         return U64_MAX;
+
+      return sqlite3_last_insert_rowid(sqliteDb);
+   }
+
+   return U64_MAX;
+}
+
+
+static string getSavepointName(S32 depth)
+{
+   return "bf_savepoint_" + itos(depth);
+}
+
+
+// Transactions can be nested; only the outermost begin and commit go to the database, and inner ones become
+// savepoints.  That lets the game stats writer use a transaction for each game, and back out a game that fails, while
+// still joining any bigger transaction a database worker has going.  IMMEDIATE takes SQLite's write lock up front, so
+// two workers can't deadlock trying to upgrade their read locks.
+void DbQuery::beginTransaction()
+{
+   mTransactionDepth++;
+
+   try
+   {
+      if(mTransactionDepth > 1)
+         runQuery("SAVEPOINT " + getSavepointName(mTransactionDepth) + ";");
+      else
+         runQuery(query ? "START TRANSACTION;" : "BEGIN IMMEDIATE;");
+   }
+   catch(const Exception &ex) 
+   {
+      logprintf("[%s] Failure starting database transaction: %s", getTimeStamp().c_str(), ex.what());
+   }
+}
+
+
+void DbQuery::commitTransaction()
+{
+   TNLAssert(mTransactionDepth > 0, "Unbalanced commit!");
+
+   mTransactionDepth--;
+
+   try
+   {
+      if(mTransactionDepth > 0)
+         runQuery("RELEASE SAVEPOINT " + getSavepointName(mTransactionDepth + 1) + ";");
+      else
+         runQuery("COMMIT;");
+   }
+   catch(const Exception &ex) 
+   {
+      logprintf("[%s] Failure committing database transaction: %s", getTimeStamp().c_str(), ex.what());
+   }
+}
+
+
+// Undoes everything since the matching beginTransaction(), leaving any enclosing transaction intact
+void DbQuery::rollbackTransaction()
+{
+   TNLAssert(mTransactionDepth > 0, "Unbalanced rollback!");
+
+   mTransactionDepth--;
+
+   try
+   {
+      if(mTransactionDepth > 0)
+      {
+         // SQLite keeps the savepoint open after rolling back to it, so release it too
+         string savepoint = getSavepointName(mTransactionDepth + 1);
+         runQuery("ROLLBACK TO SAVEPOINT " + savepoint + ";");
+         runQuery("RELEASE SAVEPOINT " + savepoint + ";");
+      }
+      else
+         runQuery("ROLLBACK;");
+   }
+   catch(const Exception &ex) 
+   {
+      logprintf("[%s] Failure rolling back database transaction: %s", getTimeStamp().c_str(), ex.what());
+   }
+}
+
+
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Constructor
+DatabaseWorkerContext::DatabaseWorkerContext(const MasterSettings *settings)
+{
+   mSettings = settings;
+   mHasWriter = false;
+   mInTransaction = false;
+}
+
+
+// Destructor
+DatabaseWorkerContext::~DatabaseWorkerContext()
+{
+   if(mInTransaction)
+      mWriter.commitTransaction();
+}
+
+
+// Keeps returning the same writer, and thus the same connection, unless the database settings have changed
+const DatabaseWriter &DatabaseWorkerContext::getWriter()
+{
+   if(mInTransaction)
+      return mWriter;
+
+   DatabaseWriter writer = createDatabaseWriter(mSettings);
+
+   if(!mHasWriter || !mWriter.isSameDatabase(writer))
+   {
+      mWriter = writer;
+      mHasWriter = true;
+   }
+
+   return mWriter;
+}
+
+
+void DatabaseWorkerContext::beginBatch()
+{
+   getWriter();
+   mWriter.beginTransaction();
+   mInTransaction = true;
+}
+
+
+void DatabaseWorkerContext::endBatch()
+{
+   mWriter.commitTransaction();
+   mInTransaction = false;
+}
+
+
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Constructor
+DatabaseWriterThread::DatabaseWriterThread(const MasterSettings *settings, U32 workerCount, U32 maxBatchSize) :
+   DatabaseAccessThread(workerCount, maxBatchSize)
+{
+   mSettings = settings;
+}
+
+
+// Destructor
+DatabaseWriterThread::~DatabaseWriterThread()
+{
+   terminate();      // Workers call createWorkerContext(), so they must be stopped before we go away
+}
+
+
+WorkerContext *DatabaseWriterThread::createWorkerContext()
+{
+   return new DatabaseWorkerContext(mSettings);
+}
+
+
 ////////////////////////////////////////
 ////////////////////////////////////////
 
@@ -12,11 +12,16 @@
 #include "../zap/gameStats.h"
 #include "../zap/SharedConstants.h"
 
+#include "DatabaseAccessThread.h"
+
 #include "tnlTypes.h"
 #include "tnlVector.h"
 #include "tnlNonce.h"
 #include <sqlite3.h>
 #include <string>
+#include <map>
+
+#include <boost/shared_ptr.hpp>
 
 
 #ifdef BF_WRITE_TO_MYSQL
@@ -41,31 +46,20 @@ namespace Master {
 namespace DbWriter
 {
 
-struct ServerInfo
-{
-   U64 id;
-   string name;
-   string ip;
-
-   // Quickie constructor
-   ServerInfo(U64 id, const string name, const string &ip) 
-   { 
-      this->id = id; 
-      this->name = name; 
-      this->ip = ip;
-   }
-};
-
-
-////////////////////////////////////////
-////////////////////////////////////////
-
 class DbQuery
 {
 #ifdef BF_WRITE_TO_MYSQL
    Connection conn;
+   map<string, Query *> mTemplateQueries;       // Keyed by the sql they were built from
+
+   Query *getTemplateQuery(const string &sql);
 #endif
 
+   map<string, sqlite3_stmt *> mStatements;     // Keyed by the sql they were prepared from
+   S32 mTransactionDepth;
+
+   sqlite3_stmt *getStatement(const string &sql);
+
 public:
    Query *query;
    sqlite3 *sqliteDb;
@@ -77,6 +71,11 @@ public:
    ~DbQuery();                      // Destructor
 
    U64 runQuery(const string &sql) const;
+   U64 runQuery(const string &sql, const Vector<string> &params);
+
+   void beginTransaction();
+   void commitTransaction();
+   void rollbackTransaction();
 };
 
 
@@ -91,18 +90,18 @@ private:
    char mDb[64];
    char mUser[64];
    char mPassword[64];
-   Vector<ServerInfo> cachedServers;
+   boost::shared_ptr<DbQuery> mQuery;     // Opened on first use, then shared by all copies of this writer
 
    S32 lastGameID;
 
+   DbQuery &getQuery();
+
    void initialize(const char *server, const char *db, const char *user, const char *password);
    void createStatsDatabase();
    string getSqliteSchema();
 
-   U64 getServerID(const DbQuery &query, const string &serverName, const string &serverIP);
-
-   void addToServerCache(U64 id, const string &serverName, const string &serverIPAddr);         // Add database ID to our cache
-   U64 getServerIDFromCache(const string &serverName, const string &serverIPAddr);              // And get it back out again
+   U64 getServerID(DbQuery &query, const string &serverName, const string &serverIP);
+   string getCacheKey(const string &key) const;
 
    S32 getServerIdFromDatabase(const DbQuery &query, const string &serverName, const string &serverIP);
 
@@ -122,12 +121,18 @@ public:
 
    void setDumpSql(bool dump);
 
+   bool isSameDatabase(const DatabaseWriter &other) const;
+
+   void beginTransaction();
+   void commitTransaction();
+
    void insertStats(const GameStats &gameStats);
    void insertAchievement(U8 achievementId, const StringTableEntry &playerNick, const string &serverName, const string &serverIP);
    void insertLevelInfo(const string &hash, const string &levelName, const string &creator, 
                         const string &gameType, bool hasLevelGen, U8 teamCount, S32 winningScore, S32 gameDurationInSeconds);
 
    void getTopPlayers(const string &table, const string &col2, S32 count, Vector<string> &names, Vector<string> &scores);
+   S32 getPlayerScore(const string &table, const string &col2, const string &playerName);
 
    // GameJolt support queries
    string getGameJoltTrophyId(S32 achievementId);
@@ -143,6 +148,44 @@ public:
 
 DatabaseWriter getDatabaseWriter(const Master::MasterSettings *settings);
 
+
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Gives each database worker its own connection, which is held open for the life of the worker
+class DatabaseWorkerContext : public Master::WorkerContext
+{
+private:
+   const Master::MasterSettings *mSettings;
+   DatabaseWriter mWriter;
+   bool mHasWriter;
+   bool mInTransaction;
+
+public:
+   DatabaseWorkerContext(const Master::MasterSettings *settings);    // Constructor
+   virtual ~DatabaseWorkerContext();                                 // Destructor
+
+   const DatabaseWriter &getWriter();
+
+   void beginBatch();
+   void endBatch();
+};
+
+
+// The master's pool of database workers
+class DatabaseWriterThread : public Master::DatabaseAccessThread
+{
+private:
+   const Master::MasterSettings *mSettings;
+
+protected:
+   Master::WorkerContext *createWorkerContext();
+
+public:
+   DatabaseWriterThread(const Master::MasterSettings *settings, U32 workerCount, U32 maxBatchSize);   // Constructor
+   virtual ~DatabaseWriterThread();                                                                  // Destructor
+};
+
 }
 
 
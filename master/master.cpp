@@ -169,7 +169,9 @@ MasterServer::MasterServer(MasterSettings *settings)
 
    mLastMotd = mSettings->getMotd();            // When this changes, we'll broadcast a new MOTD to clients
    
-   mDatabaseAccessThread = new DatabaseAccessThread();    // Deleted in destructor
+   mDatabaseAccessThread = new DbWriter::DatabaseWriterThread(mSettings,                                          // Deleted in destructor
+                                                              mSettings->getVal<U32>(IniKey::DatabaseWorkerThreads),
+                                                              mSettings->getVal<U32>(IniKey::DatabaseBatchSize));
 
    MasterServerConnection::setMasterServer(this);
 
@@ -244,9 +246,16 @@ const Vector<MasterServerConnection *> *MasterServer::getClientList() const
 }
 
 
+ServerDirectory *MasterServer::getServerDirectory()
+{
+   return &mServerDirectory;
+}
+
+
 void MasterServer::addServer(MasterServerConnection *server)
 {
    mServerList.push_back(server);
+   mServerDirectory.addServer(server);
 }
 
 
@@ -259,6 +268,7 @@ void MasterServer::addClient(MasterServerConnection *client)
 void MasterServer::removeServer(S32 index)
 {
    TNLAssert(index >= 0 && index < mServerList.size(), "Index out of range!");
+   mServerDirectory.removeServer(mServerList[index]);
    mServerList.erase_fast(index);
 }
 
@@ -266,6 +276,7 @@ void MasterServer::removeServer(S32 index)
 void MasterServer::removeClient(S32 index)
 {
    TNLAssert(index >= 0 && index < mClientList.size(), "Index out of range!");
+   mServerDirectory.unsubscribe(mClientList[index]);
    mClientList.erase_fast(index);
 }
 
@@ -305,6 +316,7 @@ void MasterServer::idle(const U32 timeDelta)
    if(mCleanupTimer.update(timeDelta))
    {
       MasterServerConnection::removeOldEntriesFromRatingsCache();    //<== need non-static access
+      logDatabaseStats();
       mCleanupTimer.reset();
    }
 
@@ -401,6 +413,18 @@ void MasterServer::broadcastMotd() const
 }
 
 
+void MasterServer::logDatabaseStats()
+{
+   DatabaseAccessThread::Stats stats = mDatabaseAccessThread->getStats();
+
+   logprintf("[%s] Database queue: %d waiting, %d peak, %d processed, %d batches, latency %dms avg, %dms max", 
+             getTimeStamp().c_str(), stats.queueDepth, stats.peakQueueDepth, stats.processedCount, stats.batchCount,
+             stats.averageLatency, stats.maxLatency);
+
+   mDatabaseAccessThread->resetPeakStats();
+}
+
+
 DatabaseAccessThread *MasterServer::getDatabaseAccessThread()
 {
    return mDatabaseAccessThread;
@@ -6,6 +6,7 @@
 #include "masterInterface.h"
 
 #include "MasterServerConnection.h"
+#include "ServerDirectory.h"
 
 #include "../zap/IniFile.h"
 
@@ -45,6 +46,8 @@ using namespace Zap;
    SETTINGS_ITEM(string,    StatsDatabaseName,          "stats",    "stats_database_name",                  "",                         NULL, NULL, "" ) \
    SETTINGS_ITEM(string,    StatsDatabaseUsername,      "stats",    "stats_database_username",              "",                         NULL, NULL, "" ) \
    SETTINGS_ITEM(string,    StatsDatabasePassword,      "stats",    "stats_database_password",              "",                         NULL, NULL, "" ) \
+   SETTINGS_ITEM(U32,       DatabaseWorkerThreads,      "stats",    "database_worker_threads",              2,                          NULL, NULL, "" ) \
+   SETTINGS_ITEM(U32,       DatabaseBatchSize,          "stats",    "database_batch_size",                  32,                         NULL, NULL, "" ) \
                                                                                                                                                          \
    /* GameJolt settings */                                                                                                                               \
    SETTINGS_ITEM(YesNo,     UseGameJolt,                "GameJolt", "UseGameJolt",                          Yes,                        NULL, NULL, "" ) \
@@ -133,10 +136,13 @@ private:
    Vector<MasterServerConnection *> mServerList;
    Vector<MasterServerConnection *> mClientList;
 
+   ServerDirectory mServerDirectory;         // Servers indexed by version and mode, for answering client queries
+
    NetInterface *createNetInterface() const;
 
    bool motdHasChanged() const;
    void broadcastMotd() const;
+   void logDatabaseStats();
 
 public:
    MasterServer(MasterSettings *settings);      // Constructor
@@ -161,6 +167,8 @@ public:
    const Vector<MasterServerConnection *> *getServerList() const;
    const Vector<MasterServerConnection *> *getClientList() const;
 
+   ServerDirectory *getServerDirectory();
+
    void addServer(MasterServerConnection *server);
    void addClient(MasterServerConnection *client);
 
@@ -31,6 +31,7 @@ static const S32 M_RPC_019  = 3;
 static const S32 M_RPC_019a = 4;
 static const S32 M_RPC_019d = 5;
 static const S32 M_RPC_020  = 6;
+static const S32 M_RPC_021  = 7;
 
 TNL_IMPLEMENT_RPC(MasterServerInterface, c2mQueryServers,
    (U32 queryId), (queryId),
@@ -262,5 +263,33 @@ TNL_IMPLEMENT_RPC(MasterServerInterface, s2mServerDescription,
    (descr),
    NetClassGroupMasterMask, RPCGuaranteedOrderedBigData, RPCDirClientToServer, M_RPC_PRE_017) {}
 
+TNL_IMPLEMENT_RPC(MasterServerInterface, c2mSubscribeServerList,
+   (U32 queryId, bool hostOnly), 
+   (queryId, hostOnly),
+   NetClassGroupMasterMask, RPCGuaranteedOrdered, RPCDirClientToServer, M_RPC_021) {}
+
+TNL_IMPLEMENT_RPC(MasterServerInterface, c2mUnsubscribeServerList,
+   (), 
+   (),
+   NetClassGroupMasterMask, RPCGuaranteedOrdered, RPCDirClientToServer, M_RPC_021) {}
+
+TNL_IMPLEMENT_RPC(MasterServerInterface, m2cServerStatus,
+   (U32 queryId, IPAddress address, S32 serverId, StringTableEntry serverName, StringTableEntry serverDescr, 
+    StringTableEntry levelName, U32 botCount, U32 playerCount, U32 maxPlayers, U32 infoFlags), 
+   (queryId, address, serverId, serverName, serverDescr, levelName, botCount, playerCount, maxPlayers, infoFlags),
+   NetClassGroupMasterMask, RPCGuaranteedOrderedBigData, RPCDirServerToClient, M_RPC_021) {}
+
+TNL_IMPLEMENT_RPC(MasterServerInterface, m2cServerRemoved,
+   (U32 queryId, S32 serverId), 
+   (queryId, serverId),
+   NetClassGroupMasterMask, RPCGuaranteedOrdered, RPCDirServerToClient, M_RPC_021) {}
+
+
+// Connections negotiate the number of RPCs they both understand; RPCs beyond that are silently dropped
+bool MasterServerInterface::isServerListSubscriptionSupported()
+{
+   return getEventClassVersion() >= (U32)M_RPC_021;
+}
+
 
 }
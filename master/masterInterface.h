@@ -188,6 +188,21 @@ public:
 
    TNL_DECLARE_RPC(s2mChangeName, (StringTableEntry name));         // when server changes name using /setservname
    TNL_DECLARE_RPC(s2mServerDescription, (StringTableEntry descr)); // when server changes using /setservdescr
+
+   /// c2mSubscribeServerList works like c2mQueryServers / c2mQueryHostServers, but after the initial list has been
+   /// sent, the master will keep the client informed of servers that come, go, or change their status with
+   /// m2cServerStatus and m2cServerRemoved, until the client sends c2mUnsubscribeServerList.
+   TNL_DECLARE_RPC(c2mSubscribeServerList, (U32 queryId, bool hostOnly));
+   TNL_DECLARE_RPC(c2mUnsubscribeServerList, ());
+
+   /// m2cServerStatus is sent to subscribed clients with the cached status of a server, whenever a server is added
+   /// or its status changes.  This lets the client fill in its server list without querying every server.
+   TNL_DECLARE_RPC(m2cServerStatus, (U32 queryId, IPAddress address, S32 serverId, 
+                                     StringTableEntry serverName, StringTableEntry serverDescr, StringTableEntry levelName, 
+                                     U32 botCount, U32 playerCount, U32 maxPlayers, U32 infoFlags));
+   TNL_DECLARE_RPC(m2cServerRemoved, (U32 queryId, S32 serverId));
+
+   bool isServerListSubscriptionSupported();    // True if the other end of this connection knows about the RPCs above
 };
 
 }
@@ -35,6 +35,7 @@ LOCAL_SRC_FILES := assert.cpp \
 	rpc.cpp \
 	symmetricCipher.cpp \
 	thread.cpp \
+	timerWheel.cpp \
 	tnlMethodDispatch.cpp \
 	journal.cpp \
 	udp.cpp \
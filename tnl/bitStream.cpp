@@ -54,6 +54,7 @@ void BitStream::reset()
    mCompressRelative = false;
    mStringBuffer[0] = 0;
    mStringTable = NULL;
+   mStringRecorder = NULL;
 }
 
 U8 *BitStream::getBytePtr()
@@ -207,6 +208,53 @@ bool BitStream::readBits(U32 bitCount, void *bitPtr)
    return true;
 }
 
+bool BitStream::writeRecordedBits(U32 bitCount, const U8 *bitPtr, const Vector<RecordedString> &strings)
+{
+   // Strings will generally leave us with stretches that don't start on a byte boundary, which writeBits() can't
+   // copy from; we read those out through a stream of our own, a chunk at a time
+   BitStream source(const_cast<U8 *>(bitPtr), (bitCount + 7) >> 3);
+   U8 chunk[256];
+   U32 position = 0;
+
+   for(S32 i = 0; i <= strings.size(); i++)
+   {
+      U32 end = (i < strings.size()) ? strings[i].bitPosition : bitCount;
+
+      if((position & 0x7) == 0)
+      {
+         if(!writeBits(end - position, bitPtr + (position >> 3)))
+            return false;
+      }
+      else
+      {
+         source.setBitPosition(position);
+
+         for(U32 remaining = end - position; remaining > 0; )
+         {
+            U32 count = getMin(remaining, U32(sizeof(chunk) << 3));
+
+            source.readBits(count, chunk);
+            if(!writeBits(count, chunk))
+               return false;
+
+            remaining -= count;
+         }
+      }
+
+      position = end;
+
+      if(i == strings.size())
+         break;
+
+      if(strings[i].isTableEntry)
+         writeStringTableEntry(strings[i].tableEntry);
+      else
+         writeString(strings[i].string.getString(), strings[i].maxLen);
+   }
+
+   return isValid();
+}
+
 bool BitStream::setBit(U32 bitCount, bool set)
 {
    if(bitCount >= maxWriteBitNum)
@@ -508,6 +556,19 @@ void BitStream::writeString(const char *string, U8 maxLen)     // maxlen default
 {
    if(!string)
       string = "";
+
+   if(mStringRecorder)
+   {
+      RecordedString recorded;
+      recorded.bitPosition = bitNum;
+      recorded.isTableEntry = false;
+      recorded.string = string;
+      recorded.maxLen = maxLen;
+
+      mStringRecorder->push_back(recorded);
+      return;
+   }
+
    U8 j;
    for(j = 0; j < maxLen && mStringBuffer[j] == string[j] && string[j];j++)
       ;  // do nothing
@@ -543,7 +604,17 @@ void BitStream::readStringTableEntry(StringTableEntry *ste)
 
 void BitStream::writeStringTableEntry(const StringTableEntry &ste)
 {
-   if(mStringTable)
+   if(mStringRecorder)
+   {
+      RecordedString recorded;
+      recorded.bitPosition = bitNum;
+      recorded.isTableEntry = true;
+      recorded.tableEntry = ste;
+      recorded.maxLen = 0;
+
+      mStringRecorder->push_back(recorded);
+   }
+   else if(mStringTable)
       mStringTable->writeStringTableEntry(this, ste);
    else
       writeString(ste.getString());
@@ -62,8 +62,12 @@ bool ClientPuzzleManager::NonceTable::checkAdd(Nonce &theNonce)
 ClientPuzzleManager::ClientPuzzleManager()
 {
    mCurrentDifficulty = InitialPuzzleDifficulty;
+   mLastDifficulty = InitialPuzzleDifficulty;
    mLastUpdateTime = 0;
    mLastTickTime = 0;
+   mLastDifficultyUpdateTime = 0;
+   mHandshakeTime = 0;
+   mHandshakeLoad = 0;
    //Random::read(mCurrentNonce.data, Nonce::NonceSize);
    //Random::read(mLastNonce.data, Nonce::NonceSize);
    mCurrentNonce.getRandom();
@@ -82,29 +86,52 @@ ClientPuzzleManager::~ClientPuzzleManager()
 void ClientPuzzleManager::tick(U32 currentTime)
 {
    if(!mLastTickTime)
+   {
       mLastTickTime = currentTime;
+      mLastDifficultyUpdateTime = currentTime;
+   }
 
-   // use delta of last tick time and current time to manage puzzle
-   // difficulty.
-
-   // not yet implemented.
+   // Make puzzles harder while handshakes are eating a lot of CPU, and ease off again once they aren't.
+   U32 updateDelta = currentTime - mLastDifficultyUpdateTime;
+   if(updateDelta >= DifficultyUpdateInterval)
+   {
+      mHandshakeLoad = U32(mHandshakeTime * 1000 / updateDelta);
+      mHandshakeTime = 0;
+      mLastDifficultyUpdateTime = currentTime;
 
+      if(mHandshakeLoad > HighHandshakeLoad && mCurrentDifficulty < MaxAdaptivePuzzleDifficulty)
+      {
+         // A new puzzle, or solutions to the easier one would keep coming in for another 30 seconds
+         refreshNonce(currentTime);
+         mCurrentDifficulty++;
+      }
+      else if(mHandshakeLoad < LowHandshakeLoad && mCurrentDifficulty > InitialPuzzleDifficulty)
+         mCurrentDifficulty--;     // Solutions to the harder puzzle are still good, so no new one needed
+   }
 
    // see if it's time to refresh the current puzzle:
    U32 timeDelta = currentTime - mLastUpdateTime;
    if(timeDelta > PuzzleRefreshTime)
-   {
-      mLastUpdateTime = currentTime;
-      mLastNonce = mCurrentNonce;
-      NonceTable *tempTable = mLastNonceTable;
-      mLastNonceTable = mCurrentNonceTable;
-      mCurrentNonceTable = tempTable;
-
-      mLastNonce = mCurrentNonce;
-      mCurrentNonceTable->reset();
-      //Random::read(mCurrentNonce.data, Nonce::NonceSize);
-      mCurrentNonce.getRandom();
-   }
+      refreshNonce(currentTime);
+}
+
+void ClientPuzzleManager::refreshNonce(U32 currentTime)
+{
+   mLastUpdateTime = currentTime;
+   mLastNonce = mCurrentNonce;
+   mLastDifficulty = mCurrentDifficulty;
+   NonceTable *tempTable = mLastNonceTable;
+   mLastNonceTable = mCurrentNonceTable;
+   mCurrentNonceTable = tempTable;
+
+   mCurrentNonceTable->reset();
+   //Random::read(mCurrentNonce.data, Nonce::NonceSize);
+   mCurrentNonce.getRandom();
+}
+
+void ClientPuzzleManager::addHandshakeTime(F64 milliseconds)
+{
+   mHandshakeTime += milliseconds;
 }
 
 bool ClientPuzzleManager::checkOneSolution(U32 solution, Nonce &clientNonce, Nonce &serverNonce, U32 puzzleDifficulty, U32 clientIdentity)
@@ -136,15 +163,23 @@ bool ClientPuzzleManager::checkOneSolution(U32 solution, Nonce &clientNonce, Non
 
 ClientPuzzleManager::ErrorCode ClientPuzzleManager::checkSolution(U32 solution, Nonce &clientNonce, Nonce &serverNonce, U32 puzzleDifficulty, U32 clientIdentity)
 {
-   if(puzzleDifficulty != mCurrentDifficulty)
-      return InvalidPuzzleDifficulty;
    NonceTable *theTable = NULL;
+   U32 requiredDifficulty = 0;
    if(serverNonce == mCurrentNonce)
+   {
       theTable = mCurrentNonceTable;
+      requiredDifficulty = mCurrentDifficulty;
+   }
    else if(serverNonce == mLastNonce)
+   {
       theTable = mLastNonceTable;
+      requiredDifficulty = mLastDifficulty;
+   }
    if(!theTable)
       return InvalidServerNonce;
+   // Difficulty may have dropped since the client got its puzzle; a solution to a harder one is still fine
+   if(puzzleDifficulty < requiredDifficulty || puzzleDifficulty > MaxPuzzleDifficulty)
+      return InvalidPuzzleDifficulty;
    if(!checkOneSolution(solution, clientNonce, serverNonce, puzzleDifficulty, clientIdentity))
       return InvalidSolution;
    if(!theTable->checkAdd(clientNonce))
@@ -597,6 +597,8 @@ bool EventConnection::postNetEvent(NetEvent *theEvent)
          mUnorderedSendEventQueueTail->mNextEvent = event;
       mUnorderedSendEventQueueTail = event;
    }
+
+   wake();
    return true;
 }
 
@@ -66,7 +66,7 @@ static const char *packetTypeNames[] =
 
 //-----------------------------------------------------------------
 
-NetConnection::NetConnection()
+NetConnection::NetConnection() : mServiceTimer(this)
 {
    mInitialSendSeq = Random::readI();
    mConnectionParameters.mNonce.getRandom();
@@ -78,6 +78,7 @@ NetConnection::NetConnection()
 
    mLastPacketRecvTime = 0;
    mLastUpdateTime = 0;
+   mNextTimeoutCheckTime = 0;
    mRoundTripTime = 0;
    mSendDelayCredit = 0;
    mConnectionState = NotConnected;
@@ -203,6 +204,12 @@ void NetConnection::keepAlive()
    mPingSendCount = 0;
 }
 
+void NetConnection::wake()
+{
+   if(mInterface.isValid())
+      mInterface->wakeConnection(this);
+}
+
 //--------------------------------------------------------------------
 
 char NetConnection::mErrorBuffer[256];
@@ -269,6 +276,7 @@ void NetConnection::readRawPacket(BitStream *bstream)
    if(readPacketHeader(bstream))
    {
       mLastPacketRecvTime = mInterface->getCurrentTime();
+      wake();     // There may be acks to send, or room in the window now
 
       readPacketRateInfo(bstream);
       bstream->setStringTable(mStringTable);
@@ -730,6 +738,43 @@ void NetConnection::checkPacketSend(bool force, U32 curTime)
    sendPacket(&stream);
 }
 
+U32 NetConnection::getNextPacketSendTime(U32 currentTime)
+{
+   U32 delay = mCurrentPacketSendPeriod;
+
+   if(!isAdaptive())
+   {
+      // Same throttling as checkPacketSend()
+      if(mLastSendSeq - mHighestAckedSeq > 5)
+         delay *= (mLastSendSeq - mHighestAckedSeq - 5) * 2;
+
+      U32 sendTime = mLastUpdateTime + delay - mSendDelayCredit;
+      if(S32(sendTime - currentTime) > 0)
+         return sendTime;
+
+      // We could have sent, but had nothing to; look again in a while, as ghosts may have come into scope.
+      // With no send period, as with useZeroLatencyForTesting(), that's the next pass, as it always was.
+      return currentTime + delay;
+   }
+
+   // Adaptive connections send whenever they have something, one packet at a time
+   if(mLastUpdateTime == currentTime)
+      return currentTime + 1;
+
+   U32 nextTime = currentTime + delay;
+
+   // When checkPacketSend()'s ack heuristic will decide it's time to ack what we've received
+   S32 ackDelta = mLastSeqRecvd - mLastSeqRecvdAck;
+   if(ackDelta > 0)
+   {
+      U32 ackTime = mLastAckTime + 800 / ackDelta + 1;
+      if(S32(ackTime - nextTime) < 0)
+         nextTime = ackTime;
+   }
+
+   return nextTime;
+}
+
 bool NetConnection::windowFull()
 {
    if(mLastSendSeq - mHighestAckedSeq >= (MaxPacketWindowSize - 2))
@@ -41,11 +41,10 @@ namespace TNL {
 // NetInterface initialization/destruction
 //-----------------------------------------------------------------------------
 
-NetInterface::NetInterface(const Address &bindAddress) : mSocket(bindAddress)
+NetInterface::NetInterface(const Address &bindAddress) : mConnectionTimers(Platform::getRealMilliseconds()), mSocket(bindAddress)
 {
    NetClassRep::initialize(); // initialize the net class reps, if they haven't been initialized already.
 
-   mLastTimeoutCheckTime = 0;
    mAllowConnections = true;
    mRequiresKeyExchange = false;
 
@@ -54,8 +53,21 @@ NetInterface::NetInterface(const Address &bindAddress) : mSocket(bindAddress)
    mConnectionHashTable.resize(129);
    for(S32 i = 0; i < mConnectionHashTable.size(); i++)
       mConnectionHashTable[i] = NULL;
+
+   mPendingConnectionHashTable.resize(129);
+   for(S32 i = 0; i < mPendingConnectionHashTable.size(); i++)
+      mPendingConnectionHashTable[i] = NULL;
    mSendPacketList = NULL;
    mCurrentTime = Platform::getRealMilliseconds();
+
+   for(U32 i = 0; i < HandshakeBucketCount; i++)
+   {
+      mHandshakeBuckets[i].network = 0;
+      mHandshakeBuckets[i].lastRefillTime = mCurrentTime;
+      mHandshakeBuckets[i].tokens = HandshakeBurst;
+   }
+   mHandshakeBucketSalt = Random::readI();
+   mDroppedHandshakeCount = 0;
 }
 
 NetInterface::~NetInterface()
@@ -152,6 +164,93 @@ U32 NetInterface::computeClientIdentityToken(const Address &address, const Nonce
    return hash[0];
 }
 
+//-----------------------------------------------------------------------------
+// NetInterface connection hash tables
+//-----------------------------------------------------------------------------
+
+// The connection hash tables are single vectors, with hash collisions
+// resolved to the next open space in the table.
+
+static NetConnection *hashTableFind(const Vector<NetConnection *> &table, const Address &address)
+{
+   // Compute the hash index based on the network address
+   U32 hashIndex = address.hash() % table.size();
+
+   // Search through the table for an address that matches the source
+   // address.  If the connection pointer is NULL, we've found an
+   // empty space and a connection with that address is not in the table
+   while(table[hashIndex] != NULL)
+   {
+      if(address == table[hashIndex]->getNetAddress())
+         return table[hashIndex];
+      hashIndex++;
+      if(hashIndex >= (U32) table.size())
+         hashIndex = 0;
+   }
+   return NULL;
+}
+
+static void hashTableInsert(Vector<NetConnection *> &table, NetConnection *conn)
+{
+   U32 index = conn->getNetAddress().hash() % table.size();
+   while(table[index] != NULL)
+   {
+      index++;
+      if(index >= (U32) table.size())
+         index = 0;
+   }
+   table[index] = conn;
+}
+
+// Returns false if the connection wasn't in the table
+static bool hashTableRemove(Vector<NetConnection *> &table, NetConnection *conn)
+{
+   U32 index = conn->getNetAddress().hash() % table.size();
+   U32 startIndex = index;
+
+   while(table[index] != conn)
+   {
+      index++;
+      if(index >= (U32) table.size())
+         index = 0;
+      if(index == startIndex)
+         return false;
+   }
+   table[index] = NULL;
+
+   // rehash all subsequent entries until we find a NULL entry:
+   for(;;)
+   {
+      index++;
+      if(index >= (U32) table.size())
+         index = 0;
+      if(!table[index])
+         break;
+      NetConnection *rehashConn = table[index];
+      table[index] = NULL;
+      hashTableInsert(table, rehashConn);
+   }
+   return true;
+}
+
+// Adds conn, which has just been added to list, to table, growing table if it's getting full
+static void hashTableAdd(Vector<NetConnection *> &table, const Vector<NetConnection *> &list, NetConnection *conn)
+{
+   S32 numConnections = list.size();
+
+   if(numConnections > table.size() / 2)
+   {
+      table.resize(numConnections * 4 - 1);
+      for(S32 i = 0; i < table.size(); i++)
+         table[i] = NULL;
+
+      for(S32 i = 0; i < numConnections; i++)
+         hashTableInsert(table, list[i]);
+   }
+   else
+      hashTableInsert(table, conn);
+}
+
 //-----------------------------------------------------------------------------
 // NetInterface pending connection list management
 //-----------------------------------------------------------------------------
@@ -169,43 +268,52 @@ void NetInterface::addPendingConnection(NetConnection *connection)
    // Hang on to the connection and add it to the pending connection list
    connection->incRef();
    mPendingConnections.push_back(connection);   // (only place where something is added to the mPendingConnections list)
+   hashTableAdd(mPendingConnectionHashTable, mPendingConnections, connection);
+
+   scheduleConnection(connection, getCurrentTime() + TimeoutCheckInterval);
 }
 
 
 // Search the pending connection list for the specified connection and remove it
 void NetInterface::removePendingConnection(NetConnection *connection)
 {
-   for(S32 i = 0; i < mPendingConnections.size(); i++)
-      if(mPendingConnections[i] == connection)
-      {
-         connection->decRef();
-         mPendingConnections.erase(i);
-         return;
-      }
+   S32 index = mPendingConnections.getIndex(connection);
+   if(index == -1)
+      return;
+
+   hashTableRemove(mPendingConnectionHashTable, connection);
+
+   // If it's just become a regular connection, its timer belongs to that now
+   if(findConnection(connection->getNetAddress()) != connection)
+      mConnectionTimers.cancel(&connection->mServiceTimer);
+
+   connection->decRef();
+   mPendingConnections.erase(index);
 }
 
 
 NetConnection *NetInterface::findPendingConnection(const Address &address)
 {
-   // Loop through all the pending connections and compare the NetAddresses
-   for(S32 i = 0; i < mPendingConnections.size(); i++)
-      if(address == mPendingConnections[i]->getNetAddress())
-         return mPendingConnections[i];
-   return NULL;
+   return hashTableFind(mPendingConnectionHashTable, address);
 }
 
 
 void NetInterface::findAndRemovePendingConnection(const Address &address)
 {
-   // Search through the list by Address and remove any connection
-   // that matches.
-   for(S32 i = 0; i < mPendingConnections.size(); i++)
-      if(address == mPendingConnections[i]->getNetAddress())
-      {
-         mPendingConnections[i]->decRef();
-         mPendingConnections.erase(i);
-         return;
-      }
+   NetConnection *connection = findPendingConnection(address);
+   if(connection)
+      removePendingConnection(connection);
+}
+
+
+void NetInterface::setPendingConnectionAddress(NetConnection *connection, const Address &address)
+{
+   // It's filed under its address, so it has to be refiled
+   bool found = hashTableRemove(mPendingConnectionHashTable, connection);
+   connection->setNetAddress(address);
+
+   if(found)
+      hashTableInsert(mPendingConnectionHashTable, connection);
 }
 
 //-----------------------------------------------------------------------------
@@ -214,24 +322,7 @@ void NetInterface::findAndRemovePendingConnection(const Address &address)
 
 NetConnection *NetInterface::findConnection(const Address &addr)
 {
-   // The connection hash table is a single vector, with hash collisions
-   // resolved to the next open space in the table.
-
-   // Compute the hash index based on the network address
-   U32 hashIndex = addr.hash() % mConnectionHashTable.size();
-
-   // Search through the table for an address that matches the source
-   // address.  If the connection pointer is NULL, we've found an
-   // empty space and a connection with that address is not in the table
-   while(mConnectionHashTable[hashIndex] != NULL)
-   {
-      if(addr == mConnectionHashTable[hashIndex]->getNetAddress())
-         return mConnectionHashTable[hashIndex];
-      hashIndex++;
-      if(hashIndex >= (U32) mConnectionHashTable.size())
-         hashIndex = 0;
-   }
-   return NULL;
+   return hashTableFind(mConnectionHashTable, addr);
 }
 
 void NetInterface::removeConnection(NetConnection *conn)
@@ -244,39 +335,14 @@ void NetInterface::removeConnection(NetConnection *conn)
          break;
       }
    }
-   U32 index = conn->getNetAddress().hash() % mConnectionHashTable.size();
-   U32 startIndex = index;
 
-   while(mConnectionHashTable[index] != conn)
+   if(!hashTableRemove(mConnectionHashTable, conn))
    {
-      index++;
-      if(index >= (U32) mConnectionHashTable.size())
-         index = 0;
-      TNLAssert(index != startIndex, "Attempting to remove a connection that is not in the table."); // not in the table
-      if(index == startIndex)
-         return;
+      TNLAssert(false, "Attempting to remove a connection that is not in the table."); // not in the table
+      return;
    }
-   mConnectionHashTable[index] = NULL;
 
-   // rehash all subsequent entries until we find a NULL entry:
-   for(;;)
-   {
-      index++;
-      if(index >= (U32) mConnectionHashTable.size())
-         index = 0;
-      if(!mConnectionHashTable[index])
-         break;
-      NetConnection *rehashConn = mConnectionHashTable[index];
-      mConnectionHashTable[index] = NULL;
-      U32 realIndex = rehashConn->getNetAddress().hash() % mConnectionHashTable.size();
-      while(mConnectionHashTable[realIndex] != NULL)
-      {
-         realIndex++;
-         if(realIndex >= (U32) mConnectionHashTable.size())
-            realIndex = 0;
-      }
-      mConnectionHashTable[realIndex] = rehashConn;
-   }
+   mConnectionTimers.cancel(&conn->mServiceTimer);
    conn->decRef();
 }
 
@@ -284,38 +350,10 @@ void NetInterface::addConnection(NetConnection *conn)
 {
    conn->incRef();
    mConnectionList.push_back(conn);
+   hashTableAdd(mConnectionHashTable, mConnectionList, conn);
 
-   S32 numConnections = mConnectionList.size();
-
-   if(numConnections > mConnectionHashTable.size() / 2)
-   {
-      mConnectionHashTable.resize(numConnections * 4 - 1);
-      for(S32 i = 0; i < mConnectionHashTable.size(); i++)
-         mConnectionHashTable[i] = NULL;
-
-      for(S32 i = 0; i < numConnections; i++)
-      {
-         U32 index = mConnectionList[i]->getNetAddress().hash() % mConnectionHashTable.size();
-         while(mConnectionHashTable[index] != NULL)
-         {
-            index++;
-            if(index >= (U32) mConnectionHashTable.size())
-               index = 0;
-         }
-         mConnectionHashTable[index] = mConnectionList[i];
-      }
-   }
-   else
-   {
-      U32 index = mConnectionList[numConnections - 1]->getNetAddress().hash() % mConnectionHashTable.size();
-      while(mConnectionHashTable[index] != NULL)
-      {
-         index++;
-         if(index >= (U32) mConnectionHashTable.size())
-            index = 0;
-      }
-      mConnectionHashTable[index] = mConnectionList[numConnections - 1];
-   }
+   conn->mNextTimeoutCheckTime = getCurrentTime() + TimeoutCheckInterval;
+   scheduleConnection(conn, getCurrentTime());
 }
 
 //-----------------------------------------------------------------------------
@@ -353,92 +391,160 @@ void NetInterface::processConnections()
    }
 
    NetObject::collapseDirtyList(); // collapse all the mask bits...
-   for(S32 i = 0; i < mConnectionList.size(); i++)
-      mConnectionList[i]->checkPacketSend(false, getCurrentTime());
 
-   if(U32(getCurrentTime() - mLastTimeoutCheckTime) > TimeoutCheckInterval)
+   // Only look at connections with something due: a packet they may be able to send, a handshake
+   // retry, or a timeout check.  Mostly idle connections stay out of the way until then.
+   mConnectionTimers.advance(getCurrentTime());
+
+   while(TimerWheel::Timer *timer = mConnectionTimers.getNextDue())
    {
-      for(S32 i = 0; i < mPendingConnections.size();)
+      RefPtr<NetConnection> conn = (NetConnection *) timer->getUserData();   // In case processing it gets it removed
+
+      if(findPendingConnection(conn->getNetAddress()) == conn)
+         processPendingConnection(conn);
+      else
+         processConnection(conn);
+   }
+
+   // check if we're trying to solve any client connection puzzles
+   for(S32 i = 0; i < mPendingConnections.size(); i++)
+   {
+      if(mPendingConnections[i]->getConnectionState() == NetConnection::ComputingPuzzleSolution)
+      {
+         continuePuzzleSolution(mPendingConnections[i]);
+         break;
+      }
+   }
+}
+
+void NetInterface::processConnection(NetConnection *conn)
+{
+   U32 currentTime = getCurrentTime();
+
+   conn->checkPacketSend(false, currentTime);
+
+   if(S32(currentTime - conn->mNextTimeoutCheckTime) >= 0)
+   {
+      conn->mNextTimeoutCheckTime = currentTime + TimeoutCheckInterval;
+
+      if(conn->checkTimeout(currentTime))
       {
-         NetConnection *pending = mPendingConnections[i];
+         conn->setConnectionState(NetConnection::TimedOut);
+         conn->onConnectionTerminated(NetConnection::ReasonTimedOut, "Timeout");
+         removeConnection(conn);
+         return;
+      }
+   }
+
+   if(conn->getConnectionState() != NetConnection::Connected)    // Disconnected along the way
+      return;
+
+   // Nothing to do until then, unless something wakes it up sooner
+   U32 nextTime = conn->getNextPacketSendTime(currentTime);
+   if(S32(conn->mNextTimeoutCheckTime - nextTime) < 0)
+      nextTime = conn->mNextTimeoutCheckTime;
+
+   scheduleConnection(conn, nextTime);
+}
+
+void NetInterface::processPendingConnection(NetConnection *pending)
+{
+   U32 currentTime = getCurrentTime();
+   U32 retryTime = 0;
+
+   if(pending->getConnectionState() == NetConnection::AwaitingChallengeResponse)
+   {
+      retryTime = ChallengeRetryTime;
 
-         if(pending->getConnectionState() == NetConnection::AwaitingChallengeResponse &&
-            getCurrentTime() - pending->mConnectLastSendTime > ChallengeRetryTime)
+      if(currentTime - pending->mConnectLastSendTime > ChallengeRetryTime)
+      {
+         if(pending->mConnectSendCount > ChallengeRetryCount)
          {
-            if(pending->mConnectSendCount > ChallengeRetryCount)
-            {
-               pending->setConnectionState(NetConnection::ConnectTimedOut);
-               pending->onConnectTerminated(NetConnection::ReasonTimedOut, "Timeout");
-               removePendingConnection(pending);
-               continue;
-            }
-            else
-               sendConnectChallengeRequest(pending);
+            pending->setConnectionState(NetConnection::ConnectTimedOut);
+            pending->onConnectTerminated(NetConnection::ReasonTimedOut, "Timeout");
+            removePendingConnection(pending);
+            return;
          }
-         else if(pending->getConnectionState() == NetConnection::AwaitingConnectResponse &&
-                                    getCurrentTime() - pending->mConnectLastSendTime > ConnectRetryTime)
+         else
+            sendConnectChallengeRequest(pending);
+      }
+   }
+   else if(pending->getConnectionState() == NetConnection::AwaitingConnectResponse)
+   {
+      retryTime = ConnectRetryTime;
+
+      if(currentTime - pending->mConnectLastSendTime > ConnectRetryTime)
+      {
+         if(pending->mConnectSendCount > ConnectRetryCount)
          {
-            if(pending->mConnectSendCount > ConnectRetryCount)
-            {
-               pending->setConnectionState(NetConnection::ConnectTimedOut);
-               pending->onConnectTerminated(NetConnection::ReasonTimedOut, "Timeout");
-               removePendingConnection(pending);
-               continue;
-            }
-            else
-            {
-               if(pending->getConnectionParameters().mIsArranged)
-                  sendArrangedConnectRequest(pending);
-               else
-                  sendConnectRequest(pending);
-            }
+            pending->setConnectionState(NetConnection::ConnectTimedOut);
+            pending->onConnectTerminated(NetConnection::ReasonTimedOut, "Timeout");
+            removePendingConnection(pending);
+            return;
          }
-         else if(pending->getConnectionState() == NetConnection::SendingPunchPackets &&
-            getCurrentTime() - pending->mConnectLastSendTime > PunchRetryTime)
+         else
          {
-            if(pending->mConnectSendCount > PunchRetryCount)
-            {
-               pending->setConnectionState(NetConnection::ConnectTimedOut);
-               pending->onConnectTerminated(NetConnection::ReasonTimedOut, "Timeout");
-               removePendingConnection(pending);
-               continue;
-            }
+            if(pending->getConnectionParameters().mIsArranged)
+               sendArrangedConnectRequest(pending);
             else
-               sendPunchPackets(pending);
+               sendConnectRequest(pending);
          }
-         else if(pending->getConnectionState() == NetConnection::ComputingPuzzleSolution &&
-            getCurrentTime() - pending->mConnectLastSendTime > PuzzleSolutionTimeout)
+      }
+   }
+   else if(pending->getConnectionState() == NetConnection::SendingPunchPackets)
+   {
+      retryTime = PunchRetryTime;
+
+      if(currentTime - pending->mConnectLastSendTime > PunchRetryTime)
+      {
+         if(pending->mConnectSendCount > PunchRetryCount)
          {
             pending->setConnectionState(NetConnection::ConnectTimedOut);
             pending->onConnectTerminated(NetConnection::ReasonTimedOut, "Timeout");
             removePendingConnection(pending);
+            return;
          }
-         i++;
+         else
+            sendPunchPackets(pending);
       }
-      mLastTimeoutCheckTime = getCurrentTime();
+   }
+   else if(pending->getConnectionState() == NetConnection::ComputingPuzzleSolution)
+   {
+      retryTime = PuzzleSolutionTimeout;
 
-      for(S32 i = 0; i < mConnectionList.size();)
+      if(currentTime - pending->mConnectLastSendTime > PuzzleSolutionTimeout)
       {
-         if(mConnectionList[i]->checkTimeout(getCurrentTime()))
-         {
-            mConnectionList[i]->setConnectionState(NetConnection::TimedOut);
-            mConnectionList[i]->onConnectionTerminated(NetConnection::ReasonTimedOut, "Timeout");
-            removeConnection(mConnectionList[i]);
-         }
-         else
-            i++;
+         pending->setConnectionState(NetConnection::ConnectTimedOut);
+         pending->onConnectTerminated(NetConnection::ReasonTimedOut, "Timeout");
+         removePendingConnection(pending);
+         return;
       }
    }
 
-   // check if we're trying to solve any client connection puzzles
-   for(S32 i = 0; i < mPendingConnections.size(); i++)
+   // Come back when its retry is due, but no later than TimeoutCheckInterval, as its state may change in the meantime
+   U32 nextTime = currentTime + TimeoutCheckInterval;
+   if(retryTime)
    {
-      if(mPendingConnections[i]->getConnectionState() == NetConnection::ComputingPuzzleSolution)
-      {
-         continuePuzzleSolution(mPendingConnections[i]);
-         break;
-      }
+      U32 retryDueTime = pending->mConnectLastSendTime + retryTime + 1;
+      if(S32(retryDueTime - currentTime) > 0 && S32(retryDueTime - nextTime) < 0)
+         nextTime = retryDueTime;
    }
+
+   scheduleConnection(pending, nextTime);
+}
+
+void NetInterface::scheduleConnection(NetConnection *conn, U32 time)
+{
+   mConnectionTimers.schedule(&conn->mServiceTimer, time);
+}
+
+void NetInterface::wakeConnection(NetConnection *conn)
+{
+   // Connections that aren't scheduled aren't ours to look after, or are being looked after right now
+   TimerWheel::Timer *timer = &conn->mServiceTimer;
+
+   if(timer->isScheduled() && S32(timer->getDueTime() - getCurrentTime()) > 0)
+      mConnectionTimers.schedule(timer, getCurrentTime());
 }
 
 //-----------------------------------------------------------------------------
@@ -497,14 +603,12 @@ void NetInterface::processPacket(const Address &sourceAddress, BitStream *pStrea
          switch(packetType)
          {
             case ConnectChallengeRequest:
-               handleConnectChallengeRequest(sourceAddress, pStream);
+            case ConnectRequest:
+               handleHandshakeRequest(sourceAddress, packetType, pStream);
                break;
             case ConnectChallengeResponse:
                handleConnectChallengeResponse(sourceAddress, pStream);
                break;
-            case ConnectRequest:
-               handleConnectRequest(sourceAddress, pStream);
-               break;
             case ConnectReject:
                handleConnectReject(sourceAddress, pStream);
                break;
@@ -529,6 +633,58 @@ void NetInterface::handleInfoPacket(const Address &address, U8 packetType, BitSt
 {
 }
 
+// Anyone can send us these, so the time we spend on them sets how hard our client puzzles are.  Challenge
+// requests are left alone: we keep nothing for them, and the reply is cheap, so there's nothing a flood of
+// them can use up but the puzzle difficulty.  Connect requests are limited by network in handleConnectRequest,
+// but only once their identity token has shown they really came from the address they claim to.
+void NetInterface::handleHandshakeRequest(const Address &address, U8 packetType, BitStream *stream)
+{
+   S64 startTime = Platform::getHighPrecisionTimerValue();
+
+   if(packetType == ConnectChallengeRequest)
+      handleConnectChallengeRequest(address, stream);
+   else
+      handleConnectRequest(address, stream);
+
+   mPuzzleManager.addHandshakeTime(Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - startTime));
+}
+
+bool NetInterface::allowHandshake(const Address &address, U32 currentTime)
+{
+   // Hosts on the same /24 are usually all in the same hands, so they share a limit (TNL only does IPv4)
+   U32 network = address.netNum[0] >> 8;
+   HandshakeBucket &bucket = mHandshakeBuckets[(((network ^ mHandshakeBucketSalt) * 2654435761u) >> 16) % HandshakeBucketCount];
+
+   if(bucket.network != network)
+   {
+      bucket.network = network;
+      bucket.lastRefillTime = currentTime;
+      bucket.tokens = HandshakeBurst;
+   }
+
+   U32 earned = (currentTime - bucket.lastRefillTime) / HandshakeRefillTime;
+
+   if(earned > 0)
+   {
+      if(bucket.tokens + earned >= HandshakeBurst)
+      {
+         bucket.tokens = HandshakeBurst;
+         bucket.lastRefillTime = currentTime;
+      }
+      else
+      {
+         bucket.tokens += earned;
+         bucket.lastRefillTime += earned * HandshakeRefillTime;
+      }
+   }
+
+   if(bucket.tokens == 0)
+      return false;
+
+   bucket.tokens--;
+   return true;
+}
+
 //-----------------------------------------------------------------------------
 // NetInterface connection handshake initiaton and processing
 //-----------------------------------------------------------------------------
@@ -565,6 +721,9 @@ void NetInterface::handleConnectChallengeRequest(const Address &addr, BitStream
    if(!mAllowConnections)
       return;
 
+   // Note that we keep nothing about the requestor here: the identity token in our response is a keyed
+   // hash of its address and nonce, which we can recompute when its connect request comes in.
+
    Nonce clientNonce;
    clientNonce.read(stream);
    bool wantsKeyExchange = stream->readFlag();
@@ -749,6 +908,13 @@ void NetInterface::handleConnectRequest(const Address &address, BitStream *strea
    if(theParams.mClientIdentity != computeClientIdentityToken(address, theParams.mNonce))
       return;
 
+   // Only someone who got our challenge response can get this far, so the address is real, and we can limit it
+   if(!allowHandshake(address, getCurrentTime()))
+   {
+      mDroppedHandshakeCount++;
+      return;
+   }
+
    stream->read(&theParams.mPuzzleDifficulty);
    stream->read(&theParams.mPuzzleSolution);
 
@@ -1143,7 +1309,7 @@ void NetInterface::handlePunch(const Address &theAddress, BitStream *stream)
    if(i == mPendingConnections.size())
       return;
 
-   conn->setNetAddress(theAddress);
+   setPendingConnectionAddress(conn, theAddress);
    logprintf(LogConsumer::LogNetInterface, "Punch from %s matched nonces - connecting...", theAddress.toString());
 
    conn->setConnectionState(NetConnection::AwaitingConnectResponse);
@@ -1278,7 +1444,7 @@ void NetInterface::handleArrangedConnectRequest(const Address &theAddress, BitSt
    if(oldConnection)
       disconnect(oldConnection, NetConnection::ReasonSelfDisconnect, "");
 
-   conn->setNetAddress(theAddress);
+   setPendingConnectionAddress(conn, theAddress);
    conn->setInitialRecvSequence(connectSequence);
    if(theParams.mUsingCrypto)
       conn->setSymmetricCipher(new SymmetricCipher(theParams.mSymmetricKey, theParams.mInitVector));
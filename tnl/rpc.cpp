@@ -36,11 +36,31 @@ namespace TNL {
 RPCEvent::RPCEvent(RPCGuaranteeType gType, RPCDirection dir) :
       NetEvent((NetEvent::GuaranteeType) gType, (NetEvent::EventDirection) dir)
 {
+   mPackCount = 0;
 }
 
+// The same event is often posted to many connections (see TNL_RPC_CONSTRUCT_NETEVENT and NetObject RPCs), and gets
+// packed again for each of them, as well as whenever it has to be resent.  So the first time we're packed we just
+// write our arguments, but after that we pack them once into a buffer of our own and copy that into each stream.
+// Strings are left out of the buffer and written into each stream separately, as they're compressed using the
+// connection's string table and whatever string that stream last wrote.
 void RPCEvent::pack(EventConnection *ps, BitStream *bstream)
 {
-   mFunctor->write(*bstream);
+   if(mPackCount++ == 0)
+   {
+      mFunctor->write(*bstream);
+      return;
+   }
+
+   if(mPackedArgs.isNull())
+   {
+      mPackedArgs = new BitStream();
+      mPackedArgs->setStringRecorder(&mPackedStrings);
+      mFunctor->write(*mPackedArgs);
+      mPackedArgs->setStringRecorder(NULL);
+   }
+
+   bstream->writeRecordedBits(mPackedArgs->getBitPosition(), mPackedArgs->getBuffer(), mPackedStrings);
 }
 
 void RPCEvent::unpack(EventConnection *ps, BitStream *bstream)
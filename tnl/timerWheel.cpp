@@ -0,0 +1,206 @@
+//-----------------------------------------------------------------------------------
+//
+//   Torque Network Library
+//   Copyright (C) 2004 GarageGames.com, Inc.
+//   Modifications (C) 2008 Chris Eykamp
+//   For more information see http://www.opentnl.org
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License as published by
+//   the Free Software Foundation; either version 2 of the License, or
+//   (at your option) any later version.
+//
+//   For use in products that are not compatible with the terms of the GNU
+//   General Public License, alternative licensing options are available
+//   from GarageGames.com.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   along with this program; if not, write to the Free Software
+//   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//------------------------------------------------------------------------------------
+
+#include "tnl.h"
+#include "tnlTimerWheel.h"
+
+namespace TNL {
+
+TimerWheel::Timer::Timer(void *userData)
+{
+   mNext = NULL;
+   mPrev = NULL;
+   mDueTime = 0;
+   mUserData = userData;
+}
+
+TimerWheel::Timer::~Timer()
+{
+   unlink();
+}
+
+void TimerWheel::Timer::unlink()
+{
+   if(!mNext)
+      return;
+
+   mPrev->mNext = mNext;
+   mNext->mPrev = mPrev;
+   mNext = NULL;
+   mPrev = NULL;
+}
+
+//-----------------------------------------------------------------------------
+
+// Each slot is a circular list, with a Timer that's never scheduled as its head
+TimerWheel::TimerWheel(U32 currentTime)
+{
+   mCurrentTime = currentTime;
+
+   for(U32 i = 0; i < NearSlotCount; i++)
+      mNearSlots[i].mNext = mNearSlots[i].mPrev = &mNearSlots[i];
+
+   for(U32 level = 0; level < FarLevelCount; level++)
+      for(U32 i = 0; i < FarSlotCount; i++)
+         mFarSlots[level][i].mNext = mFarSlots[level][i].mPrev = &mFarSlots[level][i];
+
+   mDueList.mNext = mDueList.mPrev = &mDueList;
+   mLateList.mNext = mLateList.mPrev = &mLateList;
+}
+
+TimerWheel::~TimerWheel()
+{
+   // Leave whatever timers are still scheduled unscheduled, rather than pointing into a wheel that's gone
+   Timer *lists[NearSlotCount + FarSlotCount * FarLevelCount + 2];
+   U32 listCount = 0;
+
+   for(U32 i = 0; i < NearSlotCount; i++)
+      lists[listCount++] = &mNearSlots[i];
+   for(U32 level = 0; level < FarLevelCount; level++)
+      for(U32 i = 0; i < FarSlotCount; i++)
+         lists[listCount++] = &mFarSlots[level][i];
+   lists[listCount++] = &mDueList;
+   lists[listCount++] = &mLateList;
+
+   for(U32 i = 0; i < listCount; i++)
+      while(lists[i]->mNext != lists[i])
+         lists[i]->mNext->unlink();
+}
+
+void TimerWheel::append(Timer *list, Timer *timer)
+{
+   timer->mPrev = list->mPrev;
+   timer->mNext = list;
+   list->mPrev->mNext = timer;
+   list->mPrev = timer;
+}
+
+// Puts timer in the slot for its due time, relative to where the wheel is now
+void TimerWheel::insert(Timer *timer)
+{
+   U32 delay = timer->mDueTime - mCurrentTime;
+
+   if(S32(delay) < 0)
+   {
+      append(&mLateList, timer);
+      return;
+   }
+
+   if(delay < NearSlotCount)
+   {
+      append(&mNearSlots[timer->mDueTime & (NearSlotCount - 1)], timer);
+      return;
+   }
+
+   // Anything beyond what the wheel covers waits in the farthest slot, and gets another look from there
+   U32 slotTime = timer->mDueTime;
+   if(delay > MaxDelay)
+      slotTime = mCurrentTime + MaxDelay;
+
+   U32 shift = NearSlotBits;
+   for(U32 level = 0; level < FarLevelCount; level++, shift += FarSlotBits)
+   {
+      if(delay >> (shift + FarSlotBits) == 0 || level == FarLevelCount - 1)
+      {
+         append(&mFarSlots[level][(slotTime >> shift) & (FarSlotCount - 1)], timer);
+         return;
+      }
+   }
+}
+
+// Moves the timers in the current slot of the given far level down to finer slots, and returns true if
+// that slot was the first of its level, meaning the next level up needs the same treatment
+bool TimerWheel::cascade(U32 level)
+{
+   U32 index = (mCurrentTime >> (NearSlotBits + FarSlotBits * level)) & (FarSlotCount - 1);
+   Timer *list = &mFarSlots[level][index];
+
+   while(list->mNext != list)
+   {
+      Timer *timer = list->mNext;
+      timer->unlink();
+      insert(timer);
+   }
+
+   return index == 0;
+}
+
+void TimerWheel::schedule(Timer *timer, U32 dueTime)
+{
+   timer->unlink();
+   timer->mDueTime = dueTime;
+   insert(timer);
+}
+
+void TimerWheel::cancel(Timer *timer)
+{
+   timer->unlink();
+}
+
+void TimerWheel::advance(U32 currentTime)
+{
+   while(mLateList.mNext != &mLateList)
+   {
+      Timer *timer = mLateList.mNext;
+      timer->unlink();
+      append(&mDueList, timer);
+   }
+
+   while(S32(currentTime - mCurrentTime) >= 0)
+   {
+      U32 index = mCurrentTime & (NearSlotCount - 1);
+
+      // Coming around to the start of the near slots, so bring down the next lot from further out
+      if(index == 0)
+         for(U32 level = 0; level < FarLevelCount && cascade(level); level++)
+            ;
+
+      Timer *list = &mNearSlots[index];
+      while(list->mNext != list)
+      {
+         Timer *timer = list->mNext;
+         TNLAssert(S32(timer->mDueTime - mCurrentTime) <= 0, "Timer isn't due yet!");
+
+         timer->unlink();
+         append(&mDueList, timer);
+      }
+
+      mCurrentTime++;
+   }
+}
+
+TimerWheel::Timer *TimerWheel::getNextDue()
+{
+   if(mDueList.mNext == &mDueList)
+      return NULL;
+
+   Timer *timer = mDueList.mNext;
+   timer->unlink();
+   return timer;
+}
+
+};
@@ -35,6 +35,14 @@
 #include "tnlConnectionStringTable.h"
 #endif
 
+#ifndef _TNL_VECTOR_H_
+#include "tnlVector.h"
+#endif
+
+#ifndef _TNL_STRING_H_
+#include "tnlString.h"
+#endif
+
 #include "tnlHuffmanStringProcessor.h"    // For HuffmanStringProcessor::MAX_SENDABLE_LINE_LENGTH
 
 #include "tnl.h"
@@ -66,6 +74,18 @@ inline bool read(T *value) { T temp; bool success = read(sizeof(T), &temp); *val
 /// BitStream provides a bit-level stream interface to a data buffer.
 class BitStream : public ByteBuffer
 {
+public:
+   /// A string left out of a stream with a string recorder set, along with where it would have gone.
+   /// See setStringRecorder() and writeRecordedBits().
+   struct RecordedString
+   {
+      U32 bitPosition;                 ///< Bit position in the stream where the string belongs
+      bool isTableEntry;               ///< True if the string was written with writeStringTableEntry()
+      StringTableEntry tableEntry;     ///< The entry, if isTableEntry
+      StringPtr string;                ///< The string, if not isTableEntry
+      U8 maxLen;                       ///< maxLen passed to writeString()
+   };
+
 protected:
    enum {
       ResizePad = 1500,
@@ -79,6 +99,8 @@ protected:
    ConnectionStringTable *mStringTable; ///< String table used to compress StringTableEntries over the network.
    /// String buffer holds the last string written into the stream for substring compression.
    char mStringBuffer[256];
+   /// If set, strings are recorded here rather than being written into the stream.
+   Vector<RecordedString> *mStringRecorder;
 
    bool resizeBits(U32 numBitsNeeded);
 public:
@@ -116,6 +138,11 @@ public:
    /// sets the ConnectionStringTable for compressing string table entries across the network
    void setStringTable(ConnectionStringTable *table) { mStringTable = table; }
 
+   /// Sets a list to record strings in, instead of writing them into the stream.  Strings are compressed differently
+   /// for every connection, so this lets the rest of the data be written once and copied into many streams with
+   /// writeRecordedBits().  Pass NULL to go back to writing strings normally.
+   void setStringRecorder(Vector<RecordedString> *recorder) { mStringRecorder = recorder; }
+
    /// clears the error state from an attempted read or write overrun
    void clearError() { error = false; }
 
@@ -213,6 +240,10 @@ public:
    /// Reads bitCount bits from the stream into bitPtr.
    bool readBits(U32 bitCount, void *bitPtr);
 
+   /// Writes bitCount bits from bitPtr, written with a string recorder set, into the stream, writing the recorded
+   /// strings into their places as we go.  Gives the same result as writing everything into this stream directly.
+   bool writeRecordedBits(U32 bitCount, const U8 *bitPtr, const Vector<RecordedString> &strings);
+
    /// Writes a ByteBuffer into the stream.  The ByteBuffer can be no larger than 1024 bytes in size.
    bool write(const ByteBuffer *theBuffer);
 
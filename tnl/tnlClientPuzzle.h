@@ -77,9 +77,17 @@ private:
    };
 
    U32 mCurrentDifficulty;
+   U32 mLastDifficulty;          ///< Difficulty of the puzzles we handed out with mLastNonce
    U32 mLastUpdateTime;
    U32 mLastTickTime;
 
+   U32 mLastDifficultyUpdateTime;
+   F64 mHandshakeTime;           ///< Milliseconds spent on handshakes since the last difficulty update...
+   U32 mHandshakeLoad;           ///< ...and milliseconds per second spent on them before that
+
+   /// Starts a new puzzle, keeping the current one around as the previous one
+   void refreshNonce(U32 currentTime);
+
    Nonce mCurrentNonce;
    Nonce mLastNonce;
 
@@ -91,9 +99,14 @@ public:
    ~ClientPuzzleManager();
 
    /// Checks to see if a new nonce needs to be created, and if so
-   /// generates one and tosses out the current list of accepted nonces
+   /// generates one and tosses out the current list of accepted nonces.
+   /// Also adjusts the puzzle difficulty to the recent handshake load.
    void tick(U32 currentTime);
 
+   /// Records time spent handling a connection handshake packet, which
+   /// is what we base the puzzle difficulty on
+   void addHandshakeTime(F64 milliseconds);
+
    /// Error codes that can be returned by checkSolution
    enum ErrorCode {
       Success,
@@ -110,6 +123,11 @@ public:
       InitialPuzzleDifficulty    = 17, ///< Initial puzzle difficulty is set so clients do approx 2-3x the shared secret
                                        ///  generation of the server
       MaxPuzzleDifficulty        = 26, ///< Maximum puzzle difficulty is approx 1 minute to solve on ~2004 hardware.
+      MaxAdaptivePuzzleDifficulty = 22, ///< Highest difficulty we'll raise puzzles to on our own; any higher and legitimate
+                                       ///  clients on slow machines start running into PuzzleSolutionTimeout
+      DifficultyUpdateInterval   = 1000, ///< Milliseconds between adjustments of the puzzle difficulty
+      HighHandshakeLoad          = 50, ///< Milliseconds per second spent on handshakes above which puzzles get harder...
+      LowHandshakeLoad           = 10, ///< ...and below which they get easier again
       MaxSolutionComputeFragment = 30, ///< Number of milliseconds spent computing solution per call to solvePuzzle.
       SolutionFragmentIterations = 50000, ///< Number of attempts to spend on the client puzzle per call to solvePuzzle.
    };
@@ -137,6 +155,9 @@ public:
 
    /// Returns the current client puzzle difficulty
    U32 getCurrentDifficulty() { return mCurrentDifficulty; }
+
+   /// Returns the milliseconds per second spent handling handshakes, as of the last difficulty update
+   U32 getHandshakeLoad() { return mHandshakeLoad; }
 };
 
 };
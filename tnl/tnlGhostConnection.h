@@ -315,6 +315,9 @@ inline void GhostConnection::ghostPushNonZero(GhostInfo *info)
 
    mGhostZeroUpdateIndex++;
    //TNLAssert(validateGhostArray(), "Invalid ghost array!");
+
+   if(mGhostZeroUpdateIndex == 1)      // First thing to send
+      wake();
 }
 
 inline void GhostConnection::ghostPushToZero(GhostInfo *info)
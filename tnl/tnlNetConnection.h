@@ -47,6 +47,10 @@
 #include "tnlConnectionStringTable.h"
 #endif
 
+#ifndef _TNL_TIMERWHEEL_H_
+#include "tnlTimerWheel.h"
+#endif
+
 namespace TNL {
 
 class NetConnection;
@@ -473,6 +477,13 @@ public:
 
 protected:
    SafePtr<NetInterface> mInterface;             ///< The NetInterface of which this NetConnection is a member.
+
+   TimerWheel::Timer mServiceTimer;  ///< When our NetInterface next needs to look at this connection.
+   U32 mNextTimeoutCheckTime;        ///< When we're next due a checkTimeout() or, while pending, a retry.
+
+   /// Tells our NetInterface we may have something to send, so it looks at us on its next pass
+   /// rather than waiting until we were next due.
+   void wake();
 public:
    void setInterface(NetInterface *myInterface); ///< Sets the NetInterface this NetConnection will communicate through.
    NetInterface *getInterface();                 ///< Returns the NetInterface this connection communicates through.
@@ -559,6 +570,11 @@ public:
    /// If force is true and there is space in the window, it will always send a packet.
    void checkPacketSend(bool force, U32 currentTime);
 
+   /// Returns the earliest time after a checkPacketSend() at currentTime that another one could send
+   /// anything, assuming nothing is queued or received in the meantime (either of which will wake()
+   /// the connection anyway).
+   U32 getNextPacketSendTime(U32 currentTime);
+
    /// Connection state flags for a NetConnection instance.  If this list is modifed, please check if netInterface.cpp needs updates as well
    enum NetConnectionState {
       NotConnected=0,            ///< Initial state of a NetConnection instance - not connected
@@ -45,6 +45,10 @@
 #include "tnlNetConnection.h"
 #endif
 
+#ifndef _TNL_TIMERWHEEL_H_
+#include "tnlTimerWheel.h"
+#endif
+
 namespace TNL {
 
 class AsymmetricKey;
@@ -168,12 +172,22 @@ public:
       FirstValidInfoPacketId        = 8, /// The first valid ID for a NetInterface subclass's info packets.
    };
 
+   enum HandshakeLimits
+   {
+      HandshakeBucketCount = 1024,   /// Networks we track connect request rates for; a fixed number so a flood can't make us allocate.
+      HandshakeBurst = 16,           /// Connect requests a network (a /24 for IPv4) can send us in a burst...
+      HandshakeRefillTime = 100,     /// ...and the milliseconds it takes to earn another after that.
+   };
+
 protected:
    Vector<NetConnection *> mConnectionList;        /// List of all the connections that are in a connected state on this NetInterface.
    Vector<NetConnection *> mConnectionHashTable;   /// A resizable hash table for all connected connections.  This is a flat hash table (no buckets).
 
    Vector<NetConnection *> mPendingConnections;    /// List of connections that are in the startup state, where the remote host has not fully
                                                    /// validated the connection.
+   Vector<NetConnection *> mPendingConnectionHashTable;  /// Flat hash table of the pending connections, by address, like mConnectionHashTable.
+
+   TimerWheel mConnectionTimers;    /// When each connection, pending or connected, next has something to do.
 
    RefPtr<AsymmetricKey> mPrivateKey;  /// The private key used by this NetInterface for secure key exchange.
    RefPtr<Certificate> mCertificate;   /// A certificate, signed by some Certificate Authority, to authenticate this host.
@@ -192,7 +206,6 @@ protected:
 
    U32 mCurrentTime;            /// Current time tracked by this NetInterface.
    bool mRequiresKeyExchange;   /// True if all connections outgoing and incoming require key exchange.
-   U32  mLastTimeoutCheckTime;  /// Last time all the active connections were checked for timeouts.
    U8  mRandomHashData[12];     /// Data that gets hashed with connect challenge requests to prevent connection spoofing.
    bool mAllowConnections;      /// Set if this NetInterface allows connections from remote instances.
 
@@ -211,6 +224,19 @@ protected:
    };
    DelaySendPacket *mSendPacketList; /// List of delayed packets pending to send.
 
+   /// Token bucket limiting the connect requests we'll handle from a network.  Networks are hashed into a fixed
+   /// number of these, but each belongs to only one network at a time; another network that hashes to it takes
+   /// it over with a fresh burst, so nobody can use up the tokens of a network they don't send from.
+   struct HandshakeBucket
+   {
+      U32 network;
+      U32 lastRefillTime;
+      U32 tokens;
+   };
+   HandshakeBucket mHandshakeBuckets[HandshakeBucketCount];
+   U32 mHandshakeBucketSalt;    /// Keeps networks from knowing which others they share a bucket with.
+   U32 mDroppedHandshakeCount;  /// Connect requests dropped because their network was sending too many.
+
    enum NetInterfaceConstants {
       ChallengeRetryCount = 4,     /// Number of times to send connect challenge requests before giving up.
       ChallengeRetryTime = 2500,   /// Timeout interval in milliseconds before retrying connect challenge.
@@ -241,6 +267,22 @@ protected:
    /// Finds a connection by address from the pending list and removes it.
    void findAndRemovePendingConnection(const Address &address);
 
+   /// Changes the address of a pending connection, keeping the pending connection hash table up to date.
+   void setPendingConnectionAddress(NetConnection *conn, const Address &address);
+
+   /// Sets when processConnections() next needs to look at the connection.
+   void scheduleConnection(NetConnection *conn, U32 time);
+
+   /// Has processConnections() look at the connection on its next pass, if it wasn't going to already.
+   void wakeConnection(NetConnection *conn);
+
+   /// Sends whatever packet the connection is due to send, and checks it for timeouts when it's time to.
+   void processConnection(NetConnection *conn);
+
+   /// Resends a pending connection's handshake packets when they've gone unanswered, and gives up when
+   /// that doesn't help.
+   void processPendingConnection(NetConnection *conn);
+
    /// Adds a connection to the internal connection list.
    void addConnection(NetConnection *connection);
 
@@ -253,6 +295,10 @@ protected:
    /// Sends a connect challenge request on behalf of the connection to the remote host.
    void sendConnectChallengeRequest(NetConnection *conn);
 
+   /// Passes a connect challenge request or connect request on to the appropriate handler, recording how
+   /// long that took so the puzzle difficulty can follow the load.
+   void handleHandshakeRequest(const Address &address, U8 packetType, BitStream *stream);
+
    /// Handles a connect challenge request by replying to the requestor of a connection with a
    /// unique token for that connection, as well as (possibly) a client puzzle (for DoS prevention),
    /// or this NetInterface's public key.
@@ -381,6 +427,18 @@ public:
 
    /// returns the current process time for this NetInterface
    U32 getCurrentTime() { return mCurrentTime; }
+
+   /// Returns true if we should handle a connect request from address, using up one of its network's tokens if so.
+   bool allowHandshake(const Address &address, U32 currentTime);
+
+   /// Returns the number of connect requests dropped by allowHandshake() so far.
+   U32 getDroppedHandshakeCount() { return mDroppedHandshakeCount; }
+
+   /// Returns the number of connections in the startup state.
+   S32 getPendingConnectionCount() { return mPendingConnections.size(); }
+
+   /// Returns the object tracking our client puzzles and their difficulty.
+   ClientPuzzleManager &getPuzzleManager() { return mPuzzleManager; }
 };
 
 };
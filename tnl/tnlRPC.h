@@ -172,6 +172,13 @@ public: \
 /// All declared RPC methods create subclasses of RPCEvent to send data across the wire
 class RPCEvent : public NetEvent
 {
+   /// Number of times we've been packed so far
+   U32 mPackCount;
+   /// Our arguments, minus any strings, packed once for every connection we get sent to after the first.  See pack().
+   RefPtr<BitStream> mPackedArgs;
+   /// Strings left out of mPackedArgs, which have to be compressed separately for each connection
+   Vector<BitStream::RecordedString> mPackedStrings;
+
 public:
    Functor *mFunctor;
    /// Constructor call from within the rpc<i>Something</i> method generated by the TNL_IMPLEMENT_RPC macro.
@@ -0,0 +1,114 @@
+//-----------------------------------------------------------------------------------
+//
+//   Torque Network Library
+//   Copyright (C) 2004 GarageGames.com, Inc.
+//   Modifications (C) 2008 Chris Eykamp
+//   For more information see http://www.opentnl.org
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License as published by
+//   the Free Software Foundation; either version 2 of the License, or
+//   (at your option) any later version.
+//
+//   For use in products that are not compatible with the terms of the GNU
+//   General Public License, alternative licensing options are available
+//   from GarageGames.com.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   along with this program; if not, write to the Free Software
+//   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//------------------------------------------------------------------------------------
+
+#ifndef _TNL_TIMERWHEEL_H_
+#define _TNL_TIMERWHEEL_H_
+
+#ifndef _TNL_TYPES_H_
+#include "tnlTypes.h"
+#endif
+
+namespace TNL {
+
+/// A hierarchical timer wheel, for keeping track of when lots of things are next due without
+/// looking at all of them every time.
+///
+/// Timers due within the next 256 milliseconds go in a slot of their own for the millisecond
+/// they're due.  Later ones go into coarser slots of 256 milliseconds, and later still, of 16
+/// seconds, and get moved down into finer slots as their time comes closer.  Scheduling and
+/// canceling a timer are constant time, and advancing the wheel costs a look at one slot per
+/// millisecond passed, plus whatever has come due.
+///
+/// Timers are embedded in whatever they're timing, so nothing gets allocated, and a Timer takes
+/// itself out of the wheel when it's destroyed.
+class TimerWheel
+{
+public:
+   class Timer
+   {
+      friend class TimerWheel;
+
+      Timer *mNext;     ///< Next timer in the same slot; NULL if not scheduled
+      Timer *mPrev;     ///< Previous timer in the same slot
+      U32 mDueTime;     ///< Time, in milliseconds, when this timer is due
+      void *mUserData;  ///< Whatever this timer belongs to
+
+      void unlink();
+
+   public:
+      Timer(void *userData = NULL);
+      ~Timer();
+
+      void *getUserData() const { return mUserData; }
+      U32 getDueTime() const { return mDueTime; }
+      bool isScheduled() const { return mNext != NULL; }
+   };
+
+private:
+   enum {
+      NearSlotBits = 8,
+      FarSlotBits = 6,
+      NearSlotCount = 1 << NearSlotBits,
+      FarSlotCount = 1 << FarSlotBits,
+      FarLevelCount = 2,
+      MaxDelay = (1 << (NearSlotBits + FarSlotBits * FarLevelCount)) - 1,
+   };
+
+   Timer mNearSlots[NearSlotCount];
+   Timer mFarSlots[FarLevelCount][FarSlotCount];
+   Timer mDueList;            ///< Timers that have come due, but haven't been handed out by getNextDue() yet
+   Timer mLateList;           ///< Timers scheduled for a time we'd already advanced to, waiting for the next advance()
+
+   U32 mCurrentTime;          ///< Next millisecond we'll look at in advance()
+
+   void insert(Timer *timer);
+   bool cascade(U32 level);
+   static void append(Timer *list, Timer *timer);
+
+public:
+   TimerWheel(U32 currentTime);
+   ~TimerWheel();
+
+   /// Schedules timer for dueTime, moving it if it's already scheduled.  A timer scheduled for a
+   /// time the wheel has already been advanced to comes due at the next call to advance(), even
+   /// one for the same time, but never during the current one, so it can't be handed out twice.
+   void schedule(Timer *timer, U32 dueTime);
+
+   /// Takes timer out of the wheel, if it's in it.
+   void cancel(Timer *timer);
+
+   /// Moves all timers due at or before currentTime to the due list, for getNextDue() to hand out.
+   void advance(U32 currentTime);
+
+   /// Takes the next timer off the due list, or returns NULL if there are none left.  The timer is
+   /// no longer scheduled afterwards, and can be rescheduled right away.
+   Timer *getNextDue();
+};
+
+};
+
+#endif
@@ -0,0 +1,204 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "AudioWorker.h"
+
+#include "VoiceJitterBuffer.h"
+#include "voiceCodec.h"
+
+#include "tnlLog.h"
+#include "tnlPlatform.h"
+
+#include <string.h>
+
+namespace Zap
+{
+
+// Constructor
+AudioWorker::AudioWorker()
+{
+   mDroppedSamples = 0;
+   mExitNow = false;
+   mRunning = false;
+}
+
+
+// Destructor
+AudioWorker::~AudioWorker()
+{
+   // Subclasses should stop us themselves, while their process() is still around to be called
+   TNLAssert(!mRunning, "Stop the thread before deleting it!");
+   stopThread();
+
+   for(S32 i = 0; i < mSpeakers.size(); i++)
+      delete mSpeakers[i].buffer;
+}
+
+
+VoiceDecoder *AudioWorker::createDecoder()
+{
+   return new SpeexVoiceDecoder();
+}
+
+
+// Returns false if we couldn't get a thread; caller will have to call process() itself
+bool AudioWorker::startThread()
+{
+   mExitNow = false;
+   mRunning = true;
+
+   if(!start())
+   {
+      logprintf(LogConsumer::LogWarning, "Failed to create audio thread; voice chat will be decoded on the game thread");
+      mRunning = false;
+   }
+
+   return mRunning;
+}
+
+
+void AudioWorker::stopThread()
+{
+   mExitNow = true;
+
+   while(mRunning)         // Wait until the other thread is done
+      Platform::sleep(1);
+}
+
+
+bool AudioWorker::isRunning() const
+{
+   return mRunning;
+}
+
+
+U32 AudioWorker::run()
+{
+   while(!mExitNow)
+   {
+      process(Platform::getRealMilliseconds());
+      Platform::sleep(UpdateInterval);
+   }
+
+   mRunning = false;
+   return 0;
+}
+
+
+// Returns false if the worker is too far behind to take the packet, in which case it's dropped
+bool AudioWorker::addVoicePacket(U32 speakerId, const U8 *data, U32 size)
+{
+   flushRemovals();
+
+   VoicePacket packet;
+   packet.speakerId = speakerId;
+   packet.speakerGone = false;
+   packet.data.resize(size);
+   memcpy(packet.data.address(), data, size);
+
+   return mPackets.push(packet);
+}
+
+
+void AudioWorker::removeSpeaker(U32 speakerId)
+{
+   mPendingRemovals.push_back(speakerId);
+   flushRemovals();
+}
+
+
+void AudioWorker::flushRemovals()
+{
+   while(mPendingRemovals.size() > 0)
+   {
+      VoicePacket packet;
+      packet.speakerId = mPendingRemovals.last();
+      packet.speakerGone = true;
+
+      if(!mPackets.push(packet))
+         return;
+
+      mPendingRemovals.pop_back();
+   }
+}
+
+
+bool AudioWorker::getVoiceSamples(VoiceSamples &samples)
+{
+   flushRemovals();
+
+   return mSamples.pop(samples);
+}
+
+
+// Decode whatever has arrived, and pass along whatever's due to be played
+void AudioWorker::process(U32 currentTime)
+{
+   VoicePacket packet;
+
+   while(mPackets.pop(packet))
+   {
+      S32 index = findSpeaker(packet.speakerId);
+
+      if(packet.speakerGone)
+      {
+         if(index != -1)
+         {
+            delete mSpeakers[index].buffer;
+            mSpeakers.erase_fast(index);
+         }
+
+         continue;
+      }
+
+      if(index == -1)
+      {
+         Speaker speaker;
+         speaker.id = packet.speakerId;
+         speaker.buffer = new VoiceJitterBuffer(createDecoder());     // Deleted when speaker leaves, or in destructor
+
+         mSpeakers.push_back(speaker);
+         index = mSpeakers.size() - 1;
+      }
+
+      mSpeakers[index].buffer->addPacket(packet.data.address(), packet.data.size(), currentTime);
+   }
+
+   for(S32 i = 0; i < mSpeakers.size(); i++)
+   {
+      VoiceSamples samples;
+      samples.speakerId = mSpeakers[i].id;
+
+      mSpeakers[i].buffer->readSamples(currentTime, samples.samples);
+
+      if(samples.samples.size() > 0 && !mSamples.push(samples))
+         mDroppedSamples += samples.samples.size();      // Game thread isn't keeping up; nothing to do but drop it
+   }
+}
+
+
+S32 AudioWorker::findSpeaker(U32 speakerId) const
+{
+   for(S32 i = 0; i < mSpeakers.size(); i++)
+      if(mSpeakers[i].id == speakerId)
+         return i;
+
+   return -1;
+}
+
+
+S32 AudioWorker::getSpeakerCount() const
+{
+   return mSpeakers.size();
+}
+
+
+U32 AudioWorker::getDroppedSamples() const
+{
+   return mDroppedSamples;
+}
+
+
+};
@@ -0,0 +1,98 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _AUDIO_WORKER_H_
+#define _AUDIO_WORKER_H_
+
+#include "LockFreeQueue.h"
+
+#include "tnlThread.h"
+#include "tnlTypes.h"
+#include "tnlVector.h"
+
+using namespace TNL;
+
+namespace Zap
+{
+
+class VoiceDecoder;
+class VoiceJitterBuffer;
+
+// Decodes incoming voice chat on its own thread, so a few teammates talking at once doesn't cost us frames.  The game
+// thread hands over compressed packets as they arrive and picks up decoded samples ready to queue on a sound source;
+// neither side ever waits on the other.
+//
+// Speakers are identified by ids the game thread makes up; each gets its own decoder and jitter buffer here.
+class AudioWorker : public Thread
+{
+public:
+   static const U32 QueueSize = 256;         // Packets, or blocks of samples, in flight each way
+   static const U32 UpdateInterval = 10;     // Ms between passes over our speakers
+
+   struct VoicePacket
+   {
+      U32 speakerId;
+      bool speakerGone;       // Speaker has left; forget about them
+      Vector<U8> data;
+   };
+
+   struct VoiceSamples
+   {
+      U32 speakerId;
+      Vector<S16> samples;
+   };
+
+private:
+   struct Speaker
+   {
+      U32 id;
+      VoiceJitterBuffer *buffer;
+   };
+
+   // Game thread to worker
+   LockFreeQueue<VoicePacket, QueueSize> mPackets;
+   Vector<U32> mPendingRemovals;             // Game thread only: speakers we couldn't squeeze into mPackets yet
+
+   // Worker to game thread
+   LockFreeQueue<VoiceSamples, QueueSize> mSamples;
+
+   // Worker only
+   Vector<Speaker> mSpeakers;
+   U32 mDroppedSamples;
+
+   volatile bool mExitNow;
+   volatile bool mRunning;
+
+   S32 findSpeaker(U32 speakerId) const;
+   void flushRemovals();
+
+protected:
+   virtual VoiceDecoder *createDecoder();
+
+public:
+   AudioWorker();             // Constructor
+   virtual ~AudioWorker();    // Destructor
+
+   // Game thread
+   bool startThread();
+   void stopThread();
+   bool isRunning() const;
+
+   bool addVoicePacket(U32 speakerId, const U8 *data, U32 size);
+   void removeSpeaker(U32 speakerId);
+   bool getVoiceSamples(VoiceSamples &samples);
+
+   // Worker thread, or the game thread if we couldn't start one
+   virtual void process(U32 currentTime);
+   U32 run();
+
+   S32 getSpeakerCount() const;
+   U32 getDroppedSamples() const;
+};
+
+
+};
+
+#endif
@@ -0,0 +1,148 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "BinaryBuffer.h"
+
+#include <fstream>
+
+namespace Zap
+{
+
+// Constructor
+BinaryWriter::BinaryWriter()
+{
+   // Do nothing
+}
+
+
+// Destructor
+BinaryWriter::~BinaryWriter()
+{
+   // Do nothing
+}
+
+
+void BinaryWriter::writePoint(const Point &point)
+{
+   write(point.x);
+   write(point.y);
+}
+
+
+void BinaryWriter::writeBytes(const string &bytes)
+{
+   mBuffer.append(bytes);
+}
+
+
+void BinaryWriter::writeString(const string &str)
+{
+   write((U32)str.length());
+   mBuffer.append(str.c_str(), str.length() + 1);     // Include the null
+}
+
+
+const string &BinaryWriter::getBuffer() const
+{
+   return mBuffer;
+}
+
+
+bool BinaryWriter::writeToFile(const string &path) const
+{
+   ofstream file(path.c_str(), ios_base::out | ios_base::binary);
+
+   if(!file.is_open())
+      return false;
+
+   file.write(mBuffer.data(), mBuffer.length());
+
+   return file.good();
+}
+
+
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Constructor
+BinaryReader::BinaryReader(const string &buffer) : mBuffer(buffer)
+{
+   mPos = 0;
+   mOk = true;
+}
+
+
+// Destructor
+BinaryReader::~BinaryReader()
+{
+   // Do nothing
+}
+
+
+bool BinaryReader::checkAvailable(size_t length)
+{
+   if(mOk && length > mBuffer.length() - mPos)
+      mOk = false;
+
+   return mOk;
+}
+
+
+Point BinaryReader::readPoint()
+{
+   F32 x = read<F32>();
+   F32 y = read<F32>();
+
+   return Point(x, y);
+}
+
+
+string BinaryReader::readBytes(size_t length)
+{
+   if(!checkAvailable(length))
+      return "";
+
+   mPos += length;
+   return mBuffer.substr(mPos - length, length);
+}
+
+
+const char *BinaryReader::readString()
+{
+   U32 length = read<U32>();
+
+   // Need room for the chars and the null
+   if(!mOk || length >= mBuffer.length() - mPos || mBuffer[mPos + length] != '\0')
+   {
+      mOk = false;
+      return "";
+   }
+
+   const char *str = mBuffer.data() + mPos;
+   mPos += length + 1;
+
+   return str;
+}
+
+
+void BinaryReader::setBad()
+{
+   mOk = false;
+}
+
+
+bool BinaryReader::isOk() const
+{
+   return mOk;
+}
+
+
+bool BinaryReader::isAtEnd() const
+{
+   return mPos == mBuffer.length();
+}
+
+
+}
@@ -0,0 +1,92 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _BINARY_BUFFER_H_
+#define _BINARY_BUFFER_H_
+
+#include "Point.h"
+
+#include "tnlTypes.h"
+
+#include <string>
+#include <string.h>     // For memcpy
+
+using namespace std;
+using namespace TNL;
+
+namespace Zap
+{
+
+// Simple helpers for our binary cache files.  Values are written in native byte order, so anything that might be
+// moved to a different machine should include something in its header that lets the reader detect a mismatch.
+class BinaryWriter
+{
+private:
+   string mBuffer;
+
+public:
+   BinaryWriter();            // Constructor
+   virtual ~BinaryWriter();   // Destructor
+
+   template <class T>
+   void write(const T &val)
+   {
+      mBuffer.append((const char *)&val, sizeof(T));
+   }
+
+   void writePoint(const Point &point);
+   void writeBytes(const string &bytes);     // Raw, with no length
+   void writeString(const string &str);      // Length, chars, and a terminating null
+
+   const string &getBuffer() const;
+   bool writeToFile(const string &path) const;     // Returns false if the file couldn't be written
+};
+
+
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Reads values written by BinaryWriter, keeping track of whether we've tried to read past the end of the buffer.
+// Once that happens, isOk() returns false and all further reads return empty values.
+class BinaryReader
+{
+private:
+   const string &mBuffer;     // Must outlive the reader
+   size_t mPos;
+   bool mOk;
+
+   bool checkAvailable(size_t length);
+
+public:
+   explicit BinaryReader(const string &buffer);    // Constructor
+   virtual ~BinaryReader();                        // Destructor
+
+   template <class T>
+   T read()
+   {
+      T val = T();
+
+      if(checkAvailable(sizeof(T)))
+      {
+         memcpy(&val, mBuffer.data() + mPos, sizeof(T));
+         mPos += sizeof(T);
+      }
+
+      return val;
+   }
+
+   Point readPoint();
+   string readBytes(size_t length);
+   const char *readString();        // Points into the buffer, so no copying
+
+   void setBad();
+   bool isOk() const;
+   bool isAtEnd() const;
+};
+
+
+}
+
+#endif
@@ -5,6 +5,7 @@
 
 #include "BotNavMeshZone.h"
 
+#include "BinaryBuffer.h"
 #include "barrier.h"                // For Barrier methods in generating zones
 #include "EngineeredItem.h"         // For Turret and ForceFieldProjector methods in generating zones
 #include "GameObjectRender.h"
@@ -12,6 +13,8 @@
 #include "Teleporter.h"             // For Teleporter::TELEPORTER_RADIUS
 #include "GeomUtils.h"
 #include "MathUtils.h"
+#include "Md5Utils.h"
+#include "stringUtils.h"
 
 #include "tnlLog.h"
 
@@ -45,6 +48,13 @@ const S32 BotNavMeshZone::BufferRadius = Ship::CollisionRadius;  // Radius to bu
 // Make sure we always have 50 for good measure
 const S32 BotNavMeshZone::LevelZoneBuffer = MAX(BufferRadius * 2, 50);
 
+string BotNavMeshZone::CacheDir = "";     // Set in FolderManager::resolveDirs()
+
+static const char *CacheFileMagic = "BFNM";
+static const U32 CacheFormatVersion = 1;           // Bump this whenever the zone building code changes its output
+static const S32 MaxCacheFiles = 500;              // Cache is cleared when it gets bigger than this
+static const string CacheFileExtension = "navmesh";
+
 
 // Constructor
 BotNavMeshZone::BotNavMeshZone(S32 id)
@@ -290,14 +300,12 @@ static BotNavMeshZone *findZoneTouchingCircle(const GridDatabase *botZoneDatabas
 #  define LOG_TIMER
 #endif
 
-static bool mergeBotZoneBuffers(const Vector<DatabaseObject *> &barriers,
-                                const Vector<DatabaseObject *> &turrets,
-                                const Vector<DatabaseObject *> &forceFieldProjectors, 
-                                F32 bufferRadius,   PolyTree &solution)
+// Fills inputPolygons with the buffered outlines of everything bots need to steer around
+static void getBotZoneBuffers(const Vector<DatabaseObject *> &barriers,
+                              const Vector<DatabaseObject *> &turrets,
+                              const Vector<DatabaseObject *> &forceFieldProjectors, 
+                              F32 bufferRadius, Vector<Vector<Point> > &inputPolygons)
 {
-
-   Vector<Vector<Point> > inputPolygons;
-
    // Add barriers (PolyWalls are Barriers on the server)
    for(S32 i = 0; i < barriers.size(); i++)
    {
@@ -352,6 +360,16 @@ static bool mergeBotZoneBuffers(const Vector<DatabaseObject *> &barriers,
          inputPolygons[i][j].x = (F32)floor(inputPolygons[i][j].x);
          inputPolygons[i][j].y = (F32)floor(inputPolygons[i][j].y);
       }
+}
+
+
+static bool mergeBotZoneBuffers(const Vector<DatabaseObject *> &barriers,
+                                const Vector<DatabaseObject *> &turrets,
+                                const Vector<DatabaseObject *> &forceFieldProjectors, 
+                                F32 bufferRadius,   PolyTree &solution)
+{
+   Vector<Vector<Point> > inputPolygons;
+   getBotZoneBuffers(barriers, turrets, forceFieldProjectors, bufferRadius, inputPolygons);
 
    return mergePolysToPolyTree(inputPolygons, solution);
 }
@@ -434,13 +452,22 @@ bool BotNavMeshZone::buildBotMeshZones(GridDatabase &botZoneDatabase, Vector<Bot
       return false;
    }
 
+   Vector<Vector<Point> > inputPolygons;
+   getBotZoneBuffers(barrierList, turretList, forceFieldProjectorList, (F32)BufferRadius, inputPolygons);
+
+   // Zones depend only on the geometry gathered so far, so if we've seen it before, we can skip all the hard work
+   string cacheKey = getCacheKey(bounds, inputPolygons, teleporterData);
+
+   if(loadZonesFromCache(cacheKey, botZoneDatabase, allZones, triangulateZones))
+      return true;
+
    Vector<F32> holes;
    PolyTree solution;
 
    // Merge bot zone buffers from barriers, turrets, and forcefield projectors
    // The Clipper library is the work horse here.  Its output is essential for the
    // triangulation.  The output contains the upscaled Clipper points (you will need to downscale)
-   if(!mergeBotZoneBuffers(barrierList, turretList, forceFieldProjectorList, (F32)BufferRadius, solution))
+   if(!mergePolysToPolyTree(inputPolygons, solution))
       return false;
 
 
@@ -540,6 +567,8 @@ bool BotNavMeshZone::buildBotMeshZones(GridDatabase &botZoneDatabase, Vector<Bot
 
       buildBotNavMeshZoneConnectionsRecastStyle(allZones, mesh, polyToZoneMap);
       linkTeleportersBotNavMeshZoneConnections(&botZoneDatabase, teleporterData);
+
+      saveZonesToCache(cacheKey, allZones);
    }
 
    // If recast failed, build zones from the underlying triangle geometry.  This bit could be made more efficient by using the adjacnecy
@@ -582,6 +611,177 @@ bool BotNavMeshZone::buildBotMeshZones(GridDatabase &botZoneDatabase, Vector<Bot
 }
 
 
+////////////////////////////////////////
+////////////////////////////////////////
+// Zone cache
+//
+// Each cache file holds the zones and neighbor data built from one set of inputs.  Files are named after a hash of
+// those inputs, so when a level's geometry (or our build parameters) change, we simply look for a different file.  
+// Files never leave the machine that wrote them, so byte order is not a concern.
+
+// Static method
+string BotNavMeshZone::getCacheKey(const Rect &bounds, const Vector<Vector<Point> > &inputPolygons,
+                                   const Vector<pair<Point, const Vector<Point> *> > &teleporterData)
+{
+   BinaryWriter data;
+
+   data.write(CacheFormatVersion);
+   data.write(BufferRadius);
+   data.write(LevelZoneBuffer);
+   data.write(MAX_ZONES);
+
+   data.writePoint(bounds.min);
+   data.writePoint(bounds.max);
+
+   data.write(inputPolygons.size());
+   for(S32 i = 0; i < inputPolygons.size(); i++)
+   {
+      data.write(inputPolygons[i].size());
+      for(S32 j = 0; j < inputPolygons[i].size(); j++)
+         data.writePoint(inputPolygons[i][j]);
+   }
+
+   data.write(teleporterData.size());
+   for(S32 i = 0; i < teleporterData.size(); i++)
+   {
+      data.writePoint(teleporterData[i].first);
+      data.write(teleporterData[i].second->size());
+
+      for(S32 j = 0; j < teleporterData[i].second->size(); j++)
+         data.writePoint(teleporterData[i].second->get(j));
+   }
+
+   return Md5::getHashFromString(data.getBuffer());
+}
+
+
+// Static method
+string BotNavMeshZone::getCacheFileName(const string &key)
+{
+   return joindir(CacheDir, key + "." + CacheFileExtension);
+}
+
+
+// Static method -- returns true if zones were found in the cache and loaded
+bool BotNavMeshZone::loadZonesFromCache(const string &key, GridDatabase &botZoneDatabase, Vector<BotNavMeshZone *> &allZones,
+                                        bool triangulateZones)
+{
+   if(CacheDir == "")
+      return false;
+
+   string contents;
+   if(!readFile(getCacheFileName(key), contents))
+      return false;
+
+   BinaryReader reader(contents);
+
+   if(reader.readBytes(strlen(CacheFileMagic)) != CacheFileMagic || reader.read<U32>() != CacheFormatVersion ||
+      reader.readBytes(key.length()) != key)
+      return false;
+
+   U32 zoneCount = reader.read<U32>();
+
+   if(!reader.isOk() || zoneCount > (U32)MAX_ZONES)
+      return false;
+
+   for(U32 i = 0; i < zoneCount && reader.isOk(); i++)
+   {
+      BotNavMeshZone *botzone = new BotNavMeshZone(i);
+
+      if(!triangulateZones)
+         botzone->disableTriangulation();
+
+      U16 vertCount = reader.read<U16>();
+      for(U16 j = 0; j < vertCount; j++)
+         botzone->addVert(reader.readPoint());
+
+      U16 neighborCount = reader.read<U16>();
+      botzone->mNeighbors.resize(neighborCount);
+
+      for(U16 j = 0; j < neighborCount; j++)
+      {
+         NeighboringZone &neighbor = botzone->mNeighbors[j];
+
+         neighbor.zoneID       = reader.read<U16>();
+         neighbor.borderStart  = reader.readPoint();
+         neighbor.borderEnd    = reader.readPoint();
+         neighbor.borderCenter = reader.readPoint();
+         neighbor.center       = reader.readPoint();
+         neighbor.distTo       = reader.read<F32>();
+
+         if(neighbor.zoneID >= zoneCount)
+            reader.setBad();
+      }
+
+      botzone->addToZoneDatabase(&botZoneDatabase);
+   }
+
+   if(!reader.isOk() || !reader.isAtEnd())      // File is corrupt; get rid of what we loaded and build from scratch
+   {
+      logprintf(LogConsumer::LogWarning, "Ignoring corrupt bot zone cache file %s", getCacheFileName(key).c_str());
+
+      populateZoneList(&botZoneDatabase, &allZones);
+      allZones.deleteAndClear();
+      return false;
+   }
+
+   populateZoneList(&botZoneDatabase, &allZones);
+
+   return true;
+}
+
+
+// Static method
+void BotNavMeshZone::saveZonesToCache(const string &key, const Vector<BotNavMeshZone *> &allZones)
+{
+   if(CacheDir == "" || !makeSureFolderExists(CacheDir))
+      return;
+
+   // Don't let the cache grow forever -- levelgens can make a new set of geometry every time a level is played
+   Vector<string> cacheFiles;
+   getFilesFromFolder(CacheDir, cacheFiles, FULL_PATH, &CacheFileExtension, 1);
+
+   if(cacheFiles.size() >= MaxCacheFiles)
+      for(S32 i = 0; i < cacheFiles.size(); i++)
+         remove(cacheFiles[i].c_str());
+
+   BinaryWriter data;
+
+   data.writeBytes(CacheFileMagic);
+   data.write(CacheFormatVersion);
+   data.writeBytes(key);
+   data.write((U32)allZones.size());
+
+   for(S32 i = 0; i < allZones.size(); i++)
+   {
+      const BotNavMeshZone *zone = allZones[i];
+      const Vector<Point> *outline = zone->getOutline();
+
+      TNLAssert(zone->mZoneId == i, "Zone ids should match their position in the list!");
+
+      data.write((U16)outline->size());
+      for(S32 j = 0; j < outline->size(); j++)
+         data.writePoint(outline->get(j));
+
+      data.write((U16)zone->mNeighbors.size());
+      for(S32 j = 0; j < zone->mNeighbors.size(); j++)
+      {
+         const NeighboringZone &neighbor = zone->mNeighbors[j];
+
+         data.write(neighbor.zoneID);
+         data.writePoint(neighbor.borderStart);
+         data.writePoint(neighbor.borderEnd);
+         data.writePoint(neighbor.borderCenter);
+         data.writePoint(neighbor.center);
+         data.write(neighbor.distTo);
+      }
+   }
+
+   if(!data.writeToFile(getCacheFileName(key)))
+      logprintf(LogConsumer::LogWarning, "Could not write bot zone cache file %s", getCacheFileName(key).c_str());
+}
+
+
 inline F32 getTriangleArea(const Point &p1, const Point &p2, const Point &p3)
 {
    F32 area = ((p2.x - p1.x) * (p3.y - p1.y) - (p3.x - p1.x) * (p2.y - p1.y)) / 2;
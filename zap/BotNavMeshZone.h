@@ -53,6 +53,14 @@ private:
 
    static void populateZoneList(GridDatabase *mBotZoneDatabase, Vector<BotNavMeshZone *> *allZones);  // Populates allZones
 
+   // Zone cache
+   static string getCacheKey(const Rect &bounds, const Vector<Vector<Point> > &inputPolygons,
+                             const Vector<pair<Point, const Vector<Point> *> > &teleporterData);
+   static string getCacheFileName(const string &key);
+   static bool loadZonesFromCache(const string &key, GridDatabase &botZoneDatabase, Vector<BotNavMeshZone *> &allZones,
+                                  bool triangulateZones);
+   static void saveZonesToCache(const string &key, const Vector<BotNavMeshZone *> &allZones);
+
 public:
    explicit BotNavMeshZone(S32 id = -1);     // Constructor
    virtual ~BotNavMeshZone();                // Destructor
@@ -60,6 +68,8 @@ public:
    static const S32 BufferRadius;            // Radius to buffer objects when creating the holes for zones
    static const S32 LevelZoneBuffer;         // Extra padding around the game extents to allow outsize zones to be created
 
+   static string CacheDir;                   // Where built zones are cached; "" disables caching
+
    void renderLayer(S32 layerIndex);
 
    GridDatabase *getGameObjDatabase();
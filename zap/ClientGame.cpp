@@ -860,6 +860,19 @@ void ClientGame::gotServerListFromMaster(const Vector<ServerAddr> &serverList)
 }
 
 
+void ClientGame::gotServerStatusFromMaster(const Address &address, S32 serverId, const char *serverName, const char *serverDescr,
+                                           U32 playerCount, U32 maxPlayers, U32 botCount, bool test)
+{
+   mUIManager->gotServerStatusFromMaster(address, serverId, serverName, serverDescr, playerCount, maxPlayers, botCount, test);
+}
+
+
+void ClientGame::gotServerRemovedFromMaster(S32 serverId)
+{
+   mUIManager->gotServerRemovedFromMaster(serverId);
+}
+
+
 void ClientGame::setGameType(GameType *gameType)
 {
    Parent::setGameType(gameType);
@@ -927,6 +940,37 @@ void ClientGame::gotVoiceChat(const StringTableEntry &from, const ByteBufferPtr
 }
 
 
+// The server has already left out anyone we've muted
+void ClientGame::gotMixedVoiceChat(S32 teamIndex, U32 streamId, const ByteBufferPtr &voiceBuffer)
+{
+   S32 index = -1;
+   for(S32 i = 0; i < mMixedVoice.size(); i++)
+      if(mMixedVoice[i].teamIndex == teamIndex)
+         index = i;
+
+   if(index == -1)
+   {
+      MixedVoice mixedVoice;
+      mixedVoice.teamIndex = teamIndex;
+      mixedVoice.streamId = 0;
+
+      mMixedVoice.push_back(mixedVoice);
+      index = mMixedVoice.size() - 1;
+   }
+
+   MixedVoice &mixedVoice = mMixedVoice[index];
+
+   // Dropping the old effect drops its decoder along with it
+   if(mixedVoice.voiceSFX.isNull() || mixedVoice.streamId != streamId)
+   {
+      mixedVoice.streamId = streamId;
+      mixedVoice.voiceSFX = new SoundEffect(SFXVoice, NULL, 1, Point(), Point());    // RefPtr, will self-delete
+   }
+
+   queueVoiceChatBuffer(mixedVoice.voiceSFX, voiceBuffer);      // Decoded on the audio thread
+}
+
+
 void ClientGame::activatePlayerMenuUi()
 {
    mUIManager->showPlayerActionMenu(PlayerActionChangeTeam);
@@ -943,6 +987,8 @@ void ClientGame::gameTypeIsAboutToBeDeleted()
 {
    // Quit EngineerHelper when level changes, or when current GameType gets removed
    quitEngineerHelper();
+
+   mMixedVoice.clear();    // We may be on another server next time, with its own stream ids
 }
 
 
@@ -1419,11 +1465,19 @@ bool ClientGame::isOnMuteList(const string &name)
 void ClientGame::addToVoiceMuteList(const string &name)
 {
    mVoiceMuteList.push_back(name);
+
+   // The server needs to know too, or it would mix them into everything we hear
+   GameConnection *conn = getConnectionToServer();
+   if(conn)
+      conn->c2sSetVoiceMute(name, true);
 }
 
 
 void ClientGame::removeFromVoiceMuteList(const string &name)
 {
+   GameConnection *conn = getConnectionToServer();
+   if(conn)
+      conn->c2sSetVoiceMute(name, false);
 
    for(S32 i = 0; i < mVoiceMuteList.size(); i++)
       if(mVoiceMuteList[i] == name)
@@ -1444,6 +1498,12 @@ bool ClientGame::isOnVoiceMuteList(const string &name)
 }
 
 
+const Vector<string> &ClientGame::getVoiceMuteList() const
+{
+   return mVoiceMuteList;
+}
+
+
 string ClientGame::getRemoteLevelDownloadFilename() const
 {
    return mRemoteLevelDownloadFilename;
@@ -49,6 +49,16 @@ private:
    Vector<string> mMuteList;        // List of players we aren't listening to anymore because they've annoyed us!
    Vector<string> mVoiceMuteList;   // List of players we mute because they are abusing voice chat
 
+   // Mixed voice chat from the server; every stream comes from a different encoder, so each needs a fresh decoder
+   struct MixedVoice
+   {
+      S32 teamIndex;
+      U32 streamId;
+      SFXHandle voiceSFX;
+   };
+
+   Vector<MixedVoice> mMixedVoice;
+
    string mEnteredServerPermsPassword;
    string mEnteredServerAccessPassword;
 
@@ -175,6 +185,9 @@ public:
    F32 getObjectiveArrowHighlightAlpha() const;
 
    void gotServerListFromMaster(const Vector<ServerAddr> &serverList);
+   void gotServerStatusFromMaster(const Address &address, S32 serverId, const char *serverName, const char *serverDescr,
+                                  U32 playerCount, U32 maxPlayers, U32 botCount, bool test);
+   void gotServerRemovedFromMaster(S32 serverId);
 
    // Got some shizzle
    void gotLobbyChatMessage(const char *playerNick, const char *message, bool isPrivate);
@@ -182,6 +195,7 @@ public:
    void gotChatPM(const StringTableEntry &fromName, const StringTableEntry &toName, const StringPtr &message);
    void gotAnnouncement(const string &announcement);
    void gotVoiceChat(const StringTableEntry &from, const ByteBufferPtr &voiceBuffer);
+   void gotMixedVoiceChat(S32 teamIndex, U32 streamId, const ByteBufferPtr &voiceBuffer);
 
    void gameTypeIsAboutToBeDeleted();
    void activatePlayerMenuUi();
@@ -260,6 +274,7 @@ public:
    void addToVoiceMuteList(const string &name);
    void removeFromVoiceMuteList(const string &name);
    bool isOnVoiceMuteList(const string &name);
+   const Vector<string> &getVoiceMuteList() const;
 
    void connectionToServerRejected(const char *reason);
    void setMOTD(const string &motd);
@@ -10,7 +10,6 @@
 #include "EngineeredItem.h"   // For EngineerModuleDeployer def
 #include "ServerGame.h"
 #include "ship.h"
-#include "voiceCodec.h"       // This should be removed
 
 
 class Game;
@@ -752,13 +751,6 @@ SoundEffect *FullClientInfo::getVoiceSFX()
 }
 
 
-VoiceDecoder *FullClientInfo::getVoiceDecoder()
-{
-   TNLAssert(false, "Can't access VoiceDecoder from this class!");
-   return NULL;
-}
-
-
 void FullClientInfo::playVoiceChat(const ByteBufferPtr &voiceBuffer)
 {
    TNLAssert(false, "Can't play voice from this class!");
@@ -819,7 +811,6 @@ RemoteClientInfo::RemoteClientInfo(Game *game, const StringTableEntry &name, boo
    mCurrentKillStreak = killStreak;
 
    // Initialize speech stuff
-   mDecoder = new SpeexVoiceDecoder();                                  // Deleted in destructor
    mVoiceSFX = new SoundEffect(SFXVoice, NULL, 1, Point(), Point());    // RefPtr, will self-delete
 }
 
@@ -827,7 +818,7 @@ RemoteClientInfo::RemoteClientInfo(Game *game, const StringTableEntry &name, boo
 // Destructor
 RemoteClientInfo::~RemoteClientInfo()
 {
-   delete mDecoder;
+   // Do nothing
 }
 
 
@@ -875,16 +866,9 @@ SoundEffect *RemoteClientInfo::getVoiceSFX()
 }
 
 
-VoiceDecoder *RemoteClientInfo::getVoiceDecoder()
-{
-   return mDecoder;
-}
-
-
 void RemoteClientInfo::playVoiceChat(const ByteBufferPtr &voiceBuffer)
 {
-   ByteBufferPtr playBuffer = getVoiceDecoder()->decompressBuffer(voiceBuffer);
-   mGame->queueVoiceChatBuffer(getVoiceSFX(), playBuffer);
+   mGame->queueVoiceChatBuffer(getVoiceSFX(), voiceBuffer);      // Decoded on the audio thread
 }
 
 
@@ -24,7 +24,6 @@ class Game;
 class GameConnection;
 class Ship;
 class SoundEffect;
-class VoiceDecoder;
 
 class LuaPlayerInfo;
 
@@ -207,7 +206,6 @@ public:
    void requireReturnToGameTimer(bool required);
 
    virtual SoundEffect *getVoiceSFX() = 0;
-   virtual VoiceDecoder *getVoiceDecoder() = 0;
    virtual void playVoiceChat(const ByteBufferPtr &voiceBuffer) = 0;
 
    virtual bool isEngineeringTeleporter() = 0;
@@ -250,7 +248,6 @@ public:
    ClientClass getClientClass() const;
 
    SoundEffect *getVoiceSFX();
-   VoiceDecoder *getVoiceDecoder();
    void playVoiceChat(const ByteBufferPtr &voiceBuffer);
 
    bool isEngineeringTeleporter();
@@ -273,8 +270,7 @@ private:
    F32 mRating;      // Ratings are provided by the server and stored here
 
    // For voice chat
-   RefPtr<SoundEffect> mVoiceSFX;
-   VoiceDecoder *mDecoder;
+   RefPtr<SoundEffect> mVoiceSFX;      // Voice is decoded on the audio thread, which keeps a decoder for each speaker
 
    bool mIsRobot;
 
@@ -297,7 +293,6 @@ public:
 
    // Voice chat stuff -- these will be invalid on the server side
    SoundEffect *getVoiceSFX();
-   VoiceDecoder *getVoiceDecoder();
    void playVoiceChat(const ByteBufferPtr &voiceBuffer);
 
    bool isEngineeringTeleporter();
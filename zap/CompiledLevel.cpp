@@ -0,0 +1,321 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "CompiledLevel.h"
+
+#include "BinaryBuffer.h"
+#include "Level.h"
+#include "LevelSource.h"
+#include "Md5Utils.h"
+#include "stringUtils.h"
+
+#include "tnlLog.h"
+
+#include <sstream>
+
+namespace Zap
+{
+
+static const string FileMagic = "BFLC";
+
+const string CompiledLevel::FileExtension = "levelc";
+string CompiledLevel::CacheDir = "";      // Set in FolderManager::resolveDirs()
+
+
+// Static method -- foo.level is compiled to foo.levelc
+string CompiledLevel::getCompiledFileName(const string &sourceFile)
+{
+   return stripExtension(sourceFile) + "." + FileExtension;
+}
+
+
+// Static method -- where we'd cache a compiled version of sourceFile; different folders can have levels with the
+// same name, so we name these after the whole path
+string CompiledLevel::getCacheFileName(const string &sourceFile)
+{
+   return joindir(CacheDir, Md5::getHashFromString(sourceFile) + "." + FileExtension);
+}
+
+
+// Static method -- sourceSize and sourceTime are stored so we can tell later if the source has changed
+string CompiledLevel::compile(const string &levelCode, U64 sourceSize, U64 sourceTime)
+{
+   BinaryWriter data;
+   compile(levelCode, sourceSize, sourceTime, data);
+
+   return data.getBuffer();
+}
+
+
+// Static method
+void CompiledLevel::compile(const string &levelCode, U64 sourceSize, U64 sourceTime, BinaryWriter &data)
+{
+   // Get the same info MultiLevelSource would get by reading the start of the file
+   LevelInfoDb::LevelHeader levelHeader;
+   LevelSource::getLevelHeaderFromCodeChunk(levelCode.substr(0, 1024 * 4), levelHeader);
+
+   BinaryWriter lines;
+   U32 lineCount = 0;
+
+   // Hash must match what Level::getHash() would give us if we loaded the level from levelCode
+   Md5::IncrementalHasher md5;
+
+   istringstream iss(levelCode);
+   string line;
+   Vector<string> args;
+   S32 id;
+
+   while(getline(iss, line))
+   {
+      md5.add(line);
+
+      Level::tokenizeLevelLine(line, args, id);
+
+      if(args.size() == 0 || args[0] == "#")     // The loader would ignore these anyway
+         continue;
+
+      lines.write(id);
+      lines.write((U32)args.size());
+
+      for(S32 i = 0; i < args.size(); i++)
+         lines.writeString(args[i]);
+
+      lineCount++;
+   }
+
+   data.writeBytes(FileMagic);
+   data.write((U32)ByteOrderMarker);
+   data.write((U32)FormatVersion);
+
+   data.write(sourceSize);
+   data.write(sourceTime);
+   data.writeString(Md5::getHashFromString(levelCode));
+   data.writeString(md5.getHash());
+
+   data.writeString(levelHeader.levelName);
+   data.write((U32)levelHeader.levelType);
+   data.write(levelHeader.minPlayers);
+   data.write(levelHeader.maxPlayers);
+   data.writeString(levelHeader.scriptName);
+
+   data.write(lineCount);
+   data.writeBytes(lines.getBuffer());
+}
+
+
+// Static method -- returns false if sourceFile couldn't be read, or the compiled file couldn't be written
+bool CompiledLevel::compileFile(const string &sourceFile, const string &compiledFile)
+{
+   U64 size, time;
+   string contents;
+
+   if(!getFileSizeAndTime(sourceFile, size, time) || !readFile(sourceFile, contents))
+      return false;
+
+   BinaryWriter data;
+   compile(contents, size, time, data);
+
+   return data.writeToFile(compiledFile);
+}
+
+
+// Static method -- returns false if this isn't a compiled level we can read
+bool CompiledLevel::readHeader(BinaryReader &reader, Header &header)
+{
+   if(reader.readBytes(FileMagic.length()) != FileMagic)
+      return false;
+
+   if(reader.read<U32>() != ByteOrderMarker || reader.read<U32>() != FormatVersion)
+      return false;
+
+   header.sourceSize = reader.read<U64>();
+   header.sourceTime = reader.read<U64>();
+   header.sourceHash = reader.readString();
+   header.levelHash  = reader.readString();
+
+   LevelInfoDb::LevelHeader &levelHeader = header.levelHeader;
+   U32 levelType;
+
+   levelHeader.levelName  = reader.readString();
+   levelType              = reader.read<U32>();
+   levelHeader.minPlayers = reader.read<S32>();
+   levelHeader.maxPlayers = reader.read<S32>();
+   levelHeader.scriptName = reader.readString();
+
+   header.lineCount = reader.read<U32>();
+
+   if(!reader.isOk() || levelType >= GameTypesCount)
+      return false;
+
+   levelHeader.levelType = (GameTypeId)levelType;
+   return true;
+}
+
+
+// Static method -- returns false, leaving level untouched, if compiled is not a valid compiled level
+bool CompiledLevel::loadLevel(const string &compiled, Level *level, const string &filename)
+{
+   BinaryReader reader(compiled);
+   Header header;
+
+   if(!readHeader(reader, header))
+      return false;
+
+   // Read everything before handing any of it to the level, so a damaged file can't leave us with half a level.
+   // The args all point into compiled, so there's no copying here.
+   Vector<S32> ids;
+   Vector<U32> argcs;
+   Vector<const char *> args;
+
+   for(U32 i = 0; i < header.lineCount && reader.isOk(); i++)
+   {
+      ids.push_back(reader.read<S32>());
+      argcs.push_back(reader.read<U32>());
+
+      for(U32 j = 0; j < argcs.last() && reader.isOk(); j++)
+         args.push_back(reader.readString());
+   }
+
+   if(!reader.isOk() || !reader.isAtEnd())
+      return false;
+
+   const char **argv = args.address();
+
+   for(S32 i = 0; i < ids.size(); i++)
+   {
+      level->processTokenizedLine(argcs[i], ids[i], argv, filename);
+      argv += argcs[i];
+   }
+
+   level->mLevelHash = header.levelHash;
+   level->finishLoading();
+
+   return true;
+}
+
+
+// Static method -- fills levelInfo with the metadata stored in compiled; returns false if compiled is not valid
+bool CompiledLevel::getLevelInfo(const string &compiled, LevelInfo &levelInfo)
+{
+   LevelInfoDb::LevelHeader levelHeader;
+
+   if(!getLevelHeader(compiled, levelHeader))
+      return false;
+
+   levelInfo.setHeader(levelHeader);
+   return true;
+}
+
+
+// Static method -- as above, but safe to use off the main thread
+bool CompiledLevel::getLevelHeader(const string &compiled, LevelInfoDb::LevelHeader &levelHeader)
+{
+   BinaryReader reader(compiled);
+   Header header;
+
+   if(!readHeader(reader, header))
+      return false;
+
+   levelHeader = header.levelHeader;
+   return true;
+}
+
+
+// Static method -- looks for a compiled version of sourceFile that was built from its current contents; we check
+// for one next to the source first, then in our cache.  If we have a hash of the source, that is used in place of
+// the modification time.
+bool CompiledLevel::readFreshCompiledFile(const string &sourceFile, U64 sourceSize, U64 sourceTime,
+                                          const string &sourceHash, string &compiled)
+{
+   Vector<string> candidates;
+   candidates.push_back(getCompiledFileName(sourceFile));
+
+   if(CacheDir != "")
+      candidates.push_back(getCacheFileName(sourceFile));
+
+   for(S32 i = 0; i < candidates.size(); i++)
+   {
+      if(!readFile(candidates[i], compiled))
+         continue;
+
+      BinaryReader reader(compiled);
+      Header header;
+
+      if(!readHeader(reader, header) || header.sourceSize != sourceSize)
+         continue;
+
+      if(sourceHash != "" ? header.sourceHash == sourceHash : header.sourceTime == sourceTime)
+         return true;
+   }
+
+   compiled.clear();
+   return false;
+}
+
+
+// Static method -- compiles contents and, if we have a cache, saves the result there.  Returns the compiled level.
+string CompiledLevel::writeToCache(const string &sourceFile, const string &contents, U64 sourceSize, U64 sourceTime)
+{
+   BinaryWriter data;
+   compile(contents, sourceSize, sourceTime, data);
+
+   if(CacheDir != "" && makeSureFolderExists(CacheDir))
+      if(!data.writeToFile(getCacheFileName(sourceFile)))
+         logprintf(LogConsumer::LogWarning, "Could not write compiled level cache file for %s", sourceFile.c_str());
+
+   return data.getBuffer();
+}
+
+
+// Static method -- like Level::loadLevelFromFile(), this always leaves us with a valid level, and returns false
+// if sourceFile could not be read.  Reading and hashing the source is cheap next to parsing it, and means an edit
+// that doesn't change the size or (coarse) modification time can't get us a stale level.
+bool CompiledLevel::loadLevelFromFile(const string &sourceFile, Level *level)
+{
+   if(LevelSource::isTestFile(sourceFile))
+      return level->loadLevelFromFile(sourceFile);
+
+   U64 size, time;
+   string contents;
+   bool fileExists = getFileSizeAndTime(sourceFile, size, time) && readFile(sourceFile, contents);
+
+   string compiled;
+   if(fileExists && readFreshCompiledFile(sourceFile, size, time, Md5::getHashFromString(contents), compiled) &&
+                    loadLevel(compiled, level, sourceFile))
+      return true;
+
+   level->loadLevelFromString(contents, sourceFile);
+
+   // Compile it now so it loads faster next time
+   if(fileExists && CacheDir != "")
+      writeToCache(sourceFile, contents, size, time);
+
+   return fileExists;
+}
+
+
+// Static method -- returns false if there is no up-to-date compiled version of sourceFile, and we don't have a cache
+// in which to put one.  Doesn't touch the string table, so it can be run on a worker thread.
+bool CompiledLevel::getLevelHeaderFromFile(const string &sourceFile, LevelInfoDb::LevelHeader &levelHeader)
+{
+   U64 size, time;
+   if(LevelSource::isTestFile(sourceFile) || !getFileSizeAndTime(sourceFile, size, time))
+      return false;
+
+   string compiled;
+   if(!readFreshCompiledFile(sourceFile, size, time, "", compiled))
+   {
+      string contents;
+      if(CacheDir == "" || !readFile(sourceFile, contents))
+         return false;
+
+      compiled = writeToCache(sourceFile, contents, size, time);
+   }
+
+   return getLevelHeader(compiled, levelHeader);
+}
+
+
+}
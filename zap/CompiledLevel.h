@@ -0,0 +1,78 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _COMPILED_LEVEL_H_
+#define _COMPILED_LEVEL_H_
+
+#include "LevelInfoDatabase.h"     // For LevelHeader
+
+#include "tnlTypes.h"
+
+#include <string>
+
+using namespace std;
+using namespace TNL;
+
+namespace Zap
+{
+
+class Level;
+class BinaryReader;
+class BinaryWriter;
+struct LevelInfo;
+
+// A .levelc file is a level that has already been tokenized, along with the metadata the server needs for its
+// level list.  Loading one skips all the string parsing we'd otherwise do, but still hands each line to the same
+// object loaders as a .level file would, so the resulting Level is identical.
+//
+// Compiled files record the size, modification time, and a hash of the .level they were built from, and are ignored
+// once they no longer match.  Loading a level checks the hash, since we read the source anyway; scanning headers
+// only checks the size and time, so we don't have to.  The editor's test file is never compiled.  They can be created with the -compilelevels command line option, in which case
+// they live next to their source, or they get created on the fly in CacheDir the first time a level is loaded.
+class CompiledLevel
+{
+private:
+   struct Header
+   {
+      U64 sourceSize;
+      U64 sourceTime;
+      string sourceHash;      // Of the whole file, as opposed to levelHash, which matches Level::getHash()
+      string levelHash;
+      LevelInfoDb::LevelHeader levelHeader;
+      U32 lineCount;
+   };
+
+   static const U32 FormatVersion = 2;
+   static const U32 ByteOrderMarker = 0x01020304;     // Will read back scrambled on a machine with different endianness
+
+   static void compile(const string &levelCode, U64 sourceSize, U64 sourceTime, BinaryWriter &data);
+   static bool readHeader(BinaryReader &reader, Header &header);
+   static bool readFreshCompiledFile(const string &sourceFile, U64 sourceSize, U64 sourceTime, const string &sourceHash,
+                                     string &compiled);
+   static string writeToCache(const string &sourceFile, const string &contents, U64 sourceSize, U64 sourceTime);
+
+public:
+   static const string FileExtension;
+   static string CacheDir;                // Where lazily compiled levels are kept; "" disables the cache
+
+   static string getCompiledFileName(const string &sourceFile);
+   static string getCacheFileName(const string &sourceFile);
+
+   static string compile(const string &levelCode, U64 sourceSize = 0, U64 sourceTime = 0);
+   static bool compileFile(const string &sourceFile, const string &compiledFile);
+
+   static bool loadLevel(const string &compiled, Level *level, const string &filename = "");
+   static bool getLevelInfo(const string &compiled, LevelInfo &levelInfo);
+   static bool getLevelHeader(const string &compiled, LevelInfoDb::LevelHeader &levelHeader);
+
+   // These use a compiled version of sourceFile when an up-to-date one is available, and create one if not
+   static bool loadLevelFromFile(const string &sourceFile, Level *level);
+   static bool getLevelHeaderFromFile(const string &sourceFile, LevelInfoDb::LevelHeader &levelHeader);  // Thread safe
+};
+
+
+}
+
+#endif
@@ -41,6 +41,8 @@
    SETTINGS_ITEM(S32,                ConnectionSpeed,          "Settings",       "ConnectionSpeed",          0,                               NULL,     NULL,     "This adjusts the latency and bandwidth of a connection.  Values can be: -2, -1, 0, 1, 2, where the higher number means less latency and more bandwidth.  Zap! used -1.") \
    SETTINGS_ITEM(U32,                MaxFpsClient,             "Settings",       "MaxFPS",                   100,                        checkClientFps,NULL,     "Maximum FPS the client will run at.  Higher values use more CPU, lower may increase lag (default = 100).")                     \
    SETTINGS_ITEM(YesNo,              Vsync,                    "Settings",       "Vsync",                    Yes,                             NULL,     NULL,     "Turns on vertical sync. Yes/No")                                                                                               \
+   SETTINGS_ITEM(U32,                InterpolationDelay,       "Settings",       "InterpolationDelay",       0,                               NULL,     NULL,     "Milliseconds to draw other players and moving items behind the latest update from the server, so they can be smoothly interpolated between updates.  Try 100 on a jittery connection.  0 uses the old smoothing (default = 0).")\
+   SETTINGS_ITEM(U32,                MaxExtrapolation,         "Settings",       "MaxExtrapolation",         250,                             NULL,     NULL,     "When using InterpolationDelay, the most milliseconds we will guess where something went after its last update before freezing it in place (default = 250).")\
                                                                                                                                                                                                                                                                                                   \
    SETTINGS_ITEM(ColorEntryMode,     ColorEntryMode,          "EditorSettings", "ColorEntryMode",            ColorEntryMode100,               NULL,     NULL,     "Specifies which color entry mode to use: RGB100, RGB255, RGBHEX; best to let the game manage this")                            \
    SETTINGS_ITEM(YesNo,              ShowConnectionsToMaster, "EditorSettings", "ShowConnectionsToMaster",   Yes,                             NULL,     NULL,     "Should the editor notify user of all connections to the master server?")                                                       \
@@ -73,6 +75,8 @@
    SETTINGS_ITEM(YesNo,              AddRobots,                "Host",           "AddRobots",                No,                              NULL,     NULL,     "Add robot players to this server.")                                                                                            \
    SETTINGS_ITEM(S32,                MinBalancedPlayers,       "Host",           "MinBalancedPlayers",       6,                               NULL,     NULL,     "The minimum number of players ensured in each map.  Bots will be added up to this number.")                                    \
    SETTINGS_ITEM(YesNo,              EnableServerVoiceChat,    "Host",           "EnableServerVoiceChat",    Yes,                             NULL,     NULL,     "If false, prevents any voice chat in a server.")                                                                               \
+   SETTINGS_ITEM(VoiceChatMode,      ServerVoiceChatMode,      "Host",           "ServerVoiceChatMode",      VoiceChatRelay,                  NULL,     NULL,     "Relay sends each speaker to their teammates; Mix combines a team's speakers into one stream whenever several are talking\n"    \
+                                                                                                                                                                  "at once (more CPU, less bandwidth); Auto does the same, but only while the CPU can spare it")                                  \
    SETTINGS_ITEM(YesNo,              AllowGetMap,              "Host",           "AllowGetMap",              No,                              NULL,     NULL,     "When getmap is allowed, anyone can download the current level using the /getmap command.")                                     \
    SETTINGS_ITEM(YesNo,              AllowDataConnections,     "Host",           "AllowDataConnections",     No,                              NULL,     NULL,     "When data connections are allowed, anyone with the admin password can upload or download levels, bots, or levelGen scripts.\n" \
                                                                                                                                                                   "This feature is probably insecure, and should be DISABLED unless you require the functionality.")                              \
@@ -91,6 +95,8 @@
    SETTINGS_ITEM(YesNo,              GameRecordingDownload,    "Host",           "GameRecordingDownload",    No,                              NULL,     NULL,     "If Yes, other players can download")                                                                                           \
    SETTINGS_ITEM(U32,                MaxFpsServer,             "Host",           "MaxFPS",                   100,                             NULL,     NULL,     "Maximum FPS the dedicated server will run at.  Higher values use more CPU (and power), lower may increase lag.\n"              \
                                                                                                                                                                   "Specify 0 for no limit. Negative values will not make Bitfighter run backwards.  Sorry.  (default = 100)")                     \
+   SETTINGS_ITEM(U32,                MaxLagCompensation,       "Host",           "MaxLagCompensation",       200,                             NULL,     NULL,     "When checking whether a lagged player's shot hit someone, the server looks at where ships were when the player fired.\n"       \
+                                                                                                                                                                  "This is the furthest back, in ms, it will look (0 disables this; values over 1000 are treated as 1000).")                      \
    MYSQL_SETTINGS_TABLE_ENTRY                                                                                                                                                                                                                                                                     \
                                                                                                                                                                                                                                                                                                   \
    SETTINGS_ITEM(YesNo,              VotingEnabled,            "Host-Voting",    "VoteEnable",               No,                              NULL,     NULL,     "Enable voting on this server")                                                                                                 \
@@ -216,6 +222,19 @@ enum RelAbs {
 };
 
 
+#define VOICE_CHAT_MODE_TABLE \
+VOICE_CHAT_MODE_ITEM(VoiceChatRelay, "Relay" )  \
+VOICE_CHAT_MODE_ITEM(VoiceChatMix,   "Mix"   )  \
+VOICE_CHAT_MODE_ITEM(VoiceChatAuto,  "Auto"  )  \
+
+// Gernerate an enum
+enum VoiceChatMode {
+#define VOICE_CHAT_MODE_ITEM(enumVal, b) enumVal,
+    VOICE_CHAT_MODE_TABLE
+#undef VOICE_CHAT_MODE_ITEM
+};
+
+
 #define MESSAGE_TYPE_TABLE \
 MESSAGE_TYPE_ITEM(TeamMessageType,    "Team"    ) \
 MESSAGE_TYPE_ITEM(GlobalMessageType,  "Global"  ) \
@@ -98,7 +98,11 @@ void ConnectionStatsRenderer::render(GameConnection *conn) const
       RenderUtils::drawStringfr(x2, y_space*4+y, size, "%i", conn->mPacketSendBytesTotal);
       RenderUtils::drawStringfr(x3, y_space*4+y, size, "%i", conn->mPacketRecvBytesTotal);
 
-      y += y_space*5;
+      // How much work we've been doing to keep our ship in sync with the server
+      RenderUtils::drawStringf (x1, y_space*5+y, size, "Replays %i  Smoothed %i", conn->getReplayCount(), conn->getReplaySmoothedCount());
+      RenderUtils::drawStringf (x1, y_space*6+y, size, "Moves replayed %i  Last %i", conn->getReplayMovesTotal(), conn->getReplayMovesLast());
+
+      y += y_space*7;
    }
 
 
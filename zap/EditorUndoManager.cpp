@@ -45,13 +45,35 @@ void EditorUndoManager::fixupActionList()
    if(mUndoLevel < mActions.size())
    {
       for(S32 i = mActions.size() - 1; i >= mUndoLevel; i--)
+      {
+         delete mActions[i];
          mActions.erase(i);
+      }
 
       mSavedAtLevel = -1;
    }
 }
 
 
+// Drop our oldest undo states until our history fits in MaxUndoMemory.  We always keep the most recent one,
+// and never drop anything that's been undone, as that would leave us unable to redo it.
+void EditorUndoManager::trimHistory()
+{
+   U32 total = getMemoryUsage();
+
+   while(total > MaxUndoMemory && mActions.size() > 1 && mUndoLevel > 0)
+   {
+      total -= mActions[0]->getMemoryUsage();
+
+      delete mActions[0];
+      mActions.erase(0);
+
+      mUndoLevel--;
+      mSavedAtLevel--;     // Goes negative if we drop the saved state, which is what we want; we can't get back there
+   }
+}
+
+
 void EditorUndoManager::saveAction(EditorAction action, const BfObject *bfObject)
 {
    // Handle special case... if we're in a MergeAction, and the first part was creating the object, and
@@ -83,7 +105,10 @@ void EditorUndoManager::saveAction(EditorAction action, const BfObject *bfObject
       TNLAssert(false, "Action not implemented!");
 
    if(!mInTransaction)
+   {
       mUndoLevel = mActions.size();
+      trimHistory();
+   }
 }
 
 
@@ -109,7 +134,10 @@ void EditorUndoManager::saveAction(EditorAction action, const BfObject *origObje
       TNLAssert(false, "Action not implemented!");
 
    if(!mInTransaction)
+   {
       mUndoLevel = mActions.size();
+      trimHistory();
+   }
 }
 
 
@@ -154,6 +182,7 @@ void EditorUndoManager::discardAction()
    if(mUndoLevel == mActions.size())
       mUndoLevel--;
 
+   delete mActions.last();
    mActions.erase(mActions.size() - 1);
 }
 
@@ -261,6 +290,7 @@ void EditorUndoManager::endTransaction(ChangeIdentifier ident)    // ident defau
    {
       TNLAssert(dynamic_cast<EditorWorkUnitGroup *>(mActions.last()), "Expected a WorkUnitGroup!");
       static_cast<EditorWorkUnitGroup *>(mActions.last())->mergeTransactions(mTransactionActions);
+      mTransactionActions.deleteAndClear();     // Merged into the previous transaction; we're done with them
    }
    else
    {
@@ -269,6 +299,7 @@ void EditorUndoManager::endTransaction(ChangeIdentifier ident)    // ident defau
       fixupActionList();
       mActions.push_back(group);
       mUndoLevel = mActions.size();
+      trimHistory();
    }
 
 
@@ -310,4 +341,16 @@ bool EditorUndoManager::needToSave() const
 }
 
 
+// Rough estimate of how much memory our undo history is using, in bytes
+U32 EditorUndoManager::getMemoryUsage() const
+{
+   U32 total = 0;
+
+   for(S32 i = 0; i < mActions.size(); i++)
+      total += mActions[i]->getMemoryUsage();
+
+   return total;
+}
+
+
 } };  // Nested namespace
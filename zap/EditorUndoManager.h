@@ -32,6 +32,8 @@ public:
       ChangeIdNone
    };
 
+   static const U32 MaxUndoMemory = 64 * 1024 * 1024;    // Oldest undo states get dropped once history gets bigger than this
+
 private:
    S32 mUndoLevel;
    S32 mSavedAtLevel;
@@ -48,6 +50,7 @@ private:
    bool mInMergeAction;
 
    void fixupActionList();
+   void trimHistory();
 
 public:
    EditorUndoManager();             // Constructor
@@ -81,6 +84,8 @@ public:
 
    bool undoAvailable();
    bool redoAvailable();
+
+   U32 getMemoryUsage() const;
 };
 
 
@@ -11,6 +11,14 @@
 namespace Zap { namespace Editor 
 {
 
+// A very rough guess at what a copy of an object costs us; objects vary a lot, and walls bring their segments along
+static U32 getCopySize(const BfObject *object)
+{
+   static const U32 ObjectCopyOverhead = 1024;
+
+   return ObjectCopyOverhead + object->getVertCount() * sizeof(Point) * 8;
+}
+
 
 // Constructor
 EditorWorkUnit::EditorWorkUnit(boost::shared_ptr<Level> level, EditorUserInterface *editor, EditorAction action)
@@ -28,6 +36,13 @@ EditorWorkUnit::~EditorWorkUnit()
 }
 
 
+// Set to NULL to stop this unit from telling the editor what it's done
+void EditorWorkUnit::setEditor(EditorUserInterface *editor)
+{
+   mEditor = editor;
+}
+
+
 ////////////////////////////////////////
 ////////////////////////////////////////
 
@@ -90,6 +105,12 @@ EditorAction EditorWorkUnitCreate::getAction() const
 }
 
 
+U32 EditorWorkUnitCreate::getMemoryUsage() const
+{
+   return sizeof(*this) + getCopySize(mCreatedObject);
+}
+
+
 ////////////////////////////////////////
 ////////////////////////////////////////
 
@@ -154,26 +175,57 @@ EditorAction EditorWorkUnitDelete::getAction() const
 }
 
 
+U32 EditorWorkUnitDelete::getMemoryUsage() const
+{
+   return sizeof(*this) + getCopySize(mDeletedObject);
+}
+
+
 ////////////////////////////////////////
 ////////////////////////////////////////
 
-// Helper function -- iterates through all objects in list and saves their geometries for posterity
-static void getGeometries(const Vector<boost::shared_ptr<BfObject> > &objects, Vector<Vector<Point> > &geoms)
+static Vector<Point> getGeom(const BfObject *object)
 {
-   geoms.reserve(objects.size());
+   Vector<Point> geom(object->getVertCount());
 
-   Vector<Point> points;
-   for(S32 i = 0; i < objects.size(); i++)
-   {
-      const Vector<Point> *pointsPtr = objects[i]->getGeometry().getOutline();
-      points.clear();
-      points.reserve(pointsPtr->size());
-
-      for(S32 i = 0; i < pointsPtr->size(); i++)
-         points.push_back(pointsPtr->get(i));
-         
-      geoms.push_back(points);
-   }
+   for(S32 i = 0; i < object->getVertCount(); i++)
+      geom.push_back(object->getVert(i));
+
+   return geom;
+}
+
+
+// Returns a copy of object with its geometry replaced by geom
+static BfObject *copyWithGeom(const BfObject *object, const Vector<Point> &geom)
+{
+   BfObject *copy = object->clone();
+
+   static_cast<GeomObject *>(copy)->setGeom(geom);
+   copy->onGeomChanged();
+
+   return copy;
+}
+
+
+// Returns true if the only thing about the object that changed is its geometry.  Anything that matters will be in
+// the level code, so we compare that, with the new geometry put back the way it was.
+static bool onlyGeomChanged(const BfObject *origObject, const BfObject *changedObject)
+{
+   string origCode = origObject->toLevelCode();
+   string changedCode = changedObject->toLevelCode();
+
+   if(origCode == changedCode)
+      return true;
+
+   string origGeom = origObject->geomToLevelCode();
+   string changedGeom = changedObject->geomToLevelCode();
+
+   size_t pos = changedCode.find(changedGeom);
+
+   if(pos == string::npos)
+      return false;
+
+   return origCode == changedCode.substr(0, pos) + origGeom + changedCode.substr(pos + changedGeom.length());
 }
 
 
@@ -184,8 +236,21 @@ EditorWorkUnitChange::EditorWorkUnitChange(const boost::shared_ptr<Level> &level
                                            const BfObject *changedObject) : 
    Parent(level, editor, ActionChange)
 {
-   mOrigObject = origObject->clone();
-   mChangedObject = changedObject->clone();
+   mSerialNumber = changedObject->getSerialNumber();
+
+   if(onlyGeomChanged(origObject, changedObject))
+   {
+      mOrigGeom = getGeom(origObject);
+      mChangedGeom = getGeom(changedObject);
+
+      mOrigObject = NULL;
+      mChangedObject = NULL;
+   }
+   else
+   {
+      mOrigObject = origObject->clone();
+      mChangedObject = changedObject->clone();
+   }
 }
 
 
@@ -197,49 +262,106 @@ EditorWorkUnitChange::~EditorWorkUnitChange()
 }
 
 
+// Private method
+void EditorWorkUnitChange::applyGeom(const Vector<Point> &geom)
+{
+   BfObject *obj = mLevel->findObjBySerialNumber(mSerialNumber);
+   TNLAssert(obj, "Could not find object!");
+
+   static_cast<GeomObject *>(obj)->setGeom(geom);
+   obj->onGeomChanged();
+}
+
+
 void EditorWorkUnitChange::undo()
 {
-   mLevel->swapObject(mChangedObject->getSerialNumber(), mOrigObject);
+   if(isGeomOnly())
+      applyGeom(mOrigGeom);
+   else
+      mLevel->swapObject(mSerialNumber, mOrigObject);
 
    if(mEditor)
-      mEditor->doneChangingGeoms(mOrigObject->getSerialNumber());
+      mEditor->doneChangingGeoms(mSerialNumber);
 }
 
 
 void EditorWorkUnitChange::redo()
 {
-   mLevel->swapObject(mOrigObject->getSerialNumber(), mChangedObject);
+   if(isGeomOnly())
+      applyGeom(mChangedGeom);
+   else
+      mLevel->swapObject(mSerialNumber, mChangedObject);
 
    if(mEditor)
-      mEditor->doneChangingGeoms(mChangedObject->getSerialNumber());
+      mEditor->doneChangingGeoms(mSerialNumber);
 }
 
 
+// workUnit is a change made to our object after ours, so its original state is our changed state
 void EditorWorkUnitChange::merge(const EditorWorkUnit *workUnit)
 {
+   TNLAssert(dynamic_cast<const EditorWorkUnitChange *>(workUnit), "Can only merge changes!");
+   const EditorWorkUnitChange *change = static_cast<const EditorWorkUnitChange *>(workUnit);
+
+   if(isGeomOnly() && change->isGeomOnly())
+   {
+      mChangedGeom = change->mChangedGeom;
+      return;
+   }
+
+   // Someone changed more than geometry, so we'll need whole objects for both states
+   BfObject *changedObject;
+
+   if(change->isGeomOnly())
+      changedObject = copyWithGeom(mChangedObject, change->mChangedGeom);
+   else
+      changedObject = change->mChangedObject->clone();
+
+   if(isGeomOnly())
+      mOrigObject = copyWithGeom(change->mOrigObject, mOrigGeom);
+
    delete mChangedObject;
-   mChangedObject = workUnit->getObject()->clone();
+   mChangedObject = changedObject;
+
+   mOrigGeom.clear();
+   mChangedGeom.clear();
 }
 
 
 S32 EditorWorkUnitChange::getSerialNumber() const
 {
-   return mChangedObject->getSerialNumber();
+   return mSerialNumber;
 }
 
 
+// Returns NULL if we're only keeping track of geometry
 const BfObject *EditorWorkUnitChange::getObject() const
 {
    return mChangedObject;
 }
 
 
+bool EditorWorkUnitChange::isGeomOnly() const
+{
+   return mOrigObject == NULL;
+}
+
+
 EditorAction EditorWorkUnitChange::getAction() const
 {
    return ActionChange;
 }
 
 
+U32 EditorWorkUnitChange::getMemoryUsage() const
+{
+   if(isGeomOnly())
+      return sizeof(*this) + (mOrigGeom.size() + mChangedGeom.size()) * sizeof(Point);
+
+   return sizeof(*this) + getCopySize(mOrigObject) + getCopySize(mChangedObject);
+}
+
+
 ////////////////////////////////////////
 ////////////////////////////////////////
 
@@ -250,6 +372,10 @@ EditorWorkUnitGroup::EditorWorkUnitGroup(const boost::shared_ptr<Level> &level,
    Parent(level, editor, ActionChange)
 {
    mWorkUnits = workUnits;
+
+   // We'll tell the editor about everything at once, rather than having it rebuild the level once for every object
+   for(S32 i = 0; i < mWorkUnits.size(); i++)
+      mWorkUnits[i]->setEditor(NULL);
 }
 
 
@@ -266,8 +392,7 @@ void EditorWorkUnitGroup::undo()
    for(S32 i = mWorkUnits.size() - 1; i >= 0 ; i--)
       mWorkUnits[i]->undo();
 
-   //if(mEditor)
-   //   mEditor->doneChangingGeoms(mOrigObject->getSerialNumber());
+   notifyEditor(true);
 }
 
 
@@ -276,8 +401,40 @@ void EditorWorkUnitGroup::redo()
    for(S32 i = 0; i < mWorkUnits.size(); i++)
       mWorkUnits[i]->redo();
 
-   //if(mEditor)
-   //   mEditor->doneChangingGeoms(mChangedObject->getSerialNumber());
+   notifyEditor(false);
+}
+
+
+// Private method
+void EditorWorkUnitGroup::notifyEditor(bool undoing)
+{
+   if(!mEditor)
+      return;
+
+   Vector<S32> addedObjects;
+   Vector<S32> changedObjects;
+   bool deletedObjects = false;
+
+   for(S32 i = 0; i < mWorkUnits.size(); i++)
+   {
+      EditorAction action = mWorkUnits[i]->getAction();
+
+      if(action == ActionChange)
+         changedObjects.push_back(mWorkUnits[i]->getSerialNumber());
+      else if((action == ActionDelete) == undoing)      // Undoing a delete, or redoing a create
+         addedObjects.push_back(mWorkUnits[i]->getSerialNumber());
+      else
+         deletedObjects = true;
+   }
+
+   if(deletedObjects)
+      mEditor->doneDeletingObjects();
+
+   // Both of these rebuild everything, so one call covers added and changed objects alike
+   if(addedObjects.size() > 0)
+      mEditor->doneAddingObjects(addedObjects);
+   else if(changedObjects.size() > 0)
+      mEditor->doneChangingGeoms(changedObjects);
 }
 
 
@@ -327,5 +484,16 @@ EditorAction EditorWorkUnitGroup::getAction() const
 }
 
 
+U32 EditorWorkUnitGroup::getMemoryUsage() const
+{
+   U32 size = sizeof(*this);
+
+   for(S32 i = 0; i < mWorkUnits.size(); i++)
+      size += mWorkUnits[i]->getMemoryUsage();
+
+   return size;
+}
+
+
 
 } };  // Nested namespace
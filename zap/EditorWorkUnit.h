@@ -54,6 +54,9 @@ public:
    virtual const BfObject *getObject() const = 0;
 
    virtual EditorAction getAction() const = 0;
+   virtual U32 getMemoryUsage() const = 0;    // Rough estimate, in bytes
+
+   void setEditor(EditorUserInterface *editor);
 };
 
 
@@ -83,6 +86,7 @@ public:
    const BfObject *getObject() const;
 
    EditorAction getAction() const;
+   U32 getMemoryUsage() const;
 };
 
 
@@ -112,6 +116,7 @@ public:
    const BfObject *getObject() const;
 
    EditorAction getAction() const;
+   U32 getMemoryUsage() const;
 };
 
 
@@ -119,14 +124,23 @@ public:
 ////////////////////////////////////
 ////////////////////////////////////
 
+// Most changes just move things around, in which case all we keep is the geometry from before and after the change,
+// and apply it to the object in the level when we undo or redo.  Otherwise, we keep copies of the whole object.
 class EditorWorkUnitChange : public EditorWorkUnit
 {
    typedef EditorWorkUnit Parent;
 
 private:
-   BfObject *mOrigObject;
+   S32 mSerialNumber;
+
+   Vector<Point> mOrigGeom;         // Only used when mOrigObject is NULL
+   Vector<Point> mChangedGeom;
+
+   BfObject *mOrigObject;           // NULL if only the geometry changed
    BfObject *mChangedObject;
 
+   void applyGeom(const Vector<Point> &geom);
+
 public:
    // Constructor
    EditorWorkUnitChange(const boost::shared_ptr<Level> &level, 
@@ -144,7 +158,10 @@ public:
    S32 getSerialNumber() const;
    const BfObject *getObject() const;
 
+   bool isGeomOnly() const;
+
    EditorAction getAction() const;
+   U32 getMemoryUsage() const;
 };
 
 
@@ -158,6 +175,8 @@ class EditorWorkUnitGroup : public EditorWorkUnit
 private:
    Vector<EditorWorkUnit *> mWorkUnits;
 
+   void notifyEditor(bool undoing);
+
 public:
    // Constructor
    EditorWorkUnitGroup(const boost::shared_ptr<Level> &level, 
@@ -180,6 +199,7 @@ public:
    const BfObject *getObject() const;
 
    EditorAction getAction() const;
+   U32 getMemoryUsage() const;
 };
 
 
@@ -134,6 +134,13 @@ static FontId currentFontId;
 
 static BfFont *fontList[FontCount] = {NULL};
 
+// Geometry and widths of recently drawn strings.  HUD text and menus draw much the same strings every frame.
+static const U32 TextLayoutCacheSize = 256;
+static TextLayoutCache textLayoutCache(TextLayoutCacheSize);
+
+// Changes whenever fonts are loaded or unloaded, so anything that measured text with the old ones knows to do it again
+static U32 fontsRevision = 0;
+
 sth_stash *FontManager::mStash = NULL;
 bool FontManager::mUsingExternalFonts = true;
 
@@ -198,6 +205,9 @@ void FontManager::initialize(GameSettings *settings, bool useExternalFonts)
 
 void FontManager::cleanup()
 {
+   textLayoutCache.clear();      // Keyed by fonts we're about to delete, and TTF glyphs in the stash
+   fontsRevision++;
+
    for(S32 i = 0; i < FontCount; i++)
    {
       delete fontList[i];
@@ -218,13 +228,41 @@ sth_stash *FontManager::getStash()
 }
 
 
+const TextLayoutCache *FontManager::getTextLayoutCache()
+{
+   return &textLayoutCache;
+}
+
+
+U32 FontManager::getFontsRevision()
+{
+   return fontsRevision;
+}
+
+
 void FontManager::drawTTFString(BfFont *font, const char *string, F32 size)
 {
-   F32 outPos;
+   TextLayoutCache::Layout *layout = textLayoutCache.get(font, size, string);
+
+   if(!layout->hasGeometry)
+   {
+      // A string can't have more glyphs than it has bytes
+      S32 maxGlyphs = (S32)strlen(string);
+
+      layout->verts.resize(maxGlyphs * 6 * 4);
+      layout->textures.resize(maxGlyphs);
+
+      S32 glyphs = sth_layout_text(mStash, font->getStashFontId(), size, string, 
+                                   layout->verts.address(), layout->textures.address(), maxGlyphs, &layout->advance);
+
+      layout->verts.resize(glyphs * 6 * 4);
+      layout->textures.resize(glyphs);
+      layout->hasGeometry = true;
+   }
 
    sth_begin_draw(mStash);
 
-   sth_draw_text(mStash, font->getStashFontId(), size, 0.0, 0.0, string, &outPos);
+   sth_draw_layout(mStash, layout->verts.address(), layout->textures.address(), layout->textures.size());
 
    sth_end_draw(mStash);
 }
@@ -369,6 +407,59 @@ void FontManager::drawStrokeCharacter(const SFG_StrokeFont *font, S32 character)
 }
 
 
+// Lays out string as a list of line segments, as drawStrokeCharacter() would draw it a character at a time
+void FontManager::layoutStrokeString(const SFG_StrokeFont *font, const char *string, TextLayoutCache::Layout *layout)
+{
+   layout->verts.clear();
+   layout->advance = 0;
+   layout->hasGeometry = true;
+
+   if(!font)
+      return;
+
+   for(S32 i = 0; string[i]; i++)
+   {
+      S32 character = string[i];
+
+      if(character < 0 || character >= font->Quantity)
+         continue;
+
+      const SFG_StrokeChar *schar = font->Characters[character];
+
+      if(!schar)
+         continue;
+
+      const SFG_StrokeStrip *strip = schar->Strips;
+
+      for(S32 j = 0; j < schar->Number; j++, strip++)
+         for(S32 k = 1; k < strip->Number; k++)
+         {
+            layout->verts.push_back(strip->Vertices[k - 1].X + layout->advance);
+            layout->verts.push_back(strip->Vertices[k - 1].Y);
+            layout->verts.push_back(strip->Vertices[k].X + layout->advance);
+            layout->verts.push_back(strip->Vertices[k].Y);
+         }
+
+      layout->advance += schar->Right;
+   }
+}
+
+
+// Draws the whole string in one batch, leaving us translated past the end of it, as drawStrokeCharacter() would
+void FontManager::drawStrokeString(BfFont *font, const char *string)
+{
+   TextLayoutCache::Layout *layout = textLayoutCache.get(font, 0, string);
+
+   if(!layout->hasGeometry)
+      layoutStrokeString(font->getStrokeFont(), string, layout);
+
+   if(layout->verts.size() > 0)
+      mGL->renderVertexArray(layout->verts.address(), layout->verts.size() / 2, GLOPT::Lines);
+
+   mGL->glTranslate(layout->advance, 0);
+}
+
+
 BfFont *FontManager::getFont(FontId currentFontId)
 {
    BfFont *font;
@@ -386,12 +477,25 @@ BfFont *FontManager::getFont(FontId currentFontId)
 
 F32 FontManager::getStringLength(const char* string)
 {
+   if(!string)
+      return 0;
+
    BfFont *font = getFont(currentFontId);
 
-   if(font->isStrokeFont())
-      return getStrokeFontStringLength(font->getStrokeFont(), string);
-   else
-      return getTtfFontStringLength(font, string);
+   // Stroke fonts are drawn at one size and scaled, so they share their layout with drawStrokeString()
+   TextLayoutCache::Layout *layout = textLayoutCache.get(font, font->isStrokeFont() ? 0 : legacyRomanSizeFactorThanksGlut, string);
+
+   if(!layout->hasWidth)
+   {
+      if(font->isStrokeFont())
+         layout->width = getStrokeFontStringLength(font->getStrokeFont(), string);
+      else
+         layout->width = getTtfFontStringLength(font, string);
+
+      layout->hasWidth = true;
+   }
+
+   return layout->width;
 }
 
 
@@ -455,8 +559,7 @@ void FontManager::renderString(F32 size, const char *string)
 
       F32 scaleFactor = size / 120.0f;  // Where does this magic number come from?
       mGL->glScale(scaleFactor, -scaleFactor);
-      for(S32 i = 0; string[i]; i++)
-         FontManager::drawStrokeCharacter(font->getStrokeFont(), string[i]);
+      drawStrokeString(font, string);
 
       mGL->glLineWidth(RenderUtils::DEFAULT_LINE_WIDTH);
    }
@@ -11,6 +11,7 @@
 
 #include "FontContextEnum.h"
 #include "RenderManager.h"
+#include "TextLayoutCache.h"
 
 #include <string>
 
@@ -37,6 +38,8 @@ private:
    static F32 getStrokeFontStringLength(const SFG_StrokeFont *font, const char* string);
    static F32 getTtfFontStringLength(BfFont *font, const char* string);
 
+   static void drawStrokeString(BfFont *font, const char *string);
+
 public:
    FontManager();          // Constructor
    virtual ~FontManager(); // Destructor
@@ -50,6 +53,10 @@ public:
    static void drawTTFString(BfFont *font, const char *string, F32 size);
    static void drawStrokeCharacter(const SFG_StrokeFont *font, S32 character);
 
+   static void layoutStrokeString(const SFG_StrokeFont *font, const char *string, TextLayoutCache::Layout *layout);
+   static const TextLayoutCache *getTextLayoutCache();
+   static U32 getFontsRevision();
+
    static F32 getStringLength(const char* string);
 
    static void renderString(F32 size, const char *string);
@@ -7,6 +7,7 @@
 #include "LevelSource.h"
 
 #include "BanList.h"
+#include "CompiledLevel.h"
 #include "DisplayManager.h"
 #include "IniFile.h"
 #include "game.h"
@@ -133,6 +134,7 @@ DirectiveInfo directiveDefs[] = {
 
 // Other commands
 { "rules",   NO_PARAMETERS,  SHOW_RULES,        6, GameSettings::showRules,      "",  "Print a list of \"rules of the game\" and other possibly useful data", "" },
+{ "compilelevels", ALL_REMAINING, COMPILE_LEVELS, 6, GameSettings::compileLevels, "<level 1> [level 2]...", "Compile the specified level files into .levelc files alongside them, which the server will load instead as long as the level file has not changed. All remaining items on the command line will be interpreted as levels.", "You must specify one or more level files to compile with the -compilelevels option" },
 { "help",    NO_PARAMETERS,  HELP,              6, GameSettings::showHelp,       "",  "Display this message", "" },
 { "version", NO_PARAMETERS,  VERSION,           6, GameSettings::showVersion,    "",  "Print version information", "" },
 
@@ -1061,9 +1063,41 @@ void GameSettings::sendRes(GameSettings *settings, const Vector<string> &words)
 
 ////////////////////////////////////////
 ////////////////////////////////////////
-// Dump rules with the -rules option
+// Compile levels with the -compilelevels option
 
 extern bool writeToConsole();
+
+void GameSettings::compileLevels(GameSettings *settings, const Vector<string> &words)
+{
+   writeToConsole();
+
+   S32 errors = 0;
+
+   for(S32 i = 0; i < words.size(); i++)
+   {
+      string sourceFile = words[i];
+      if(!fileExists(sourceFile) && fileExists(sourceFile + ".level"))
+         sourceFile += ".level";
+
+      string compiledFile = CompiledLevel::getCompiledFileName(sourceFile);
+
+      if(CompiledLevel::compileFile(sourceFile, compiledFile))
+         printf("Compiled %s to %s\n", sourceFile.c_str(), compiledFile.c_str());
+      else
+      {
+         printf("Could not compile %s\n", sourceFile.c_str());
+         errors++;
+      }
+   }
+
+   exitToOs(errors > 0 ? 1 : 0);
+}
+
+
+////////////////////////////////////////
+////////////////////////////////////////
+// Dump rules with the -rules option
+
 extern void printRules();
 
 void GameSettings::showRules(GameSettings *settings, const Vector<string> &words)
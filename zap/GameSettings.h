@@ -74,6 +74,7 @@ enum ParamId {
    GET_RESOURCE,
    SHOW_RULES,
    SHOW_LUA_CLASSES,
+   COMPILE_LEVELS,
    HELP,
    VERSION,
 
@@ -294,6 +295,7 @@ public:
    static void getRes(GameSettings *settings, const Vector<string> &words);
    static void sendRes(GameSettings *settings, const Vector<string> &words);
    static void showRules(GameSettings *settings, const Vector<string> &words);
+   static void compileLevels(GameSettings *settings, const Vector<string> &words);
    static void showHelp(GameSettings *settings, const Vector<string> &words);
    static void showVersion(GameSettings *settings, const Vector<string> &words);
 
@@ -284,12 +284,16 @@ void SpecialBindingSet::setBinding(SpecialBindingNameEnum bindingName, const str
 
 static Vector<InputCode> modifiers;
 
+// Revisions are unique across all managers, so a manager created where an old one used to be won't be mistaken for it
+static U32 lastBindingsRevision = 0;
+
 
 // Constructor
 InputCodeManager::InputCodeManager()
 {
    mBindingsHaveKeypadEntry = false;
    mInputMode = InputModeKeyboard;
+   bumpBindingsRevision();
 
    // Create two binding sets, one for keyboard controls, one for joystick
    mBindingSets.resize(2); 
@@ -742,6 +746,7 @@ void InputCodeManager::setBinding(BindingNameEnum bindingName, InputMode inputMo
 
    BindingSet *bindingSet = &mBindingSets[mode];
    bindingSet->setBinding(bindingName, key);
+   bumpBindingsRevision();
 
    // Try to be efficient about checking for whether we have a keypad key assigned to something
    bool isKeypad = isKeypadKey(key);
@@ -759,6 +764,7 @@ void InputCodeManager::setBinding(BindingNameEnum bindingName, InputMode inputMo
 void InputCodeManager::setEditorBinding(EditorBindingNameEnum bindingName, const string &inputString)
 {
 	mEditorBindingSet.setBinding(bindingName, inputString);
+   bumpBindingsRevision();
 }
 
 
@@ -776,6 +782,7 @@ void InputCodeManager::setSpecialBinding(SpecialBindingNameEnum bindingName, Inp
    SpecialBindingSet *bindingSet = &mSpecialBindingSets[mode];
 
 	bindingSet->setBinding(bindingName, inputString);
+   bumpBindingsRevision();
 }
 
 
@@ -783,6 +790,7 @@ void InputCodeManager::setInputMode(InputMode inputMode)
 {
    mInputMode = inputMode;
    mBindingsHaveKeypadEntry = checkIfBindingsHaveKeypad(inputMode);
+   bumpBindingsRevision();
 }
 
 
@@ -792,6 +800,21 @@ InputMode InputCodeManager::getInputMode() const
 }
 
 
+// Anything that shows bindings to the player (like the symbol strings on the help screens) can hang on to what it
+// built until this changes
+U32 InputCodeManager::getBindingsRevision() const
+{
+   return mBindingsRevision;
+}
+
+
+void InputCodeManager::bumpBindingsRevision()
+{
+   lastBindingsRevision++;
+   mBindingsRevision = lastBindingsRevision;
+}
+
+
 // Returns display-friendly mode designator like "Keyboard" or "Joystick 1"
 string InputCodeManager::getInputModeString() const
 {
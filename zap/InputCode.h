@@ -235,6 +235,9 @@ class InputCodeManager
 private:
    bool mBindingsHaveKeypadEntry;
    InputMode mInputMode;             // Joystick or Keyboard
+   U32 mBindingsRevision;            // Changes whenever bindings or input mode do
+
+   void bumpBindingsRevision();
 
    Vector<BindingSet> mBindingSets;
 
@@ -299,6 +302,8 @@ public:
    InputMode getInputMode()    const;
    string getInputModeString() const;  // Returns display-friendly mode designator like "Keyboard" or "Joystick 1"
 
+   U32 getBindingsRevision() const;
+
    #ifndef ZAP_DEDICATED
       static InputCode sdlKeyToInputCode(SDL_Keycode key);        // Convert SDL keys to InputCode
       static SDL_Keycode inputCodeToSDLKey(InputCode inputCode);  // Take a InputCode and return the SDL equivalent
@@ -21,6 +21,7 @@
 #include "stringUtils.h"
 
 #include "tnlLog.h"
+#include "tnlPlatform.h"
 
 #include <fstream>
 #include <sstream>
@@ -61,6 +62,8 @@ namespace Zap
       mGame = NULL;
       mTeamManager.reset(new TeamManager(this));    // mTeamManager is a shared_ptr, so cleanup is handled automatically
       mLevelDatabaseId = LevelDatabase::NOT_IN_DATABASE;
+      mLoadPos = string::npos;
+      mLoadFinished = true;
    }
 
 
@@ -159,19 +162,81 @@ namespace Zap
    // if contents is empty or somehow invalid.
    void Level::loadLevelFromString(const string &contents, const string &filename)
    {
+      beginLoadFromString(contents, filename);
+      continueLoading(U32_MAX);
+   }
+
+
+   // Prepare to load level in pieces with continueLoading()
+   void Level::beginLoadFromString(const string &contents, const string &filename)
+   {
+      mLoadContents = contents;
+      mLoadFileName = filename;
+      mLoadPos = 0;
+      mLoadFinished = false;
+
+      // Hashing is cheap compared to parsing, so just do it all at once
       istringstream iss(contents);
       string line;
 
       Md5::IncrementalHasher md5;
 
       while(std::getline(iss, line))
-      {
-         parseLevelLine(line, filename);
          md5.add(line);
-      }
 
       mLevelHash = md5.getHash();
+   }
+
+
+   // Parse lines until we've used up timeBudget ms; returns true when the level is completely loaded.  The final
+   // geometry pass runs on a call of its own if the budget ran out while parsing.
+   bool Level::continueLoading(U32 timeBudget)
+   {
+      if(mLoadFinished)
+         return true;
+
+      U32 startTime = Platform::getRealMilliseconds();
+      S32 linesParsed = 0;
+
+      while(mLoadPos != string::npos)
+      {
+         size_t eol = mLoadContents.find('\n', mLoadPos);
+
+         // Mimic std::getline(), which doesn't return an empty last line
+         if(eol == string::npos && mLoadPos == mLoadContents.length())
+         {
+            mLoadPos = string::npos;
+            break;
+         }
+
+         string line = mLoadContents.substr(mLoadPos, eol == string::npos ? string::npos : eol - mLoadPos);
+         mLoadPos = (eol == string::npos) ? string::npos : eol + 1;
+
+         parseLevelLine(line, mLoadFileName);
+
+         // Checking the clock for every line would be a waste
+         linesParsed++;
+         if(linesParsed % 16 == 0 && Platform::getRealMilliseconds() - startTime >= timeBudget)
+            return false;
+      }
+
+      if(timeBudget != U32_MAX && Platform::getRealMilliseconds() - startTime >= timeBudget)
+         return false;
+
+      finishLoading();
+
+      return true;
+   }
+
 
+   bool Level::isLoading() const
+   {
+      return !mLoadFinished;
+   }
+
+
+   void Level::finishLoading()
+   {
       // Build wall edge geometry
       Vector<Point> wallEdgePoints;  // <== not used
       buildWallEdgeGeometry(wallEdgePoints);
@@ -180,6 +245,9 @@ namespace Zap
       snapAllEngineeredItems(false);
 
       validateLevel();
+
+      mLoadContents.clear();
+      mLoadFinished = true;
    }
 
 
@@ -265,15 +333,30 @@ namespace Zap
    // Each line of the file is handled separately by processLevelLoadLine in game.cpp or UIEditor.cpp
    void Level::parseLevelLine(const string &line, const string &levelFileName)
    {
-      Vector<string> args = parseString(line);
-      U32 argc = args.size();
-      S32 id = 0;
+      Vector<string> args;
+      S32 id;
 
-      string errorMsg;     // Reusable object
+      tokenizeLevelLine(line, args, id);
 
+      U32 argc = args.size();
       const char** argv = new const char*[argc];     // Deleted below
 
-      if(argc >= 1)
+      for(U32 i = 0; i < argc; i++)
+         argv[i] = args[i].c_str();
+
+      processTokenizedLine(argc, id, argv, levelFileName, line);
+
+      delete[] argv;
+   }
+
+
+   // Split line into args, and extract any id embedded in the first one.  Static method.
+   void Level::tokenizeLevelLine(const string &line, Vector<string> &args, S32 &id)
+   {
+      args = parseString(line);
+      id = 0;
+
+      if(args.size() >= 1)
       {
          // Check if there is an id embedded with a "!"  (Turret!5 is a turret with id = 5)
          std::size_t pos = args[0].find("!");
@@ -283,25 +366,31 @@ namespace Zap
             args[0] = args[0].substr(0, pos);
          }
       }
+   }
 
-      for(U32 i = 0; i < argc; i++)
-         argv[i] = args[i].c_str();
+
+   // Pass the original line, if there is one, for use in error messages
+   void Level::processTokenizedLine(U32 argc, S32 id, const char **argv, const string &levelFileName, const string &line)
+   {
+      string errorMsg;
 
       try
       {
-         errorMsg.clear();
-         bool ok = processLevelLoadLine(argc, id, (const char **)argv, errorMsg);
+         bool ok = processLevelLoadLine(argc, id, argv, errorMsg);
          if(!ok)
             logprintf(LogConsumer::LogLevelError, "Level Error: Non-fatal found in level %s: %s",
             levelFileName.c_str(), errorMsg.c_str());
       }
       catch(LevelLoadException &e)
       {
+         // No original line?  Rebuild one from the args; spacing and quoting are lost, but it's close enough
+         string errorLine = line;
+         for(U32 i = 0; line.empty() && i < argc; i++)
+            errorLine += (i > 0 ? " " : "") + string(argv[i]);
+
          logprintf(LogConsumer::LogLevelError, "Level Error: Fatal error with level %s, line %s: %s",
-            levelFileName.c_str(), line.c_str(), e.what());  // TODO: fix "line" variable having hundreds of level lines
+            levelFileName.c_str(), errorLine.c_str(), e.what());  // TODO: fix "line" variable having hundreds of level lines
       }
-
-      delete[] argv;
    }
 
 
@@ -64,8 +64,16 @@ private:
    GridDatabase mBotZoneDatabase;
    Vector<BotNavMeshZone *> mAllZones;
 
+   // Incremental loading state
+   string mLoadContents;
+   string mLoadFileName;
+   size_t mLoadPos;           // Offset of next line to parse; string::npos once all lines have been parsed
+   bool mLoadFinished;
+
    void initialize();
+   void finishLoading();
    void parseLevelLine(const string &line, const string &levelFileName);
+   void processTokenizedLine(U32 argc, S32 id, const char **argv, const string &levelFileName, const string &line = "");
    bool processLevelLoadLine(U32 argc, S32 id, const char **argv, string &errorMsg);  
    bool processLevelParam(S32 argc, const char **argv);
 
@@ -78,10 +86,17 @@ public:
 
    static const U32 CurrentLevelFormat = 2;
 
+   static void tokenizeLevelLine(const string &line, Vector<string> &args, S32 &id);
+
    void onAddedToGame(Game *game);
 
    void loadLevelFromString(const string &contents, const string &filename = "");
    bool loadLevelFromFile(const string &filename);
+
+   // Load a level a piece at a time, so a big level can be parsed without holding everything else up
+   void beginLoadFromString(const string &contents, const string &filename = "");
+   bool continueLoading(U32 timeBudget);     // Returns true once the level is fully loaded
+   bool isLoading() const;
    void validateLevel();
 
    LevelInfo &getLevelInfo();
@@ -169,6 +184,8 @@ public:
    FRIEND_TEST(EditorTest, wallCentroidForRotationTest);
 
    friend class ObjectTest;      // TODO: This is probably not handled quite right...
+
+   friend class CompiledLevel;
 };
 
 
@@ -6,6 +6,7 @@
 #include "LevelInfoDatabase.h"
 
 #include "gameType.h"
+#include "LevelSource.h"
 #include "stringUtils.h"
 
 #include <sstream>
@@ -86,7 +87,7 @@ done:
 
 void readCsvFromStream(istream &stream, LevelInfoDatabase &levelDb)
 {
-   static enum Cols {
+   enum Cols {
       Md5Col,
       NameCol,
       GameTypeCol,
@@ -131,7 +132,7 @@ bool readCsv(const string &filename)
 {
    LevelInfoDatabase levelDb;
 
-   ifstream file(filename);
+   ifstream file(filename.c_str());
    if(!file)
       return false;
 
@@ -148,9 +149,198 @@ void saveLevelInfo(const string &hash, const LevelInfo &levelInfo)
 {
   ofstream outfile;
 
-  outfile.open(LevelInfoDatabaseFilename, std::ios_base::app);
+  outfile.open(LevelInfoDatabaseFilename.c_str(), std::ios_base::app);
   levelInfo.writeToStream(outfile, hash);
 }
 
 
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Constructor
+LevelHeader::LevelHeader()
+{
+   // Same defaults as LevelInfo
+   levelType = BitmatchGame;
+   minPlayers = 0;
+   maxPlayers = 0;
+}
+
+
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Constructor
+LevelInfoIndex::LevelInfoIndex()
+{
+   mChanged = false;
+}
+
+
+// Destructor
+LevelInfoIndex::~LevelInfoIndex()
+{
+   // Do nothing
+}
+
+
+static U64 parseU64(const string &str)
+{
+   U64 val = 0;
+
+   istringstream stream(str);
+   stream >> val;
+
+   return val;
+}
+
+
+void LevelInfoIndex::readFromStream(istream &stream)
+{
+   enum Cols {
+      PathCol,
+      FileSizeCol,
+      ModifiedTimeCol,
+      NameCol,
+      GameTypeCol,
+      MinPlayersCol,
+      MaxPlayersCol,
+      ScriptNameCol,
+      ColsExpected
+   };
+
+   string line;
+   Vector<string> words;
+
+   while(getline(stream, line)) 
+   {
+      stringstream lineStream(line);
+      words.clear();
+
+      while(lineStream)
+        words.push_back(getNextCsvColumn(lineStream));
+
+      if(words.size() != ColsExpected)
+         continue;
+
+      // Skip anything with a bogus gameType; we'll just read that file again
+      GameTypeId gameTypeId = GameType::getGameTypeIdFromName(words[GameTypeCol]);
+      if(gameTypeId == NoGameType)
+         continue;
+
+      Entry &entry = mEntries[words[PathCol]];
+
+      entry.fileSize          = parseU64(words[FileSizeCol]);
+      entry.modifiedTime      = parseU64(words[ModifiedTimeCol]);
+      entry.header.levelName  = words[NameCol];
+      entry.header.levelType  = gameTypeId;
+      entry.header.minPlayers = atoi(words[MinPlayersCol].c_str());
+      entry.header.maxPlayers = atoi(words[MaxPlayersCol].c_str());
+      entry.header.scriptName = words[ScriptNameCol];
+   }
+}
+
+
+void LevelInfoIndex::writeToStream(ostream &stream) const
+{
+   for(map<string, Entry>::const_iterator it = mEntries.begin(); it != mEntries.end(); it++)
+   {
+      const Entry &entry = it->second;
+
+      stream << "\"" << it->first << "\"," << entry.fileSize << "," << entry.modifiedTime << ",\""
+             << entry.header.levelName << "\"," << GameType::getGameTypeClassName(entry.header.levelType) << ","
+             << entry.header.minPlayers << "," << entry.header.maxPlayers << "," << entry.header.scriptName << '\n';
+   }
+}
+
+
+// Returns false if the index couldn't be read, which is fine the first time we run
+bool LevelInfoIndex::load(const string &filename)
+{
+   ifstream file(filename.c_str());
+   if(!file)
+      return false;
+
+   readFromStream(file);
+   mChanged = false;
+
+   return true;
+}
+
+
+// Only writes the file if something has changed since we loaded it
+bool LevelInfoIndex::save(const string &filename)
+{
+   if(!mChanged)
+      return true;
+
+   ofstream file(filename.c_str());
+   if(!file)
+      return false;
+
+   writeToStream(file);
+
+   if(!file.good())
+      return false;
+
+   mChanged = false;
+   return true;
+}
+
+
+// Returns true, and fills header, if we have an entry for path that is still current
+bool LevelInfoIndex::lookup(const string &path, U64 fileSize, U64 modifiedTime, LevelHeader &header) const
+{
+   map<string, Entry>::const_iterator it = mEntries.find(path);
+
+   if(it == mEntries.end() || it->second.fileSize != fileSize || it->second.modifiedTime != modifiedTime)
+      return false;
+
+   header = it->second.header;
+   return true;
+}
+
+
+void LevelInfoIndex::update(const string &path, U64 fileSize, U64 modifiedTime, const LevelHeader &header)
+{
+   Entry &entry = mEntries[path];
+
+   entry.fileSize = fileSize;
+   entry.modifiedTime = modifiedTime;
+   entry.header = header;
+
+   mChanged = true;
+}
+
+
+// Levels get deleted; no point in remembering them forever
+void LevelInfoIndex::removeMissingFiles()
+{
+   map<string, Entry>::iterator it = mEntries.begin();
+
+   while(it != mEntries.end())
+   {
+      if(fileExists(it->first))
+         it++;
+      else
+      {
+         mEntries.erase(it++);
+         mChanged = true;
+      }
+   }
+}
+
+
+bool LevelInfoIndex::isChanged() const
+{
+   return mChanged;
+}
+
+
+S32 LevelInfoIndex::getEntryCount() const
+{
+   return (S32)mEntries.size();
+}
+
+
 }
\ No newline at end of file
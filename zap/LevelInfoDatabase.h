@@ -35,6 +35,55 @@ struct LevelInfoDatabase {
 void readCsvFromStream(istream &stream, LevelInfoDatabase &levelDb);
 bool readCsv(const string &filename);
 
+
+// The info we extract from the top of a level file.  Unlike LevelInfo, this doesn't use the string table, which
+// isn't thread safe, so it can be filled in on a worker thread.
+struct LevelHeader
+{
+   string levelName;
+   GameTypeId levelType;
+   S32 minPlayers;
+   S32 maxPlayers;
+   string scriptName;
+
+   LevelHeader();    // Constructor
+};
+
+
+// Remembers the headers of level files between runs, so at startup we only need to read the files that have
+// changed.  Entries are keyed by full path, and are only used while the file's size and modification time still
+// match what we recorded.
+class LevelInfoIndex
+{
+private:
+   struct Entry
+   {
+      U64 fileSize;
+      U64 modifiedTime;
+      LevelHeader header;
+   };
+
+   map<string, Entry> mEntries;
+   bool mChanged;
+
+public:
+   LevelInfoIndex();             // Constructor
+   virtual ~LevelInfoIndex();    // Destructor
+
+   void readFromStream(istream &stream);
+   void writeToStream(ostream &stream) const;
+
+   bool load(const string &filename);
+   bool save(const string &filename);
+
+   bool lookup(const string &path, U64 fileSize, U64 modifiedTime, LevelHeader &header) const;
+   void update(const string &path, U64 fileSize, U64 modifiedTime, const LevelHeader &header);
+   void removeMissingFiles();
+
+   bool isChanged() const;
+   S32 getEntryCount() const;
+};
+
 } 
 
 #endif 
@@ -0,0 +1,242 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "LevelScanner.h"
+
+#include "stringUtils.h"
+
+#include "tnlLog.h"
+#include "tnlPlatform.h"
+
+namespace Zap
+{
+
+// Reads the header of a single level file on one of the scanner's workers
+class LevelScanEntry : public Master::ThreadEntry
+{
+private:
+   LevelScanner *mScanner;
+   S32 mIndex;
+   string mPath;
+
+   bool mOk;
+   U64 mFileSize;
+   U64 mModifiedTime;
+   LevelInfoDb::LevelHeader mHeader;
+
+public:
+   LevelScanEntry(LevelScanner *scanner, S32 index, const string &path)    // Constructor
+   {
+      mScanner = scanner;
+      mIndex = index;
+      mPath = path;
+
+      mOk = false;
+      mFileSize = 0;
+      mModifiedTime = 0;
+   }
+
+   void run()     // Runs on a worker thread
+   {
+      if(mScanner->isCancelled())
+         return;
+
+      // Get the size and time before reading, so if the file changes while we're at it, we'll read it again next time
+      mOk = getFileSizeAndTime(mPath, mFileSize, mModifiedTime) && MultiLevelSource::readLevelHeader(mPath, mHeader);
+   }
+
+   void finish()
+   {
+      mScanner->onLevelScanned(mIndex, mPath, mOk, mFileSize, mModifiedTime, mHeader);
+   }
+};
+
+
+////////////////////////////////////////
+////////////////////////////////////////
+
+string LevelScanner::CacheDir = "";    // Set in FolderManager::resolveDirs()
+
+
+// Constructor
+LevelScanner::LevelScanner(LevelSource *levelSource) : mWorkers(WorkerCount)
+{
+   mLevelSource = levelSource;
+   mNextLevel = 0;
+   mIndexHits = 0;
+   mStartTime = Platform::getRealMilliseconds();
+   mFinished = false;
+   mCancelled = false;
+
+   mWorkers.disableOverloadWarnings();    // We queue every level at once
+
+   if(CacheDir != "")
+      mIndex.load(getIndexFileName());
+
+   for(S32 i = 0; i < levelSource->getLevelCount(); i++)
+   {
+      string path = levelSource->getLevelFilePath(i);
+
+      U64 fileSize, modifiedTime;
+      LevelInfoDb::LevelHeader header;
+
+      mLevelInfos.push_back(levelSource->getLevelInfo(i));
+
+      // Not in a file we can find; let the source deal with it the old fashioned way
+      if(path == "")
+      {
+         bool ok = levelSource->populateLevelInfoFromSourceByIndex(i);
+
+         mLevelInfos.last() = levelSource->getLevelInfo(i);
+         mStates.push_back(ok ? Scanned : Failed);
+      }
+
+      // Unchanged since last time
+      else if(!LevelSource::isTestFile(path) && getFileSizeAndTime(path, fileSize, modifiedTime) && 
+              mIndex.lookup(path, fileSize, modifiedTime, header))
+      {
+         mLevelInfos.last().setHeader(header);
+         mLevelInfos.last().ensureLevelInfoHasValidName();
+         mStates.push_back(Scanned);
+         mIndexHits++;
+      }
+
+      else
+      {
+         mStates.push_back(Waiting);
+         mWorkers.addEntry(new LevelScanEntry(this, i, path));
+      }
+   }
+
+   // We'll give them back as they're done
+   levelSource->clear();
+}
+
+
+// Destructor
+LevelScanner::~LevelScanner()
+{
+   mCancelLock.lock();
+   mCancelled = true;
+   mCancelLock.unlock();
+
+   // Whatever we've scanned is still worth remembering
+   if(!mFinished && CacheDir != "" && makeSureFolderExists(CacheDir))
+      mIndex.save(getIndexFileName());
+}
+
+
+string LevelScanner::getIndexFileName()
+{
+   return joindir(CacheDir, "levelindex.csv");
+}
+
+
+// Can be called from any thread
+bool LevelScanner::isCancelled()
+{
+   mCancelLock.lock();
+   bool cancelled = mCancelled;
+   mCancelLock.unlock();
+
+   return cancelled;
+}
+
+
+void LevelScanner::onLevelScanned(S32 index, const string &path, bool ok, U64 fileSize, U64 modifiedTime,
+                                  const LevelInfoDb::LevelHeader &header)
+{
+   if(!ok)
+   {
+      logprintf(LogConsumer::LogWarning, "Could not read level file %s [%s]... Skipping...",
+         mLevelInfos[index].filename.c_str(), path.c_str());
+
+      mStates[index] = Failed;
+      return;
+   }
+
+   mLevelInfos[index].setHeader(header);
+   mLevelInfos[index].ensureLevelInfoHasValidName();
+   mStates[index] = Scanned;
+
+   mIndex.update(path, fileSize, modifiedTime, header);
+}
+
+
+void LevelScanner::onScanFinished()
+{
+   mFinished = true;
+
+   if(CacheDir != "" && makeSureFolderExists(CacheDir))
+   {
+      mIndex.removeMissingFiles();
+
+      if(!mIndex.save(getIndexFileName()))
+         logprintf(LogConsumer::LogWarning, "Could not save level index %s", getIndexFileName().c_str());
+   }
+
+   logprintf(LogConsumer::ServerFilter, "Scanned %d levels in %d ms (%d unchanged since last time)",
+             mLevelInfos.size(), Platform::getRealMilliseconds() - mStartTime, mIndexHits);
+}
+
+
+// Collect results from our workers, and hand back any levels we can without getting them out of order
+void LevelScanner::update(Vector<LevelInfo> &addedLevels)
+{
+   mWorkers.idle();     // Runs onLevelScanned() for any levels the workers are done with
+
+   while(mNextLevel < mLevelInfos.size() && mStates[mNextLevel] != Waiting)
+   {
+      if(mStates[mNextLevel] == Scanned)
+      {
+         mLevelSource->addNewLevel(mLevelInfos[mNextLevel]);
+         addedLevels.push_back(mLevelInfos[mNextLevel]);
+      }
+
+      mNextLevel++;
+   }
+
+   if(mNextLevel == mLevelInfos.size() && !mFinished)
+      onScanFinished();
+}
+
+
+void LevelScanner::waitForLevel(Vector<LevelInfo> &addedLevels)
+{
+   for(;;)
+   {
+      update(addedLevels);
+
+      if(addedLevels.size() > 0 || mFinished)
+         return;
+
+      Platform::sleep(1);
+   }
+}
+
+
+void LevelScanner::finish()
+{
+   Vector<LevelInfo> addedLevels;
+
+   for(;;)
+   {
+      update(addedLevels);
+
+      if(mFinished)
+         return;
+
+      Platform::sleep(1);
+   }
+}
+
+
+bool LevelScanner::isDone() const
+{
+   return mFinished;
+}
+
+
+}
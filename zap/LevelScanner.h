@@ -0,0 +1,83 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _LEVEL_SCANNER_H_
+#define _LEVEL_SCANNER_H_
+
+#include "LevelInfoDatabase.h"
+#include "LevelSource.h"
+
+#include "../master/DatabaseAccessThread.h"
+
+#include "tnlThread.h"
+#include "tnlTypes.h"
+#include "tnlVector.h"
+
+#include <string>
+
+using namespace std;
+using namespace TNL;
+
+namespace Zap
+{
+
+class LevelScanEntry;
+
+// Fills in the LevelInfos of a LevelSource.  Headers of files that haven't changed since they were last scanned
+// come from a persistent index; the rest are read by a pool of worker threads.  The scanner takes the levels out
+// of the source when it is created, and hands them back, in their original order, as soon as each one and all
+// those ahead of it are done -- so a server can start hosting with the first level while the rest are scanned.
+class LevelScanner
+{
+   friend class LevelScanEntry;
+
+private:
+   enum LevelState {
+      Waiting,
+      Scanned,
+      Failed
+   };
+
+   static const U32 WorkerCount = 4;
+
+   LevelSource *mLevelSource;
+   Vector<LevelInfo> mLevelInfos;
+   Vector<LevelState> mStates;
+   S32 mNextLevel;                        // Next level to be handed back to mLevelSource
+
+   LevelInfoDb::LevelInfoIndex mIndex;
+   S32 mIndexHits;
+   U32 mStartTime;
+   bool mFinished;
+
+   Mutex mCancelLock;
+   bool mCancelled;                       // Protected by mCancelLock; tells workers not to bother
+
+   Master::DatabaseAccessThread mWorkers; // Declared last so it's destroyed first, while the above are still good
+
+   bool isCancelled();
+   void onLevelScanned(S32 index, const string &path, bool ok, U64 fileSize, U64 modifiedTime,
+                       const LevelInfoDb::LevelHeader &header);
+   void onScanFinished();
+
+public:
+   static string CacheDir;                // Where we keep our index; "" means no index
+
+   explicit LevelScanner(LevelSource *levelSource);   // Constructor
+   virtual ~LevelScanner();                           // Destructor
+
+   void update(Vector<LevelInfo> &addedLevels);             // Returns levels handed back to the source
+   void waitForLevel(Vector<LevelInfo> &addedLevels);       // Blocks until a level is handed back or we're done
+   void finish();                                           // Blocks until we're done
+
+   bool isDone() const;
+
+   static string getIndexFileName();
+};
+
+
+}
+
+#endif
@@ -5,10 +5,13 @@
 
 #include "LevelSource.h"
 
+#include "CompiledLevel.h"
 #include "config.h"           // For FolderManager
 #include "gameType.h"
 #include "GameSettings.h"
 #include "Level.h"
+#include "LevelInfoDatabase.h"
+#include "LevelScanner.h"
 
 #include "stringUtils.h"
 
@@ -95,6 +98,30 @@ void LevelInfo::ensureLevelInfoHasValidName()
 }
 
 
+LevelInfoDb::LevelHeader LevelInfo::getHeader() const
+{
+   LevelInfoDb::LevelHeader header;
+
+   header.levelName  = mLevelName.getString();
+   header.levelType  = mLevelType;
+   header.minPlayers = minRecPlayers;
+   header.maxPlayers = maxRecPlayers;
+   header.scriptName = mScriptFileName;
+
+   return header;
+}
+
+
+void LevelInfo::setHeader(const LevelInfoDb::LevelHeader &header)
+{
+   mLevelName      = header.levelName.c_str();
+   mLevelType      = header.levelType;
+   minRecPlayers   = header.minPlayers;
+   maxRecPlayers   = header.maxPlayers;
+   mScriptFileName = header.scriptName;
+}
+
+
 ////////////////////////////////////////
 ////////////////////////////////////////
 
@@ -102,6 +129,14 @@ void LevelInfo::ensureLevelInfoHasValidName()
 const string LevelSource::TestFileName = "editor.tmp";
 
 
+// Static method -- the editor rewrites its test file every time it's used, often within a second of the last save,
+// so anything we've cached about it can't be trusted
+bool LevelSource::isTestFile(const string &filename)
+{
+   return extractFilename(filename) == TestFileName;
+}
+
+
 // Constructor
 LevelSource::LevelSource()
 {
@@ -146,6 +181,15 @@ bool LevelSource::getLevelInfoFromDatabase(const string &hash, LevelInfo &levelI
 // This is only used on the server to provide quick level information without having to load the level
 // (like with playlists or menus).  Static method.
 void LevelSource::getLevelInfoFromCodeChunk(const string &code, LevelInfo &levelInfo)
+{
+   LevelInfoDb::LevelHeader header = levelInfo.getHeader();
+   getLevelHeaderFromCodeChunk(code, header);
+   levelInfo.setHeader(header);
+}
+
+
+// As above, but leaves the string table alone so it can be used off the main thread.  Static method.
+void LevelSource::getLevelHeaderFromCodeChunk(const string &code, LevelInfoDb::LevelHeader &header)
 {
    istringstream stream(code);
    string line;
@@ -177,7 +221,7 @@ void LevelSource::getLevelInfoFromCodeChunk(const string &code, LevelInfo &level
             const string validatedName = GameType::validateGameType(gameTypeName);
 
             GameTypeId gameTypeId = GameType::getGameTypeIdFromName(validatedName);
-            levelInfo.mLevelType = gameTypeId;
+            header.levelType = gameTypeId;
 
             foundGameType = true;
             continue;
@@ -194,7 +238,7 @@ void LevelSource::getLevelInfoFromCodeChunk(const string &code, LevelInfo &level
             {
                string levelName = line.substr(pos);
                stripQuotes(levelName);
-               levelInfo.mLevelName = trim(levelName);
+               header.levelName = trim(levelName);
             }
 
             foundLevelName = true;
@@ -209,7 +253,7 @@ void LevelSource::getLevelInfoFromCodeChunk(const string &code, LevelInfo &level
          {
             pos = line.find_first_not_of(" ", minMaxPlayersLen + 1);
             if(pos != string::npos)
-               levelInfo.minRecPlayers = atoi(line.substr(pos).c_str());
+               header.minPlayers = atoi(line.substr(pos).c_str());
 
             foundMinPlayers = true;
             continue;
@@ -223,7 +267,7 @@ void LevelSource::getLevelInfoFromCodeChunk(const string &code, LevelInfo &level
          {
             pos = line.find_first_not_of(" ", minMaxPlayersLen + 1);
             if(pos != string::npos)
-               levelInfo.maxRecPlayers = atoi(line.substr(pos).c_str());
+               header.maxPlayers = atoi(line.substr(pos).c_str());
 
             foundMaxPlayers = true;
             continue;
@@ -240,7 +284,7 @@ void LevelSource::getLevelInfoFromCodeChunk(const string &code, LevelInfo &level
             {
                string scriptName = line.substr(pos);
                stripQuotes(scriptName);
-               levelInfo.mScriptFileName = scriptName;
+               header.scriptName = scriptName;
             }
             foundScriptName = true;
             continue;
@@ -289,6 +333,13 @@ string LevelSource::getLevelFileName(S32 index)
 }
 
 
+// Returns full path of the file the specified level is stored in, or "" if the level doesn't live in a file
+string LevelSource::getLevelFilePath(S32 index) const
+{
+   return "";
+}
+
+
 void LevelSource::setLevelFileName(S32 index, const string &filename)
 {
    mLevelInfos[index].filename = filename;
@@ -307,6 +358,12 @@ void LevelSource::remove(S32 index)
 }
 
 
+void LevelSource::clear()
+{
+   mLevelInfos.clear();
+}
+
+
 // static method
 Vector<string> LevelSource::findAllLevelFilesInFolder(const string &levelDir)
 {
@@ -360,43 +417,29 @@ MultiLevelSource::~MultiLevelSource()
 // Populate all our levelInfos from disk; return true if we managed to load any, false otherwise
 bool MultiLevelSource::loadLevels(FolderManager *folderManager)
 {
-   bool anyLoaded = false;
-
-   for(S32 i = 0; i < mLevelInfos.size(); i++)
-   {
-      if(Parent::populateLevelInfoFromSourceByIndex(i))
-         anyLoaded = true;
-      else
-      {
-         mLevelInfos.erase(i);
-         i--;
-      }
-   }
+   LevelScanner scanner(this);
+   scanner.finish();       // Levels that couldn't be read will have been dropped
 
-   return anyLoaded;
+   return mLevelInfos.size() > 0;
 }
 
 
 // Load specified level, put results in gameObjectDatabase.  Return md5 hash of level
 Level *MultiLevelSource::getLevel(S32 index) const
 {
-   TNLAssert(index >= 0 && index < mLevelInfos.size(), "Index out of bounds!");
-
-   const LevelInfo *levelInfo = &mLevelInfos[index];
-
-   string filename = FolderManager::findLevelFile(levelInfo->folder, levelInfo->filename);
+   string filename = getLevelFilePath(index);
 
    if(filename == "")
    {
-      logprintf("Unable to find level file \"%s\".  Skipping...", levelInfo->filename.c_str());
+      logprintf("Unable to find level file \"%s\".  Skipping...", mLevelInfos[index].filename.c_str());
       return NULL;
    }
 
    Level *level = new Level();      // Deleted by Game
 
-   if(!level->loadLevelFromFile(filename))
+   if(!CompiledLevel::loadLevelFromFile(filename, level))
    {
-      logprintf("Unable to process level file \"%s\".  Skipping...", levelInfo->filename.c_str());
+      logprintf("Unable to process level file \"%s\".  Skipping...", mLevelInfos[index].filename.c_str());
       delete level;
       return NULL;
    }
@@ -405,6 +448,17 @@ Level *MultiLevelSource::getLevel(S32 index) const
 }
 
 
+// Returns full path of the file the specified level is stored in, or "" if it can't be found
+string MultiLevelSource::getLevelFilePath(S32 index) const
+{
+   TNLAssert(index >= 0 && index < mLevelInfos.size(), "Index out of bounds!");
+
+   const LevelInfo *levelInfo = &mLevelInfos[index];
+
+   return FolderManager::findLevelFile(levelInfo->folder, levelInfo->filename);
+}
+
+
 // Returns a textual level descriptor good for logging and error messages and such
 string MultiLevelSource::getLevelFileDescriptor(S32 index) const
 {
@@ -413,23 +467,39 @@ string MultiLevelSource::getLevelFileDescriptor(S32 index) const
 
 
 // Populates levelInfo with data from fullFilename -- returns true if successful, false otherwise
-// Reads 4kb of file and uses what it finds there to populate the levelInfo
 bool MultiLevelSource::populateLevelInfoFromSource(const string &fullFilename, LevelInfo &levelInfo)
 {
    // Check if we got a dud... (FolderManager::findLevelFile() will, for example, return "" if it fails)
    if(fullFilename.empty())
       return false;
 
-   FILE *f = fopen(fullFilename.c_str(), "rb");
-   if(!f)
+   LevelInfoDb::LevelHeader header = levelInfo.getHeader();
+
+   if(!readLevelHeader(fullFilename, header))
    {
       logprintf(LogConsumer::LogWarning, "Could not read level file %s [%s]... Skipping...",
          levelInfo.filename.c_str(), fullFilename.c_str());
       return false;
    }
 
-   Level level;
-   level.loadLevelFromFile(fullFilename);
+   levelInfo.setHeader(header);
+   levelInfo.ensureLevelInfoHasValidName();
+   return true;
+}
+
+
+// Fills header with data from fullFilename -- returns false if the file couldn't be read.  Uses the header of the
+// compiled level if there is one, otherwise reads 4kb of file and uses what it finds there.  Doesn't touch the
+// string table, so it can be run on a worker thread.  Static method.
+bool MultiLevelSource::readLevelHeader(const string &fullFilename, LevelInfoDb::LevelHeader &header)
+{
+   // This will compile the level if it can, so it will load quickly when it comes up in the rotation
+   if(CompiledLevel::getLevelHeaderFromFile(fullFilename, header))
+      return true;
+
+   FILE *f = fopen(fullFilename.c_str(), "rb");
+   if(!f)
+      return false;
 
    // some ideas for getting the area of a level:
    //   if(loadLevel())
@@ -523,10 +593,8 @@ bool MultiLevelSource::populateLevelInfoFromSource(const string &fullFilename, L
    S32 size = (S32)fread(data, 1, sizeof(data), f);
    fclose(f);
 
-   getLevelInfoFromCodeChunk(string(data, size), levelInfo);     // Fills levelInfo with data from file
-
+   getLevelHeaderFromCodeChunk(string(data, size), header);     // Fills header with data from file
 
-   levelInfo.ensureLevelInfoHasValidName();
    return true;
 }
 
@@ -576,33 +644,13 @@ PlaylistLevelSource::~PlaylistLevelSource()
 }
 
 
-// Load specified level, put results in gameObjectDatabase
-Level *PlaylistLevelSource::getLevel(S32 index) const
+string PlaylistLevelSource::getLevelFilePath(S32 index) const
 {
    TNLAssert(index >= 0 && index < mLevelInfos.size(), "Index out of bounds!");
 
-   const LevelInfo *levelInfo = &mLevelInfos[index];
-
    FolderManager *folderManager = mGameSettings->getFolderManager();
 
-   string filename = folderManager->findLevelFile(folderManager->getLevelDir(), levelInfo->filename);
-
-   if(filename == "")
-   {
-      logprintf("Unable to find level file \"%s\".  Skipping...", levelInfo->filename.c_str());
-      return NULL;
-   }
-
-   Level *level = new Level();      // Will be deleted by caller
-
-   if(!level->loadLevelFromFile(filename))
-   {
-      logprintf("Unable to process level file \"%s\".  Skipping...", levelInfo->filename.c_str());
-      delete level;
-      return NULL;
-   }
-
-   return level;
+   return folderManager->findLevelFile(folderManager->getLevelDir(), mLevelInfos[index].filename);
 }
 
 
@@ -663,6 +711,12 @@ Level *TestPlaylistLevelSource::getLevel(S32 index) const
 }
 
 
+string TestPlaylistLevelSource::getLevelFilePath(S32 index) const
+{
+   return "";     // Levels here don't really exist
+}
+
+
 bool TestPlaylistLevelSource::isEmptyLevelDirOk() const
 {
    return true;      // No folder needed -- we're testing!
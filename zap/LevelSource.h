@@ -19,6 +19,11 @@
 using namespace TNL;
 using namespace std;
 
+namespace LevelInfoDb
+{
+   struct LevelHeader;
+}
+
 namespace Zap
 {
 
@@ -56,6 +61,9 @@ public:
    const char *getLevelTypeName();
    void writeToStream(ostream &stream, const string &hash) const;
    void ensureLevelInfoHasValidName();
+
+   LevelInfoDb::LevelHeader getHeader() const;
+   void setHeader(const LevelInfoDb::LevelHeader &header);
 };
 
 
@@ -76,6 +84,7 @@ protected:
 
 public:
    static const string TestFileName;
+   static bool isTestFile(const string &filename);
 
    LevelSource();             // Constructor
    virtual ~LevelSource();    // Destructor
@@ -84,6 +93,7 @@ public:
    LevelInfo getLevelInfo(S32 index);
 
    void remove(S32 index);    // Remove level from the list of levels
+   void clear();              // Remove them all
 
    pair<S32, bool> addLevel(LevelInfo levelInfo);   // Yes, pass by value
    void addNewLevel(const LevelInfo &levelInfo);
@@ -98,6 +108,7 @@ public:
    virtual bool populateLevelInfoFromSourceByIndex(S32 levelInfoIndex);
 
    virtual Level *getLevel(S32 index) const = 0;
+   virtual string getLevelFilePath(S32 index) const;
    virtual bool loadLevels(FolderManager *folderManager);
    virtual string getLevelFileDescriptor(S32 index) const = 0;
    virtual bool isEmptyLevelDirOk() const = 0;
@@ -108,6 +119,7 @@ public:
    // The following populate levelInfo
    static bool getLevelInfoFromDatabase(const string &hash, LevelInfo &levelInfo);
    static void getLevelInfoFromCodeChunk(const string &code, LevelInfo &levelInfo);     
+   static void getLevelHeaderFromCodeChunk(const string &code, LevelInfoDb::LevelHeader &header);
 };
 
 
@@ -125,10 +137,13 @@ public:
 
    bool loadLevels(FolderManager *folderManager);
    Level *getLevel(S32 index) const;
+   string getLevelFilePath(S32 index) const;
    string getLevelFileDescriptor(S32 index) const;
    virtual bool isEmptyLevelDirOk() const;
 
    bool populateLevelInfoFromSource(const string &fullFilename, LevelInfo &levelInfo);
+
+   static bool readLevelHeader(const string &fullFilename, LevelInfoDb::LevelHeader &header);
 };
 
 
@@ -162,7 +177,7 @@ public:
    PlaylistLevelSource(const Vector<string> &levelList, const string &folder, GameSettings *settings);     // Constructor
    virtual ~PlaylistLevelSource();                                                                                                                // Destructor
 
-   virtual Level *getLevel(S32 index) const;
+   string getLevelFilePath(S32 index) const;
 
    static Vector<string> findAllFilesInPlaylist(const string &fileName, const string &levelDir);
 };
@@ -180,6 +195,7 @@ public:
    TestPlaylistLevelSource(const Vector<string> &levelList, GameSettings *settings);     // Constructor
 
    Level *getLevel(S32 index) const;
+   string getLevelFilePath(S32 index) const;
    bool isEmptyLevelDirOk() const;
 };
 
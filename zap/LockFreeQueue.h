@@ -0,0 +1,95 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _LOCK_FREE_QUEUE_H_
+#define _LOCK_FREE_QUEUE_H_
+
+#include "tnlTypes.h"
+
+#ifdef TNL_COMPILER_VISUALC
+#  include <intrin.h>
+#endif
+
+using namespace TNL;
+
+namespace Zap
+{
+
+// Makes sure everything we wrote before this is visible to other threads before anything we write after it
+inline void memoryBarrier()
+{
+#ifdef TNL_COMPILER_VISUALC
+   _ReadWriteBarrier();
+#else
+   __sync_synchronize();
+#endif
+}
+
+
+// Fixed size queue for passing things from one thread to another without locking.  Exactly one thread may push,
+// and exactly one (other) thread may pop.  Each side only ever writes its own index, so neither ever waits on the other;
+// if the queue is full, push fails and it's up to the caller to decide what to drop.
+template <class T, U32 Size>
+class LockFreeQueue
+{
+private:
+   T mItems[Size + 1];           // One slot always stays empty, so we can tell full from empty
+   volatile U32 mHead;           // Next item to pop; only written by the consumer
+   volatile U32 mTail;           // Next slot to push into; only written by the producer
+
+public:
+   LockFreeQueue()
+   {
+      mHead = 0;
+      mTail = 0;
+   }
+
+
+   // Producer only
+   bool push(const T &item)
+   {
+      U32 tail = mTail;
+      U32 next = (tail + 1) % (Size + 1);
+
+      if(next == mHead)
+         return false;
+
+      mItems[tail] = item;
+      memoryBarrier();     // Item must be in place before the consumer can see it
+      mTail = next;
+
+      return true;
+   }
+
+
+   // Consumer only
+   bool pop(T &item)
+   {
+      U32 head = mHead;
+
+      if(head == mTail)
+         return false;
+
+      memoryBarrier();     // Don't read the item until we've seen that it's there
+      item = mItems[head];
+      mItems[head] = T();  // Free anything it was holding on to here, rather than on the producer's next push
+      memoryBarrier();
+      mHead = (head + 1) % (Size + 1);
+
+      return true;
+   }
+
+
+   // Only a hint when called from the producer; it might be emptying as we speak
+   bool isEmpty() const
+   {
+      return mHead == mTail;
+   }
+};
+
+
+};
+
+#endif
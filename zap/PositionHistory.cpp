@@ -0,0 +1,79 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "PositionHistory.h"
+
+namespace Zap
+{
+
+// Constructor
+PositionHistory::PositionHistory()
+{
+   clear();
+}
+
+
+void PositionHistory::clear()
+{
+   mNewest = -1;
+   mCount = 0;
+}
+
+
+// Times are game times, and should never go backwards
+void PositionHistory::record(U32 time, const Point &pos)
+{
+   // Our newest sample isn't SampleInterval past the one before it yet; keep it up to date rather than adding another
+   if(mCount > 1 && mSamples[mNewest].time - mSamples[(mNewest + SampleCount - 1) % SampleCount].time < SampleInterval)
+   {
+      mSamples[mNewest].time = time;
+      mSamples[mNewest].pos = pos;
+      return;
+   }
+
+   mNewest = (mNewest + 1) % SampleCount;
+   mSamples[mNewest].time = time;
+   mSamples[mNewest].pos = pos;
+
+   if(mCount < SampleCount)
+      mCount++;
+}
+
+
+// Finds where we were at the specified time, interpolating between samples.  Times older than our oldest sample
+// get our oldest position, times newer than our newest get our newest.  Returns false if we have no history at all.
+bool PositionHistory::getPos(U32 time, Point &pos) const
+{
+   if(mCount == 0)
+      return false;
+
+   const Sample *later = &mSamples[mNewest];
+
+   if(S32(time - later->time) >= 0)
+   {
+      pos = later->pos;
+      return true;
+   }
+
+   for(S32 i = 1; i < mCount; i++)
+   {
+      const Sample *earlier = &mSamples[(mNewest + SampleCount - i) % SampleCount];
+
+      if(S32(time - earlier->time) >= 0)
+      {
+         F32 t = F32(time - earlier->time) / F32(later->time - earlier->time);
+         pos = earlier->pos + (later->pos - earlier->pos) * t;
+         return true;
+      }
+
+      later = earlier;
+   }
+
+   pos = later->pos;    // Older than anything we've got
+   return true;
+}
+
+
+}
@@ -0,0 +1,51 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _POSITION_HISTORY_H_
+#define _POSITION_HISTORY_H_
+
+#include "Point.h"
+
+#include "tnlTypes.h"
+
+using namespace TNL;
+
+namespace Zap
+{
+
+// Remembers where an object has been over the last MaxHistoryTime ms, so the server can work out where it was
+// when a lagged player saw it.  Positions are sampled at most once every SampleInterval ms into a fixed-size ring,
+// so memory use and lookup cost don't depend on the server's frame rate.
+class PositionHistory
+{
+public:
+   static const U32 SampleInterval = 16;
+   static const U32 MaxHistoryTime = 1000;
+
+private:
+   static const S32 SampleCount = MaxHistoryTime / SampleInterval + 2;    // Enough to straddle MaxHistoryTime
+
+   struct Sample
+   {
+      U32 time;
+      Point pos;
+   };
+
+   Sample mSamples[SampleCount];
+   S32 mNewest;      // Index of most recent sample
+   S32 mCount;       // Number of valid samples
+
+public:
+   PositionHistory();      // Constructor
+
+   void record(U32 time, const Point &pos);
+   bool getPos(U32 time, Point &pos) const;
+   void clear();
+};
+
+
+}
+
+#endif
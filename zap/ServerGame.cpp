@@ -14,6 +14,7 @@
 #include "gameType.h"
 #include "IniFile.h"
 #include "Level.h"
+#include "LevelScanner.h"
 #include "LevelSource.h"
 #include "LevelSpecifierEnum.h" 
 #include "luaGameInfo.h"
@@ -27,6 +28,8 @@
 #include "GeomUtils.h"
 #include "stringUtils.h"
 
+#include "../master/DatabaseAccessThread.h"
+
 
 using namespace TNL;
 
@@ -36,6 +39,39 @@ namespace Zap
 static bool instantiated;           // Just a little something to keep us from creating multiple ServerGames...
 
 
+// Reads a level file on the secondary thread; the contents are handed back to ServerGame to be parsed
+class LevelPreloadThread : public Master::ThreadEntry
+{
+private:
+   ServerGame *mGame;
+   string mFilePath;
+   string mContents;
+   bool mFileFound;
+
+public:
+   LevelPreloadThread(ServerGame *game, const string &filePath)   // Constructor
+   {
+      mGame = game;
+      mFilePath = filePath;
+      mFileFound = false;
+   }
+
+   void run()     // Runs on secondary thread -- don't touch mGame here!
+   {
+      mFileFound = readFile(mFilePath, mContents);
+   }
+
+   void finish()
+   {
+      mGame->onLevelPreloadRead(this, mContents, mFileFound);
+   }
+};
+
+
+////////////////////////////////////////
+////////////////////////////////////////
+
+
 // Constructor -- be sure to see Game constructor too!  Lots going on there!
 ServerGame::ServerGame(const Address &address, GameSettingsPtr settings, LevelSourcePtr levelSource, bool testMode, bool dedicated, bool hostOnServer) : 
       Game(address, settings),
@@ -53,7 +89,7 @@ ServerGame::ServerGame(const Address &address, GameSettingsPtr settings, LevelSo
    mVoteNo = 0;
    mVoteNumber = 0;
    mVoteType = VoteLevelChange;  // Arbitrary
-   mLevelLoadIndex = 0;
+   mLevelScanner = NULL;
    mShutdownOriginator = NULL;
    mHostOnServer = hostOnServer;
 
@@ -107,6 +143,9 @@ ServerGame::ServerGame(const Address &address, GameSettingsPtr settings, LevelSo
 
    mDedicated = dedicated;
 
+   if(mSettings->getSetting<VoiceChatMode>(IniKey::ServerVoiceChatMode) != VoiceChatRelay && !mVoiceMixer.isAvailable())
+      logprintf(LogConsumer::LogWarning, "This server was built without voice chat, so it can only relay voice, not mix it");
+
    mGameSuspended = true;                 // Server starts with zero players
 
    U32 stutter = mSettings->getSimulatedStutter();
@@ -121,6 +160,10 @@ ServerGame::ServerGame(const Address &address, GameSettingsPtr settings, LevelSo
    GameManager::setHostingModePhase(GameManager::NotHosting);
 
    mGameRecorderServer = NULL;
+
+   mPreloadedLevel = NULL;
+   mPreloadLevelIndex = NONE;
+   mLevelWasPreloaded = false;
 }
 
 
@@ -131,6 +174,9 @@ ServerGame::~ServerGame()
       getConnectionToMaster()->disconnect(NetConnection::ReasonSelfDisconnect, "");
 
    cleanUp();
+   cancelLevelPreload();
+
+   delete mLevelScanner;
 
    instantiated = false;
 
@@ -262,25 +308,38 @@ LevelInfo ServerGame::getLevelInfo(S32 index) const
 
 void ServerGame::setLevelSource(LevelSourcePtr levelSource)
 {
+   // Scanner is working on the old levelSource
+   delete mLevelScanner;
+   mLevelScanner = NULL;
+
    mLevelSource = levelSource;    // Old levelSource should get auto-deleted
 }
 
 
 void ServerGame::sendLevelListToLevelChangers(const string &message) const
 {
+   Vector<GameConnection *> levelChangers;
+
    for(S32 i = 0; i < getClientCount(); i++)
    {
       ClientInfo *clientInfo = getClientInfo(i);
       GameConnection *conn = clientInfo->getConnection();
 
-      StringTableEntry msg(message);
-
       if(clientInfo->isLevelChanger() && conn)
-      {
-        conn->sendLevelList(true);
-        if(message != "")
-           conn->s2cDisplayMessage(GameConnection::ColorInfo, SFXNone, message);
-      }
+         levelChangers.push_back(conn);
+   }
+
+   if(levelChangers.size() == 0)
+      return;
+
+   GameConnection::sendLevelList(levelChangers, true);
+
+   if(message != "")
+   {
+      RefPtr<NetEvent> event = TNL_RPC_CONSTRUCT_NETEVENT(levelChangers[0], s2cDisplayMessage, 
+                                                          (GameConnection::ColorInfo, SFXNone, message));
+      for(S32 i = 0; i < levelChangers.size(); i++)
+         levelChangers[i]->postNetEvent(event);
    }
 }
 
@@ -297,12 +356,6 @@ AbstractTeam *ServerGame::getNewTeam()
 }
 
 
-void ServerGame::resetLevelLoadIndex()
-{
-   mLevelLoadIndex = 0;
-}
-
-
 // Return true if the only client connected is the one we passed; don't consider bots
 bool ServerGame::onlyClientIs(GameConnection *client)
 {
@@ -352,32 +405,53 @@ bool ServerGame::populateLevelInfoFromSource(const string &fullFilename, LevelIn
 
 
 // Returns name of level loaded, which will be displayed in the client window during level loading phase of hosting.
-// Can return "" if there was a problem with the level.
+// We only wait here for the first playable level; the rest are added by updateLevelScan() once we're hosting.
 string ServerGame::loadNextLevelInfo()
 {
-   // Last level to process?
-   if(mLevelLoadIndex == mLevelSource->getLevelCount())
+   if(!mLevelScanner)
+      mLevelScanner = new LevelScanner(mLevelSource.get());
+
+   Vector<LevelInfo> addedLevels;
+   mLevelScanner->waitForLevel(addedLevels);
+
+   GameManager::setHostingModePhase(GameManager::DoneLoadingLevels);
+
+   if(mLevelScanner->isDone())
+   {
+      delete mLevelScanner;
+      mLevelScanner = NULL;
+   }
+
+   if(addedLevels.size() == 0)
    {
       TNLAssert(mHostOnServer, "Shouldn't be empty if not using -hostonserver");
-      GameManager::setHostingModePhase(GameManager::DoneLoadingLevels);
       return string("No levels loaded");
    }
 
-   // populateLevelInfoFromSource() will return true if the level was processed successfully
-   string levelName;
-   if(mLevelSource->populateLevelInfoFromSourceByIndex(mLevelLoadIndex))
+   return addedLevels.last().mLevelName.getString();
+}
+
+
+// Adds any levels that have been scanned since the last time we were called
+void ServerGame::updateLevelScan()
+{
+   if(!mLevelScanner)
+      return;
+
+   Vector<LevelInfo> addedLevels;
+   mLevelScanner->update(addedLevels);
+
+   for(S32 i = 0; i < addedLevels.size(); i++)
    {
-      levelName = mLevelSource->getLevelName(mLevelLoadIndex);    // This will be the name specified in the level file we just populated
-      mLevelLoadIndex++;
+      logprintf(LogConsumer::ServerFilter, "\t%s [%s]", addedLevels[i].mLevelName.getString(), addedLevels[i].filename.c_str());
+      levelAddedNotifyClients(addedLevels[i]);
    }
-   else     // Failed to process level; remove it from the list
-      mLevelSource->remove(mLevelLoadIndex);
-
-   // Last level to process?
-   if(mLevelLoadIndex == mLevelSource->getLevelCount())
-      GameManager::setHostingModePhase(GameManager::DoneLoadingLevels);
 
-   return levelName;
+   if(mLevelScanner->isDone())
+   {
+      delete mLevelScanner;
+      mLevelScanner = NULL;
+   }
 }
 
 
@@ -477,6 +551,8 @@ void ServerGame::makeEmptyLevelIfNoGameType()
 // function respects meta-indices, and otherwise expects an absolute index.
 void ServerGame::cycleLevel(S32 nextLevel, bool isReset)
 {
+   U32 switchStartTime = Platform::getRealMilliseconds();
+
    if(mHostOnServer)
    {
       if(mHoster.isValid())
@@ -666,6 +742,11 @@ void ServerGame::cycleLevel(S32 nextLevel, bool isReset)
    sendLevelStatsToMaster();     // Give the master some information about this level for its database
 
    suspendIfNoActivePlayers();   // Does nothing if we're already suspended
+
+   logprintf(LogConsumer::ServerFilter, "Level switch took %d ms (%s)", Platform::getRealMilliseconds() - switchStartTime,
+             mLevelWasPreloaded ? "preloaded" : "not preloaded");
+
+   startLevelPreload();          // Get started on the level after this one
 }
 
 
@@ -674,6 +755,10 @@ bool ServerGame::loadNextLevel(S32 nextLevel)
 {
    bool loaded = false;
 
+   // Random levels are picked when we start preloading, so stick with that choice
+   if(nextLevel == RANDOM_LEVEL && mPreloadLevelIndex != NONE)
+      nextLevel = mPreloadLevelIndex;
+
    while(!loaded)
    {
       mCurrentLevelIndex = getAbsoluteLevelIndex(nextLevel); // Set mCurrentLevelIndex to refer to the next level we'll play
@@ -724,7 +809,14 @@ bool ServerGame::loadNextLevel(S32 nextLevel)
 // Returns true if the level is successfully loaded, false if it wasn't
 bool ServerGame::loadLevel()
 {
-   mLevel = boost::shared_ptr<Level>(mLevelSource->getLevel(mCurrentLevelIndex));
+   Level *level = takePreloadedLevel(mCurrentLevelIndex);
+
+   mLevelWasPreloaded = (level != NULL);
+
+   if(!level)
+      level = mLevelSource->getLevel(mCurrentLevelIndex);
+
+   mLevel = boost::shared_ptr<Level>(level);
 
    TNLAssert(!mLevel->getAddedToGame(), "Can't reuse Levels!");
 
@@ -799,6 +891,97 @@ bool ServerGame::loadLevel()
 }
 
 
+// Figure out which level we'll most likely play next, and start reading it so it's ready when this game ends.  Called when
+// a level starts, and again when it ends, by which time we know for sure what's coming.
+void ServerGame::startLevelPreload()
+{
+   if(mHostOnServer || mShuttingDown || mLevelSource->getLevelCount() == 0)
+      return;
+
+   // Random levels are only picked once; we'll go with whatever we're already preparing
+   if(mNextLevel == RANDOM_LEVEL && mPreloadLevelIndex != NONE)
+      return;
+
+   S32 levelIndex = getAbsoluteLevelIndex(mNextLevel);
+
+   if(levelIndex == mPreloadLevelIndex)
+      return;
+
+   cancelLevelPreload();
+
+   string filePath = mLevelSource->getLevelFilePath(levelIndex);
+
+   if(filePath == "")      // Level isn't stored in a file, or has gone missing; loadLevel() will deal with it
+      return;
+
+   mPreloadLevelIndex = levelIndex;
+   mPreloadFilePath = filePath;
+   mPreloadThread = new LevelPreloadThread(this, filePath);
+
+   getSecondaryThread()->addEntry(mPreloadThread);
+}
+
+
+void ServerGame::cancelLevelPreload()
+{
+   mPreloadThread = NULL;     // If it's still reading, its results will be ignored
+
+   delete mPreloadedLevel;
+   mPreloadedLevel = NULL;
+
+   mPreloadLevelIndex = NONE;
+   mPreloadFilePath = "";
+}
+
+
+// Called every tick; parses a few more lines of the level we're preloading
+void ServerGame::updateLevelPreload()
+{
+   if(mPreloadedLevel && mPreloadedLevel->isLoading())
+      mPreloadedLevel->continueLoading(LevelPreloadTimeBudget);
+}
+
+
+// Called on the primary thread once the file has been read
+void ServerGame::onLevelPreloadRead(LevelPreloadThread *thread, const string &contents, bool fileFound)
+{
+   if(thread != mPreloadThread.getPointer())    // Stale -- we've changed our minds about what's next
+      return;
+
+   mPreloadThread = NULL;
+
+   if(!fileFound)
+   {
+      cancelLevelPreload();   // loadLevel() will report the problem when the time comes
+      return;
+   }
+
+   mPreloadedLevel = new Level();
+   mPreloadedLevel->beginLoadFromString(contents, mPreloadFilePath);
+}
+
+
+// Returns the preloaded level if it's the one at levelIndex, or NULL if the caller will need to load it.  Either way, the
+// preloader is reset.
+Level *ServerGame::takePreloadedLevel(S32 levelIndex)
+{
+   Level *level = NULL;
+
+   // Make sure the level list hasn't shifted since we started
+   if(mPreloadedLevel && levelIndex == mPreloadLevelIndex && mLevelSource->getLevelFilePath(levelIndex) == mPreloadFilePath)
+   {
+      level = mPreloadedLevel;
+      mPreloadedLevel = NULL;
+
+      level->continueLoading(U32_MAX);    // Finish up, if we ran out of time
+   }
+
+   cancelLevelPreload();
+
+   return level;
+}
+
+
 void ServerGame::onConnectedToMaster()
 {
    Parent::onConnectedToMaster();
@@ -1264,6 +1447,8 @@ bool ServerGame::anyAdminsInGame() const
 // onClientQuit // onPlayerQuit
 void ServerGame::removeClient(ClientInfo *clientInfo)
 {
+   mVoiceMixer.removeSpeaker(clientInfo);
+
    if(mLevel)     // Could be NULL when quitting the game while remote clients are connected
       getGameType()->removeClient(clientInfo);
 
@@ -1467,11 +1652,26 @@ void ServerGame::idle(U32 timeDelta)
    if(GameManager::getHostingModePhase() == GameManager::LoadingLevels)
       return;
 
+   updateLevelScan();
+
    Parent::idle(timeDelta);
 
    processSimulatedStutter(timeDelta);
    processVoting(timeDelta);
 
+   // Mix and send out any voice chat that's waiting
+   if(mVoiceMixer.idle(timeDelta))
+   {
+      Vector<VoiceMixer::Listener> listeners;
+      Vector<VoiceMixer::MixedStream> mixedVoice;
+
+      getVoiceMixListeners(listeners);
+      mVoiceMixer.mix(listeners, mixedVoice);
+
+      if(mixedVoice.size() > 0 && mLevel && mLevel->getGameType())
+         mLevel->getGameType()->sendMixedVoiceChat(mixedVoice);
+   }
+
    if(mSendLevelInfoDelayCount.update(timeDelta) && mSendLevelInfoDelayNetInfo.isValid() && this->getConnectionToMaster())
    {
       this->getConnectionToMaster()->postNetEvent(mSendLevelInfoDelayNetInfo);
@@ -1590,6 +1790,8 @@ void ServerGame::idle(U32 timeDelta)
 
    processDeleteList(timeDelta);
 
+   updateLevelPreload();
+
    // Load a new level if the time is out on the current one
    if(mLevelSwitchTimer.update(timeDelta))
    {
@@ -1613,8 +1815,11 @@ void ServerGame::idle(U32 timeDelta)
 
       // Normalize ratings for this game
       getGameType()->updateRatings();
-      cycleLevel(mNextLevel);
+
+      // Reset mNextLevel first, so the level after this one can be preloaded
+      S32 nextLevel = mNextLevel;
       mNextLevel = getSettings()->getSetting<YesNo>(IniKey::RandomLevels) ? +RANDOM_LEVEL : +NEXT_LEVEL;
+      cycleLevel(nextLevel);
    }
 
    // The host could leave the game in a middle of next level upload, then we have to shut down
@@ -1717,6 +1922,7 @@ void ServerGame::processVoting(U32 timeDelta)
             }
             
             bool WaitingToVote = false;
+            RefPtr<NetEvent> event;    // Built once, and posted to everyone who still needs to vote
 
             for(S32 i2 = 0; i2 < getClientCount(); i2++)
             {
@@ -1726,7 +1932,11 @@ void ServerGame::processVoting(U32 timeDelta)
                if(conn && conn->mVote == 0 && !clientInfo->isRobot())
                {
                   WaitingToVote = true;
-                  conn->s2cDisplayMessageESI(GameConnection::ColorInfo, SFXNone, msg, e, s, i);
+
+                  if(event.isNull())
+                     event = TNL_RPC_CONSTRUCT_NETEVENT(conn, s2cDisplayMessageESI, (GameConnection::ColorInfo, SFXNone, msg, e, s, i));
+
+                  conn->postNetEvent(event);
                }
             }
 
@@ -1837,6 +2047,8 @@ void ServerGame::processVoting(U32 timeDelta)
          i.push_back(voteNothing);
          e.push_back(votePass ? "Pass" : "Fail");
 
+         RefPtr<NetEvent> event;
+
          for(S32 i2 = 0; i2 < getClientCount(); i2++)
          {
             ClientInfo *clientInfo = getClientInfo(i2);
@@ -1844,7 +2056,10 @@ void ServerGame::processVoting(U32 timeDelta)
 
             if(conn)
             {
-               conn->s2cDisplayMessageESI(GameConnection::ColorInfo, SFXNone, "Vote %e0 - %i0 yes, %i1 no, %i2 did not vote", e, s, i);
+               if(event.isNull())
+                  event = TNL_RPC_CONSTRUCT_NETEVENT(conn, s2cDisplayMessageESI, 
+                                                     (GameConnection::ColorInfo, SFXNone, "Vote %e0 - %i0 yes, %i1 no, %i2 did not vote", e, s, i));
+               conn->postNetEvent(event);
 
                if(!votePass && clientInfo->getName() == mVoteClientName)
                   conn->mVoteTime = settings.getVal<YesNo>(IniKey::VoteRetryLength) * 1000;
@@ -1936,6 +2151,8 @@ bool ServerGame::startHosting()
 void ServerGame::gameEnded()
 {
    mLevelSwitchTimer.reset();
+
+   startLevelPreload();    // In case things have changed since the game started, e.g. a vote for a different level
 }
 
 
@@ -1948,13 +2165,20 @@ Ship *ServerGame::getLocalPlayerShip() const
 void ServerGame::levelAddedNotifyClients(const LevelInfo &levelInfo)
 {
    // Let levelChangers know about the new level if it was just added
+   RefPtr<NetEvent> event;
+
    for(S32 i = 0; i < getClientCount(); i++)
    {
       ClientInfo *clientInfo = getClientInfo(i);
       GameConnection *conn = clientInfo->getConnection();
 
       if(clientInfo->isLevelChanger() && conn)
-         conn->s2cAddLevel(levelInfo.mLevelName, levelInfo.mLevelType);
+      {
+         if(event.isNull())
+            event = TNL_RPC_CONSTRUCT_NETEVENT(conn, s2cAddLevel, (levelInfo.mLevelName, levelInfo.mLevelType));
+
+         conn->postNetEvent(event);
+      }
    }
 }
 
@@ -2154,5 +2378,33 @@ GameRecorderServer *ServerGame::getGameRecorder()
 }
 
 
+VoiceMixer *ServerGame::getVoiceMixer()
+{
+   return &mVoiceMixer;
+}
+
+
+// Everyone who should get mixed voice chat, and who they've muted
+void ServerGame::getVoiceMixListeners(Vector<VoiceMixer::Listener> &listeners) const
+{
+   for(S32 i = 0; i < mClientInfos.size(); i++)
+   {
+      GameConnection *conn = mClientInfos[i]->getConnection();
+
+      if(!conn || !conn->mVoiceChatEnabled || !conn->canHearMixedVoiceChat())
+         continue;
+
+      VoiceMixer::Listener listener;
+      listener.clientInfo = mClientInfos[i];
+
+      for(S32 j = 0; j < mClientInfos.size(); j++)
+         if(conn->isVoiceMuted(mClientInfos[j]->getName()))
+            listener.muted.push_back(mClientInfos[j]);
+
+      listeners.push_back(listener);
+   }
+}
+
+
 };
 
@@ -13,6 +13,7 @@
 #include "LevelSource.h"         // For LevelSourcePtr def
 #include "RobotManager.h"
 #include "TeamHistoryManager.h"
+#include "VoiceMixer.h"
 
 #include "Intervals.h"
 
@@ -30,6 +31,8 @@ class ItemSpawn;
 struct LevelInfo;
 
 class GameRecorderServer;
+class LevelPreloadThread;
+class LevelScanner;
 
 static const string UploadPrefix = "upload_";
 static const string DownloadPrefix = "download_";
@@ -63,7 +66,7 @@ private:
    SafePtr<GameConnection> mShutdownOriginator;   // Who started the shutdown?
 
    bool mDedicated;
-   S32 mLevelLoadIndex;                   // For keeping track of where we are in the level loading process.  NOT CURRENT LEVEL IN PLAY!
+   LevelScanner *mLevelScanner;           // Reads level headers during startup; NULL once all levels are in
 
    SafePtr<GameConnection> mSuspendor;    // Player requesting suspension if game suspended by request
    Timer mTimeToSuspend;
@@ -76,6 +79,17 @@ private:
 
    TeamHistoryManager mTeamHistoryManager;
 
+   VoiceMixer mVoiceMixer;                // Combines voice chat when lots of people are talking at once
+
+   // The next level is read and parsed a bit at a time during the current game, so switching levels doesn't stall the server
+   RefPtr<LevelPreloadThread> mPreloadThread;   // Reads the level file on the secondary thread
+   Level *mPreloadedLevel;                      // Being parsed, or ready to go
+   S32 mPreloadLevelIndex;                      // Level we're preloading, or NONE
+   string mPreloadFilePath;
+   bool mLevelWasPreloaded;                     // True if the level in play came from the preloader
+
+   static const U32 LevelPreloadTimeBudget = 2; // Ms per tick we'll spend parsing the next level
+
 public:
    bool mHostOnServer;
    SafePtr<GameConnection> mHoster;
@@ -102,6 +116,7 @@ private:
 
    void updateStatusOnMaster();           // Give master a status report for this server
    void processVoting(U32 timeDelta);     // Manage any ongoing votes
+   void getVoiceMixListeners(Vector<VoiceMixer::Listener> &listeners) const;
    void processSimulatedStutter(U32 timeDelta);
 
    string getLevelFileNameFromIndex(S32 indx);
@@ -116,6 +131,14 @@ private:
    bool loadNextLevel(S32 nextLevel);                 // Find the next valid level, and load it with loadLevel()
    bool loadLevel();                                  // Load the level pointed to by mCurrentLevelIndex
 
+   void startLevelPreload();
+   void cancelLevelPreload();
+   void updateLevelPreload();
+   Level *takePreloadedLevel(S32 levelIndex);
+   void onLevelPreloadRead(LevelPreloadThread *thread, const string &contents, bool fileFound);
+
+   friend class LevelPreloadThread;
+
    AbstractTeam *getNewTeam();
 
    RefPtr<NetEvent> mSendLevelInfoDelayNetInfo;
@@ -173,8 +196,8 @@ public:
 
    void setShuttingDown(bool shuttingDown, U16 time, GameConnection *who, StringPtr reason);  
 
-   void resetLevelLoadIndex();
    string loadNextLevelInfo();
+   void updateLevelScan();
    bool populateLevelInfoFromSource(const string &fullFilename, LevelInfo &levelInfo) const;
 
    void deleteLevelGen(LuaLevelGenerator *levelgen);     // Add misbehaved levelgen to the kill list
@@ -284,6 +307,7 @@ public:
    void onClientChangedRoles(ClientInfo *clientInfo);
 
    GameRecorderServer *getGameRecorder();
+   VoiceMixer *getVoiceMixer();
 
    friend class ObjectTest;
 };
@@ -17,6 +17,7 @@ EnumParser<YesNo>              yesNoEnumParser;
 EnumParser<MessageType>        messageTypeEnumParser;
 EnumParser<GoalZoneFlashStyle> goalZoneFlashEnumParser;
 EnumParser<RelAbs>             relativeAbsoluteEnumParser;
+EnumParser<VoiceChatMode>      voiceChatModeEnumParser;
 
 
 class EnumInitializer
@@ -51,6 +52,10 @@ public:
 #define RELATIVE_ABSOLUTE_ITEM(value, name) relativeAbsoluteEnumParser.addItem(name, value);
     RELATIVE_ABSOLUTE_TABLE
 #undef RELATIVE_ABSOLUTE_ITEM
+
+#define VOICE_CHAT_MODE_ITEM(value, name) voiceChatModeEnumParser.addItem(name, value);
+    VOICE_CHAT_MODE_TABLE
+#undef VOICE_CHAT_MODE_ITEM
    }
 };
 
@@ -76,6 +81,7 @@ template<> YesNo              Evaluator::fromString(const string &val) { return
 template<> RelAbs             Evaluator::fromString(const string &val) { return relativeAbsoluteEnumParser.getVal(val); }
 template<> ColorEntryMode     Evaluator::fromString(const string &val) { return colorEntryModeEnumParser.getVal(val);   }
 template<> GoalZoneFlashStyle Evaluator::fromString(const string &val) { return goalZoneFlashEnumParser.getVal(val);    }
+template<> VoiceChatMode      Evaluator::fromString(const string &val) { return voiceChatModeEnumParser.getVal(val);    }
 template<> Color              Evaluator::fromString(const string &val) { return Color::iniValToColor(val);              }
 
 
@@ -91,6 +97,7 @@ string Evaluator::toString(RelAbs val)             { return relativeAbsoluteEnum
 string Evaluator::toString(DisplayMode val)        { return displayModeEnumParser.getKey(val);      }
 string Evaluator::toString(ColorEntryMode val)     { return colorEntryModeEnumParser.getKey(val);   }
 string Evaluator::toString(GoalZoneFlashStyle val) { return goalZoneFlashEnumParser.getKey(val);    }
+string Evaluator::toString(VoiceChatMode val)      { return voiceChatModeEnumParser.getKey(val);    }
 string Evaluator::toString(const Color &color)     { return color.toHexStringForIni();              }
 
 }
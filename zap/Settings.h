@@ -107,6 +107,7 @@ public:
    static string toString(DisplayMode val);
    static string toString(ColorEntryMode val);
    static string toString(GoalZoneFlashStyle val);
+   static string toString(VoiceChatMode val);
    static string toString(const Color &color);
 };
 
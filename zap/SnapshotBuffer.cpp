@@ -0,0 +1,99 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "SnapshotBuffer.h"
+
+#include "MathUtils.h"
+
+namespace Zap
+{
+
+// Constructor
+SnapshotBuffer::SnapshotBuffer()
+{
+   clear();
+}
+
+
+void SnapshotBuffer::clear()
+{
+   mNewest = -1;
+   mCount = 0;
+}
+
+
+S32 SnapshotBuffer::getCount() const
+{
+   return mCount;
+}
+
+
+// Times are client game times.  An update stamped no later than our newest snapshot (several arriving in the same
+// frame, or our estimate of the latency shifting) just replaces it, so our snapshots always stay in order.
+void SnapshotBuffer::push(U32 time, const Point &pos, const Point &vel, F32 angle)
+{
+   if(mCount == 0 || S32(time - mSnapshots[mNewest].time) > 0)
+   {
+      mNewest = (mNewest + 1) % SnapshotCount;
+      mSnapshots[mNewest].time = time;
+
+      if(mCount < SnapshotCount)
+         mCount++;
+   }
+
+   Snapshot &snapshot = mSnapshots[mNewest];
+   snapshot.pos = pos;
+   snapshot.vel = vel;
+   snapshot.angle = angle;
+}
+
+
+// Figures out where the ghost was at the specified time, interpolating between the snapshots on either side of it.
+// Times past our newest snapshot are extrapolated along its velocity, but by no more than maxExtrapolation ms, so a
+// ghost we've stopped hearing about will stop rather than sail off into the distance.  Times older than our oldest
+// snapshot get our oldest one.  Returns false if we have no snapshots at all.
+bool SnapshotBuffer::sample(U32 time, U32 maxExtrapolation, Point &pos, Point &vel, F32 &angle) const
+{
+   if(mCount == 0)
+      return false;
+
+   const Snapshot *later = &mSnapshots[mNewest];
+
+   if(S32(time - later->time) >= 0)
+   {
+      U32 ahead = MIN(time - later->time, maxExtrapolation);
+
+      pos = later->pos + later->vel * (ahead * 0.001f);
+      vel = later->vel;
+      angle = later->angle;
+      return true;
+   }
+
+   for(S32 i = 1; i < mCount; i++)
+   {
+      const Snapshot *earlier = &mSnapshots[(mNewest + SnapshotCount - i) % SnapshotCount];
+
+      if(S32(time - earlier->time) >= 0)
+      {
+         F32 t = F32(time - earlier->time) / F32(later->time - earlier->time);
+
+         pos = earlier->pos + (later->pos - earlier->pos) * t;
+         vel = earlier->vel + (later->vel - earlier->vel) * t;
+         angle = earlier->angle + getAngleDiff(earlier->angle, later->angle) * t;
+         return true;
+      }
+
+      later = earlier;
+   }
+
+   // Older than anything we've got
+   pos = later->pos;
+   vel = later->vel;
+   angle = later->angle;
+   return true;
+}
+
+
+}
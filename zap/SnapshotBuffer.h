@@ -0,0 +1,52 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _SNAPSHOT_BUFFER_H_
+#define _SNAPSHOT_BUFFER_H_
+
+#include "Point.h"
+
+#include "tnlTypes.h"
+
+using namespace TNL;
+
+namespace Zap
+{
+
+// Keeps the last few position updates the client has received for a ghost, stamped with when they arrived, so we
+// can render the ghost a little in the past and interpolate between real updates rather than guessing where it
+// went.  Fixed-size ring, so there's no allocation when updates come in.
+class SnapshotBuffer
+{
+public:
+   static const S32 SnapshotCount = 16;      // At our highest update rates, this covers about half a second
+
+private:
+   struct Snapshot
+   {
+      U32 time;
+      Point pos;
+      Point vel;
+      F32 angle;
+   };
+
+   Snapshot mSnapshots[SnapshotCount];
+   S32 mNewest;      // Index of most recent snapshot
+   S32 mCount;       // Number of valid snapshots
+
+public:
+   SnapshotBuffer();       // Constructor
+
+   void push(U32 time, const Point &pos, const Point &vel, F32 angle);
+   bool sample(U32 time, U32 maxExtrapolation, Point &pos, Point &vel, F32 &angle) const;
+   void clear();
+
+   S32 getCount() const;
+};
+
+
+}
+
+#endif
@@ -36,6 +36,8 @@ bool SoundEffect::isPlaying()
 
 #else // BF_NO_AUDIO
 
+#include "SoundSystem.h"
+
 namespace Zap {
 
 extern SFXProfile *gSFXProfiles;
@@ -50,12 +52,14 @@ SoundEffect::SoundEffect(U32 profileIndex, ByteBufferPtr ib, F32 gain, Point pos
    mSourceIndex = -1;
    mPriority = 0;
    mInitialBuffer = ib;
+   mVoiceSpeakerId = 0;
 }
 
 // Destructor
 SoundEffect::~SoundEffect()
 {
-   // Do nothing
+   if(mVoiceSpeakerId != 0)
+      SoundSystem::removeVoiceSpeaker(this);
 }
 
 
@@ -38,6 +38,7 @@ public:
    F32 mGain;
    S32 mSourceIndex;
    F32 mPriority;
+   U32 mVoiceSpeakerId;    // Incoming voice chat only: who the audio worker thinks is talking; 0 until they say something
 
    SoundEffect(U32 profileIndex, ByteBufferPtr ib, F32 gain, Point position, Point velocity);
    virtual ~SoundEffect();
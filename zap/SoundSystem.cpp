@@ -9,6 +9,7 @@
 
 #ifndef BF_NO_AUDIO
 
+#include "AudioWorker.h"
 #include "SFXProfile.h"
 #include "config.h"
 #include "UI.h"
@@ -20,6 +21,7 @@
 
 #include "tnlByteBuffer.h"
 #include "tnlNetBase.h"
+#include "tnlPlatform.h"
 
 
 #ifdef TNL_OS_WIN32
@@ -236,6 +238,26 @@ static Vector<ALuint> gFreeSources;
 static Vector<ALuint> gVoiceFreeBuffers;
 static Vector<SFXHandle> gPlayList;
 
+
+// Decodes incoming voice chat, and keeps our music streams topped up, off the game thread
+class SoundSystemWorker : public AudioWorker
+{
+   typedef AudioWorker Parent;
+
+public:
+   void process(U32 currentTime)
+   {
+      Parent::process(currentTime);
+      alureUpdate();
+   }
+};
+
+static SoundSystemWorker *gAudioWorker = NULL;
+static Vector<SoundEffect *> gVoiceSpeakers;       // Everyone who's talked to us, so we know where to play what they said
+static U32 gLastVoiceSpeakerId = 0;
+
+static volatile bool gMusicTrackEnded = false;     // Set by alure, possibly on the audio thread
+
 // Music specific static initializations
 MusicData SoundSystem::mMusicData;
 
@@ -414,6 +436,9 @@ void SoundSystem::init(SfxSet sfxSet, const Vector<string> &sfxDirs, const strin
    gVoiceFreeBuffers.resize(NumVoiceChatBuffers);
    alGenBuffers(NumVoiceChatBuffers, gVoiceFreeBuffers.address());
 
+   gAudioWorker = new SoundSystemWorker();    // Deleted in shutdown()
+   gAudioWorker->startThread();
+
    gSFXValid = true;
 }
 
@@ -423,6 +448,15 @@ void SoundSystem::shutdown()
    if(!gSFXValid)
       return;
 
+   // Stop the audio thread before we pull anything out from under it
+   gAudioWorker->stopThread();
+   delete gAudioWorker;
+   gAudioWorker = NULL;
+
+   for(S32 i = 0; i < gVoiceSpeakers.size(); i++)
+      gVoiceSpeakers[i]->mVoiceSpeakerId = 0;
+   gVoiceSpeakers.clear();
+
    // Stop and clean up music
    if(musicSystemValid())
    {
@@ -619,7 +653,9 @@ void SoundSystem::processAudio(U32 timeDelta, F32 sfxVol, F32 musicVol, F32 voic
    processMusic(timeDelta, musicVol, musicLocation);
    processVoiceChat();
 
-   alureUpdate();
+   // Normally the audio thread does this
+   if(!gAudioWorker || !gAudioWorker->isRunning())
+      alureUpdate();
 }
 
 
@@ -638,6 +674,23 @@ void SoundSystem::processMusic(U32 timeDelta, F32 musicVol, MusicLocation musicL
    if(!musicSystemValid())
       return;
 
+   // Clean up after the last track here, rather than in the callback, which might be on the audio thread
+   if(gMusicTrackEnded)
+   {
+      gMusicTrackEnded = false;
+
+      alureDestroyStream(mMusicData.stream, 0, NULL);
+
+      // If in-game, go to the next track
+      if(mMusicData.currentLocation == MusicLocationGame)
+         mGameMusicList.nextFile(true);    // Loops if we hit the end of the list
+
+      mMusicData.state = MusicStateStopped;
+
+      // Send command to start next song
+      mMusicData.command = MusicCommandPlay;
+   }
+
    // Adjust music volume only if changed
    if(S32(mMusicData.volume * 10) != S32(musicVol * 10))
    {
@@ -860,9 +913,37 @@ void SoundSystem::processMusic(U32 timeDelta, F32 musicVol, MusicLocation musicL
 }
 
 
+// Picks up whatever voice chat the audio thread has decoded, and queues it up to play
 void SoundSystem::processVoiceChat()
 {
-   // TODO move voiceChat logic here
+   if(!gAudioWorker)
+      return;
+
+   if(!gAudioWorker->isRunning())      // Couldn't get a thread, so we'll have to do the decoding ourselves
+      gAudioWorker->process(Platform::getRealMilliseconds());
+
+   AudioWorker::VoiceSamples samples;
+
+   while(gAudioWorker->getVoiceSamples(samples))
+   {
+      SoundEffect *effect = NULL;
+
+      for(S32 i = 0; i < gVoiceSpeakers.size(); i++)
+         if(gVoiceSpeakers[i]->mVoiceSpeakerId == samples.speakerId)
+         {
+            effect = gVoiceSpeakers[i];
+            break;
+         }
+
+      if(!effect)       // They left while we were decoding
+         continue;
+
+      U32 size = samples.samples.size() * sizeof(S16);
+      ByteBufferPtr buffer = new ByteBuffer(size);
+      memcpy(buffer->getBuffer(), samples.samples.address(), size);
+
+      playVoiceChatSamples(effect, buffer);
+   }
 }
 
 
@@ -1020,7 +1101,8 @@ void SoundSystem::updateGain(SFXHandle& effect, F32 sfxVol, F32 voiceVol)
 }
 
 
-// This only called when playing an incoming voice chat message
+// This only called when playing an incoming voice chat message.  We'll hand it to the audio thread for decoding, and
+// play it once it comes back in processVoiceChat().
 void SoundSystem::queueVoiceChatBuffer(const SFXHandle &effect, ByteBufferPtr p)
 {
    if(!gSFXValid)
@@ -1029,6 +1111,38 @@ void SoundSystem::queueVoiceChatBuffer(const SFXHandle &effect, ByteBufferPtr p)
    if(!p->getBufferSize())
       return;
 
+   if(effect->mVoiceSpeakerId == 0)
+   {
+      gLastVoiceSpeakerId++;
+      effect->mVoiceSpeakerId = gLastVoiceSpeakerId;
+      gVoiceSpeakers.push_back(effect.getPointer());
+   }
+
+   gAudioWorker->addVoicePacket(effect->mVoiceSpeakerId, p->getBuffer(), p->getBufferSize());
+}
+
+
+// Called when a speaker's SoundEffect goes away
+void SoundSystem::removeVoiceSpeaker(SoundEffect *effect)
+{
+   for(S32 i = 0; i < gVoiceSpeakers.size(); i++)
+      if(gVoiceSpeakers[i] == effect)
+      {
+         gVoiceSpeakers.erase_fast(i);
+         break;
+      }
+
+   if(gAudioWorker)
+      gAudioWorker->removeSpeaker(effect->mVoiceSpeakerId);
+}
+
+
+// Decoded samples from the audio thread
+void SoundSystem::playVoiceChatSamples(const SFXHandle &effect, ByteBufferPtr p)
+{
+   if(!p->getBufferSize())
+      return;
+
    effect->mInitialBuffer = p;
    if(effect->mSourceIndex != -1)
    {
@@ -1067,17 +1181,8 @@ void SoundSystem::queueVoiceChatBuffer(const SFXHandle &effect, ByteBufferPtr p)
 // This method is called after a music track finishes playing in-game
 void SoundSystem::music_end_callback(void* userdata, ALuint source)
 {
-   // Clean up the stream
-   alureDestroyStream(mMusicData.stream, 0, NULL);
-
-   // If in-game, go to the next track
-   if(mMusicData.currentLocation == MusicLocationGame)
-      mGameMusicList.nextFile(true);    // Loops if we hit the end of the list
-
-   mMusicData.state = MusicStateStopped;
-
-   // Send command to start next song
-   mMusicData.command = MusicCommandPlay;
+   // Streams usually end on the audio thread, so leave the cleanup for processMusic()
+   gMusicTrackEnded = true;
 }
 
 
@@ -118,6 +118,8 @@ private:
 
    static bool musicSystemValid();
 
+   static void playVoiceChatSamples(const SFXHandle &effect, ByteBufferPtr p);
+
 public:
    SoundSystem();
    virtual ~SoundSystem();
@@ -143,7 +145,8 @@ public:
 
    // Voice Chat functions
    static void processVoiceChat();
-   static void queueVoiceChatBuffer(const SFXHandle &effect, ByteBufferPtr p);
+   static void queueVoiceChatBuffer(const SFXHandle &effect, ByteBufferPtr p);    // p is still compressed
+   static void removeVoiceSpeaker(SoundEffect *effect);
    static bool startRecording();
    static void captureSamples(ByteBufferPtr sampleBuffer);
    static void stopRecording();
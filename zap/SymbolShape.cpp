@@ -15,6 +15,9 @@
 #include "RenderUtils.h"
 #include "stringUtils.h"
 
+#include <list>
+#include <map>
+
 using namespace TNL;
 
 
@@ -752,8 +755,8 @@ static void getSymbolShape(const InputCodeManager *inputCodeManager, const strin
 
 // Pass true for block if this is part of a block of text, and empty lines should be accorded their full height.
 // Pass false if this is a standalone string where and empty line should have zero height.
-void SymbolString::symbolParse(const InputCodeManager *inputCodeManager, const string &str, Vector<SymbolShapePtr> &symbols,
-                              FontContext fontContext, S32 fontSize, bool block, const Color *textColor, const Color *symbolColor)
+static void parseSymbols(const InputCodeManager *inputCodeManager, const string &str, Vector<SymbolShapePtr> &symbols,
+                         FontContext fontContext, S32 fontSize, bool block, const Color *textColor, const Color *symbolColor)
 {
    if(!block && str == "")
       return;
@@ -789,6 +792,163 @@ void SymbolString::symbolParse(const InputCodeManager *inputCodeManager, const s
 }
 
 
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Parsing markup means looking up bindings and measuring text, and much of our UI does it every frame.  Shapes never
+// change once they're built, so we hang on to the ones we built recently and hand them out again until the bindings
+// or fonts they were built with change.
+
+struct SymbolParseKey
+{
+   string str;
+   const InputCodeManager *inputCodeManager;
+   U32 bindingsRevision;
+   U32 fontsRevision;
+   FontContext fontContext;
+   S32 fontSize;
+   bool block;
+   bool hasTextColor;         // Shapes without a color use whatever color is current when they're drawn
+   Color textColor;
+   bool hasSymbolColor;
+   Color symbolColor;
+
+   bool operator<(const SymbolParseKey &other) const
+   {
+      if(str != other.str)
+         return str < other.str;
+      if(inputCodeManager != other.inputCodeManager)
+         return inputCodeManager < other.inputCodeManager;
+      if(bindingsRevision != other.bindingsRevision)
+         return bindingsRevision < other.bindingsRevision;
+      if(fontsRevision != other.fontsRevision)
+         return fontsRevision < other.fontsRevision;
+      if(fontContext != other.fontContext)
+         return fontContext < other.fontContext;
+      if(fontSize != other.fontSize)
+         return fontSize < other.fontSize;
+      if(block != other.block)
+         return block < other.block;
+      if(hasTextColor != other.hasTextColor)
+         return hasTextColor < other.hasTextColor;
+      if(hasSymbolColor != other.hasSymbolColor)
+         return hasSymbolColor < other.hasSymbolColor;
+
+      S32 textColorOrder = compareColors(textColor, other.textColor);
+      if(textColorOrder != 0)
+         return textColorOrder < 0;
+
+      return compareColors(symbolColor, other.symbolColor) < 0;
+   }
+
+   static S32 compareColors(const Color &a, const Color &b)
+   {
+      if(a.r != b.r)
+         return a.r < b.r ? -1 : 1;
+      if(a.g != b.g)
+         return a.g < b.g ? -1 : 1;
+      if(a.b != b.b)
+         return a.b < b.b ? -1 : 1;
+      return 0;
+   }
+};
+
+
+typedef std::list<std::pair<SymbolParseKey, Vector<SymbolShapePtr> > > SymbolParseList;
+
+static const U32 SymbolParseCacheSize = 512;
+
+static SymbolParseList parsedSymbols;                                           // Most recently used first
+static std::map<SymbolParseKey, SymbolParseList::iterator> parsedSymbolIndex;
+static U32 parseCacheHits = 0;
+static U32 parseCacheMisses = 0;
+
+
+// Appends the symbols in str to symbols
+void SymbolString::symbolParse(const InputCodeManager *inputCodeManager, const string &str, Vector<SymbolShapePtr> &symbols,
+                              FontContext fontContext, S32 fontSize, bool block, const Color *textColor, const Color *symbolColor)
+{
+   if(!block && str == "")
+      return;
+
+   // Tab stops are measured from whatever the caller already has in symbols, so those shapes can't be shared
+   if(str.find("[[TAB_STOP:") != string::npos)
+   {
+      parseSymbols(inputCodeManager, str, symbols, fontContext, fontSize, block, textColor, symbolColor);
+      return;
+   }
+
+   SymbolParseKey key;
+   key.str = str;
+   key.inputCodeManager = inputCodeManager;
+   key.bindingsRevision = inputCodeManager ? inputCodeManager->getBindingsRevision() : 0;
+   key.fontsRevision = FontManager::getFontsRevision();
+   key.fontContext = fontContext;
+   key.fontSize = fontSize;
+   key.block = block;
+   key.hasTextColor = (textColor != NULL);
+   key.textColor = textColor ? *textColor : Color();
+   key.hasSymbolColor = (symbolColor != NULL);
+   key.symbolColor = symbolColor ? *symbolColor : Color();
+
+   std::map<SymbolParseKey, SymbolParseList::iterator>::iterator it = parsedSymbolIndex.find(key);
+
+   if(it != parsedSymbolIndex.end())
+   {
+      parseCacheHits++;
+      parsedSymbols.splice(parsedSymbols.begin(), parsedSymbols, it->second);
+   }
+   else
+   {
+      parseCacheMisses++;
+
+      // Anything keyed by old bindings or fonts will never be asked for again, and will work its way to the back
+      if(parsedSymbolIndex.size() >= SymbolParseCacheSize)
+      {
+         parsedSymbolIndex.erase(parsedSymbols.back().first);
+         parsedSymbols.pop_back();
+      }
+
+      parsedSymbols.push_front(std::make_pair(key, Vector<SymbolShapePtr>()));
+      parsedSymbolIndex[key] = parsedSymbols.begin();
+
+      parseSymbols(inputCodeManager, str, parsedSymbols.front().second, fontContext, fontSize, block, textColor, symbolColor);
+   }
+
+   const Vector<SymbolShapePtr> &parsed = parsedSymbols.front().second;
+
+   for(S32 i = 0; i < parsed.size(); i++)
+      symbols.push_back(parsed[i]);
+}
+
+
+void SymbolString::clearParseCache()
+{
+   parsedSymbols.clear();
+   parsedSymbolIndex.clear();
+   parseCacheHits = 0;
+   parseCacheMisses = 0;
+}
+
+
+U32 SymbolString::getParseCacheSize()
+{
+   return (U32)parsedSymbolIndex.size();
+}
+
+
+U32 SymbolString::getParseCacheHits()
+{
+   return parseCacheHits;
+}
+
+
+U32 SymbolString::getParseCacheMisses()
+{
+   return parseCacheMisses;
+}
+
+
 ////////////////////////////////////////
 ////////////////////////////////////////
 
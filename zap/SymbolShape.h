@@ -445,6 +445,12 @@ public:
    //
    static void symbolParse(const InputCodeManager *inputCodeManager, const string &str, Vector<SymbolShapePtr> &symbols,
                            FontContext fontContext, S32 fontSize, bool block, const Color *textColor = NULL, const Color *symColor = NULL);
+
+   // symbolParse remembers what it built recently
+   static void clearParseCache();
+   static U32 getParseCacheSize();
+   static U32 getParseCacheHits();
+   static U32 getParseCacheMisses();
 };
 
 
@@ -67,8 +67,6 @@ void initHosting(GameSettingsPtr settings, LevelSourcePtr levelSource, bool test
       return;
    }
 
-   GameManager::getServerGame()->resetLevelLoadIndex();
-
    // Does this actually do anything??
    if(hostOnServer)
       GameManager::setHostingModePhase(GameManager::DoneLoadingLevels);
@@ -0,0 +1,120 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "TextLayoutCache.h"
+
+namespace Zap
+{
+
+// Constructor
+TextLayoutCache::Layout::Layout()
+{
+   hasGeometry = false;
+   advance = 0;
+
+   hasWidth = false;
+   width = 0;
+}
+
+
+bool TextLayoutCache::Key::operator<(const Key &other) const
+{
+   if(font != other.font)
+      return font < other.font;
+
+   if(size != other.size)
+      return size < other.size;
+
+   return text < other.text;
+}
+
+
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Constructor
+TextLayoutCache::TextLayoutCache(U32 capacity)
+{
+   mCapacity = capacity;
+   mHits = 0;
+   mMisses = 0;
+}
+
+
+// Destructor
+TextLayoutCache::~TextLayoutCache()
+{
+   // Do nothing
+}
+
+
+// Returns the layout for text drawn at size in font.  If we don't have one, returns a new, empty one for the caller
+// to fill in.  The pointer is good until the next call.
+TextLayoutCache::Layout *TextLayoutCache::get(const BfFont *font, F32 size, const char *text)
+{
+   Key key;
+   key.font = font;
+   key.size = size;
+   key.text = text;
+
+   map<Key, LayoutList::iterator>::iterator it = mIndex.find(key);
+
+   if(it != mIndex.end())
+   {
+      mHits++;
+
+      // Move to the front of the line
+      mLayouts.splice(mLayouts.begin(), mLayouts, it->second);
+      return &mLayouts.front().second;
+   }
+
+   mMisses++;
+
+   if(mIndex.size() >= mCapacity && !mLayouts.empty())
+   {
+      mIndex.erase(mLayouts.back().first);
+      mLayouts.pop_back();
+   }
+
+   mLayouts.push_front(make_pair(key, Layout()));
+   mIndex[key] = mLayouts.begin();
+
+   return &mLayouts.front().second;
+}
+
+
+void TextLayoutCache::clear()
+{
+   mLayouts.clear();
+   mIndex.clear();
+}
+
+
+U32 TextLayoutCache::getSize() const
+{
+   return (U32)mIndex.size();
+}
+
+
+U32 TextLayoutCache::getHits() const
+{
+   return mHits;
+}
+
+
+U32 TextLayoutCache::getMisses() const
+{
+   return mMisses;
+}
+
+
+void TextLayoutCache::resetCounters()
+{
+   mHits = 0;
+   mMisses = 0;
+}
+
+
+};
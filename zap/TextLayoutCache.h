@@ -0,0 +1,79 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _TEXT_LAYOUT_CACHE_H_
+#define _TEXT_LAYOUT_CACHE_H_
+
+#include "tnlTypes.h"
+#include "tnlVector.h"
+
+#include <list>
+#include <map>
+#include <string>
+
+using namespace TNL;
+using namespace std;
+
+struct sth_texture;
+
+namespace Zap
+{
+
+class BfFont;
+
+// Holds the geometry and width of strings we've drawn recently, so we don't have to lay them out from scratch every
+// frame.  When full, the least recently used string gets dropped.
+class TextLayoutCache
+{
+public:
+   struct Layout
+   {
+      bool hasGeometry;
+      Vector<F32> verts;               // Stroke fonts: line segments, in font units.  TTF fonts: six (x, y, s, t) per glyph
+      Vector<sth_texture *> textures;  // TTF fonts only: texture each glyph is drawn from
+      F32 advance;                     // How far along drawing the string moves us
+
+      bool hasWidth;
+      F32 width;
+
+      Layout();
+   };
+
+private:
+   struct Key
+   {
+      const BfFont *font;
+      F32 size;
+      string text;
+
+      bool operator<(const Key &other) const;
+   };
+
+   typedef list<pair<Key, Layout> > LayoutList;
+
+   LayoutList mLayouts;                            // Most recently used first
+   map<Key, LayoutList::iterator> mIndex;
+
+   U32 mCapacity;
+   U32 mHits;
+   U32 mMisses;
+
+public:
+   explicit TextLayoutCache(U32 capacity);    // Constructor
+   virtual ~TextLayoutCache();                // Destructor
+
+   Layout *get(const BfFont *font, F32 size, const char *text);
+   void clear();
+
+   U32 getSize() const;
+   U32 getHits() const;
+   U32 getMisses() const;
+   void resetCounters();
+};
+
+
+};
+
+#endif
@@ -1485,12 +1485,15 @@ Point EditorUserInterface::snapPoint(const Point &p, bool snapWhileOnDock) const
 // we'll make a local copy of closest
 Point EditorUserInterface::snapToObjects(const Point &mousePos, Point closest, F32 minDist) const
 {
-   const Vector<DatabaseObject *> *objList = getLevel()->findObjects_fast();
+   // Anything we could snap to has a vertex within minDist of closest, so it will also have an extent that reaches that
+   // far, and the database can find it for us without us having to look at every object in the level
+   fillVector.clear();
+   getLevel()->findObjects((TestFunc)isAnyObjectType, fillVector, Rect(closest, sqrt(minDist)));
 
    // Now look for other things we might want to snap to
-   for(S32 i = 0; i < objList->size(); i++)
+   for(S32 i = 0; i < fillVector.size(); i++)
    {
-      BfObject *obj = static_cast<BfObject *>(objList->get(i));
+      BfObject *obj = static_cast<BfObject *>(fillVector[i]);
 
       // Don't snap to selected items or items with selected verts (keeps us from snapping to ourselves, which is usually trouble)
       if(obj->isSelected() || obj->anyVertsSelected())
@@ -1509,7 +1512,12 @@ Point EditorUserInterface::snapToObjects(const Point &mousePos, Point closest, F
 
    // Search for a corner to snap to - by using wall edges, we'll also look for intersections between segments.  Sets closest.
    if(getSnapToWallCorners())
-      closest = checkCornersForSnap(mousePos, mLevel->getWallEdgeDatabase()->findObjects_fast(), minDist, closest);
+   {
+      fillVector.clear();
+      mLevel->getWallEdgeDatabase()->findObjects((TestFunc)isAnyObjectType, fillVector, Rect(mousePos, sqrt(minDist)));
+
+      closest = checkCornersForSnap(mousePos, &fillVector, minDist, closest);
+   }
 
    return closest;
 }
@@ -4794,10 +4802,9 @@ void EditorUserInterface::onMouseUp()
    {
       Rect r(convertCanvasToLevelCoord(mMousePos), mMouseDownPos);
 
+      // Only objects that overlap the box can have all their vertices in it
       fillVector.clear();
-
-      getLevel()->findObjects(fillVector);
-
+      getLevel()->findObjects((TestFunc)isAnyObjectType, fillVector, r);
 
       for(S32 i = 0; i < fillVector.size(); i++)
       {
@@ -524,6 +524,7 @@ public:
    friend class EditorTest;
    FRIEND_TEST(EditorTest, findSnapVertexTest);
    FRIEND_TEST(EditorTest, wallCentroidForRotationTest);
+   FRIEND_TEST(EditorTest, snapToObjects);
 };
 
 
@@ -620,6 +620,20 @@ void UIManager::gotServerListFromMaster(const Vector<ServerAddr> &serverList)
 }
 
 
+void UIManager::gotServerStatusFromMaster(const Address &address, S32 serverId, const char *serverName, const char *serverDescr,
+                                          U32 playerCount, U32 maxPlayers, U32 botCount, bool test)
+{
+   getUI<QueryServersUserInterface>()->gotServerStatusFromMaster(address, serverId, serverName, serverDescr, 
+                                                                 playerCount, maxPlayers, botCount, test);
+}
+
+
+void UIManager::gotServerRemovedFromMaster(S32 serverId)
+{
+   getUI<QueryServersUserInterface>()->gotServerRemovedFromMaster(serverId);
+}
+
+
 void UIManager::setPlayersInLobbyChat(const Vector<StringTableEntry> &playerNicks)
 {
    getUI<ChatUserInterface>()->setPlayersInLobbyChat(playerNicks);
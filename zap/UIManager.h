@@ -200,6 +200,9 @@ public:
 
    // QueryServersUI:
    void gotServerListFromMaster(const Vector<ServerAddr> &serverList);
+   void gotServerStatusFromMaster(const Address &address, S32 serverId, const char *serverName, const char *serverDescr,
+                                  U32 playerCount, U32 maxPlayers, U32 botCount, bool test);
+   void gotServerRemovedFromMaster(S32 serverId);
    void gotPingResponse (const Address &address, const Nonce &nonce, U32 clientIdentityToken, S32 clientId);
    void gotQueryResponse(const Address &address, S32 serverId, const Nonce &nonce, const char *serverName, const char *serverDescr, 
                          U32 playerCount, U32 maxPlayers, U32 botCount, bool dedicated, bool test, bool passwordRequired);
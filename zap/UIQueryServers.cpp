@@ -248,6 +248,18 @@ void QueryServersUserInterface::onActivate()
 }
 
 
+void QueryServersUserInterface::onDeactivate(bool nextUIUsesEditorScreenMode)
+{
+   // Stop the master from sending us server list changes while we aren't looking
+   MasterServerConnection *masterConn = getGame()->getConnectionToMaster();
+
+   if(masterConn)
+      masterConn->stopServerQuery();
+
+   Parent::onDeactivate(nextUIUsesEditorScreenMode);
+}
+
+
 // Checks for connection to master, and sets up timer to keep running this until it finds one.  Once a connection is located,
 // it fires off a series of requests to the master asking for servers and chat names.
 void QueryServersUserInterface::contactEveryone()
@@ -289,8 +301,17 @@ void QueryServersUserInterface::contactEveryone()
 
          getUIManager()->setIsInLobbyChat(true);
       }
-      masterConn->startServerQuery(mHostOnServer);
-      mWaitingForResponseFromMaster = true;
+      // If the master is already pushing changes to us, there is no need to ask for the whole list again
+      if(masterConn->isSubscribedToServerList() && mReceivedListOfServersFromMaster)
+      {
+         mMasterRequeryTimer.reset(MasterRequeryTime);
+         mWaitingForResponseFromMaster = false;
+      }
+      else
+      {
+         masterConn->startServerQuery(mHostOnServer);
+         mWaitingForResponseFromMaster = true;
+      }
    }
    else     // Don't have a valid connection object
    {
@@ -417,6 +438,49 @@ void QueryServersUserInterface::addServersToPingList(const Vector<ServerAddr> &s
 }
 
 
+// Master has sent us the status it has cached for a server; use it to fill in the list right away without
+// waiting for our own query to make the round trip.  We'll still ping the server to get our ping time.
+void QueryServersUserInterface::gotServerStatusFromMaster(const Address &address, S32 serverId, const char *serverName, 
+                                                          const char *serverDescr, U32 playerCount, U32 maxPlayers, 
+                                                          U32 botCount, bool test)
+{
+   S32 index = findServerByAddressOrId(servers, address, serverId);
+
+   if(index == -1)
+   {
+      ServerRef server(serverId, address, ServerRef::Start, false);
+      server.sendNonce.getRandom();
+      servers.push_back(server);
+
+      index = servers.size() - 1;
+   }
+
+   ServerRef &s = servers[index];
+
+   // Local servers get their info directly; don't let the master clobber it
+   if(s.isLocalServer)
+      return;
+
+   s.setNameDescr(serverName, serverDescr, Colors::yellow);
+   s.setPlayerBotMax(playerCount, botCount, maxPlayers);
+   s.test = test;
+
+   mShouldSort = true;
+}
+
+
+void QueryServersUserInterface::gotServerRemovedFromMaster(S32 serverId)
+{
+   S32 index = findServerByServerId(servers, serverId);
+
+   if(index != -1 && !servers[index].isLocalServer)
+   {
+      servers.erase_fast(index);
+      mShouldSort = true;
+   }
+}
+
+
 void QueryServersUserInterface::gotPingResponse(const Address &address, const Nonce &nonce, U32 clientIdentityToken, S32 serverId)
 {
    if(nonce == mLocalServerNonce || nonce == mRemoteServerNonce)     // From local broadcast ping or direct ping of remote server
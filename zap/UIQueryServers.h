@@ -202,6 +202,7 @@ public:
    bool isMouseOverDivider() const;
 
    void onActivate();            // Run when select server screeen is displayed
+   void onDeactivate(bool nextUIUsesEditorScreenMode);
    void idle(U32 t);             // Idle loop
 
    void render() const;          // Draw the screen
@@ -212,6 +213,9 @@ public:
                          U32 playerCount, U32 maxPlayers, U32 botCount, bool dedicated, bool test, bool passwordRequired);
 
    void gotServerListFromMaster(const Vector<ServerAddr> &serverList);
+   void gotServerStatusFromMaster(const Address &address, S32 serverId, const char *serverName, const char *serverDescr,
+                                  U32 playerCount, U32 maxPlayers, U32 botCount, bool test);
+   void gotServerRemovedFromMaster(S32 serverId);
 };
 
 
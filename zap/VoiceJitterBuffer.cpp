@@ -0,0 +1,167 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "VoiceJitterBuffer.h"
+
+#include "voiceCodec.h"
+
+#include "tnlByteBuffer.h"
+
+#include <string.h>
+
+namespace Zap
+{
+
+// Constructor
+VoiceJitterBuffer::VoiceJitterBuffer(VoiceDecoder *decoder)
+{
+   mDecoder = decoder;
+   mSamplesPerFrame = decoder->getSamplesPerFrame();
+   mFrameTime = mSamplesPerFrame * 1000 / SampleRate;    // 20ms for Speex narrow-band
+
+   TNLAssert(mFrameTime > 0, "Frames should play for some time!");
+
+   mReadPos = 0;
+   mFirstArrivalTime = 0;
+   mPlaying = false;
+   mPlayedUntil = 0;
+   mConcealedTime = 0;
+
+   mConcealedFrames = 0;
+   mDroppedFrames = 0;
+}
+
+
+// Destructor
+VoiceJitterBuffer::~VoiceJitterBuffer()
+{
+   // Do nothing
+}
+
+
+// Decode a packet and hold on to it until it's time to play
+void VoiceJitterBuffer::addPacket(const U8 *data, U32 size, U32 currentTime)
+{
+   if(size == 0)
+      return;
+
+   ByteBufferPtr compressed = new ByteBuffer(size);
+   memcpy(compressed->getBuffer(), data, size);
+
+   ByteBufferPtr decoded = mDecoder->decompressBuffer(compressed);
+   U32 sampleCount = decoded->getBufferSize() / sizeof(S16);
+
+   if(sampleCount == 0)
+      return;
+
+   if(getFrameCount() == 0)
+      mFirstArrivalTime = currentTime;
+
+   // Slide what we haven't played yet down to the front before adding more
+   U32 remaining = mSamples.size() - mReadPos;
+   memmove(mSamples.address(), mSamples.address() + mReadPos, remaining * sizeof(S16));
+   mSamples.resize(remaining);
+   mReadPos = 0;
+
+   S32 oldSize = mSamples.size();
+   mSamples.resize(oldSize + sampleCount);
+   memcpy(mSamples.address() + oldSize, decoded->getBuffer(), sampleCount * sizeof(S16));
+
+   // Packets that arrived very late are piled up behind others that were on time; rather than let our delay keep
+   // growing, throw out the oldest audio
+   if(getBufferedTime() > MaxDelay)
+   {
+      U32 dropFrames = getFrameCount() - TargetDelay / mFrameTime;
+
+      mReadPos += dropFrames * mSamplesPerFrame;
+      mDroppedFrames += dropFrames;
+   }
+}
+
+
+// Appends whatever audio should go to the sound device by currentTime
+void VoiceJitterBuffer::readSamples(U32 currentTime, Vector<S16> &samples)
+{
+   if(!mPlaying)
+   {
+      if(getFrameCount() == 0)
+         return;
+
+      // Wait until we've got a cushion, or until what we have has waited long enough (the speaker might have stopped
+      // after a very short burst, and there's nothing more coming)
+      if(getBufferedTime() < TargetDelay && currentTime - mFirstArrivalTime < TargetDelay)
+         return;
+
+      mPlaying = true;
+      mPlayedUntil = currentTime;
+      mConcealedTime = 0;
+   }
+
+   // If we fell behind, the sound device already ran dry; no point in trying to catch up
+   if(S32(mPlayedUntil - currentTime) < 0)
+      mPlayedUntil = currentTime;
+
+   while(S32(mPlayedUntil - currentTime) < S32(PlayAhead))
+   {
+      S32 oldSize = samples.size();
+
+      if(getFrameCount() > 0)
+      {
+         samples.resize(oldSize + mSamplesPerFrame);
+         memcpy(samples.address() + oldSize, mSamples.address() + mReadPos, mSamplesPerFrame * sizeof(S16));
+         mReadPos += mSamplesPerFrame;
+
+         mConcealedTime = 0;
+      }
+      else if(mConcealedTime < MaxConcealTime)
+      {
+         samples.resize(oldSize + mSamplesPerFrame);
+         mDecoder->concealFrame(samples.address() + oldSize);
+
+         mConcealedTime += mFrameTime;
+         mConcealedFrames++;
+      }
+      else     // Speaker's done, or gone; wait for a new cushion before we start again
+      {
+         mPlaying = false;
+         break;
+      }
+
+      mPlayedUntil += mFrameTime;
+   }
+}
+
+
+U32 VoiceJitterBuffer::getFrameCount() const
+{
+   return (mSamples.size() - mReadPos) / mSamplesPerFrame;
+}
+
+
+U32 VoiceJitterBuffer::getBufferedTime() const
+{
+   return getFrameCount() * mFrameTime;
+}
+
+
+bool VoiceJitterBuffer::isPlaying() const
+{
+   return mPlaying;
+}
+
+
+U32 VoiceJitterBuffer::getConcealedFrames() const
+{
+   return mConcealedFrames;
+}
+
+
+U32 VoiceJitterBuffer::getDroppedFrames() const
+{
+   return mDroppedFrames;
+}
+
+
+};
@@ -0,0 +1,69 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _VOICE_JITTER_BUFFER_H_
+#define _VOICE_JITTER_BUFFER_H_
+
+#include "tnlNetBase.h"
+#include "tnlTypes.h"
+#include "tnlVector.h"
+
+using namespace TNL;
+
+namespace Zap
+{
+
+class VoiceDecoder;
+
+// Smooths out the bumpy arrival of one speaker's voice packets.  We hold on to a little audio before we start playing,
+// then hand it out at the rate it plays.  If we run dry in the middle of things, the decoder fills in for a few frames
+// before we decide the speaker is done and wait for more.
+//
+// Not thread safe -- each buffer belongs to whichever thread is decoding.
+class VoiceJitterBuffer
+{
+public:
+   static const U32 SampleRate = 8000;       // Voice is 16 bit mono at 8KHz
+   static const U32 TargetDelay = 120;       // Ms of audio we hold before we start playing
+   static const U32 MaxDelay = 300;          // If we ever have more than this buffered, we drop the oldest
+   static const U32 PlayAhead = 40;          // Ms of audio we keep queued up with the sound device once playing
+   static const U32 MaxConcealTime = 60;     // Ms we'll make up audio for before deciding the speaker has stopped
+
+private:
+   RefPtr<VoiceDecoder> mDecoder;
+   U32 mSamplesPerFrame;
+   U32 mFrameTime;                           // Ms each frame plays for
+
+   Vector<S16> mSamples;                     // Decoded audio...
+   U32 mReadPos;                             // ...and how much of it we've already handed out
+   U32 mFirstArrivalTime;                    // When the oldest audio in mSamples arrived
+
+   bool mPlaying;
+   U32 mPlayedUntil;                         // When the audio we've handed out will finish playing
+   U32 mConcealedTime;                       // Ms we've been making things up since the last real audio
+
+   U32 mConcealedFrames;
+   U32 mDroppedFrames;
+
+   U32 getFrameCount() const;
+
+public:
+   explicit VoiceJitterBuffer(VoiceDecoder *decoder);    // Constructor
+   virtual ~VoiceJitterBuffer();                         // Destructor
+
+   void addPacket(const U8 *data, U32 size, U32 currentTime);
+   void readSamples(U32 currentTime, Vector<S16> &samples);
+
+   U32 getBufferedTime() const;
+   bool isPlaying() const;
+
+   U32 getConcealedFrames() const;
+   U32 getDroppedFrames() const;
+};
+
+
+};
+
+#endif
@@ -0,0 +1,478 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "VoiceMixer.h"
+
+#include "ClientInfo.h"
+#include "MathUtils.h"       // For min() and max()
+#include "voiceCodec.h"
+
+#include "tnlPlatform.h"
+
+#include <string.h>
+
+namespace Zap
+{
+
+// Constructor
+VoiceMixer::VoiceMixer()
+{
+   mCurrentTime = 0;
+   mMixTimer.reset(MixInterval);
+
+   mSamplesPerFrame = 0;
+   mNextStreamId = 1;
+
+   mRelayedBytes = 0;
+   mMixedBytes = 0;
+   mMixTime = 0;
+   mMixTimeWindow = 0;
+   mMixLoad = 0;
+}
+
+
+// Destructor
+VoiceMixer::~VoiceMixer()
+{
+   // Do nothing
+}
+
+
+VoiceDecoder *VoiceMixer::createDecoder()
+{
+   return new SpeexVoiceDecoder();
+}
+
+
+VoiceEncoder *VoiceMixer::createEncoder()
+{
+   return new SpeexVoiceEncoder();
+}
+
+
+// Servers built without voice chat can't decode anything, so all they can do is relay
+bool VoiceMixer::isAvailable() const
+{
+#ifdef BF_NO_VOICECHAT
+   return false;
+#else
+   return true;
+#endif
+}
+
+
+// Called for every voice packet that arrives; returns true if it should be handed to addVoice() rather than relayed.
+// Either way, someone talking alone is relayed untouched; there's nothing to mix them with.
+bool VoiceMixer::shouldMix(VoiceChatMode mode, ClientInfo *speaker, bool echo)
+{
+   if(mode == VoiceChatRelay || !isAvailable())
+      return false;
+
+   heardFrom(speaker, echo);     // Even if we're relaying, so we notice when people start talking over each other
+
+   S32 teamIndex = speaker->getTeamIndex();
+   bool mix;
+
+   // Auto only mixes while we can afford it
+   if(mode == VoiceChatAuto && mMixLoad > MixTimeBudget)
+      mix = false;
+
+   // Once we've started, keep going until everything we have is out; otherwise relayed audio would jump the queue
+   else
+      mix = isMixing(teamIndex) || getActiveSpeakerCount(teamIndex) > 1;
+
+   // This packet is going around us, so any decoder we have for them will be out of step with their encoder
+   if(!mix)
+      mSpeakers[findSpeaker(speaker)].decoder = NULL;
+
+   return mix;
+}
+
+
+void VoiceMixer::addVoice(ClientInfo *speaker, bool echo, const ByteBufferPtr &voiceBuffer)
+{
+   S64 startTime = Platform::getHighPrecisionTimerValue();
+
+   heardFrom(speaker, echo);
+
+   Speaker &s = mSpeakers[findSpeaker(speaker)];
+
+   if(s.decoder.isNull())
+   {
+      s.decoder = createDecoder();
+      mSamplesPerFrame = s.decoder->getSamplesPerFrame();
+   }
+
+   ByteBufferPtr decoded = s.decoder->decompressBuffer(voiceBuffer);
+   U32 sampleCount = decoded->getBufferSize() / sizeof(S16);
+
+   S32 oldSize = s.samples.size();
+   s.samples.resize(oldSize + sampleCount);
+   memcpy(s.samples.address() + oldSize, decoded->getBuffer(), sampleCount * sizeof(S16));
+
+   // If they've gotten far ahead of us, throw out their oldest audio
+   U32 maxSamples = MaxBufferedFrames * mSamplesPerFrame;
+   if(U32(s.samples.size()) > maxSamples)
+   {
+      U32 drop = s.samples.size() - maxSamples;
+      memmove(s.samples.address(), s.samples.address() + drop, maxSamples * sizeof(S16));
+      s.samples.resize(maxSamples);
+   }
+
+   mMixTime += Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - startTime);
+}
+
+
+// Called when a player leaves the game
+void VoiceMixer::removeSpeaker(ClientInfo *clientInfo)
+{
+   S32 index = findSpeaker(clientInfo);
+   if(index != -1)
+      mSpeakers.erase_fast(index);
+
+   // Anyone who was leaving them out will be put on another stream next time around
+   for(S32 i = mStreams.size() - 1; i >= 0; i--)
+      if(mStreams[i].excluded.contains(clientInfo))
+         mStreams.erase_fast(i);
+}
+
+
+// Keeps time, and returns true when there's audio waiting that it's time to mix
+bool VoiceMixer::idle(U32 timeDelta)
+{
+   mCurrentTime += timeDelta;
+
+   mMixTimeWindow += timeDelta;
+   if(mMixTimeWindow >= 1000)
+   {
+      mMixLoad = U32(mMixTime * 1000 / mMixTimeWindow);
+      mMixTime = 0;
+      mMixTimeWindow = 0;
+   }
+
+   if(!mMixTimer.update(timeDelta))
+      return false;
+
+   mMixTimer.reset();
+
+   // Forget about anyone who has gone quiet; they'll get a fresh encoder or decoder if they start up again
+   for(S32 i = mStreams.size() - 1; i >= 0; i--)
+      if(mCurrentTime - mStreams[i].lastUsedTime > SpeakerTimeout)
+         mStreams.erase_fast(i);
+
+   for(S32 i = mSpeakers.size() - 1; i >= 0; i--)
+      if(mSpeakers[i].samples.size() == 0 && mCurrentTime - mSpeakers[i].lastHeardTime > SpeakerTimeout)
+         mSpeakers.erase_fast(i);
+
+   for(S32 i = 0; i < mSpeakers.size(); i++)
+      if(mSpeakers[i].samples.size() > 0)
+         return true;
+
+   return false;
+}
+
+
+// Mixes everything that's waiting for the players in listeners, and adds the results to streams, ready to be sent
+void VoiceMixer::mix(const Vector<Listener> &listeners, Vector<MixedStream> &streams)
+{
+   S64 startTime = Platform::getHighPrecisionTimerValue();
+
+   Vector<S32> teams;
+   for(S32 i = 0; i < mSpeakers.size(); i++)
+      if(mSpeakers[i].samples.size() > 0 && !teams.contains(mSpeakers[i].teamIndex))
+         teams.push_back(mSpeakers[i].teamIndex);
+
+   for(S32 i = 0; i < teams.size(); i++)
+      mixTeam(teams[i], listeners, streams);
+
+   mMixTime += Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - startTime);
+}
+
+
+static bool sameSpeakers(const Vector<ClientInfo *> &a, const Vector<ClientInfo *> &b)
+{
+   if(a.size() != b.size())
+      return false;
+
+   for(S32 i = 0; i < a.size(); i++)
+      if(!b.contains(a[i]))
+         return false;
+
+   return true;
+}
+
+
+void VoiceMixer::mixTeam(S32 teamIndex, const Vector<Listener> &listeners, Vector<MixedStream> &streams)
+{
+   Vector<S32> contributors;
+   U32 frames = 0;
+
+   for(S32 i = 0; i < mSpeakers.size(); i++)
+      if(mSpeakers[i].teamIndex == teamIndex && mSpeakers[i].samples.size() > 0)
+      {
+         contributors.push_back(i);
+         frames = max(frames, mSpeakers[i].samples.size() / mSamplesPerFrame);
+      }
+
+   frames = min(frames, U32(MaxMixFrames));
+   U32 sampleCount = frames * mSamplesPerFrame;
+
+   Vector<S32> mix;
+   mix.resize(sampleCount);
+   memset(mix.address(), 0, sampleCount * sizeof(S32));
+
+   // Anyone who is a bit behind joins in from the start, and goes quiet once they run out
+   for(S32 i = 0; i < contributors.size(); i++)
+   {
+      const Vector<S16> &samples = mSpeakers[contributors[i]].samples;
+      U32 count = min(U32(samples.size()), sampleCount);
+
+      for(U32 j = 0; j < count; j++)
+         mix[j] += samples[j];
+   }
+
+   // Group the listeners by who they leave out.  The whole team always goes first, even if nobody is on it, as
+   // it's what gets recorded.
+   Vector<Vector<ClientInfo *> > excluded;
+   Vector<Vector<ClientInfo *> > groups;
+
+   excluded.resize(1);
+   groups.resize(1);
+
+   for(S32 i = 0; i < listeners.size(); i++)
+   {
+      if(listeners[i].clientInfo->getTeamIndex() != teamIndex)
+         continue;
+
+      Vector<ClientInfo *> leftOut;
+      getExcludedSpeakers(listeners[i], teamIndex, leftOut);
+
+      S32 group = 0;
+      while(group < excluded.size() && !sameSpeakers(excluded[group], leftOut))
+         group++;
+
+      if(group == excluded.size())
+      {
+         excluded.push_back(leftOut);
+         groups.resize(group + 1);
+      }
+
+      groups[group].push_back(listeners[i].clientInfo);
+   }
+
+   for(S32 i = 0; i < groups.size(); i++)
+   {
+      // Someone who's left out everyone talking gets nothing
+      bool audible = false;
+      for(S32 j = 0; j < contributors.size() && !audible; j++)
+         audible = !excluded[i].contains(mSpeakers[contributors[j]].clientInfo);
+
+      if(!audible)
+         continue;
+
+      MixedStream stream;
+      stream.teamIndex = teamIndex;
+      stream.wholeTeam = (i == 0);
+      stream.listeners = groups[i];
+      stream.data = encode(teamIndex, excluded[i], mix, contributors, stream.streamId);
+
+      if(stream.data.isValid())
+         streams.push_back(stream);
+   }
+
+   for(S32 i = 0; i < contributors.size(); i++)
+   {
+      Vector<S16> &samples = mSpeakers[contributors[i]].samples;
+      U32 used = min(U32(samples.size()), sampleCount);
+      U32 remaining = samples.size() - used;
+
+      memmove(samples.address(), samples.address() + used, remaining * sizeof(S16));
+      samples.resize(remaining);
+   }
+}
+
+
+// Speakers on the team that listener shouldn't hear: themselves, unless they have echo on, and anyone they've muted.
+// We go by who's been talking lately, not just who's in this mix, so a pause for breath doesn't move them to
+// another stream and back.
+void VoiceMixer::getExcludedSpeakers(const Listener &listener, S32 teamIndex, Vector<ClientInfo *> &excluded) const
+{
+   for(S32 i = 0; i < mSpeakers.size(); i++)
+   {
+      const Speaker &speaker = mSpeakers[i];
+
+      if(speaker.teamIndex != teamIndex)
+         continue;
+
+      if(speaker.samples.size() == 0 && mCurrentTime - speaker.lastHeardTime > SpeakerTimeout)
+         continue;
+
+      if(speaker.clientInfo == listener.clientInfo ? !speaker.echo : listener.muted.contains(speaker.clientInfo))
+         excluded.push_back(speaker.clientInfo);
+   }
+}
+
+
+// Encodes mix, less the excluded speakers, on the stream that leaves them out
+ByteBufferPtr VoiceMixer::encode(S32 teamIndex, const Vector<ClientInfo *> &excluded, const Vector<S32> &mix,
+                                 const Vector<S32> &contributors, U32 &streamId)
+{
+   S32 index = findStream(teamIndex, excluded);
+
+   if(index == -1)
+   {
+      Stream stream;
+      stream.teamIndex = teamIndex;
+      stream.excluded = excluded;
+      stream.id = mNextStreamId++;
+      stream.encoder = createEncoder();
+
+      mStreams.push_back(stream);
+      index = mStreams.size() - 1;
+   }
+
+   Stream &stream = mStreams[index];
+   stream.lastUsedTime = mCurrentTime;
+   streamId = stream.id;
+
+   Vector<S32> mixed(mix);
+
+   for(S32 i = 0; i < contributors.size(); i++)
+   {
+      const Speaker &speaker = mSpeakers[contributors[i]];
+
+      if(!excluded.contains(speaker.clientInfo))
+         continue;
+
+      U32 count = min(U32(speaker.samples.size()), U32(mixed.size()));
+
+      for(U32 j = 0; j < count; j++)
+         mixed[j] -= speaker.samples[j];
+   }
+
+   ByteBufferPtr samples = new ByteBuffer(mixed.size() * sizeof(S16));
+   S16 *samplePtr = (S16 *) samples->getBuffer();
+
+   for(S32 i = 0; i < mixed.size(); i++)
+      samplePtr[i] = S16(max(-0x8000, min(mixed[i], 0x7FFF)));
+
+   return stream.encoder->compressBuffer(samples);
+}
+
+
+void VoiceMixer::heardFrom(ClientInfo *clientInfo, bool echo)
+{
+   S32 index = findSpeaker(clientInfo);
+
+   if(index == -1)
+   {
+      Speaker speaker;
+      speaker.clientInfo = clientInfo;
+      speaker.teamIndex = clientInfo->getTeamIndex();
+
+      mSpeakers.push_back(speaker);
+      index = mSpeakers.size() - 1;
+   }
+
+   Speaker &speaker = mSpeakers[index];
+
+   // Changed teams; whatever they said to their old team is no longer of interest
+   if(speaker.teamIndex != clientInfo->getTeamIndex())
+   {
+      speaker.teamIndex = clientInfo->getTeamIndex();
+      speaker.samples.clear();
+   }
+
+   speaker.echo = echo;
+   speaker.lastHeardTime = mCurrentTime;
+}
+
+
+S32 VoiceMixer::findSpeaker(ClientInfo *clientInfo) const
+{
+   for(S32 i = 0; i < mSpeakers.size(); i++)
+      if(mSpeakers[i].clientInfo == clientInfo)
+         return i;
+
+   return -1;
+}
+
+
+S32 VoiceMixer::findStream(S32 teamIndex, const Vector<ClientInfo *> &excluded) const
+{
+   for(S32 i = 0; i < mStreams.size(); i++)
+      if(mStreams[i].teamIndex == teamIndex && sameSpeakers(mStreams[i].excluded, excluded))
+         return i;
+
+   return -1;
+}
+
+
+S32 VoiceMixer::getActiveSpeakerCount(S32 teamIndex) const
+{
+   S32 count = 0;
+
+   for(S32 i = 0; i < mSpeakers.size(); i++)
+      if(isSpeaking(mSpeakers[i].clientInfo, teamIndex))
+         count++;
+
+   return count;
+}
+
+
+// Returns true if we have audio for this team that hasn't gone out yet
+bool VoiceMixer::isMixing(S32 teamIndex) const
+{
+   for(S32 i = 0; i < mSpeakers.size(); i++)
+      if(mSpeakers[i].teamIndex == teamIndex && mSpeakers[i].samples.size() > 0)
+         return true;
+
+   return false;
+}
+
+
+bool VoiceMixer::isSpeaking(ClientInfo *clientInfo, S32 teamIndex) const
+{
+   S32 index = findSpeaker(clientInfo);
+
+   return index != -1 && mSpeakers[index].teamIndex == teamIndex &&
+          mCurrentTime - mSpeakers[index].lastHeardTime <= SpeakerTimeout;
+}
+
+
+void VoiceMixer::countRelayedBytes(U32 bytes)
+{
+   mRelayedBytes += bytes;
+}
+
+
+void VoiceMixer::countMixedBytes(U32 bytes)
+{
+   mMixedBytes += bytes;
+}
+
+
+// Total voice chat we've sent by relaying
+U32 VoiceMixer::getRelayedBytes() const
+{
+   return mRelayedBytes;
+}
+
+
+// Total voice chat we've sent by mixing
+U32 VoiceMixer::getMixedBytes() const
+{
+   return mMixedBytes;
+}
+
+
+// Ms of CPU spent decoding, mixing, and encoding during the last second
+U32 VoiceMixer::getMixLoad() const
+{
+   return mMixLoad;
+}
+
+
+};
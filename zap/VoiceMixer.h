@@ -0,0 +1,133 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _VOICE_MIXER_H_
+#define _VOICE_MIXER_H_
+
+#include "ConfigEnum.h"       // For VoiceChatMode
+#include "Timer.h"
+
+#include "tnlByteBuffer.h"
+#include "tnlNetBase.h"
+#include "tnlVector.h"
+
+using namespace TNL;
+
+namespace Zap
+{
+
+class ClientInfo;
+class VoiceDecoder;
+class VoiceEncoder;
+
+// Relaying voice chat sends every speaker to every teammate, so a team's voice traffic grows with speakers times
+// listeners.  When several people on a team are talking at once, we can instead decode them all here, add them
+// together, and send each listener a single stream.  Speakers get the mix minus their own voice (unless they've
+// asked to hear themselves), and nobody gets anyone they've muted.
+//
+// Listeners who leave out the same speakers share a stream.  Each stream has its own encoder and id, and clients
+// decode each id separately, so moving a listener from one stream to another never feeds one encoder's output
+// into a decoder that was following a different one.
+class VoiceMixer
+{
+public:
+   static const U32 MixInterval = 100;          // Ms between mixes; clients send their voice at the same rate
+   static const U32 SpeakerTimeout = 300;       // Ms after their last packet that we consider someone to be talking
+   static const U32 MaxBufferedFrames = 15;     // Audio we'll hold for a speaker before dropping the oldest
+   static const U32 MaxMixFrames = 10;          // Most audio we'll mix in one go, to catch up after a stall
+   static const U32 MixTimeBudget = 20;         // Ms of CPU per second we'll spend mixing in Auto mode
+
+   struct Listener
+   {
+      ClientInfo *clientInfo;
+      Vector<ClientInfo *> muted;         // Speakers this player doesn't want to hear
+   };
+
+   struct MixedStream
+   {
+      S32 teamIndex;
+      U32 streamId;                       // Same id, same encoder
+      bool wholeTeam;                     // Everyone on the team is in this one; it's what recordings get
+      Vector<ClientInfo *> listeners;
+      ByteBufferPtr data;
+   };
+
+private:
+   struct Speaker
+   {
+      ClientInfo *clientInfo;
+      S32 teamIndex;
+      bool echo;
+      U32 lastHeardTime;
+      RefPtr<VoiceDecoder> decoder;       // Only created once we start mixing them
+      Vector<S16> samples;                // Decoded, and waiting to be mixed
+   };
+
+   struct Stream
+   {
+      S32 teamIndex;
+      Vector<ClientInfo *> excluded;      // Speakers left out of this stream
+      U32 id;
+      RefPtr<VoiceEncoder> encoder;
+      U32 lastUsedTime;
+   };
+
+   Vector<Speaker> mSpeakers;
+   Vector<Stream> mStreams;
+
+   U32 mCurrentTime;
+   Timer mMixTimer;
+
+   U32 mSamplesPerFrame;
+   U32 mNextStreamId;
+
+   // For deciding between relaying and mixing
+   U32 mRelayedBytes;
+   U32 mMixedBytes;
+   F64 mMixTime;                          // Ms spent mixing so far this second...
+   U32 mMixTimeWindow;                    // ...how far into the second we are...
+   U32 mMixLoad;                          // ...and ms spent mixing during the last one
+
+   S32 findSpeaker(ClientInfo *clientInfo) const;
+   S32 findStream(S32 teamIndex, const Vector<ClientInfo *> &excluded) const;
+   S32 getActiveSpeakerCount(S32 teamIndex) const;
+   bool isMixing(S32 teamIndex) const;
+   bool isSpeaking(ClientInfo *clientInfo, S32 teamIndex) const;
+
+   void heardFrom(ClientInfo *clientInfo, bool echo);
+   void getExcludedSpeakers(const Listener &listener, S32 teamIndex, Vector<ClientInfo *> &excluded) const;
+   void mixTeam(S32 teamIndex, const Vector<Listener> &listeners, Vector<MixedStream> &streams);
+   ByteBufferPtr encode(S32 teamIndex, const Vector<ClientInfo *> &excluded, const Vector<S32> &mix,
+                        const Vector<S32> &contributors, U32 &streamId);
+
+protected:
+   virtual VoiceDecoder *createDecoder();
+   virtual VoiceEncoder *createEncoder();
+
+public:
+   VoiceMixer();              // Constructor
+   virtual ~VoiceMixer();     // Destructor
+
+   bool isAvailable() const;
+
+   bool shouldMix(VoiceChatMode mode, ClientInfo *speaker, bool echo);
+   void addVoice(ClientInfo *speaker, bool echo, const ByteBufferPtr &voiceBuffer);
+   void removeSpeaker(ClientInfo *clientInfo);
+
+   bool idle(U32 timeDelta);
+   void mix(const Vector<Listener> &listeners, Vector<MixedStream> &streams);
+
+   void countRelayedBytes(U32 bytes);
+   void countMixedBytes(U32 bytes);
+
+   U32 getRelayedBytes() const;
+   U32 getMixedBytes() const;
+   U32 getMixLoad() const;
+};
+
+
+};
+
+#endif
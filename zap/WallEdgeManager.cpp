@@ -12,6 +12,9 @@
 
 #include "GeomUtils.h"
 
+#include <map>
+#include <string.h>
+
 using namespace TNL;
 
 namespace Zap
@@ -22,13 +25,14 @@ namespace Zap
 WallEdgeManager::WallEdgeManager()
 {
    mBatchUpdatingGeom  = false;
+   mLastClippedClusterCount = 0;
 }
 
 
 // Destructor
 WallEdgeManager::~WallEdgeManager()
 {
-   // Do nothing
+   mEdgeClusters.deleteAndClear();     // The database will delete the edges themselves
 }
 
 
@@ -59,8 +63,7 @@ const GridDatabase *WallEdgeManager::getWallEdgeDatabase() const
 // Delete all segments, then find all walls and build a new set of segments
 void WallEdgeManager::rebuildEdges(const Vector<WallSegment const *> &wallSegments, Vector<Point> &wallEdgePoints)
 {
-   // Clear the edges
-   mWallEdgeDatabase.removeEverythingFromDatabase();
+   // Edges of walls that haven't changed will be kept by rebuildEdgesWithClipper()
 
    // Iterate over all our wall objects (WallItems and PolyWalls when run from the editor, Barriers when run from ServerGame::loadLevel)
    // This should already be done!
@@ -71,29 +74,276 @@ void WallEdgeManager::rebuildEdges(const Vector<WallSegment const *> &wallSegmen
 }
 
 
+static U64 hashBytes(U64 hash, const void *data, U32 size)
+{
+   // 64-bit FNV-1a
+   const U8 *bytes = (const U8 *)data;
+
+   for(U32 i = 0; i < size; i++)
+   {
+      hash ^= bytes[i];
+      hash *= 1099511628211ull;
+   }
+
+   return hash;
+}
+
+
+static const U64 HashSeed = 14695981039346656037ull;
+
+
+// Combines a sorted list of segment hashes into a single key
+static U64 hashSegmentList(const Vector<U64> &segmentHashes)
+{
+   return hashBytes(HashSeed, segmentHashes.address(), segmentHashes.size() * sizeof(U64));
+}
+
+
+static S32 QSORT_CALLBACK sortHashes(U64 *a, U64 *b)
+{
+   if(*a < *b)
+      return -1;
+
+   return *a > *b ? 1 : 0;
+}
+
+
+static bool sameHashes(const Vector<U64> &a, const Vector<U64> &b)
+{
+   if(a.size() != b.size())
+      return false;
+
+   for(S32 i = 0; i < a.size(); i++)
+      if(a[i] != b[i])
+         return false;
+
+   return true;
+}
+
+
 // Take geometry from all wall segments, and run them through clipper to generate new edge geometry.  Then use the results to create
-// a bunch of WallEdge objects, which will be stored in mWallEdgeDatabase for future reference.  The two key things to understand here
-// are that 1) it's all-or-nothing: all edges need to be recomputed at once; there is no way to do a partial rebuild.  And 2) the edges
-// cannot be associated with their source, so we'll need to rely on other tricks to find an associated wall when needed.
+// a bunch of WallEdge objects, which will be stored in mWallEdgeDatabase for future reference.  Walls are clipped in clusters of
+// walls that might overlap one another, and the results for a cluster are reused until one of its walls changes, so dragging a wall
+// around a big level only clips the walls near it.  Note that the edges cannot be associated with their source, so we'll need to
+// rely on other tricks to find an associated wall when needed.
 // Private method
 void WallEdgeManager::rebuildEdgesWithClipper(const Vector<WallSegment const *> &wallSegments, Vector<Point> &wallEdgePoints)
 {
-   // Data flow in this method: wallSegments -> wallEdgePoints -> wallEdges
+   // Data flow in this method: wallSegments -> clusters -> wallEdgePoints -> wallEdges
 
    wallEdgePoints.clear();
+   mLastClippedClusterCount = 0;
+
+   Vector<Vector<S32> > clusters;
+   findClusters(wallSegments, clusters);
+
+   // Index our old clusters so we can find the ones that haven't changed.  In the unlikely event two of them have the same
+   // key, we'll just miss the cache for one of them.
+   Vector<EdgeCluster *> oldClusters = mEdgeClusters;
+   mEdgeClusters.clear();
 
-   // Run clipper --> fills wallEdgePoints from wallSegments
-   clipAllWallEdges(wallSegments, wallEdgePoints);
+   map<U64, S32> oldClusterIndex;
+   for(S32 i = 0; i < oldClusters.size(); i++)
+      oldClusterIndex[hashSegmentList(oldClusters[i]->segmentHashes)] = i;
+
+   Vector<WallSegment const *> segments;
+   Vector<U64> segmentHashes;
+
+   for(S32 i = 0; i < clusters.size(); i++)
+   {
+      segments.clear();
+      segmentHashes.clear();
+
+      for(S32 j = 0; j < clusters[i].size(); j++)
+      {
+         segments.push_back(wallSegments[clusters[i][j]]);
+         segmentHashes.push_back(hashSegment(segments.last()));
+      }
+
+      segmentHashes.sort((Vector<U64>::compare_func)sortHashes);
+
+      EdgeCluster *cluster = NULL;
+      map<U64, S32>::iterator it = oldClusterIndex.find(hashSegmentList(segmentHashes));
+
+      if(it != oldClusterIndex.end() && oldClusters[it->second] && sameHashes(oldClusters[it->second]->segmentHashes, segmentHashes))
+      {
+         cluster = oldClusters[it->second];
+         oldClusters[it->second] = NULL;
+      }
+      else
+      {
+         cluster = clipCluster(segments);
+         cluster->segmentHashes = segmentHashes;
+         mLastClippedClusterCount++;
+      }
+
+      mEdgeClusters.push_back(cluster);
+
+      for(S32 j = 0; j < cluster->edgePoints.size(); j++)
+         wallEdgePoints.push_back(cluster->edgePoints[j]);
+   }
+
+   // Whatever's left belongs to walls that have changed or gone away
+   for(S32 i = 0; i < oldClusters.size(); i++)
+      if(oldClusters[i])
+         deleteCluster(oldClusters[i]);
+}
+
+
+// Run clipper on a single cluster, and add the resulting WallEdges to the database.  Caller owns the returned cluster.
+// Private method
+WallEdgeManager::EdgeCluster *WallEdgeManager::clipCluster(const Vector<WallSegment const *> &segments)
+{
+   EdgeCluster *cluster = new EdgeCluster;
+
+   clipAllWallEdges(segments, cluster->edgePoints);
 
    // Create a WallEdge object from the clipped wall geometry.  We'll add it to the WallEdgeDatabase, which will 
    // delete the object when it is ulitmately removed.
-   mWallEdgeDatabase.removeEverythingFromDatabase();    // Remove the old edges
+   for(S32 i = 0; i < cluster->edgePoints.size(); i += 2)
+   {
+      WallEdge *newEdge = new WallEdge(cluster->edgePoints[i], cluster->edgePoints[i+1]);   // Create the edge object
+      newEdge->addToDatabase(&mWallEdgeDatabase);                                           // And add it to the database
+      cluster->edges.push_back(newEdge);
+   }
+
+   return cluster;
+}
 
-   for(S32 i = 0; i < wallEdgePoints.size(); i+=2)
+
+// Private method
+void WallEdgeManager::deleteCluster(EdgeCluster *cluster)
+{
+   for(S32 i = 0; i < cluster->edges.size(); i++)
+      mWallEdgeDatabase.removeFromDatabase(cluster->edges[i], true);
+
+   delete cluster;
+}
+
+
+// Forget our clusters without touching the database -- for when the database has already been cleared
+// Private method
+void WallEdgeManager::clearClusters()
+{
+   mEdgeClusters.deleteAndClear();
+}
+
+
+struct ClusterSweepItem
+{
+   F32 minX;
+   S32 index;
+};
+
+
+static S32 QSORT_CALLBACK sortByMinX(ClusterSweepItem *a, ClusterSweepItem *b)
+{
+   if(a->minX < b->minX)
+      return -1;
+   if(a->minX > b->minX)
+      return 1;
+
+   return a->index - b->index;      // Keeps things deterministic
+}
+
+
+static S32 findClusterRoot(Vector<S32> &parents, S32 index)
+{
+   while(parents[index] != index)
    {
-      WallEdge *newEdge = new WallEdge(wallEdgePoints[i], wallEdgePoints[i+1]);   // Create the edge object
-      newEdge->addToDatabase(&mWallEdgeDatabase);                                 // And add it to the database
+      parents[index] = parents[parents[index]];    // Shorten the path as we go
+      index = parents[index];
    }
+
+   return index;
+}
+
+
+// Sort wallSegments into groups whose bounding boxes touch, directly or via other segments in the group.  Segments that
+// actually overlap will always end up together, so clipping each group on its own gives the same result as clipping
+// everything at once.  Each cluster is a list of indices into wallSegments; static method.
+void WallEdgeManager::findClusters(const Vector<WallSegment const *> &wallSegments, Vector<Vector<S32> > &clusters)
+{
+   S32 count = wallSegments.size();
+
+   Vector<ClusterSweepItem> sweep(count);
+   Vector<S32> parents(count);
+
+   for(S32 i = 0; i < count; i++)
+   {
+      ClusterSweepItem item;
+      item.minX = wallSegments[i]->getExtent().min.x;
+      item.index = i;
+
+      sweep.push_back(item);
+      parents.push_back(i);
+   }
+
+   sweep.sort((Vector<ClusterSweepItem>::compare_func)sortByMinX);
+
+   // Sweep from left to right, only comparing segments whose x ranges overlap
+   Vector<S32> active;
+
+   for(S32 i = 0; i < count; i++)
+   {
+      S32 index = sweep[i].index;
+      Rect extent = wallSegments[index]->getExtent();
+
+      for(S32 j = 0; j < active.size(); j++)
+      {
+         Rect activeExtent = wallSegments[active[j]]->getExtent();
+
+         if(activeExtent.max.x < extent.min.x)     // Everything from here on is to our right
+         {
+            active.erase_fast(j);
+            j--;
+            continue;
+         }
+
+         if(activeExtent.intersectsOrBorders(extent))
+            parents[findClusterRoot(parents, active[j])] = findClusterRoot(parents, index);
+      }
+
+      active.push_back(index);
+   }
+
+   // Gather up the groups, in the order their first segments appear in wallSegments
+   Vector<S32> clusterIndex(count);
+   for(S32 i = 0; i < count; i++)
+      clusterIndex.push_back(-1);
+
+   clusters.clear();
+
+   for(S32 i = 0; i < count; i++)
+   {
+      S32 root = findClusterRoot(parents, i);
+
+      if(clusterIndex[root] == -1)
+      {
+         clusterIndex[root] = clusters.size();
+         clusters.push_back(Vector<S32>());
+      }
+
+      clusters[clusterIndex[root]].push_back(i);
+   }
+}
+
+
+// Identifies a segment by its geometry; segments get recreated whenever their wall changes, so we can't use the pointers
+// Static method
+U64 WallEdgeManager::hashSegment(const WallSegment *segment)
+{
+   const Vector<Point> *corners = segment->getCorners();
+
+   U64 hash = HashSeed;
+
+   for(S32 i = 0; i < corners->size(); i++)
+   {
+      F32 coords[2] = { corners->get(i).x, corners->get(i).y };
+      hash = hashBytes(hash, coords, sizeof(coords));
+   }
+
+   return hash;
 }
 
 
@@ -247,6 +497,19 @@ void WallEdgeManager::updateAllMountedItems(const GridDatabase *gameObjectDataba
 void WallEdgeManager::clear()
 {
    mWallEdgeDatabase.removeEverythingFromDatabase();
+   clearClusters();
+}
+
+
+S32 WallEdgeManager::getClusterCount() const
+{
+   return mEdgeClusters.size();
+}
+
+
+S32 WallEdgeManager::getLastClippedClusterCount() const
+{
+   return mLastClippedClusterCount;
 }
 
 
@@ -26,11 +26,28 @@ class EngineeredItem;
 class WallEdgeManager
 {
 private:
+   // Walls whose bounding boxes touch get clipped together, as a cluster.  We remember the results for each cluster,
+   // so when a wall changes, we only need to clip the cluster it's in.
+   struct EdgeCluster
+   {
+      Vector<U64> segmentHashes;    // Sorted; identifies the segments the cluster was built from
+      Vector<Point> edgePoints;     // Clipped edges, in a-b c-d format
+      Vector<WallEdge *> edges;     // Created from edgePoints; owned by mWallEdgeDatabase
+   };
+
    bool mBatchUpdatingGeom;     
 
    GridDatabase mWallEdgeDatabase;
+   Vector<EdgeCluster *> mEdgeClusters;
+   S32 mLastClippedClusterCount;
 
    void rebuildEdgesWithClipper(const Vector<WallSegment const *> &wallSegments, Vector<Point> &wallEdges);
+   EdgeCluster *clipCluster(const Vector<WallSegment const *> &segments);
+   void deleteCluster(EdgeCluster *cluster);
+   void clearClusters();
+
+   static void findClusters(const Vector<WallSegment const *> &wallSegments, Vector<Vector<S32> > &clusters);
+   static U64 hashSegment(const WallSegment *segment);
 
 public:
    WallEdgeManager();            // Constructor
@@ -58,6 +75,9 @@ public:
 
    void updateAllMountedItems(const GridDatabase *gameObjectDatabase);
 
+   S32 getClusterCount() const;
+   S32 getLastClippedClusterCount() const;   // How many clusters had to be clipped during the last rebuild
+
    //void rebuildEdges(GridDatabase *database);
    void rebuildEdges(const Vector<WallSegment const *> &wallSegments, Vector<Point> &wallEdgePoints);
    static void buildWallSegmentEdgesAndPoints(DatabaseObject *object);
@@ -0,0 +1,221 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "ZoneMap.h"
+
+#include "gridDB.h"
+#include "GeomUtils.h"
+#include "MathUtils.h"
+
+namespace Zap
+{
+
+// Constructor
+ZoneMap::ZoneMap()
+{
+   mVersion = 0;
+   clear();
+}
+
+
+void ZoneMap::clear()
+{
+   mBounds = Rect();
+   mCellSize = MinCellSize;
+   mCols = 0;
+   mRows = 0;
+
+   mCellStart.clear();
+   mEntries.clear();
+}
+
+
+void ZoneMap::build(const Vector<DatabaseObject *> &zones)
+{
+   clear();
+   mVersion++;
+
+   bool first = true;
+
+   for(S32 i = 0; i < zones.size(); i++)
+   {
+      const Vector<Point> *poly = zones[i]->getCollisionPoly();
+
+      if(!poly || poly->size() < 3)
+         continue;
+
+      if(first)
+         mBounds.set(*poly);
+      else
+         mBounds.unionRect(Rect(*poly));
+
+      first = false;
+   }
+
+   if(first)      // No zones
+      return;
+
+   mCellSize = MAX(F32(MinCellSize), MAX(mBounds.getWidth(), mBounds.getHeight()) / MaxCellsPerSide);
+   mCols = MIN(S32(mBounds.getWidth()  / mCellSize) + 1, MaxCellsPerSide);
+   mRows = MIN(S32(mBounds.getHeight() / mCellSize) + 1, MaxCellsPerSide);
+
+   Vector<Vector<Entry> > cells;
+   cells.resize(mCols * mRows);
+
+   for(S32 i = 0; i < zones.size(); i++)
+      addZone(zones[i], cells);
+
+   // Flatten everything into one list, so lookups don't have to chase pointers
+   mCellStart.resize(cells.size() + 1);
+
+   for(S32 i = 0; i < cells.size(); i++)
+   {
+      mCellStart[i] = mEntries.size();
+
+      for(S32 j = 0; j < cells[i].size(); j++)
+         mEntries.push_back(cells[i][j]);
+   }
+
+   mCellStart[cells.size()] = mEntries.size();
+}
+
+
+// Labels every cell touched by zone as being on its boundary or entirely inside it
+void ZoneMap::addZone(DatabaseObject *zone, Vector<Vector<Entry> > &cells)
+{
+   const Vector<Point> *poly = zone->getCollisionPoly();
+
+   if(!poly || poly->size() < 3)
+      return;
+
+   Rect bounds(*poly);
+
+   S32 minx = MAX(S32((bounds.min.x - mBounds.min.x) / mCellSize), 0);
+   S32 miny = MAX(S32((bounds.min.y - mBounds.min.y) / mCellSize), 0);
+   S32 maxx = MIN(S32((bounds.max.x - mBounds.min.x) / mCellSize), mCols - 1);
+   S32 maxy = MIN(S32((bounds.max.y - mBounds.min.y) / mCellSize), mRows - 1);
+
+   S32 width = maxx - minx + 1;
+
+   Vector<bool> boundary;
+   boundary.resize(width * (maxy - miny + 1));
+
+   for(S32 i = 0; i < boundary.size(); i++)
+      boundary[i] = false;
+
+   // Any cell an edge passes through is a boundary cell.  Cells are padded a little so points right on a cell edge
+   // don't slip through the cracks.
+   for(S32 i = 0; i < poly->size(); i++)
+   {
+      const Point &p1 = poly->get(i);
+      const Point &p2 = poly->get((i + 1) % poly->size());
+
+      S32 x1 = MAX(S32((MIN(p1.x, p2.x) - mBounds.min.x) / mCellSize), minx);
+      S32 y1 = MAX(S32((MIN(p1.y, p2.y) - mBounds.min.y) / mCellSize), miny);
+      S32 x2 = MIN(S32((MAX(p1.x, p2.x) - mBounds.min.x) / mCellSize), maxx);
+      S32 y2 = MIN(S32((MAX(p1.y, p2.y) - mBounds.min.y) / mCellSize), maxy);
+
+      for(S32 x = x1; x <= x2; x++)
+         for(S32 y = y1; y <= y2; y++)
+         {
+            Rect cellRect(mBounds.min.x + x * mCellSize - 0.01f,       mBounds.min.y + y * mCellSize - 0.01f,
+                          mBounds.min.x + (x + 1) * mCellSize + 0.01f, mBounds.min.y + (y + 1) * mCellSize + 0.01f);
+
+            if(cellRect.intersects(p1, p2))
+               boundary[(y - miny) * width + (x - minx)] = true;
+         }
+   }
+
+   // No edges pass through the rest, so they're either entirely inside or entirely outside; their centers will tell us which
+   for(S32 x = minx; x <= maxx; x++)
+      for(S32 y = miny; y <= maxy; y++)
+      {
+         Entry entry;
+         entry.zone = zone;
+         entry.boundary = boundary[(y - miny) * width + (x - minx)];
+
+         Point center(mBounds.min.x + (x + 0.5f) * mCellSize, mBounds.min.y + (y + 0.5f) * mCellSize);
+
+         if(entry.boundary || polygonContainsPoint(poly->address(), poly->size(), center))
+            cells[y * mCols + x].push_back(entry);
+      }
+}
+
+
+// Fills zones with every zone containing point
+void ZoneMap::findZones(const Point &point, Vector<DatabaseObject *> &zones) const
+{
+   S32 cell = getCell(point);
+
+   if(cell == -1)
+      return;
+
+   for(S32 i = mCellStart[cell]; i < mCellStart[cell + 1]; i++)
+   {
+      const Entry &entry = mEntries[i];
+
+      if(entry.boundary)
+      {
+         const Vector<Point> *poly = entry.zone->getCollisionPoly();
+
+         if(!polygonContainsPoint(poly->address(), poly->size(), point))
+            continue;
+      }
+
+      zones.push_back(entry.zone);
+   }
+}
+
+
+S32 ZoneMap::getCell(const Point &point) const
+{
+   if(mCols == 0 || !mBounds.contains(point))
+      return -1;
+
+   S32 x = MIN(S32((point.x - mBounds.min.x) / mCellSize), mCols - 1);
+   S32 y = MIN(S32((point.y - mBounds.min.y) / mCellSize), mRows - 1);
+
+   return y * mCols + x;
+}
+
+
+bool ZoneMap::isBoundaryCell(S32 cell) const
+{
+   if(cell == -1)
+      return false;
+
+   for(S32 i = mCellStart[cell]; i < mCellStart[cell + 1]; i++)
+      if(mEntries[i].boundary)
+         return true;
+
+   return false;
+}
+
+
+S32 ZoneMap::getCellCount() const
+{
+   return mCols * mRows;
+}
+
+
+S32 ZoneMap::getBoundaryCellCount() const
+{
+   S32 count = 0;
+
+   for(S32 i = 0; i < getCellCount(); i++)
+      if(isBoundaryCell(i))
+         count++;
+
+   return count;
+}
+
+
+U32 ZoneMap::getVersion() const
+{
+   return mVersion;
+}
+
+
+}
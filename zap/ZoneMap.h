@@ -0,0 +1,70 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _ZONE_MAP_H_
+#define _ZONE_MAP_H_
+
+#include "Point.h"
+#include "Rect.h"
+
+#include "tnlTypes.h"
+#include "tnlVector.h"
+
+using namespace TNL;
+
+namespace Zap
+{
+
+class DatabaseObject;
+
+// Point-location map for the zones in a level, so we can find out which zones a ship is in without testing it
+// against every zone polygon nearby.  The area covered by zones is chopped into a grid of cells, and each cell
+// remembers which zones completely cover it, and which zones have an edge passing through it.  Only the latter
+// need an exact polygon test.  Built once when the zones are in place; rebuilt if they change.
+class ZoneMap
+{
+public:
+   static const S32 MaxCellsPerSide = 256;   // Keeps the map to a sensible size on huge levels
+   static const S32 MinCellSize = 32;        // About the size of a ship
+
+private:
+   struct Entry
+   {
+      DatabaseObject *zone;
+      bool boundary;          // True if an edge of the zone passes through the cell, so we need to test exactly
+   };
+
+   Rect mBounds;
+   F32 mCellSize;
+   S32 mCols;
+   S32 mRows;
+
+   Vector<S32> mCellStart;    // Index of each cell's first entry in mEntries; one extra at the end marks the end of the last cell
+   Vector<Entry> mEntries;
+
+   U32 mVersion;              // Bumped every time the map is rebuilt
+
+   void addZone(DatabaseObject *zone, Vector<Vector<Entry> > &cells);
+
+public:
+   ZoneMap();     // Constructor
+
+   void build(const Vector<DatabaseObject *> &zones);
+   void clear();
+
+   void findZones(const Point &point, Vector<DatabaseObject *> &zones) const;
+
+   S32 getCell(const Point &point) const;    // Returns -1 if point is outside every zone
+   bool isBoundaryCell(S32 cell) const;
+
+   S32 getCellCount() const;
+   S32 getBoundaryCellCount() const;
+   U32 getVersion() const;
+};
+
+
+}
+
+#endif
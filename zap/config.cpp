@@ -6,10 +6,13 @@
 #include "config.h"
 
 #include "BanList.h"
+#include "BotNavMeshZone.h"       // For BotNavMeshZone::CacheDir
 #include "Colors.h"
+#include "CompiledLevel.h"        // For CompiledLevel::CacheDir
 #include "GameSettings.h"
 #include "IniFile.h"
 #include "InputCode.h"
+#include "LevelScanner.h"         // For LevelScanner::CacheDir
 #include "QuickChatMessages.h"
 #include "version.h"
 
@@ -1416,6 +1419,9 @@ void FolderManager::resolveDirs(GameSettings *settings)
 #ifndef BF_NO_STATS
    DatabaseWriter::sqliteFile = folderManager->logDir + DatabaseWriter::sqliteFile;
 #endif
+   BotNavMeshZone::CacheDir = joindir(rootDataDir, "cache");
+   CompiledLevel::CacheDir  = joindir(rootDataDir, "cache");
+   LevelScanner::CacheDir   = joindir(rootDataDir, "cache");
    mResolved = true;
 }
 
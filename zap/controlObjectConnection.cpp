@@ -8,12 +8,18 @@
 #include "game.h"
 
 #include "ship.h"
+#include "MathUtils.h"
 
 #include <math.h>
 
 namespace Zap
 {
 
+// Corrections that move us less than this, without changing anything else about our ship, are applied to our prediction
+// as-is rather than by replaying our pending moves
+const F32 ControlObjectConnection::MaxSmoothedReplayError = 3;
+
+
 ControlObjectConnection::ControlObjectConnection()
 {
    highSendIndex[0] = 0;
@@ -32,6 +38,12 @@ ControlObjectConnection::ControlObjectConnection()
    mIsBusy = false;
    mBusyTime = 0;
    mNeedReplayMoves = false;
+   mHavePredictedState = false;
+
+   mReplayCount = 0;
+   mReplaySmoothedCount = 0;
+   mReplayMovesLast = 0;
+   mReplayMovesTotal = 0;
 }
 
 
@@ -277,29 +289,152 @@ void ControlObjectConnection::readPacket(BitStream *bstream)
 
    if(mNeedReplayMoves && controlObject.isValid())
    {
-      for(S32 i = 0; i < pendingMoves.size(); i++)
-      {
-         if(controlObject.isValid() && controlObject->getObjectTypeNumber() == PlayerShipTypeNumber)
-            ((Ship*)controlObject.getPointer())->getState(&pendingMoves[i]);
-         Move theMove = pendingMoves[i];
-         theMove.prepare();
-         controlObject->setCurrentMove(theMove);
-         controlObject->idle(BfObject::ClientReplayingPendingMoves);
-      }
+      replayPendingMoves();
       controlObject->controlMoveReplayComplete();
       mNeedReplayMoves = false;
    }
+
+   mHavePredictedState = false;
 }
+
+
 void ControlObjectConnection::prepareReplay()
 {
    if(!mNeedReplayMoves)
    {
       mNeedReplayMoves = true;
       if(controlObject.isValid() && pendingMoves.size() != 0)
-         ((Ship*)controlObject.getPointer())->setState(&pendingMoves[0]);
+      {
+         Ship *ship = (Ship*)controlObject.getPointer();
+
+         // Remember where we were, in case the correction turns out not to change much
+         ship->getState(&mPredictedState);
+         mHavePredictedState = true;
+
+         ship->setState(&pendingMoves[0]);
+      }
+   }
+}
+
+
+// Everything about the ship we keep in ControlObjectData, other than position and velocity
+static bool nonMotionStateMatches(const ControlObjectData &state1, const ControlObjectData &state2)
+{
+   return state1.mImpulseVector        == state2.mImpulseVector        &&
+          state1.mEnergy               == state2.mEnergy               &&
+          state1.mFireTimer            == state2.mFireTimer            &&
+          state1.mFastRechargeTimer    == state2.mFastRechargeTimer    &&
+          state1.mSpyBugPlacementTimer == state2.mSpyBugPlacementTimer &&
+          state1.mPulseTimer           == state2.mPulseTimer           &&
+          state1.mCooldownNeeded       == state2.mCooldownNeeded       &&
+          state1.mFastRecharging       == state2.mFastRecharging       &&
+          state1.mBoostActive          == state2.mBoostActive;
+}
+
+
+static bool stateMatches(const ControlObjectData &state1, const ControlObjectData &state2)
+{
+   return state1.mPos == state2.mPos && state1.mVel == state2.mVel && nonMotionStateMatches(state1, state2);
+}
+
+
+// The server has told us where our ship was at the start of our first pending move; work out where that puts us now.
+// Each pending move remembers the state we predicted for its start, so rather than re-simulating every move, we stop
+// as soon as our replay catches back up with our original prediction (say, when both end up pushed against the same
+// wall), and don't re-simulate more than MaxReplayMoves moves if all that's left to correct is our motion.
+void ControlObjectConnection::replayPendingMoves()
+{
+   bool isShip = controlObject->getObjectTypeNumber() == PlayerShipTypeNumber;
+   Ship *ship = isShip ? (Ship*)controlObject.getPointer() : NULL;
+
+   // Without a prediction to compare against, all we can do is replay everything
+   bool incremental = ship && mHavePredictedState && pendingMoves.size() != 0;
+
+   if(incremental && smoothCorrection(ship))
+   {
+      mReplaySmoothedCount++;
+      return;
+   }
+
+   mReplayCount++;
+   mReplayMovesLast = 0;
+
+   for(S32 i = 0; i < pendingMoves.size(); i++)
+   {
+      if(incremental)
+      {
+         ControlObjectData state = pendingMoves[i];
+         ship->getState(&state);
+
+         // Back on our predicted path; the rest of our prediction still holds
+         if(i > 0 && stateMatches(state, pendingMoves[i]))
+         {
+            ship->setState(&mPredictedState);
+            break;
+         }
+
+         // We've spent all the time on this we're willing to; assume the rest of the moves go as predicted,
+         // only offset by however far off we still are.  We can only shift position and velocity; if the server
+         // also corrected something like energy or a cooldown, we keep going until that has played out.
+         if(i >= MaxReplayMoves && nonMotionStateMatches(state, pendingMoves[i]))
+         {
+            shiftPrediction(ship, i, state.mPos - pendingMoves[i].mPos, state.mVel - pendingMoves[i].mVel);
+            break;
+         }
+
+         pendingMoves[i] = state;
+      }
+      else if(isShip)
+         ((Ship*)controlObject.getPointer())->getState(&pendingMoves[i]);
+
+      Move theMove = pendingMoves[i];
+      theMove.prepare();
+      controlObject->setCurrentMove(theMove);
+      controlObject->idle(BfObject::ClientReplayingPendingMoves);
+
+      mReplayMovesLast++;
    }
+
+   mReplayMovesTotal += mReplayMovesLast;
+}
+
+
+// If the server's idea of where our first pending move started is only a little different from ours, and differs
+// only in position, our moves since then will have played out the same, just offset by that difference.  So we
+// apply the difference to our prediction and let the ship interpolate its way there.  Returns true if it did that.
+bool ControlObjectConnection::smoothCorrection(Ship *ship)
+{
+   ControlObjectData serverState = pendingMoves[0];
+   ship->getState(&serverState);
+
+   Point posError = serverState.mPos - pendingMoves[0].mPos;
+
+   if(serverState.mVel != pendingMoves[0].mVel || !nonMotionStateMatches(serverState, pendingMoves[0]) ||
+      posError.lenSquared() > sq(MaxSmoothedReplayError))
+      return false;
+
+   shiftPrediction(ship, 0, posError, Point(0,0));
+   return true;
 }
 
+
+// Moves our ship to our predicted state, offset by the specified errors, along with the states we remember for pending
+// moves starting at firstMove
+void ControlObjectConnection::shiftPrediction(Ship *ship, S32 firstMove, const Point &posError, const Point &velError)
+{
+   for(S32 i = firstMove; i < pendingMoves.size(); i++)
+   {
+      pendingMoves[i].mPos += posError;
+      pendingMoves[i].mVel += velError;
+   }
+
+   mPredictedState.mPos += posError;
+   mPredictedState.mVel += velError;
+
+   ship->setState(&mPredictedState);
+}
+
+
 // A new move has arrived
 void ControlObjectConnection::onGotNewMove(const Move &move)
 {
@@ -317,6 +452,30 @@ void ControlObjectConnection::onGotNewMove(const Move &move)
 }
 
 
+U32 ControlObjectConnection::getReplayCount() const
+{
+   return mReplayCount;
+}
+
+
+U32 ControlObjectConnection::getReplaySmoothedCount() const
+{
+   return mReplaySmoothedCount;
+}
+
+
+U32 ControlObjectConnection::getReplayMovesLast() const
+{
+   return mReplayMovesLast;
+}
+
+
+U32 ControlObjectConnection::getReplayMovesTotal() const
+{
+   return mReplayMovesTotal;
+}
+
+
 U32 ControlObjectConnection::getTimeSinceLastMove()
 {
    return mTimeSinceLastMove;
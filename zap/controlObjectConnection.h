@@ -9,6 +9,7 @@
 #include "move.h"
 #include "Point.h"
 #include "BfObject.h" 
+#include "Test.h"
 
 #include "tnl.h"
 #include "tnlGhostConnection.h"
@@ -34,6 +35,7 @@ struct ControlObjectData : public Move
 };
 
 class BfObject;
+class Ship;
 
 class ControlObjectConnection: public GhostConnection    // only child class is GameConnection...
 {
@@ -44,12 +46,18 @@ private:
    enum {
       MaxPendingMoves = 63,
       MaxMoveTimeCredit = 512,
+      MaxReplayMoves = 32,          // Most moves we'll re-simulate for a single correction from the server
    };
 
+   static const F32 MaxSmoothedReplayError;
 
-   Vector<ControlObjectData> pendingMoves;
+
+   Vector<ControlObjectData> pendingMoves;    // Each holds the state we predicted for the start of its move
    SafePtr<BfObject> controlObject;
 
+   ControlObjectData mPredictedState;        // Where our prediction had us before the server corrected it
+   bool mHavePredictedState;
+
    U32 mLastClientControlCRC;
    Point mServerPosition;
    bool mCompressPointsRelative;
@@ -65,8 +73,20 @@ private:
 
    U32 mBusyTime;          // How long have we been busy (see mIsBusy)
 
+   // Client-side prediction statistics
+   U32 mReplayCount;             // Corrections we re-simulated pending moves for
+   U32 mReplaySmoothedCount;     // Corrections small enough that we just nudged our prediction
+   U32 mReplayMovesLast;         // Moves re-simulated for the most recent correction
+   U32 mReplayMovesTotal;
+
    void onGotNewMove(const Move &move);
 
+   void replayPendingMoves();
+   bool smoothCorrection(Ship *ship);
+   void shiftPrediction(Ship *ship, S32 firstMove, const Point &posError, const Point &velError);
+
+   FRIEND_TEST(MoveTest, ReplayKeepsEnergyCorrection);
+
 protected:
    bool mIsBusy;
    bool mNeedReplayMoves;
@@ -75,6 +95,12 @@ public:
    ControlObjectConnection();
    virtual ~ControlObjectConnection();
 
+   // Client-side prediction statistics, shown by ConnectionStatsRenderer
+   U32 getReplayCount() const;
+   U32 getReplaySmoothedCount() const;
+   U32 getReplayMovesLast() const;
+   U32 getReplayMovesTotal() const;
+
    void setControlObject(BfObject *theObject);
    BfObject *getControlObject() const;
    U32 getControlCRC();
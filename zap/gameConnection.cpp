@@ -833,6 +833,8 @@ TNL_IMPLEMENT_RPC(GameConnection, c2sSetParam,
       // If we're clearning the level change password, quietly grant access to anyone who doesn't already have it
       if(!strcmp(param.getString(), ""))
       {
+         Vector<GameConnection *> newLevelChangers;
+
          for(S32 i = 0; i < mServerGame->getClientCount(); i++)
          {
             ClientInfo *clientInfo = mServerGame->getClientInfo(i);
@@ -843,9 +845,11 @@ TNL_IMPLEMENT_RPC(GameConnection, c2sSetParam,
 
                GameConnection *conn = clientInfo->getConnection();
                if(conn)
-                  conn->sendLevelList(true);
+                  newLevelChangers.push_back(conn);
             }
          }
+
+         sendLevelList(newLevelChangers, true);
       }
       else  // If setting a password, remove everyone's permissions (except admins)
       { 
@@ -925,14 +929,18 @@ void GameConnection::markCurrentLevelAsDeleted()
 
 void GameConnection::sendListOfLevelsToAllLevelChangers(bool sendPlaylistList) const
 {
+   Vector<GameConnection *> levelChangers;
+
    for(S32 i = 0; i < mServerGame->getClientCount(); i++)
    {
       ClientInfo *clientInfo = mServerGame->getClientInfo(i);
       GameConnection *conn = clientInfo->getConnection();
 
       if(clientInfo->isLevelChanger() && conn)
-         conn->sendLevelList(sendPlaylistList);
+         levelChangers.push_back(conn);
    }
+
+   sendLevelList(levelChangers, sendPlaylistList);
 }
 
 
@@ -1275,25 +1283,47 @@ static Vector<string> findAllScriptsInFolder(const string &dir)
 // Server only
 void GameConnection::sendLevelList(bool sendPlaylistList)
 {
+   Vector<GameConnection *> connections;
+   connections.push_back(this);
+
+   sendLevelList(connections, sendPlaylistList);
+}
+
+
+// Server only -- sends the same list to every connection, building each message once and posting it to all of them
+void GameConnection::sendLevelList(const Vector<GameConnection *> &connections, bool sendPlaylistList)
+{
+   if(connections.size() == 0)
+      return;
+
+   GameConnection *first = connections[0];
+   ServerGame *serverGame = first->mServerGame;
+
+   Vector<RefPtr<NetEvent> > events;
+
    // Send blank entry to clear the remote list
-   s2cAddLevel("", NoGameType);    
+   events.push_back(TNL_RPC_CONSTRUCT_NETEVENT(first, s2cAddLevel, ("", NoGameType)));
 
    // Build list remotely by sending level names one-by-one
-   for(S32 i = 0; i < mServerGame->getLevelCount(); i++)
+   for(S32 i = 0; i < serverGame->getLevelCount(); i++)
    {
-      LevelInfo levelInfo = mServerGame->getLevelInfo(i);
-      s2cAddLevel(levelInfo.mLevelName, levelInfo.mLevelType);
+      LevelInfo levelInfo = serverGame->getLevelInfo(i);
+      events.push_back(TNL_RPC_CONSTRUCT_NETEVENT(first, s2cAddLevel, (levelInfo.mLevelName, levelInfo.mLevelType)));
    }
 
-   Vector<string> playlistList = mServerGame->getServerPlaylists();
+   Vector<string> playlistList = serverGame->getServerPlaylists();
 
-   S32 currentPlaylistIndex = playlistList.getIndex(mServerGame->getPlaylist());
+   S32 currentPlaylistIndex = playlistList.getIndex(serverGame->getPlaylist());
 
    if(sendPlaylistList)
-      s2cSendScriptAndPlaylistLists(findAllScriptsInFolder(mServerGame->getSettings()->getFolderManager()->getLevelDir()), 
-                                    playlistList, currentPlaylistIndex);
+      events.push_back(TNL_RPC_CONSTRUCT_NETEVENT(first, s2cSendScriptAndPlaylistLists, 
+            (findAllScriptsInFolder(serverGame->getSettings()->getFolderManager()->getLevelDir()), playlistList, currentPlaylistIndex)));
    else
-      s2cSendCurrentPlaylist(currentPlaylistIndex);
+      events.push_back(TNL_RPC_CONSTRUCT_NETEVENT(first, s2cSendCurrentPlaylist, (currentPlaylistIndex)));
+
+   for(S32 i = 0; i < connections.size(); i++)
+      for(S32 j = 0; j < events.size(); j++)
+         connections[i]->postNetEvent(events[j]);
 }
 
 
@@ -2127,6 +2157,32 @@ TNL_IMPLEMENT_RPC(GameConnection, s2rVoiceChatEnable, (bool enable), (enable), N
 }
 
 
+// Client has /vmuted someone, or changed their mind.  We keep track so neither relayed nor mixed voice reaches them.
+TNL_IMPLEMENT_RPC(GameConnection, c2sSetVoiceMute, (StringTableEntry name, bool muted), (name, muted),
+                  NetClassGroupGameMask, RPCGuaranteedOrdered, RPCDirClientToServer, 4)
+{
+   S32 index = mVoiceMuteList.getIndex(name);
+
+   if(muted && index == -1 && mVoiceMuteList.size() < MaxVoiceMutes)
+      mVoiceMuteList.push_back(name);
+   else if(!muted && index != -1)
+      mVoiceMuteList.erase_fast(index);
+}
+
+
+bool GameConnection::isVoiceMuted(const StringTableEntry &name) const
+{
+   return mVoiceMuteList.contains(name);
+}
+
+
+// Mixed voice chat, and c2sSetVoiceMute, arrived with version 4 RPCs; older clients only know how to hear it relayed
+bool GameConnection::canHearMixedVoiceChat()
+{
+   return getEventClassVersion() >= 4;
+}
+
+
 static string serverPW;
 
 // Send password, client's name, and version info to game server
@@ -2505,6 +2561,11 @@ void GameConnection::onConnectionEstablished_client()
 
    if(mSettings->getSetting<F32>(IniKey::VoiceChatVolume) == 0)
       s2rVoiceChatEnable(false);
+
+   // Let the server know who we've muted, so it doesn't mix them into what we hear
+   const Vector<string> &voiceMuteList = mClientGame->getVoiceMuteList();
+   for(S32 i = 0; i < voiceMuteList.size(); i++)
+      c2sSetVoiceMute(voiceMuteList[i], true);
 #endif
 }
 
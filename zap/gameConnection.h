@@ -175,6 +175,7 @@ public:
    void submitPassword(const char *password);
 
    void sendLevelList(bool sendPlaylistList);
+   static void sendLevelList(const Vector<GameConnection *> &connections, bool sendPlaylistList);
 
    bool isReadyForRegularGhosts();
    void setReadyForRegularGhosts(bool ready);
@@ -331,6 +332,15 @@ public:
                             // client side: this can allow or disallow sending voice to server
    TNL_DECLARE_RPC(s2rVoiceChatEnable, (bool enabled));
 
+private:
+   Vector<StringTableEntry> mVoiceMuteList;     // Server side: players this client doesn't want to hear
+   static const S32 MaxVoiceMutes = 64;
+
+public:
+   TNL_DECLARE_RPC(c2sSetVoiceMute, (StringTableEntry name, bool muted));
+   bool isVoiceMuted(const StringTableEntry &name) const;
+   bool canHearMixedVoiceChat();
+
    void resetAuthenticationTimer();
    S32 getAuthenticationCounter();
 
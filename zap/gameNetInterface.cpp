@@ -8,13 +8,66 @@
 #include "game.h"
 #include "version.h"
 
+#include "tnlRandom.h"
+
 namespace Zap
 {
 
+// Constructor
+GameNetInterface::QueryResponseValues::QueryResponseValues()
+{
+   playerCount = 0;
+   maxPlayers = 0;
+   robotCount = 0;
+   dedicated = false;
+   testServer = false;
+   passwordRequired = false;
+   clientId = 0;
+}
+
+
+// Constructor -- server only
+GameNetInterface::QueryResponseValues::QueryResponseValues(Game *game)
+{
+   hostName = game->getSettings()->getHostName();
+   hostDescr = game->getSettings()->getHostDescr();
+   playerCount = game->getPlayerCount();
+   maxPlayers = game->getMaxPlayers();
+   robotCount = game->getRobotCount();
+   dedicated = game->isDedicated();
+   testServer = game->isTestServer();
+   passwordRequired = game->getSettings()->getServerPassword() != "";
+   clientId = game->getClientId();
+}
+
+
+bool GameNetInterface::QueryResponseValues::operator==(const QueryResponseValues &other) const
+{
+   return playerCount == other.playerCount && maxPlayers == other.maxPlayers && robotCount == other.robotCount &&
+          dedicated == other.dedicated && testServer == other.testServer && passwordRequired == other.passwordRequired &&
+          clientId == other.clientId && hostName == other.hostName && hostDescr == other.hostDescr;
+}
+
+
+////////////////////////////////////////
+////////////////////////////////////////
+
 // Constructor
 GameNetInterface::GameNetInterface(const Address &bindAddress, Game *theGame) : NetInterface(bindAddress)
 {
    mGame = theGame;
+
+   mQueryResponseBuilt = false;
+   mQueryResponseBuildCount = 0;
+
+   for(U32 i = 0; i < RequestBucketCount; i++)
+   {
+      mRequestBuckets[i].address = 0;
+      mRequestBuckets[i].lastRefillTime = 0;
+      mRequestBuckets[i].tokens = RequestBurst;
+   }
+
+   mRequestBucketSalt = Random::readI();
 }
 
 
@@ -97,9 +150,9 @@ static void handlePingResponse(Game *game, const Address &remoteAddress, BitStre
 }
 
 
-static void handleQuery(Game *game, const Address &remoteAddress, Socket &socket, BitStream *stream)
+void GameNetInterface::handleQuery(const Address &remoteAddress, BitStream *stream)
 {
-   TNLAssert(game->isServer(), "Expected this to be a server!");
+   TNLAssert(mGame->isServer(), "Expected this to be a server!");
 
    Nonce nonce;
    U32 clientIdentityToken;
@@ -108,25 +161,62 @@ static void handleQuery(Game *game, const Address &remoteAddress, Socket &socket
    stream->read(&clientIdentityToken);
 
    if(clientIdentityToken == computeSimpleToken(nonce))
-   {
-      PacketStream queryResponse;
-      queryResponse.write(U8(GameNetInterface::QueryResponse));
+      getQueryResponse(nonce)->sendto(mSocket, remoteAddress);
+}
 
-      nonce.write(&queryResponse);
-      queryResponse.writeStringTableEntry(game->getSettings()->getHostName());
-      queryResponse.writeStringTableEntry(game->getSettings()->getHostDescr());
 
-      queryResponse.write(game->getPlayerCount());
-      queryResponse.write(game->getMaxPlayers());
-      queryResponse.write(game->getRobotCount());
-      queryResponse.writeFlag(game->isDedicated());
-      queryResponse.writeFlag(game->isTestServer());
-      queryResponse.writeFlag(game->getSettings()->getServerPassword() != "");
+// Read in handleQueryResponse(), below
+void GameNetInterface::writeQueryResponse(Game *game, const Nonce &nonce, BitStream *stream)
+{
+   stream->write(U8(GameNetInterface::QueryResponse));
+
+   nonce.write(stream);
+   stream->writeStringTableEntry(game->getSettings()->getHostName());
+   stream->writeStringTableEntry(game->getSettings()->getHostDescr());
+
+   stream->write(game->getPlayerCount());
+   stream->write(game->getMaxPlayers());
+   stream->write(game->getRobotCount());
+   stream->writeFlag(game->isDedicated());
+   stream->writeFlag(game->isTestServer());
+   stream->writeFlag(game->getSettings()->getServerPassword() != "");
+
+   stream->write(game->getClientId());  // older 019 ignore this or won't read this
+}
 
-      queryResponse.write(game->getClientId());  // older 019 ignore this or won't read this
 
-      queryResponse.sendto(socket, remoteAddress);
+// Server browsers send us a lot of queries, and the answer hardly ever changes, so we write it once and only patch in
+// the nonce for each query, writing it again only when something in it changes
+PacketStream *GameNetInterface::getQueryResponse(const Nonce &nonce)
+{
+   QueryResponseValues values(mGame);
+
+   if(!mQueryResponseBuilt || !(values == mQueryResponseValues))
+   {
+      mQueryResponse.reset();
+      writeQueryResponse(mGame, nonce, &mQueryResponse);
+
+      mQueryResponseValues = values;
+      mQueryResponseBuilt = true;
+      mQueryResponseBuildCount++;
+
+      return &mQueryResponse;
    }
+
+   // The nonce comes right after the packet type
+   U32 endPosition = mQueryResponse.getBitPosition();
+
+   mQueryResponse.setBytePosition(1);
+   nonce.write(&mQueryResponse);
+   mQueryResponse.setBitPosition(endPosition);
+
+   return &mQueryResponse;
+}
+
+
+U32 GameNetInterface::getQueryResponseBuildCount() const
+{
+   return mQueryResponseBuildCount;
 }
 
 
@@ -164,8 +254,50 @@ static void handleQueryResponse(Game *game, const Address &remoteAddress, BitStr
 }
 
 
+// Returns true if we should answer a ping or query from remoteAddress, using up one of its tokens if so
+bool GameNetInterface::allowInfoRequest(const Address &remoteAddress, U32 currentTime)
+{
+   // Leave out the port, so nobody can get around this by sending from lots of them
+   U32 address = remoteAddress.netNum[0] ^ remoteAddress.netNum[1] ^ remoteAddress.netNum[2] ^ remoteAddress.netNum[3];
+   RequestBucket &bucket = mRequestBuckets[(((address ^ mRequestBucketSalt) * 2654435761u) >> 16) % RequestBucketCount];
+
+   if(bucket.address != address)
+   {
+      bucket.address = address;
+      bucket.lastRefillTime = currentTime;
+      bucket.tokens = RequestBurst;
+   }
+
+   U32 earned = (currentTime - bucket.lastRefillTime) / RequestRefillTime;
+
+   if(earned > 0)
+   {
+      if(bucket.tokens + earned >= RequestBurst)
+      {
+         bucket.tokens = RequestBurst;
+         bucket.lastRefillTime = currentTime;
+      }
+      else
+      {
+         bucket.tokens += earned;
+         bucket.lastRefillTime += earned * RequestRefillTime;    // Keep credit for any partial token
+      }
+   }
+
+   if(bucket.tokens == 0)
+      return false;
+
+   bucket.tokens--;
+   return true;
+}
+
+
 void GameNetInterface::handleInfoPacket(const Address &remoteAddress, U8 packetType, BitStream *stream)
 {
+   // Only servers answer pings and queries, and only so many from any one address
+   if((packetType == Ping || packetType == Query) && mGame->isServer() && !allowInfoRequest(remoteAddress, getCurrentTime()))
+      return;
+
    switch(packetType)
    {
       case Ping:
@@ -180,7 +312,7 @@ void GameNetInterface::handleInfoPacket(const Address &remoteAddress, U8 packetT
 
       case Query:
          if(mGame->isServer())
-            handleQuery(mGame, remoteAddress, mSocket, stream);
+            handleQuery(remoteAddress, stream);
          break;
 
       case QueryResponse: 
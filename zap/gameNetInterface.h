@@ -8,7 +8,10 @@
 
 #include "tnlNetInterface.h"
 
+#include <string>
+
 using namespace TNL;
+using namespace std;
 
 namespace Zap
 {
@@ -29,10 +32,61 @@ public:
       QueryResponse,
    };
 
+   static const U32 RequestBucketCount = 1024;  // Fixed, so a flood from many addresses can't make us allocate anything
+   static const U32 RequestBurst = 8;           // Pings and queries an address can send us in a burst...
+   static const U32 RequestRefillTime = 250;    // ...and how often, in ms, it earns another one after that
+
+private:
+   // Everything that goes into our answer to a query, so we can tell when our cached answer is out of date
+   struct QueryResponseValues
+   {
+      string hostName;
+      string hostDescr;
+      S32 playerCount;
+      U32 maxPlayers;
+      S32 robotCount;
+      bool dedicated;
+      bool testServer;
+      bool passwordRequired;
+      S32 clientId;
+
+      QueryResponseValues();
+      explicit QueryResponseValues(Game *game);
+
+      bool operator==(const QueryResponseValues &other) const;
+   };
+
+   QueryResponseValues mQueryResponseValues;
+   PacketStream mQueryResponse;     // Our answer to queries, with the nonce patched in for each one
+   bool mQueryResponseBuilt;
+   U32 mQueryResponseBuildCount;
+
+   // Token bucket for limiting how many pings and queries we'll answer.  Addresses are hashed into a fixed set of
+   // these, but each belongs to only one address at a time; another address that hashes to it takes it over with a
+   // fresh burst.  A flood from forged addresses just keeps resetting them, and can't use up anyone else's tokens.
+   struct RequestBucket
+   {
+      U32 address;
+      U32 lastRefillTime;
+      U32 tokens;
+   };
+
+   RequestBucket mRequestBuckets[RequestBucketCount];
+   U32 mRequestBucketSalt;          // So nobody can pick addresses that share a bucket, and take turns resetting it
+
+   void handleQuery(const Address &remoteAddress, BitStream *stream);
+
+public:
    GameNetInterface(const Address &bindAddress, Game *theGame);
    virtual ~GameNetInterface();
 
    void handleInfoPacket(const Address &remoteAddress, U8 packetType, BitStream *stream);
+
+   bool allowInfoRequest(const Address &remoteAddress, U32 currentTime);
+
+   static void writeQueryResponse(Game *game, const Nonce &nonce, BitStream *stream);
+   PacketStream *getQueryResponse(const Nonce &nonce);
+   U32 getQueryResponseBuildCount() const;
    void sendPing(const Address &theAddress, const Nonce &clientNonce);
    void sendQuery(const Address &theAddress, const Nonce &clientNonce, U32 identityToken);
    void processPacket(const Address &sourceAddress, BitStream *pStream);
@@ -409,6 +409,370 @@ void writeVersion3Stats(TNL::BitStream &s, const Zap::PlayerStats &val)
 }
 
 
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Starting with version 4, each team's players are sent a column at a time: all the names, then everyone's points,
+// then everyone's kills, and so on.  Each column of numbers is sent using just enough bits for its largest value, so
+// columns of small numbers cost little, and columns of zeroes (which are common) cost almost nothing.  Weapons,
+// modules, and loadouts are sent as indices into dictionaries that are sent once, ahead of the teams.
+
+static const U32 ColumnWidthBits = 6;        // Enough to hold 0 - 32
+static const U32 MaxColumnSize = 1024;       // Sanity limit on dictionaries, players per team, and entries per player
+
+typedef U32 Zap::PlayerStats::*PlayerCounter;
+
+// Order matters!  Add new counters at the end, and bump the version.
+static const PlayerCounter PlayerCounters[] = {
+   &PlayerStats::kills,       &PlayerStats::deaths,       &PlayerStats::suicides,     &PlayerStats::switchedTeamCount,
+   &PlayerStats::fratricides, &PlayerStats::flagPickup,   &PlayerStats::flagDrop,     &PlayerStats::flagReturn,
+   &PlayerStats::flagScore,   &PlayerStats::crashedIntoAsteroid, &PlayerStats::changedLoadout, &PlayerStats::teleport,
+   &PlayerStats::playTime,    &PlayerStats::turretKills,  &PlayerStats::ffKills,      &PlayerStats::astKills,
+   &PlayerStats::turretsEngr, &PlayerStats::ffEngr,       &PlayerStats::telEngr,      &PlayerStats::distTraveled
+};
+
+
+// Weapon and module types, and loadout hashes, that appear anywhere in the game
+struct StatsDictionaries
+{
+   Vector<U32> weapons;
+   Vector<U32> modules;
+   Vector<U32> loadouts;
+};
+
+
+static U32 clampColumnSize(U32 size)
+{
+   return size < MaxColumnSize ? size : MaxColumnSize;
+}
+
+
+// Zigzag encoding maps small negative numbers to small positive ones: 0, -1, 1, -2, 2... become 0, 1, 2, 3, 4...
+static U32 zigzag(S32 value)
+{
+   return (U32(value) << 1) ^ U32(value >> 31);
+}
+
+
+static S32 unzigzag(U32 value)
+{
+   return S32(value >> 1) ^ -S32(value & 1);
+}
+
+
+static void writeColumn(TNL::BitStream &s, const Vector<U32> &values)
+{
+   U32 maxValue = 0;
+   for(S32 i = 0; i < values.size(); i++)
+      maxValue |= values[i];                 // Same high bit as the largest value, which is all we care about
+
+   U32 width = (maxValue == 0) ? 0 : getBinLog2(maxValue) + 1;
+   s.writeInt(width, ColumnWidthBits);
+
+   if(width > 0)
+      for(S32 i = 0; i < values.size(); i++)
+         s.writeInt(values[i], width);
+}
+
+
+static U32 readColumnWidth(TNL::BitStream &s)
+{
+   U32 width = s.readInt(ColumnWidthBits);
+   return width < 32 ? width : 32;
+}
+
+
+static U32 readColumnValue(TNL::BitStream &s, U32 width)
+{
+   return width == 0 ? 0 : s.readInt(width);
+}
+
+
+static U32 getIndexWidth(U32 dictionarySize)
+{
+   return dictionarySize <= 1 ? 0 : getNextBinLog2(dictionarySize);
+}
+
+
+static void writeIndexColumn(TNL::BitStream &s, const Vector<U32> &indices, U32 dictionarySize)
+{
+   U32 width = getIndexWidth(dictionarySize);
+
+   if(width > 0)
+      for(S32 i = 0; i < indices.size(); i++)
+         s.writeInt(indices[i], width);
+}
+
+
+// Returns the dictionary entry the next index refers to; bad indices get the first entry rather than running off the end
+static U32 readIndex(TNL::BitStream &s, const Vector<U32> &dictionary)
+{
+   U32 index = readColumnValue(s, getIndexWidth(dictionary.size()));
+   return index < U32(dictionary.size()) ? dictionary[index] : (dictionary.size() > 0 ? dictionary[0] : 0);
+}
+
+
+static void addToDictionary(Vector<U32> &dictionary, U32 value)
+{
+   if(!dictionary.contains(value) && U32(dictionary.size()) < MaxColumnSize)
+      dictionary.push_back(value);
+}
+
+
+static void buildDictionaries(const Zap::GameStats &val, StatsDictionaries &dictionaries)
+{
+   for(S32 i = 0; i < val.teamStats.size(); i++)
+      for(S32 j = 0; j < val.teamStats[i].playerStats.size(); j++)
+      {
+         const PlayerStats &player = val.teamStats[i].playerStats[j];
+
+         for(S32 k = 0; k < player.weaponStats.size(); k++)
+            addToDictionary(dictionaries.weapons, player.weaponStats[k].weaponType);
+
+         for(S32 k = 0; k < player.moduleStats.size(); k++)
+            addToDictionary(dictionaries.modules, player.moduleStats[k].shipModule);
+
+         for(S32 k = 0; k < player.loadoutStats.size(); k++)
+            addToDictionary(dictionaries.loadouts, player.loadoutStats[k].loadoutHash);
+      }
+}
+
+
+static void writeDictionary(TNL::BitStream &s, const Vector<U32> &dictionary, U8 bitCount)
+{
+   writeCompressedU32(s, dictionary.size());
+
+   for(S32 i = 0; i < dictionary.size(); i++)
+      s.writeInt(dictionary[i], bitCount);
+}
+
+
+static void readDictionary(TNL::BitStream &s, Vector<U32> &dictionary, U8 bitCount)
+{
+   dictionary.resize(clampColumnSize(readCompressedU32(s)));
+
+   for(S32 i = 0; i < dictionary.size(); i++)
+      dictionary[i] = s.readInt(bitCount);
+}
+
+
+static void writeTeamColumns(TNL::BitStream &s, const Zap::TeamStats &val, const StatsDictionaries &dictionaries)
+{
+   writeString(s, val.name);
+   writeCompressedS32(s, val.score);
+   s.writeInt(val.intColor, 24);    // 24 bit color
+
+   const Vector<PlayerStats> &players = val.playerStats;
+   U32 playerCount = clampColumnSize(players.size());
+
+   writeCompressedU32(s, playerCount);
+
+   for(U32 i = 0; i < playerCount; i++)
+      writeString(s, players[i].name);
+
+   for(U32 i = 0; i < playerCount; i++)
+   {
+      s.writeFlag(players[i].isRobot);
+      s.writeFlag(players[i].isAdmin);
+      s.writeFlag(players[i].isLevelChanger);
+      s.writeFlag(players[i].isHosting);
+
+      if(s.writeFlag(players[i].isAuthenticated))
+         players[i].nonce.write(&s);      // Only needed if server claims a player is authenticated
+   }
+
+   Vector<U32> column(playerCount);
+
+   for(U32 i = 0; i < playerCount; i++)
+      column.push_back(zigzag(players[i].points));
+   writeColumn(s, column);
+
+   for(U32 c = 0; c < ARRAYSIZE(PlayerCounters); c++)
+   {
+      column.clear();
+      for(U32 i = 0; i < playerCount; i++)
+         column.push_back(players[i].*PlayerCounters[c]);
+      writeColumn(s, column);
+   }
+
+   // Each kind of per-player list goes out as a column of list sizes, then a column of dictionary indices,
+   // then a column for each value
+   Vector<U32> counts(playerCount), indices, shots, hits, hitBy;
+
+   for(U32 i = 0; i < playerCount; i++)
+   {
+      U32 count = clampColumnSize(players[i].weaponStats.size());
+      counts.push_back(count);
+
+      for(U32 j = 0; j < count; j++)
+      {
+         const WeaponStats &weaponStats = players[i].weaponStats[j];
+         indices.push_back(dictionaries.weapons.getIndex(weaponStats.weaponType));
+         shots.push_back(weaponStats.shots);
+         hits.push_back(weaponStats.hits);
+         hitBy.push_back(weaponStats.hitBy);
+      }
+   }
+
+   writeColumn(s, counts);
+   writeIndexColumn(s, indices, dictionaries.weapons.size());
+   writeColumn(s, shots);
+   writeColumn(s, hits);
+   writeColumn(s, hitBy);
+
+   Vector<U32> seconds;
+   counts.clear();
+   indices.clear();
+
+   for(U32 i = 0; i < playerCount; i++)
+   {
+      U32 count = clampColumnSize(players[i].moduleStats.size());
+      counts.push_back(count);
+
+      for(U32 j = 0; j < count; j++)
+      {
+         indices.push_back(dictionaries.modules.getIndex(players[i].moduleStats[j].shipModule));
+         seconds.push_back(players[i].moduleStats[j].seconds);
+      }
+   }
+
+   writeColumn(s, counts);
+   writeIndexColumn(s, indices, dictionaries.modules.size());
+   writeColumn(s, seconds);
+
+   counts.clear();
+   indices.clear();
+
+   for(U32 i = 0; i < playerCount; i++)
+   {
+      U32 count = clampColumnSize(players[i].loadoutStats.size());
+      counts.push_back(count);
+
+      for(U32 j = 0; j < count; j++)
+         indices.push_back(dictionaries.loadouts.getIndex(players[i].loadoutStats[j].loadoutHash));
+   }
+
+   writeColumn(s, counts);
+   writeIndexColumn(s, indices, dictionaries.loadouts.size());
+}
+
+
+// Reads straight into the structs the database writer will use, without any intermediate copies.  A corrupt stream
+// can make a mess of the values, but can't make us read out of bounds or allocate without limit; the checksum
+// will catch the mess.
+static void readTeamColumns(TNL::BitStream &s, Zap::TeamStats *val, const StatsDictionaries &dictionaries)
+{
+   val->name     = readString(s);
+   val->score    = readCompressedS32(s);
+   val->intColor = s.readInt(24);       // 24 bit color
+   val->hexColor = Color(val->intColor).toHexString();
+
+   Vector<PlayerStats> &players = val->playerStats;
+   players.resize(clampColumnSize(readCompressedU32(s)));
+
+   for(S32 i = 0; i < players.size(); i++)
+      players[i].name = readString(s);
+
+   for(S32 i = 0; i < players.size(); i++)
+   {
+      players[i].isRobot         = s.readFlag();
+      players[i].isAdmin         = s.readFlag();
+      players[i].isLevelChanger  = s.readFlag();
+      players[i].isHosting       = s.readFlag();
+      players[i].isAuthenticated = s.readFlag();
+
+      if(players[i].isAuthenticated)
+         players[i].nonce.read(&s);
+   }
+
+   U32 width = readColumnWidth(s);
+   for(S32 i = 0; i < players.size(); i++)
+      players[i].points = unzigzag(readColumnValue(s, width));
+
+   for(U32 c = 0; c < ARRAYSIZE(PlayerCounters); c++)
+   {
+      width = readColumnWidth(s);
+      for(S32 i = 0; i < players.size(); i++)
+         players[i].*PlayerCounters[c] = readColumnValue(s, width);
+   }
+
+   // Weapons
+   width = readColumnWidth(s);
+   for(S32 i = 0; i < players.size(); i++)
+      players[i].weaponStats.resize(clampColumnSize(readColumnValue(s, width)));
+
+   for(S32 i = 0; i < players.size(); i++)
+      for(S32 j = 0; j < players[i].weaponStats.size(); j++)
+         players[i].weaponStats[j].weaponType = WeaponType(readIndex(s, dictionaries.weapons));
+
+   U32 WeaponStats::*weaponColumns[] = { &WeaponStats::shots, &WeaponStats::hits, &WeaponStats::hitBy };
+
+   for(U32 c = 0; c < ARRAYSIZE(weaponColumns); c++)
+   {
+      width = readColumnWidth(s);
+      for(S32 i = 0; i < players.size(); i++)
+         for(S32 j = 0; j < players[i].weaponStats.size(); j++)
+            players[i].weaponStats[j].*weaponColumns[c] = readColumnValue(s, width);
+   }
+
+   // Modules
+   width = readColumnWidth(s);
+   for(S32 i = 0; i < players.size(); i++)
+      players[i].moduleStats.resize(clampColumnSize(readColumnValue(s, width)));
+
+   for(S32 i = 0; i < players.size(); i++)
+      for(S32 j = 0; j < players[i].moduleStats.size(); j++)
+         players[i].moduleStats[j].shipModule = ShipModule(readIndex(s, dictionaries.modules));
+
+   width = readColumnWidth(s);
+   for(S32 i = 0; i < players.size(); i++)
+      for(S32 j = 0; j < players[i].moduleStats.size(); j++)
+         players[i].moduleStats[j].seconds = readColumnValue(s, width);
+
+   // Loadouts
+   width = readColumnWidth(s);
+   for(S32 i = 0; i < players.size(); i++)
+      players[i].loadoutStats.resize(clampColumnSize(readColumnValue(s, width)));
+
+   for(S32 i = 0; i < players.size(); i++)
+      for(S32 j = 0; j < players[i].loadoutStats.size(); j++)
+         players[i].loadoutStats[j].loadoutHash = readIndex(s, dictionaries.loadouts);
+}
+
+
+static void writeColumnarTeams(TNL::BitStream &s, const Zap::GameStats &val)
+{
+   StatsDictionaries dictionaries;
+   buildDictionaries(val, dictionaries);
+
+   writeDictionary(s, dictionaries.weapons,  8);
+   writeDictionary(s, dictionaries.modules,  8);
+   writeDictionary(s, dictionaries.loadouts, 32);
+
+   U32 teamCount = clampColumnSize(val.teamStats.size());
+   writeCompressedU32(s, teamCount);
+
+   for(U32 i = 0; i < teamCount; i++)
+      writeTeamColumns(s, val.teamStats[i], dictionaries);
+}
+
+
+static void readColumnarTeams(TNL::BitStream &s, Zap::GameStats *val)
+{
+   StatsDictionaries dictionaries;
+
+   readDictionary(s, dictionaries.weapons,  8);
+   readDictionary(s, dictionaries.modules,  8);
+   readDictionary(s, dictionaries.loadouts, 32);
+
+   Vector<TeamStats> &teamStats = val->teamStats;
+   teamStats.resize(clampColumnSize(readCompressedU32(s)));
+
+   for(S32 i = 0; i < teamStats.size() && s.isValid(); i++)     // Stop once we've run off the end
+      readTeamColumns(s, &teamStats[i], dictionaries);
+}
+
+
 void read(TNL::BitStream &s, Zap::PlayerStats *val, U8 version)
 {
    val->name = readString(s);
@@ -475,7 +839,11 @@ void read(TNL::BitStream &s, Zap::GameStats *val, U8 version)
    val->isTeamGame = s.readFlag();
    val->gameType = readString(s);
    val->levelName = readString(s);
-   read(s, &val->teamStats, version);
+
+   if(version >= 4)
+      readColumnarTeams(s, val);
+   else
+      read(s, &val->teamStats, version);
 
    val->playerCount = 0;
 
@@ -495,7 +863,26 @@ void write(TNL::BitStream &s, Zap::GameStats &val, U8 version)
    s.writeFlag(val.isTeamGame);
    writeString(s, val.gameType);
    writeString(s, val.levelName);
-   write(s, val.teamStats, version);
+
+   if(version >= 4)
+      writeColumnarTeams(s, val);
+   else
+      write(s, val.teamStats, version);
+}
+
+
+// Checksum of everything from bitStart up to where we are now.  Before version 4, the arguments to calculateChecksum()
+// were passed in the wrong order, so the checksum skipped the stats and covered whatever bits followed them instead
+// (which, when reading, is the checksum itself).  Older versions still get the old calculation, so nothing changes
+// for older servers.
+static U32 calculateStatsChecksum(TNL::BitStream &s, U32 bitStart, U8 version)
+{
+   U32 length = s.getBitPosition() - bitStart;
+
+   if(version < 4)
+      return calculateChecksum(s, bitStart, length);
+
+   return calculateChecksum(s, length, bitStart);
 }
 
    
@@ -516,7 +903,7 @@ void read(TNL::BitStream &s, VersionedGameStats *val)
    if(!s.isValid() || val->gameStats.teamStats.size() == 0)  // team size should never be zero
       return;
 
-   U32 actualChecksum = calculateChecksum(s, bitStart, s.getBitPosition() - bitStart);
+   U32 actualChecksum = calculateStatsChecksum(s, bitStart, val->version);
    val->valid = (actualChecksum == readU32(s));
 }
 
@@ -550,7 +937,7 @@ void write(TNL::BitStream &s, VersionedGameStats &val)
    // write(U16(number)) always writes 16 bit when number is U8, S32, or any other type
 
    // checksum is used here, just in case a bad coding causes most cases of mismatched read/write not make it to database.
-   U32 checksum = calculateChecksum(s, bitStart, s.getBitPosition() - bitStart);
+   U32 checksum = calculateStatsChecksum(s, bitStart, val.CURRENT_VERSION);
    s.write(U32(checksum));
 }
 
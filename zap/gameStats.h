@@ -124,10 +124,11 @@ struct GameStats
 // CURRENT_VERSION = 1 (016)
 // CURRENT_VERSION = 2 (017)
 // CURRENT_VERSION = 3 (018a)
+// CURRENT_VERSION = 4 (020, players sent as columns; see gameStats.cpp)
 // This contains the whole kilbasa
 struct VersionedGameStats
 {
-   static const U8 CURRENT_VERSION = 3;
+   static const U8 CURRENT_VERSION = 4;
 
    U8 version;
    bool valid;
@@ -3827,7 +3827,7 @@ GAMETYPE_RPC_S2C(GameType, s2cKillMessage, (StringTableEntry victim, StringTable
 TNL_IMPLEMENT_NETOBJECT_RPC(GameType, c2sVoiceChat, (bool echo, ByteBufferPtr voiceBuffer), (echo, voiceBuffer),
    NetClassGroupGameMask, RPCUnguaranteed, RPCToGhostParent, 0)
 {
-   // Broadcast this to all clients on the same team; only send back to the source if echo is true
+   // Broadcast this to all clients on the same team who haven't muted the source; only send back to the source if echo is true
 
    GameConnection *source = (GameConnection *) getRPCSourceConnection();
    ClientInfo *sourceClientInfo = source->getClientInfo();
@@ -3838,19 +3838,62 @@ TNL_IMPLEMENT_NETOBJECT_RPC(GameType, c2sVoiceChat, (bool echo, ByteBufferPtr vo
 
    if(source)
    {
+      VoiceMixer *mixer = ((ServerGame *)mGame)->getVoiceMixer();
+      VoiceChatMode mode = getGame()->getSettings()->getSetting<VoiceChatMode>(IniKey::ServerVoiceChatMode);
+
+      // Mixed voice goes out with everyone else's in ServerGame::idle(), except to clients too old to play it
+      bool mixed = mixer->shouldMix(mode, sourceClientInfo, echo);
+      if(mixed)
+         mixer->addVoice(sourceClientInfo, echo, voiceBuffer);
+
       RefPtr<NetEvent> event = TNL_RPC_CONSTRUCT_NETEVENT(this, s2cVoiceChat, (sourceClientInfo->getName(), voiceBuffer));
+      U32 sent = 0;
 
       for(S32 i = 0; i < mGame->getClientCount(); i++)
       {
          ClientInfo *clientInfo = mGame->getClientInfo(i);
          GameConnection *dest = clientInfo->getConnection();
 
-         if(dest && dest->mVoiceChatEnabled && clientInfo->getTeamIndex() == sourceClientInfo->getTeamIndex() && (dest != source || echo))
-            dest->postNetEvent(event);
+         if(!dest || !dest->mVoiceChatEnabled || clientInfo->getTeamIndex() != sourceClientInfo->getTeamIndex())
+            continue;
+
+         if((dest == source && !echo) || dest->isVoiceMuted(sourceClientInfo->getName()))
+            continue;
+
+         if(mixed && dest->canHearMixedVoiceChat())
+            continue;
+
+         dest->postNetEvent(event);
+         sent++;
       }
 
+      mixer->countRelayedBytes(sent * voiceBuffer->getBufferSize());
+
       GameConnection *gc = ((ServerGame *)mGame)->getGameRecorder();
-      if(gc)
+      if(gc && !mixed)
+         gc->postNetEvent(event);
+   }
+}
+
+
+// Server only -- sends voice chat that VoiceMixer has mixed together to the players it's meant for
+void GameType::sendMixedVoiceChat(const Vector<VoiceMixer::MixedStream> &streams)
+{
+   VoiceMixer *mixer = ((ServerGame *)mGame)->getVoiceMixer();
+
+   for(S32 i = 0; i < streams.size(); i++)
+   {
+      const VoiceMixer::MixedStream &stream = streams[i];
+      RefPtr<NetEvent> event = TNL_RPC_CONSTRUCT_NETEVENT(this, s2cMixedVoiceChat, (stream.teamIndex, stream.streamId, stream.data));
+
+      for(S32 j = 0; j < stream.listeners.size(); j++)
+         stream.listeners[j]->getConnection()->postNetEvent(event);
+
+      mixer->countMixedBytes(stream.listeners.size() * stream.data->getBufferSize());
+
+      // Recordings get what the rest of the team heard
+      GameConnection *gc = ((ServerGame *)mGame)->getGameRecorder();
+      if(gc && stream.wholeTeam)
          gc->postNetEvent(event);
    }
 }
@@ -3865,6 +3908,15 @@ TNL_IMPLEMENT_NETOBJECT_RPC(GameType, s2cVoiceChat, (StringTableEntry clientName
 }
 
 
+TNL_IMPLEMENT_NETOBJECT_RPC(GameType, s2cMixedVoiceChat, (S32 teamIndex, U32 streamId, ByteBufferPtr voiceBuffer), (teamIndex, streamId, voiceBuffer),
+   NetClassGroupGameMask, RPCUnguaranteed, RPCToGhost, 4)
+{
+#ifndef ZAP_DEDICATED
+   static_cast<ClientGame *>(mGame)->gotMixedVoiceChat(teamIndex, streamId, voiceBuffer);
+#endif
+}
+
+
 // Server tells clients that another player is idle and will not be joining us for the moment
 TNL_IMPLEMENT_NETOBJECT_RPC(GameType, s2cSetIsSpawnDelayed, (StringTableEntry name, bool idle), (name, idle), 
                   NetClassGroupGameMask, RPCGuaranteedOrdered, RPCToGhost, 0)
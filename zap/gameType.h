@@ -16,6 +16,7 @@
 #include "DismountModesEnum.h"
 
 #include "Timer.h"
+#include "VoiceMixer.h"          // For VoiceMixer::MixedStream
 
 #include <string>
 #include <boost/shared_ptr.hpp>
@@ -461,6 +462,8 @@ public:
 
    TNL_DECLARE_RPC(c2sVoiceChat, (bool echo, ByteBufferPtr compressedVoice));
    TNL_DECLARE_RPC(s2cVoiceChat, (StringTableEntry client, ByteBufferPtr compressedVoice));
+   TNL_DECLARE_RPC(s2cMixedVoiceChat, (S32 teamIndex, U32 streamId, ByteBufferPtr compressedVoice));
+   void sendMixedVoiceChat(const Vector<VoiceMixer::MixedStream> &streams);
 
    TNL_DECLARE_RPC(c2sSetTime, (U32 time));
    TNL_DECLARE_RPC(c2sSetWinningScore, (U32 score));
@@ -41,6 +41,7 @@ GridDatabase::GridDatabase()
          mBuckets[i][j].nextInBucket = NULL;
 
    mDatabaseId = getNextId();
+   mZoneMapDirty = true;
 }
 
 
@@ -143,6 +144,9 @@ void GridDatabase::addToDatabase(DatabaseObject *object)
 
    U8 type = object->getObjectTypeNumber();
 
+   if(isZoneType(type))
+      mZoneMapDirty = true;
+
    if(type == GoalZoneTypeNumber)
       mGoalZones.push_back(object);
    else if(type == FlagTypeNumber)
@@ -209,6 +213,7 @@ void GridDatabase::removeEverythingFromDatabase()
    mPolyWalls.clear();
    mWallitems.clear();
    mLoadoutZones.clear();
+   mZoneMapDirty = true;
 
    for(S32 i = 0; i < mAllObjects.size(); i++)
       mAllObjects[i]->deleteThyself();
@@ -274,6 +279,9 @@ void GridDatabase::removeFromDatabase(DatabaseObject *object, bool deleteObject)
 
    U8 type = object->getObjectTypeNumber();
 
+   if(isZoneType(type))
+      mZoneMapDirty = true;
+
    if(type == GoalZoneTypeNumber)
       eraseObject_fast(&mGoalZones, object);
    else if(type == FlagTypeNumber)
@@ -627,10 +635,12 @@ DatabaseObject *GridDatabase::findObjectLOS(TestFunc testFunc, U32 stateIndex, b
 }
 
 
-// This variant only searches one of the items in the passed vector
+// This variant only searches the items in the passed vector.  Any object found in excludeList will be
+// skipped, which lets callers ignore specific objects without toggling their collision flags.
 DatabaseObject *GridDatabase::findObjectLOS(const Vector<DatabaseObject *> &objList, U32 stateIndex, bool format,
                                             const Point &rayStart, const Point &rayEnd, 
-                                            F32 &collisionTime, Point &surfaceNormal) const
+                                            F32 &collisionTime, Point &surfaceNormal,
+                                            const Vector<DatabaseObject *> *excludeList) const
 {
    Point collisionPoint;
 
@@ -648,6 +658,9 @@ DatabaseObject *GridDatabase::findObjectLOS(const Vector<DatabaseObject *> &objL
       if(!objList[i]->isCollisionEnabled())     // Skip collision-disabled objects
          continue;
 
+      if(excludeList && excludeList->contains(objList[i]))
+         continue;
+
       if(objList[i]->checkForCollision(rayStart, rayEnd, format, stateIndex, ct, norm))
       {
          if(ct < 0)        // Special condition... found something, but not what we want.  Don't do circle check.
@@ -799,12 +812,31 @@ DatabaseObject *GridDatabase::getObjectByIndex(S32 index) const
 } 
 
 
+// Zones rarely change once a level is loaded, so we only rebuild the map when something asks for it after they do
+const ZoneMap *GridDatabase::getZoneMap() const
+{
+   if(mZoneMapDirty)
+   {
+      Vector<DatabaseObject *> zones;
+      findObjects((TestFunc)isZoneType, zones);
+
+      mZoneMap.build(zones);
+      mZoneMapDirty = false;
+   }
+
+   return &mZoneMap;
+}
+
+
 void GridDatabase::updateExtents(DatabaseObject *object, const Rect &newExtents)
 {
    // Does the equivalent of the following, but more efficiently:
    // removeFromDatabase();    
    // addToDatabase();
 
+   if(isZoneType(object->getObjectTypeNumber()))
+      mZoneMapDirty = true;      // Zone may have changed shape, even if its extents haven't
+
    S32 minxold, minyold, maxxold, maxyold;
    S32 minx, miny, maxx, maxy;
 
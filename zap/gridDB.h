@@ -13,6 +13,7 @@
 #include "tnlVector.h"
 
 #include "Rect.h"
+#include "ZoneMap.h"
 
 
 using namespace TNL;
@@ -125,6 +126,10 @@ private:
    // For tracking objects by type and team
    Vector<Vector<DatabaseObject *> > mLoadoutZones;
 
+   // For finding which zones a point is in; rebuilt when it's next needed after any zone changes
+   mutable ZoneMap mZoneMap;
+   mutable bool mZoneMapDirty;
+
    void findObjects(U8 typeNumber, Vector<DatabaseObject *> &fillVector, const Rect *extents, const IntRect *bins) const;
    void findObjects(Vector<U8> typeNumbers, Vector<DatabaseObject *> &fillVector, const Rect *extents, const IntRect *bins) const;
    void findObjects(TestFunc testFunc, Vector<DatabaseObject *> &fillVector, const Rect *extents, const IntRect *bins, bool sameQuery = false) const;
@@ -158,7 +163,8 @@ public:
 
    DatabaseObject *findObjectLOS(const Vector<DatabaseObject *> &objList, U32 stateIndex, bool format,
                                  const Point &rayStart, const Point &rayEnd, 
-                                 F32 &collisionTime, Point &surfaceNormal) const;
+                                 F32 &collisionTime, Point &surfaceNormal,
+                                 const Vector<DatabaseObject *> *excludeList = NULL) const;
 
    bool pointCanSeePoint(const Point &point1, const Point &point2);
    void computeSelectionMinMax(Point &min, Point &max);
@@ -202,6 +208,8 @@ public:
    bool hasObjectOfType(U8 typeNumber) const;
    bool hasObjectOfType(U8 typeNumber, S32 teamIndex) const;
    DatabaseObject *getObjectByIndex(S32 index) const;   // Kind of hacky, kind of useful
+
+   const ZoneMap *getZoneMap() const;
 };
 
 
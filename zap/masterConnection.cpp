@@ -36,6 +36,9 @@ MasterServerConnection::MasterServerConnection(Game *game)
 
    mCurrentQueryId = 0;
 
+   mSubscribedToServerList = false;
+   mServerListQueryId = 0;
+
    // Determine connection type based on Game that is running
    // An anonymous connection can be set with setConnectionType()
    if(mGame->isServer())
@@ -75,15 +78,40 @@ void MasterServerConnection::startServerQuery(bool hostOnServer)
    // Invalidate old queries
    mCurrentQueryId++;
 
+   // Newer masters can send us the list once, then keep us up-to-date with changes
+   if(isServerListSubscriptionSupported())
+   {
+      mServerListQueryId = mCurrentQueryId;
+      mSubscribedToServerList = true;
+
+      c2mSubscribeServerList(mCurrentQueryId, hostOnServer);
+   }
+
    // And automatically do a server query as well - you may not want to do things
    // in this order in your own clients.
-   if(hostOnServer)
+   else if(hostOnServer)
       c2mQueryHostServers(mCurrentQueryId);
    else
       c2mQueryServers(mCurrentQueryId);
 }
 
 
+void MasterServerConnection::stopServerQuery()
+{
+   if(!mSubscribedToServerList)
+      return;
+
+   mSubscribedToServerList = false;
+   c2mUnsubscribeServerList();
+}
+
+
+bool MasterServerConnection::isSubscribedToServerList() const
+{
+   return mSubscribedToServerList;
+}
+
+
 #ifndef ZAP_DEDICATED
 
 
@@ -149,6 +177,37 @@ TNL_IMPLEMENT_RPC_OVERRIDE(MasterServerConnection, m2cQueryServersResponse_019a,
       mServerList.clear();
    }
 }
+
+
+// Master is telling us about a new server, or about a change to one we already know about
+TNL_IMPLEMENT_RPC_OVERRIDE(MasterServerConnection, m2cServerStatus, 
+                           (U32 queryId, IPAddress address, S32 serverId, 
+                            StringTableEntry serverName, StringTableEntry serverDescr, StringTableEntry levelName,
+                            U32 botCount, U32 playerCount, U32 maxPlayers, U32 infoFlags))
+{
+   if(mGame->isServer())
+      return;
+
+   if(!mSubscribedToServerList || queryId != mServerListQueryId)
+      return;
+
+   static_cast<ClientGame *>(mGame)->gotServerStatusFromMaster(Address(address), serverId, serverName.getString(), 
+                                                               serverDescr.getString(), playerCount, maxPlayers, botCount, 
+                                                               (infoFlags & TestModeFlag) != 0);
+}
+
+
+TNL_IMPLEMENT_RPC_OVERRIDE(MasterServerConnection, m2cServerRemoved, (U32 queryId, S32 serverId))
+{
+   if(mGame->isServer())
+      return;
+
+   if(!mSubscribedToServerList || queryId != mServerListQueryId)
+      return;
+
+   static_cast<ClientGame *>(mGame)->gotServerRemovedFromMaster(serverId);
+}
+
 #endif
 
 
@@ -27,6 +27,9 @@ class MasterServerConnection : public MasterServerInterface
 private:
    U32 mCurrentQueryId;    // ID of our current query
 
+   bool mSubscribedToServerList;    // True if the master is pushing server list changes to us
+   U32 mServerListQueryId;          // ID we used when subscribing; changes tagged with anything else are stale
+
    Game *mGame;
    string mMasterName;
 
@@ -52,6 +55,8 @@ public:
    string getMasterName();
 
    void startServerQuery(bool hostOnServer);
+   void stopServerQuery();
+   bool isSubscribedToServerList() const;
 
    Vector<ServerAddr> mServerList;
 
@@ -68,6 +73,11 @@ public:
 
    TNL_DECLARE_RPC_OVERRIDE(m2cQueryServersResponse, (U32 queryId, Vector<IPAddress> ipList));
    TNL_DECLARE_RPC_OVERRIDE(m2cQueryServersResponse_019a, (U32 queryId, Vector<IPAddress> ipList, Vector<S32> clientIdList));
+
+   TNL_DECLARE_RPC_OVERRIDE(m2cServerStatus, (U32 queryId, IPAddress address, S32 serverId, 
+                                              StringTableEntry serverName, StringTableEntry serverDescr, StringTableEntry levelName,
+                                              U32 botCount, U32 playerCount, U32 maxPlayers, U32 infoFlags));
+   TNL_DECLARE_RPC_OVERRIDE(m2cServerRemoved, (U32 queryId, S32 serverId));
 #endif
 
    TNL_DECLARE_RPC_OVERRIDE(m2sClientRequestedArrangedConnection, (U32 requestId, Vector<IPAddress> possibleAddresses,
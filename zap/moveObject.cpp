@@ -10,6 +10,7 @@
 
 #include "game.h"
 #include "gameConnection.h"
+#include "GameSettings.h"
 #include "ship.h"
 #include "Level.h"
 
@@ -701,8 +702,45 @@ void MoveObject::playCollisionSound(U32 stateIndex, MoveObject *moveObjectThatWa
 }
 
 
+// Remember the state we just unpacked, stamped with our best guess at when the server sent it
+void MoveObject::recordSnapshot(GhostConnection *connection)
+{
+   U32 sentTime = getGame()->getCurrentTime() - U32(connection->getOneWayTime());
+   mSnapshots.push(sentTime, getActualPos(), getActualVel(), getActualAngle());
+}
+
+
+// If the player wants an interpolation delay, render where our snapshots say we were that long ago, rather than
+// chasing our (extrapolated) actual position.  Returns false if we should smooth the old way.
+bool MoveObject::sampleSnapshots()
+{
+   if(mSnapshots.getCount() == 0)
+      return false;
+
+   GameSettings *settings = getGame()->getSettings();
+   U32 delay = settings->getSetting<U32>(IniKey::InterpolationDelay);
+
+   if(delay == 0)
+      return false;
+
+   Point pos, vel;
+   F32 angle;
+
+   mSnapshots.sample(getGame()->getCurrentTime() - delay, settings->getSetting<U32>(IniKey::MaxExtrapolation), pos, vel, angle);
+
+   setRenderPos(pos);
+   setRenderVel(vel);
+   setRenderAngle(angle);
+
+   return true;
+}
+
+
 void MoveObject::updateInterpolation()
 {
+   if(sampleSnapshots())
+      return;
+
    U32 deltaT = mCurrentMove.time;
    {
       setRenderAngle(getActualAngle());
@@ -1008,6 +1046,11 @@ void MoveItem::unpackUpdate(GhostConnection *connection, BitStream *stream)
    // Note that in order for WarpPositionMask to work, we also need to set PositionMask flag
    if(positionChanged)
    {
+      if(warpToNewPosition)
+         mSnapshots.clear();     // Don't interpolate across a warp
+
+      recordSnapshot(connection);
+
       if(warpToNewPosition)
       {
          // We get here during the initial object transfer, probably other times as well.
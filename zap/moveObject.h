@@ -7,6 +7,7 @@
 #define _MOVEOBJECT_H_
 
 #include "item.h"          // Parent class
+#include "SnapshotBuffer.h"
 #include "LuaWrapper.h"
 #include "DismountModesEnum.h"
 
@@ -67,6 +68,10 @@ protected:
    bool mInterpolating;
    F32 mMass;
    bool mWaitingForMoveToUpdate;  // client only
+   SnapshotBuffer mSnapshots;     // client only
+
+   void recordSnapshot(GhostConnection *connection);
+   bool sampleSnapshots();
 
    enum MaskBits {
       PositionMask     = Parent::FirstFreeMask << 0,     // Position has changed and needs to be updated
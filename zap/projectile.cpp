@@ -9,6 +9,7 @@
 #include "ship.h"
 #include "game.h"
 #include "gameConnection.h"
+#include "GameSettings.h"
 
 #ifndef ZAP_DEDICATED
 #  include "ClientGame.h"
@@ -20,6 +21,7 @@
 
 #include "stringUtils.h"
 #include "MathUtils.h"
+#include "GeomUtils.h"
 
 
 TNL_IMPLEMENT_NETOBJECT(Projectile);
@@ -217,6 +219,59 @@ void Projectile::onAddedToGame(Game *game)
    Parent::onAddedToGame(game);
 }
 
+// How far back in time the shooter was seeing other ships when they fired, as best we can tell.  The ships they saw
+// were already half a round trip old when they got them, and their shot took the other half to get here.  Only players'
+// shots are compensated; robots and turrets see things as they are.
+U32 Projectile::getLagCompensationTime() const
+{
+   if(isGhost() || !mShooter.isValid() || !isShipType(mShooter->getObjectTypeNumber()))
+      return 0;
+
+   GameConnection *conn = mShooter->getControllingClient();
+   if(!conn)
+      return 0;
+
+   U32 maxTime = min(getGame()->getSettings()->getSetting<U32>(IniKey::MaxLagCompensation), PositionHistory::MaxHistoryTime);
+
+   return min(U32(conn->getRoundTripTime()), maxTime);
+}
+
+
+// Finds the first ship not in excludeList that we would have hit on our way from startPos to endPos, if every ship
+// were where it was at the specified time
+static Ship *findRewoundShipHit(Game *game, U32 time, const Point &startPos, const Point &endPos,
+                                const Vector<DatabaseObject *> &excludeList, F32 &collisionTime, Point &surfNormal)
+{
+   Ship *hitShip = NULL;
+   collisionTime = 1;
+
+   for(S32 i = 0; i < game->getClientCount(); i++)
+   {
+      Ship *ship = game->getClientInfo(i)->getShip();
+
+      if(!ship || ship->isDestroyed() || !ship->isCollisionEnabled() || excludeList.contains(ship))
+         continue;
+
+      Point pos;
+      if(!ship->getRewoundPos(time, pos))
+         pos = ship->getRenderPos();
+
+      F32 t;
+      if(circleIntersectsSegment(pos, ship->getRadius(), startPos, endPos, t) && t < collisionTime)
+      {
+         collisionTime = t;
+         surfNormal = (startPos + (endPos - startPos) * t) - pos;
+         hitShip = ship;
+      }
+   }
+
+   if(hitShip)
+      surfNormal.normalize();
+
+   return hitShip;
+}
+
+
 void Projectile::idle(BfObject::IdleCallPath path)
 {
    U32 deltaT = mCurrentMove.time;
@@ -229,6 +284,14 @@ void Projectile::idle(BfObject::IdleCallPath path)
 
       Point startPos, collisionPoint;
 
+      // Scratch lists for our collision search, reused for each pass through the loop below
+      Vector<DatabaseObject *> candidates;
+      Vector<DatabaseObject *> excludeList;
+
+      // If our shooter was lagging, we'll check ships where they were when our shooter saw them, rather than where they are now
+      U32 lagCompensationTime = getLagCompensationTime();
+      U32 rewoundTime = getGame()->getCurrentTime() - lagCompensationTime;
+
       while(timeLeft > 0.01f && loopcount != 0)    // This loop is to prevent slow bounce on low frame rate / high time left
       {
          loopcount--;
@@ -238,47 +301,66 @@ void Projectile::idle(BfObject::IdleCallPath path)
          // Calculate where projectile will be at the end of the current interval
          Point endPos = startPos + (mVelocity * .001f) * timeLeft;    // mVelocity in units/sec, timeLeft in ms
 
-         // Check for collision along projected route of movement
-         static Vector<BfObject *> disabledList;
-
+         // Check for collision along projected route of movement.  We gather the candidates along our path
+         // once, then repeatedly test against that list, growing a local exclusion list of things we want to
+         // ignore.  This avoids re-walking the grid and avoids toggling collision flags on shared objects.
          Rect queryRect(startPos, endPos);     // Bounding box of our travels
 
-         disabledList.clear();
+         candidates.clear();
+         excludeList.clear();
 
+         GridDatabase *database = getDatabase();
+         if(database)
+            database->findObjects((TestFunc)isWeaponCollideableType, candidates, queryRect);
 
          // Don't collide with shooter during first 500ms of life
          if(mShooter.isValid() && objAge < 500 && !mBounced)
-         {
-            disabledList.push_back(mShooter);
-            mShooter->disableCollision();
-         }
+            excludeList.push_back(mShooter.getPointer());
 
-         BfObject *hitObject;
+         BfObject *hitObject = NULL;
 
          F32 collisionTime;
          Point surfNormal;
 
+         // Ships get checked separately, at their rewound positions
+         if(lagCompensationTime > 0)
+            for(S32 i = candidates.size() - 1; i >= 0; i--)
+               if(isShipType(candidates[i]->getObjectTypeNumber()))
+                  candidates.erase_fast(i);
+
          // Do the search
-         while(true)  
+         while(candidates.size() > 0 || lagCompensationTime > 0)
          {
-            hitObject = findObjectLOS((TestFunc)isWeaponCollideableType, RenderState, startPos, endPos, collisionTime, surfNormal);
+            hitObject = NULL;
+            collisionTime = 1;
+
+            if(candidates.size() > 0)
+               hitObject = static_cast<BfObject *>(
+                  database->findObjectLOS(candidates, RenderState, true, startPos, endPos, collisionTime, surfNormal, &excludeList));
+
+            if(lagCompensationTime > 0)
+            {
+               F32 shipCollisionTime;
+               Point shipSurfNormal;
+
+               Ship *ship = findRewoundShipHit(getGame(), rewoundTime, startPos, endPos, excludeList, shipCollisionTime, shipSurfNormal);
+
+               if(ship && (!hitObject || shipCollisionTime < collisionTime))
+               {
+                  hitObject = ship;
+                  collisionTime = shipCollisionTime;
+                  surfNormal = shipSurfNormal;
+               }
+            }
 
             if((!hitObject || hitObject->collide(this)))
                break;
 
-            // Disable collisions with things that don't want to be
-            // collided with (i.e. whose collide methods return false)
-            disabledList.push_back(hitObject);
-            hitObject->disableCollision();
+            // Ignore things that don't want to be collided with (i.e. whose collide methods return false)
+            excludeList.push_back(hitObject);
          }
 
-         // Re-enable collison flag for ship and items in our path that don't want to be collided with
-         // Note that if we hit an object that does want to be collided with, it won't be in disabledList
-         // and thus collisions will not have been disabled, and thus don't need to be re-enabled.
          // Our collision detection is done, and hitObject contains the first thing that the projectile hit.
-         for(S32 i = 0; i < disabledList.size(); i++)
-            disabledList[i]->enableCollision();
-
          if(hitObject)  // Hit something...  should we bounce?
          {
             bool bounce = false;
@@ -34,6 +34,7 @@ private:
    SafePtr<BfObject> mShooter;
 
    void initialize(WeaponType type, const Point &pos, const Point &vel, BfObject *shooter);
+   U32 getLagCompensationTime() const;
 
 protected:
    enum MaskBits {
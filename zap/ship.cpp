@@ -120,6 +120,8 @@ void Ship::initialize(ClientInfo *clientInfo, S32 team, const Point &pos)
    doClassSpecificInitialization(pos);
 
    mZones1IsCurrent = true;
+   mZoneCell = -1;
+   mZoneMapVersion = 0;
 
 #ifndef ZAP_DEDICATED
    mSparkElapsed = 0;
@@ -282,7 +284,10 @@ void Ship::setActualPos(const Point &p, bool warp)
    Parent::setRenderPos(p);
 
    if(warp)
+   {
       setMaskBits(PositionMask | WarpPositionMask | TeleportMask);
+      mPositionHistory.clear();     // Don't want to rewind anyone to somewhere between here and where we warped from
+   }
    else
       setMaskBits(PositionMask);
 }
@@ -356,8 +361,8 @@ F32 Ship::processMove(U32 stateIndex)
 // If ship is in multiple zones, an aribtrary one will be returned, and the level designer will be flogged.
 BfObject *Ship::isInAnyZone() const
 {
-   findObjectsUnderShip((TestFunc)isZoneType);  // Clears and fills fillVector
-   return doIsInZone(fillVector);
+   findZonesUnderShip();         // Clears and fills fillVector
+   return fillVector.size() > 0 ? static_cast<BfObject *>(fillVector[0]) : NULL;
 }
 
 
@@ -365,8 +370,8 @@ BfObject *Ship::isInAnyZone() const
 // If ship is in multiple zones of type zoneTypeNumber, an aribtrary one will be returned, and the level designer will be flogged.
 BfObject *Ship::isInZone(U8 zoneTypeNumber) const
 {
-   findObjectsUnderShip(zoneTypeNumber);        // Clears and fills fillVector
-   return doIsInZone(fillVector);
+   findZonesUnderShip();         // Clears and fills fillVector
+   return doIsInZone(fillVector, zoneTypeNumber);
 }
 
 
@@ -374,33 +379,39 @@ BfObject *Ship::isInZone(U8 zoneTypeNumber) const
 // If ship is in multiple zones of type zoneTypeNumber, an aribtrary one will be returned, and the level designer will be flogged.
 BfObject *Ship::isInZone(U8 zoneTypeNumber, S32 teamIndex) const
 {
-   findObjectsUnderShip(zoneTypeNumber);        // Clears and fills fillVector
-   return doIsInZone(fillVector, teamIndex);
+   findZonesUnderShip();         // Clears and fills fillVector
+   return doIsInZone(fillVector, zoneTypeNumber, teamIndex);
 }
 
 
-// Private helper for isInZone() and isInAnyZone() -- these fill fillVector, and we operate on it below
-// Note: teamIndex defaults to NO_TEAM
-BfObject *Ship::doIsInZone(const Vector<DatabaseObject *> &objects, S32 teamIndex) const
+// Private helper for isInZone() and isInAnyZone() -- the level's ZoneMap does the hard work here
+void Ship::findZonesUnderShip() const
 {
-   if(objects.size() == 0)  // Ship isn't in extent of any objectType objects, can bail here
-      return NULL;
+   fillVector.clear();
+
+   GridDatabase *database = getDatabase();
+
+   if(database)
+      database->getZoneMap()->findZones(getActualPos(), fillVector);
+}
 
-   // Extents overlap...  now check for actual overlap
 
-   for(S32 i = 0; i < objects.size(); i++)
+// Private helper for isInZone() -- picks the first of the zones we're in with the right type and team
+// Note: teamIndex defaults to NO_TEAM
+BfObject *Ship::doIsInZone(const Vector<DatabaseObject *> &zones, U8 zoneTypeNumber, S32 teamIndex) const
+{
+   for(S32 i = 0; i < zones.size(); i++)
    {
-      BfObject *zone = static_cast<BfObject *>(objects[i]);
+      BfObject *zone = static_cast<BfObject *>(zones[i]);
+
+      if(zone->getObjectTypeNumber() != zoneTypeNumber)
+         continue;
 
       // Ignore zones not on the specified team
       if(teamIndex != NO_TEAM && zone->getTeam() != teamIndex)
          continue;
 
-      // Get points that define the zone boundaries
-      const Vector<Point> *polyPoints = zone->getCollisionPoly();
-
-      if( polyPoints->size() != 0 && polygonContainsPoint(polyPoints->address(), polyPoints->size(), getActualPos()) )
-         return zone;
+      return zone;
    }
 
    return NULL;
@@ -532,6 +543,14 @@ void Ship::processWeaponFire()
    }
 }
 
+// Where we were at the specified game time, as far as projectiles were concerned.  Server only; returns false if
+// we don't know.
+bool Ship::getRewoundPos(U32 time, Point &pos) const
+{
+   return mPositionHistory.getPos(time, pos);
+}
+
+
 // Compute the delta between our current render position and the server position after 
 // client-side prediction has been run
 void Ship::controlMoveReplayComplete()
@@ -652,7 +671,10 @@ void Ship::idle(IdleCallPath path)
    }
 
    if(path == ServerIdleMainLoop)
+   {
       checkForZones();        // See if ship entered or left any zones
+      mPositionHistory.record(getGame()->getCurrentTime(), getRenderPos());
+   }
 
    // Update the object in the game's extents database
    updateExtentInDatabase();
@@ -691,6 +713,10 @@ void Ship::idle(IdleCallPath path)
 
    if(path == ClientIdlingLocalShip || path == ClientIdlingNotLocalShip)
    {
+      // We may have picked up a snapshot before we knew this ship was ours
+      if(path == ClientIdlingLocalShip)
+         mSnapshots.clear();
+
       // On the client, update the interpolation of this object unless we are replaying control moves
       mInterpolating = (getActualVel().lenSquared() < MoveObject::InterpMaxVelocity*MoveObject::InterpMaxVelocity);
       updateInterpolation();
@@ -713,13 +739,6 @@ Vector<SafePtr<Zone> > &Ship::getCurrZoneList()
 }
 
 
-// Get list of zones ship was in last tick
-Vector<SafePtr<Zone> > &Ship::getPrevZoneList()
-{
-   return mZones1IsCurrent ? mZones2 : mZones1;
-}
-
-
 bool Ship::checkForSpeedzones(U32 stateIndex)
 {
    SpeedZone *speedZone = static_cast<SpeedZone *>(isOnObject(SpeedZoneTypeNumber, stateIndex));
@@ -733,8 +752,26 @@ bool Ship::checkForSpeedzones(U32 stateIndex)
 // Server only
 void Ship::checkForZones()
 {
+   GridDatabase *database = getDatabase();
+
+   if(!database)
+      return;
+
+   const ZoneMap *zoneMap = database->getZoneMap();
+   S32 cell = zoneMap->getCell(getActualPos());
+
+   // If we haven't left the cell we were in last time, and no zone edges pass through it, we can't have entered or
+   // left anything.  This is where ships spend nearly all their time.
+   if(cell == mZoneCell && zoneMap->getVersion() == mZoneMapVersion && !zoneMap->isBoundaryCell(cell))
+      return;
+
+   mZoneCell = cell;
+   mZoneMapVersion = zoneMap->getVersion();
+
+   // Flip our lists, so the current one becomes the previous one without copying
+   Vector<SafePtr<Zone> > &prevZoneList = getCurrZoneList();
+   mZones1IsCurrent = !mZones1IsCurrent;
    Vector<SafePtr<Zone> > &currZoneList = getCurrZoneList();
-   Vector<SafePtr<Zone> > &prevZoneList = getPrevZoneList();
 
    getZonesShipIsIn(currZoneList);     // Fill currZoneList with a list of all zones ship is currently in
 
@@ -754,25 +791,12 @@ void Ship::checkForZones()
 // Server only
 void Ship::getZonesShipIsIn(Vector<SafePtr<Zone> > &zoneList)
 {
-   // Use this boolean as a cheap way of making the current zone list be the previous out without copying
-   mZones1IsCurrent = !mZones1IsCurrent;     
-
    zoneList.clear();
 
-   Rect rect(getActualPos(), getActualPos());      // Center of ship
-
-   fillVector.clear();                             
-   findObjects((TestFunc)isZoneType, fillVector, rect);  // Find all zones the ship might be in
+   findZonesUnderShip();         // Clears and fills fillVector
 
-   // Extents overlap...  now check for actual overlap
    for(S32 i = 0; i < fillVector.size(); i++)
-   {
-      // Get points that define the zone boundaries
-      const Vector<Point> *polyPoints = fillVector[i]->getCollisionPoly();
-
-      if(polygonContainsPoint(polyPoints->address(), polyPoints->size(), getActualPos()))
-         zoneList.push_back(SafePtr<Zone>(static_cast<Zone*>(fillVector[i])));
-   }
+      zoneList.push_back(SafePtr<Zone>(static_cast<Zone*>(fillVector[i])));
 }
 
 
@@ -1706,6 +1730,15 @@ void Ship::unpackUpdate(GhostConnection *connection, BitStream *stream)
 
    setActualAngle(mCurrentMove.angle);
 
+   // Our own ship is predicted from our moves, so only remote ships get snapshots
+   if(positionChanged && ((GameConnection *)connection)->getControlObject() != this)
+   {
+      if(shipwarped)
+         mSnapshots.clear();     // Don't interpolate across a warp
+
+      recordSnapshot(connection);
+   }
+
    if(positionChanged)
       onPositionChanged(connection);
 
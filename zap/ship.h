@@ -8,6 +8,7 @@
 
 #include "moveObject.h"
 #include "LoadoutTracker.h"
+#include "PositionHistory.h"
 #include "TeamConstants.h"
 
 #include "Timer.h"
@@ -45,6 +46,8 @@ private:
    Vector<SafePtr<Zone> > mZones1;      // A list of zones the ship is currently in
    Vector<SafePtr<Zone> > mZones2;
    bool mZones1IsCurrent;
+   S32 mZoneCell;                       // Cell of the level's ZoneMap we were in when we last checked our zones
+   U32 mZoneMapVersion;                 // ...and which version of the map that was
    bool mFastRecharging;
 
    F32 mLastProcessStateAngle;
@@ -54,7 +57,7 @@ private:
    Teleporter *mEngineeredTeleporter;
 
    // Find objects of specified type that may be under the ship, and put them in fillVector.  This is a private helper
-   // for isInZone() and isInAnyZone().
+   // for isOnObject().
    template <typename T>
    void findObjectsUnderShip(T typeNumberOrFunction) const
    {
@@ -66,7 +69,8 @@ private:
    }
 
 
-   BfObject *doIsInZone(const Vector<DatabaseObject *> &objects, S32 teamIndex = NO_TEAM) const; // Private helper for isInZone() and isInAnyZone()
+   void findZonesUnderShip() const;   // Put the zones the ship is in into fillVector; private helper for isInZone() and isInAnyZone()
+   BfObject *doIsInZone(const Vector<DatabaseObject *> &zones, U8 zoneTypeNumber, S32 teamIndex = NO_TEAM) const;
 
    // Idle helpers
    bool checkForSpeedzones(U32 stateIndex = ActualState); // Check to see if we collided with a GoFast
@@ -75,7 +79,6 @@ private:
    bool isLocalPlayerShip(Game *game) const;       // Returns true if ship represents local player
   
    Vector<SafePtr<Zone> > &getCurrZoneList();    // Get list of zones ship is currently in
-   Vector<SafePtr<Zone> > &getPrevZoneList();    // Get list of zones ship was in last tick
 
    bool doesShipActivateSensor(const Ship *ship);
    F32 getShipVisibility(const Ship *localShip);
@@ -94,6 +97,8 @@ protected:
 
    Point mSpawnPoint;      // Where ship or robot spawned.  Will only be valid on server, client doesn't currently get this.
 
+   PositionHistory mPositionHistory;   // Where we've been recently, for lag compensation.  Server only.
+
    virtual void initialize(const Point &pos);   // Some initialization code needed by both bots and ships
    virtual void doClassSpecificInitialization(const Point &pos);
 
@@ -274,6 +279,8 @@ public:
    void controlMoveReplayComplete();
    void onAddedToGame(Game *game);
 
+   bool getRewoundPos(U32 time, Point &pos) const;
+
    void emitExplosion();
    void setActualPos(const Point &p, bool warp);
    bool isModulePrimaryActive(ShipModule module);
@@ -628,6 +628,29 @@ bool fileExists(const string &path)
 }
 
 
+// Gets size and last-modified time of file, in nanoseconds; returns false if file doesn't exist.  We use the finest
+// resolution the platform will give us, so two saves in the same second don't look like the same file.
+bool getFileSizeAndTime(const string &path, U64 &size, U64 &modifiedTime)
+{
+   struct stat st;
+
+   if(stat(path.c_str(), &st) != 0)
+      return false;
+
+   size = (U64)st.st_size;
+
+#if defined(TNL_OS_LINUX)
+   modifiedTime = (U64)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#elif defined(TNL_OS_MAC_OSX) || defined(TNL_OS_IOS)
+   modifiedTime = (U64)st.st_mtimespec.tv_sec * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+   modifiedTime = (U64)st.st_mtime * 1000000000;
+#endif
+
+   return true;
+}
+
+
 // Checks if specified folder exists; creates it if not
 bool makeSureFolderExists(const string &folder)
 {
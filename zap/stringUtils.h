@@ -93,6 +93,7 @@ bool caseInsensitiveStringCompare(const string &str1, const string &str2);
 // File utils
 string getFileSeparator();
 bool fileExists(const string &path);               // Does file exist?
+bool getFileSizeAndTime(const string &path, U64 &size, U64 &modifiedTime);    // Time is in ns; returns false if file doesn't exist
 bool makeSureFolderExists(const string &dir);      // Like the man said: Make sure folder exists
 
 enum ReturnFileType {
@@ -121,6 +121,11 @@ ByteBufferPtr VoiceDecoder::decompressBuffer(const ByteBufferPtr &compressedBuff
    return decodedBuffer;
 }
 
+void VoiceDecoder::concealFrame(S16 *framePtr)
+{
+   memset(framePtr, 0, getSamplesPerFrame() * sizeof(S16));
+}
+
 
 
 #ifdef BF_NO_VOICECHAT
@@ -135,6 +140,7 @@ SpeexVoiceDecoder::~SpeexVoiceDecoder() { /* Do nothing */  }
 U32 SpeexVoiceDecoder::getSamplesPerFrame() { return 0; }
 U32 SpeexVoiceDecoder::getAvgCompressedFrameSize() { return 0; }
 U32 SpeexVoiceDecoder::decompressFrame(S16 *framePtr, U8 *inputPtr, U32 inSize) { return 0; }
+void SpeexVoiceDecoder::concealFrame(S16 *framePtr) { /* Do nothing */ }
 
 // Begin Speex
 #else // BF_NO_VOICECHAT
@@ -205,6 +211,12 @@ U32 SpeexVoiceDecoder::decompressFrame(S16 *framePtr, U8 *inputPtr, U32 inSize)
 
    return maxFrameByteSize;
 }
+
+// Speex does its own packet loss concealment when we decode without any bits
+void SpeexVoiceDecoder::concealFrame(S16 *framePtr)
+{
+   speex_decode_int(decoderState, NULL, framePtr);
+}
 #endif // BF_NO_VOICECHAT
 
 
@@ -8,7 +8,8 @@
 
 #include "tnlByteBuffer.h"
 
-#if defined(TNL_OS_MOBILE) || defined(BF_NO_AUDIO) || defined(ZAP_DEDICATED)
+// The codec needs only Speex, not a sound device, so dedicated servers have it too and can mix voice chat
+#if defined(TNL_OS_MOBILE)
 #  ifndef BF_NO_VOICECHAT
 #     define BF_NO_VOICECHAT
 #  endif
@@ -50,7 +51,6 @@ public:
 /// 16 bit sample buffer.
 class VoiceDecoder : public Object
 {
-   virtual U32 getSamplesPerFrame() = 0;
    virtual U32 getAvgCompressedFrameSize() = 0;
 
    virtual U32 decompressFrame(S16 *framePtr, U8 *inputPtr, U32 inSize) = 0;
@@ -58,7 +58,13 @@ public:
    VoiceDecoder();
    virtual ~VoiceDecoder();
 
+   virtual U32 getSamplesPerFrame() = 0;
+
    ByteBufferPtr decompressBuffer(const ByteBufferPtr &compressedBuffer);
+
+   /// Fills in a frame that never arrived with our best guess at what it
+   /// sounded like, based on what came before.  By default, silence.
+   virtual void concealFrame(S16 *framePtr);
 };
 
 /// The SpeexVoiceEncoder class implements the Speex codec
@@ -85,13 +91,15 @@ class SpeexVoiceDecoder : public VoiceDecoder
    static const U32 maxFrameByteSize = 33;
 
    void *decoderState;
-   U32 getSamplesPerFrame();
    U32 getAvgCompressedFrameSize();
 
    U32 decompressFrame(S16 *framePtr, U8 *inputPtr, U32 inSize);
 public:
    SpeexVoiceDecoder();
    virtual ~SpeexVoiceDecoder();
+
+   U32 getSamplesPerFrame();
+   void concealFrame(S16 *framePtr);
 };
 
 };